@@ -0,0 +1,311 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+// LOCAL
+#include "PacketConsumer.h"
+#include "vtkLidarReader.h"
+#include "vtkPacketFileReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+// VTK
+#include <vtkNew.h>
+#include <vtkTimerLog.h>
+
+// BOOST
+#include <boost/thread/thread.hpp>
+
+// STD
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+/**
+ * @brief The BenchmarkResult struct contains the measures made on one decoding path
+ */
+struct BenchmarkResult
+{
+  std::string Name;
+  //! best elapsed time over all repetitions, in seconds
+  double ElapsedTime = std::numeric_limits<double>::max();
+  unsigned long NumberOfPackets = 0;
+  unsigned long NumberOfFrames = 0;
+  unsigned long NumberOfPoints = 0;
+};
+
+//-----------------------------------------------------------------------------
+std::string EscapeJSON(const std::string& str)
+{
+  std::string escaped;
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+      escaped += c;
+    }
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      // control characters are not allowed in JSON strings
+      char code[7];
+      std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+      escaped += code;
+    }
+    else
+    {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::string> LoadLidarPackets(const std::string& pcapFileName,
+                                          vtkLidarPacketInterpreter* interpreter)
+{
+  std::vector<std::string> packets;
+  vtkPacketFileReader reader;
+  if (!reader.Open(pcapFileName))
+  {
+    std::cerr << "Failed to open packet file: " << pcapFileName << std::endl
+              << reader.GetLastError() << std::endl;
+    return packets;
+  }
+
+  const unsigned char* data = nullptr;
+  unsigned int dataLength = 0;
+  double timeSinceStart = 0;
+  while (reader.NextPacket(data, dataLength, timeSinceStart))
+  {
+    if (interpreter->IsLidarPacket(data, dataLength))
+    {
+      packets.emplace_back(reinterpret_cast<const char*>(data), dataLength);
+    }
+  }
+  return packets;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkLidarReader> CreateReader(const std::string& pcapFileName,
+                                             const std::string& calibrationFileName)
+{
+  auto reader = vtkSmartPointer<vtkLidarReader>::New();
+  auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  reader->SetInterpreter(interpreter);
+  reader->SetFileName(pcapFileName);
+  reader->SetCalibrationFileName(calibrationFileName);
+  return reader;
+}
+
+//-----------------------------------------------------------------------------
+void BenchmarkReadFrameInformation(const std::string& pcapFileName,
+                                   const std::string& calibrationFileName,
+                                   BenchmarkResult& result)
+{
+  // a new reader is needed as the frame index is only built once
+  vtkSmartPointer<vtkLidarReader> reader = CreateReader(pcapFileName, calibrationFileName);
+
+  const double startTime = vtkTimerLog::GetUniversalTime();
+  reader->UpdateInformation();
+  const double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  result.ElapsedTime = std::min(result.ElapsedTime, elapsedTime);
+  result.NumberOfFrames = reader->GetNumberOfFrames();
+}
+
+//-----------------------------------------------------------------------------
+void BenchmarkGetFrame(const std::string& pcapFileName,
+                       const std::string& calibrationFileName,
+                       BenchmarkResult& result)
+{
+  vtkSmartPointer<vtkLidarReader> reader = CreateReader(pcapFileName, calibrationFileName);
+  reader->UpdateInformation();
+  reader->Open();
+
+  unsigned long numberOfPoints = 0;
+  const int numberOfFrames = reader->GetNumberOfFrames();
+  const double startTime = vtkTimerLog::GetUniversalTime();
+  for (int frame = 0; frame < numberOfFrames; ++frame)
+  {
+    vtkSmartPointer<vtkPolyData> polyData = reader->GetFrame(frame);
+    if (polyData)
+    {
+      numberOfPoints += polyData->GetNumberOfPoints();
+    }
+  }
+  const double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+  reader->Close();
+
+  result.ElapsedTime = std::min(result.ElapsedTime, elapsedTime);
+  result.NumberOfFrames = numberOfFrames;
+  result.NumberOfPoints = numberOfPoints;
+}
+
+//-----------------------------------------------------------------------------
+void BenchmarkPacketConsumer(const std::vector<std::string>& packets,
+                             const std::string& calibrationFileName,
+                             BenchmarkResult& result)
+{
+  auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  interpreter->LoadCalibration(calibrationFileName);
+
+  PacketConsumer consumer;
+  consumer.SetInterpreter(interpreter);
+  // keep all frames to be able to count the points
+  consumer.SetMaxNumberOfFrames(0);
+  // the whole capture is queued at once, it must be fully decoded like a sensor
+  // the machine keeps up with, instead of shedding work to drain the backlog
+  consumer.SetOverloadPolicy(OverloadController::Disabled);
+  consumer.Start();
+
+  // same as the PacketReceiver, each packet is copied before being enqueued
+  const double startTime = vtkTimerLog::GetUniversalTime();
+  for (const std::string& packet : packets)
+  {
+    consumer.Enqueue(new std::string(packet));
+  }
+  consumer.WaitForProcessedPackets(packets.size());
+  const double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+  consumer.Stop();
+
+  unsigned long numberOfPoints = 0;
+  std::vector<double> timesteps = consumer.GetTimesteps();
+  {
+    boost::lock_guard<boost::mutex> lock(consumer.ConsumerMutex);
+    for (double time : timesteps)
+    {
+      double actualTime;
+      vtkSmartPointer<vtkPolyData> polyData = consumer.GetFrameForTime(time, actualTime);
+      if (polyData)
+      {
+        numberOfPoints += polyData->GetNumberOfPoints();
+      }
+    }
+  }
+
+  result.ElapsedTime = std::min(result.ElapsedTime, elapsedTime);
+  result.NumberOfFrames = timesteps.size();
+  result.NumberOfPoints = numberOfPoints;
+}
+
+//-----------------------------------------------------------------------------
+void WriteResults(std::ostream& os, const std::string& sensorName, const std::string& pcapFileName,
+                  int repetitions, const std::vector<BenchmarkResult>& results)
+{
+  os << "{" << std::endl
+     << "  \"sensor\": \"" << EscapeJSON(sensorName) << "\"," << std::endl
+     << "  \"pcap\": \"" << EscapeJSON(pcapFileName) << "\"," << std::endl
+     << "  \"repetitions\": " << repetitions << "," << std::endl
+     << "  \"benchmarks\": [" << std::endl;
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& r = results[i];
+    const double elapsedTime = std::max(r.ElapsedTime, std::numeric_limits<double>::epsilon());
+    os << "    {" << std::endl
+       << "      \"name\": \"" << EscapeJSON(r.Name) << "\"," << std::endl
+       << "      \"elapsed_s\": " << r.ElapsedTime << "," << std::endl
+       << "      \"packets\": " << r.NumberOfPackets << "," << std::endl
+       << "      \"frames\": " << r.NumberOfFrames << "," << std::endl
+       << "      \"points\": " << r.NumberOfPoints << "," << std::endl
+       << "      \"packets_per_s\": " << r.NumberOfPackets / elapsedTime << "," << std::endl
+       << "      \"points_per_s\": " << r.NumberOfPoints / elapsedTime << std::endl
+       << "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+  }
+  os << "  ]" << std::endl
+     << "}" << std::endl;
+}
+}
+
+/**
+ * @brief BenchmarkLidarDecoding measures the decoding throughput of a pcap file along
+ * the 3 paths used by VeloView: the frame indexing (vtkLidarReader::ReadFrameInformation),
+ * the frame decoding (vtkLidarReader::GetFrame) and the live path (PacketConsumer).
+ * Each measure is repeated and the best time is kept. Results are written in JSON.
+ * @param pcapFileName the pcap to replay
+ * @param calibrationFileName the XML sensor calibration file, can be empty for live calibration
+ * @param sensorName name of the sensor reported in the results
+ * @param outputFileName JSON file where the results are written
+ * @param repetitions (optional) number of repetitions of each measure, default to 3
+ * @return 0 on success, 1 on failure
+ */
+int main(int argc, char* argv[])
+{
+  if (argc < 5)
+  {
+    std::cerr << "Wrong number of arguments. Usage: BenchmarkLidarDecoding <pcapFileName> "
+                 "<correctionFileName> <sensorName> <outputFileName> [repetitions]" << std::endl;
+    return 1;
+  }
+
+  // get command line parameter
+  std::string pcapFileName = argv[1];
+  std::string calibrationFileName = argv[2];
+  std::string sensorName = argv[3];
+  std::string outputFileName = argv[4];
+  int repetitions = argc > 5 ? std::max(1, std::atoi(argv[5])) : 3;
+
+  std::cout << "-------------------------------------------------------------------------" << std::endl
+            << "Pcap :\t" << pcapFileName << std::endl
+            << "Corrections :\t" << calibrationFileName << std::endl
+            << "Sensor :\t" << sensorName << std::endl
+            << "-------------------------------------------------------------------------" << std::endl;
+
+  // load all lidar packets in memory, so that the live path is not bound by the disk
+  vtkNew<vtkVelodynePacketInterpreter> interpreter;
+  std::vector<std::string> packets = LoadLidarPackets(pcapFileName, interpreter.Get());
+  if (packets.empty())
+  {
+    std::cerr << "No lidar packet found in " << pcapFileName << std::endl;
+    return 1;
+  }
+
+  std::vector<BenchmarkResult> results(3);
+  results[0].Name = "ReadFrameInformation";
+  results[1].Name = "GetFrame";
+  results[2].Name = "PacketConsumer";
+  for (BenchmarkResult& result : results)
+  {
+    result.NumberOfPackets = packets.size();
+  }
+
+  for (int i = 0; i < repetitions; ++i)
+  {
+    BenchmarkReadFrameInformation(pcapFileName, calibrationFileName, results[0]);
+    BenchmarkGetFrame(pcapFileName, calibrationFileName, results[1]);
+    BenchmarkPacketConsumer(packets, calibrationFileName, results[2]);
+  }
+  // the frame index does not create any point, report the one decoded by GetFrame
+  results[0].NumberOfPoints = results[1].NumberOfPoints;
+
+  WriteResults(std::cout, sensorName, pcapFileName, repetitions, results);
+
+  std::ofstream output(outputFileName);
+  if (!output.is_open())
+  {
+    std::cerr << "Could not open " << outputFileName << " for writing" << std::endl;
+    return 1;
+  }
+  WriteResults(output, sensorName, pcapFileName, repetitions, results);
+
+  return 0;
+}
@@ -20,6 +20,9 @@
 #ifndef CERES_COST_FUNCTIONS_H
 #define CERES_COST_FUNCTIONS_H
 
+// STD
+#include <cmath>
+
 // EIGEN
 #include <Eigen/Dense>
 
@@ -497,6 +500,110 @@ private:
   Eigen::Vector3d V1, V2, U1, U2;
 };
 
+/**
+* \class AggregatedRotationAndTranslationCalibrationResidual
+* \brief Sum of many FrobeniusDistanceRotationAndTranslationCalibrationResidual
+*        constraints, evaluated in constant time with analytic derivatives.
+*
+* Since R is a rotation, the squared residual of a constraint is:
+* |R' * (A * T + b) - c|^2 = |A * T + b - R * c|^2
+* with A = Q0' * Q1 - I, b = Q0' * (U1 - U0) and c = P0' * (V1 - V0).
+* This residual is linear in z = (T, vec(R), 1): it is Jk * z, with Jk a 3x13
+* matrix. The sum of the squared residuals is then z' * G * z, G being the sum
+* of the Jk' * Jk. G is computed once from all the constraints and decomposed
+* as G = S' * S, so that the problem is solved using the 13 residuals S * z,
+* whatever the number of constraints. R is parametrized by its euler angles, as
+* in FrobeniusDistanceRotationAndTranslationCalibrationResidual.
+*
+* AddConstraint must be called for all the constraints before Finalize, which
+* must be called before the cost function is evaluated.
+*/
+//-----------------------------------------------------------------------------
+class AggregatedRotationAndTranslationCalibrationResidual : public ceres::SizedCostFunction<13, 6>
+{
+public:
+  typedef Eigen::Matrix<double, 13, 13> Matrix13d;
+
+  AggregatedRotationAndTranslationCalibrationResidual()
+  {
+    this->Gram.setZero();
+    this->SqrtGram.setZero();
+  }
+
+  //! Add the constraint of FrobeniusDistanceRotationAndTranslationCalibrationResidual(P1, P2, Q1, Q2, V1, V2, U1, U2)
+  void AddConstraint(const Eigen::Matrix3d& P1, const Eigen::Matrix3d& Q1, const Eigen::Matrix3d& Q2,
+                     const Eigen::Vector3d& V1, const Eigen::Vector3d& V2,
+                     const Eigen::Vector3d& U1, const Eigen::Vector3d& U2)
+  {
+    const Eigen::Vector3d c = P1.transpose() * (V2 - V1);
+    Eigen::Matrix<double, 3, 13> J;
+    J.block<3, 3>(0, 0) = Q1.transpose() * Q2 - Eigen::Matrix3d::Identity();
+    for (int j = 0; j < 3; ++j)
+    {
+      // R * c is the sum of the columns of R weighted by c
+      J.block<3, 3>(0, 3 + 3 * j) = -c(j) * Eigen::Matrix3d::Identity();
+    }
+    J.col(12) = Q1.transpose() * (U2 - U1);
+    this->Gram.noalias() += J.transpose() * J;
+    this->NbConstraints++;
+  }
+
+  //! Compute the square root of the sum of the constraints
+  void Finalize()
+  {
+    Eigen::SelfAdjointEigenSolver<Matrix13d> eigen(this->Gram);
+    // G is positive semi-definite, clamp its rounding errors
+    const Eigen::Matrix<double, 13, 1> sqrtEigenValues = eigen.eigenvalues().cwiseMax(0.).cwiseSqrt();
+    this->SqrtGram = sqrtEigenValues.asDiagonal() * eigen.eigenvectors().transpose();
+  }
+
+  int GetNumberOfConstraints() const { return this->NbConstraints; }
+
+  bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override
+  {
+    const double* w = parameters[0];
+
+    // store sin / cos values for this angle
+    const double crx = std::cos(w[0]); const double srx = std::sin(w[0]);
+    const double cry = std::cos(w[1]); const double sry = std::sin(w[1]);
+    const double crz = std::cos(w[2]); const double srz = std::sin(w[2]);
+
+    // R = Rz * Ry * Rx, and the derivatives of each elementary rotation
+    Eigen::Matrix3d Rx, Ry, Rz, dRx, dRy, dRz;
+    Rx << 1, 0, 0, 0, crx, -srx, 0, srx, crx;
+    Ry << cry, 0, sry, 0, 1, 0, -sry, 0, cry;
+    Rz << crz, -srz, 0, srz, crz, 0, 0, 0, 1;
+    dRx << 0, 0, 0, 0, -srx, -crx, 0, crx, -srx;
+    dRy << -sry, 0, cry, 0, 0, 0, -cry, 0, -sry;
+    dRz << -srz, -crz, 0, crz, -srz, 0, 0, 0, 0;
+    const Eigen::Matrix3d R = Rz * Ry * Rx;
+
+    Eigen::Matrix<double, 13, 1> z;
+    z << w[3], w[4], w[5], Eigen::Map<const Eigen::Matrix<double, 9, 1> >(R.data()), 1.;
+    Eigen::Map<Eigen::Matrix<double, 13, 1> > residualsMap(residuals);
+    residualsMap = this->SqrtGram * z;
+
+    if (jacobians && jacobians[0])
+    {
+      const Eigen::Matrix3d dR[3] = { Rz * Ry * dRx, Rz * dRy * Rx, dRz * Ry * Rx };
+      Eigen::Matrix<double, 13, 6> dz = Eigen::Matrix<double, 13, 6>::Zero();
+      for (int k = 0; k < 3; ++k)
+      {
+        dz.block<9, 1>(3, k) = Eigen::Map<const Eigen::Matrix<double, 9, 1> >(dR[k].data());
+      }
+      dz.block<3, 3>(0, 3).setIdentity();
+      Eigen::Map<Eigen::Matrix<double, 13, 6, Eigen::RowMajor> > jacobianMap(jacobians[0]);
+      jacobianMap = this->SqrtGram * dz;
+    }
+    return true;
+  }
+
+private:
+  Matrix13d Gram;
+  Matrix13d SqrtGram;
+  int NbConstraints = 0;
+};
+
 /**
 * \class EuclideanDistanceAffineIsometryResidual
 * \brief Cost function to minimize to estimate the rotation and translation
@@ -576,6 +683,82 @@ public:
 private:
   Eigen::Vector3d X, Y;
 };
+
+/**
+* \class RelativePoseResidual
+* \brief Cost function of a pose graph edge: difference between the relative
+*        motion (Rij, Tij) measured between two poses i and j, and the relative
+*        motion given by the current estimation of the poses Wi and Wj:
+*
+*        Ri^t * Rj = Rij
+*        Ri^t * (Tj - Ti) = Tij
+*
+*        The rotation error is expressed as an angle-axis vector and the
+*        translation error in the frame of the measurement. Both are weighted
+*        by the inverse of their expected standard deviation.
+*        As in the other cost functions, the poses are parametrized by their
+*        euler angles: R(rx, ry, rz) = Rz(rz) * Ry(ry) * Rx(rx)
+*/
+//-----------------------------------------------------------------------------
+struct RelativePoseResidual
+{
+public:
+  RelativePoseResidual(const Eigen::Matrix3d& argR, const Eigen::Vector3d& argT,
+                       double argRotationWeight, double argTranslationWeight)
+  {
+    this->R = argR;
+    this->T = argT;
+    this->RotationWeight = argRotationWeight;
+    this->TranslationWeight = argTranslationWeight;
+  }
+
+  template <typename Scalar>
+  bool operator()(const Scalar* const wi, const Scalar* const wj, Scalar* residual) const
+  {
+    Eigen::Matrix<Scalar, 3, 3> Ri = RotationMatrix(wi);
+    Eigen::Matrix<Scalar, 3, 3> Rj = RotationMatrix(wj);
+    Eigen::Matrix<Scalar, 3, 1> dT;
+    dT << wj[3] - wi[3], wj[4] - wi[4], wj[5] - wi[5];
+
+    Eigen::Matrix<Scalar, 3, 3> Rm = this->R.cast<Scalar>();
+    Eigen::Matrix<Scalar, 3, 1> Tm = this->T.cast<Scalar>();
+
+    // rotation error
+    Eigen::Matrix<Scalar, 3, 3> Rerror = Rm.transpose() * Ri.transpose() * Rj;
+    ceres::RotationMatrixToAngleAxis(ceres::ColumnMajorAdapter3x3(Rerror.data()), residual);
+
+    // translation error
+    Eigen::Matrix<Scalar, 3, 1> Terror = Rm.transpose() * (Ri.transpose() * dT - Tm);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      residual[i] *= Scalar(this->RotationWeight);
+      residual[i + 3] = Scalar(this->TranslationWeight) * Terror(i);
+    }
+    return true;
+  }
+
+private:
+  template <typename Scalar>
+  static Eigen::Matrix<Scalar, 3, 3> RotationMatrix(const Scalar* const w)
+  {
+    // store sin / cos values for this angle
+    Scalar crx = ceres::cos(w[0]); Scalar srx = ceres::sin(w[0]);
+    Scalar cry = ceres::cos(w[1]); Scalar sry = ceres::sin(w[1]);
+    Scalar crz = ceres::cos(w[2]); Scalar srz = ceres::sin(w[2]);
+
+    Eigen::Matrix<Scalar, 3, 3> rotation;
+    rotation << cry*crz, (srx*sry*crz-crx*srz), (crx*sry*crz+srx*srz),
+                cry*srz, (srx*sry*srz+crx*crz), (crx*sry*srz-srx*crz),
+                   -sry,               srx*cry,               crx*cry;
+    return rotation;
+  }
+
+  Eigen::Matrix3d R;
+  Eigen::Vector3d T;
+  double RotationWeight;
+  double TranslationWeight;
+};
 }
 
 #endif // CERES_COST_FUNCTIONS_H
@@ -33,7 +33,10 @@
 #define __vtkPacketFileReader_h
 
 #include <pcap.h>
+
+#include <algorithm>
 #include <string>
+#include <vector>
 
 // Some versions of libpcap do not have PCAP_NETMASK_UNKNOWN
 #if !defined(PCAP_NETMASK_UNKNOWN)
@@ -134,6 +137,120 @@ public:
 #endif
   }
 
+  // Get the byte offset of the next packet record in the file.
+  // This is not available with MSVC as the FILE of libpcap can not be accessed
+  bool GetFileOffset(long long& offset)
+  {
+#ifdef _MSC_VER
+    return false;
+#else
+    if (!this->PCAPFile)
+    {
+      return false;
+    }
+    offset = ftello(pcap_file(this->PCAPFile));
+    return offset >= 0;
+#endif
+  }
+
+  // Move to the packet record starting at the given byte offset,
+  // which must come from GetFileOffset or FindPacketRecord
+  bool SetFileOffset(long long offset)
+  {
+#ifdef _MSC_VER
+    return false;
+#else
+    return this->PCAPFile && fseeko(pcap_file(this->PCAPFile), offset, SEEK_SET) == 0;
+#endif
+  }
+
+  // Get the byte offset of the record of the packet returned by the last call to
+  // NextPacket. The records rejected by the packet filter are skipped by NextPacket,
+  // so this can be after the offset returned by GetFileOffset before the call.
+  bool GetLastPacketOffset(long long& offset)
+  {
+    const long long recordHeaderSize = 16;
+    if (!this->GetFileOffset(offset))
+    {
+      return false;
+    }
+    offset -= recordHeaderSize + this->LastPacketCapturedLength;
+    return true;
+  }
+
+  // Find the first packet record starting at or after the given byte offset.
+  // The records of a pcap file are not delimited, so a record header is
+  // recognized by its lengths and timestamp, and must be followed by other
+  // valid records (or by the end of the file). The file position is not kept.
+  // Return false if no record has been found near the offset.
+  bool FindPacketRecord(long long offset, long long& recordOffset)
+  {
+#ifdef _MSC_VER
+    return false;
+#else
+    if (!this->PCAPFile)
+    {
+      return false;
+    }
+    FILE* f = pcap_file(this->PCAPFile);
+    const long long fileHeaderSize = 24;
+    const long long recordHeaderSize = 16;
+    const long long searchSize = 1 << 18;
+    const int numberOfRecordsToCheck = 4;
+    const unsigned int maxRecordSize = std::max(pcap_snapshot(this->PCAPFile), 65535);
+    offset = std::max(offset, fileHeaderSize);
+
+    // read enough bytes to check several records after the last possible candidate
+    std::vector<unsigned char> buffer(searchSize + numberOfRecordsToCheck * (recordHeaderSize + maxRecordSize));
+    long long previousOffset = ftello(f);
+    if (fseeko(f, offset, SEEK_SET) != 0)
+    {
+      return false;
+    }
+    size_t bufferSize = fread(buffer.data(), 1, buffer.size(), f);
+    bool isEndOfFile = feof(f) != 0;
+    fseeko(f, previousOffset, SEEK_SET);
+
+    const bool isSwapped = pcap_is_swapped(this->PCAPFile) != 0;
+    auto readUInt32 = [&](size_t pos) {
+      unsigned int value = buffer[pos] | (buffer[pos + 1] << 8) | (buffer[pos + 2] << 16) | (buffer[pos + 3] << 24);
+      return isSwapped ? ((value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24)) : value;
+    };
+
+    for (size_t candidate = 0; candidate < static_cast<size_t>(searchSize) && candidate + recordHeaderSize <= bufferSize; ++candidate)
+    {
+      size_t pos = candidate;
+      unsigned int lastSeconds = 0;
+      int validRecords = 0;
+      while (validRecords < numberOfRecordsToCheck && pos + recordHeaderSize <= bufferSize)
+      {
+        unsigned int seconds = readUInt32(pos);
+        unsigned int fraction = readUInt32(pos + 4);
+        unsigned int capturedLength = readUInt32(pos + 8);
+        unsigned int length = readUInt32(pos + 12);
+        // the timestamps of consecutive records should not be too far apart
+        bool isTimeValid = validRecords == 0 ||
+          (seconds + 1 >= lastSeconds && seconds <= lastSeconds + 60);
+        if (fraction >= 1000000000 || capturedLength == 0 || capturedLength > maxRecordSize ||
+          capturedLength > length || length > (1 << 18) || !isTimeValid)
+        {
+          break;
+        }
+        lastSeconds = seconds;
+        pos += recordHeaderSize + capturedLength;
+        validRecords++;
+      }
+      // a record can also be followed by the end of the file
+      if (validRecords == numberOfRecordsToCheck || (isEndOfFile && pos == bufferSize && validRecords > 0))
+      {
+        recordOffset = offset + candidate;
+        return true;
+      }
+    }
+    return false;
+#endif
+  }
+
   bool NextPacket(const unsigned char*& data, unsigned int& dataLength, double& timeSinceStart,
     pcap_pkthdr** headerReference = NULL, unsigned int* dataHeaderLength = NULL)
   {
@@ -149,6 +266,7 @@ public:
       this->Close();
       return false;
     }
+    this->LastPacketCapturedLength = header->caplen;
 
     // Only return the payload.
     // We read the actual IP header length (v4 & v6) + assumes UDP
@@ -181,6 +299,7 @@ protected:
   std::string LastError;
   struct timeval StartTime;
   unsigned int FrameHeaderLength;
+  unsigned int LastPacketCapturedLength = 0;
 };
 
 #endif
@@ -140,7 +140,8 @@ const std::string& vtkPacketFileWriter::GetFileName()
 
 //--------------------------------------------------------------------------------
 // Write an UDP packet from the data (without providing a header, so we construct it)
-bool vtkPacketFileWriter::WritePacket(const unsigned char* data, unsigned int dataLength)
+bool vtkPacketFileWriter::WritePacket(const unsigned char* data, unsigned int dataLength,
+                                      unsigned short port)
 {
   if (!this->PCAPFile)
   {
@@ -177,6 +178,13 @@ bool vtkPacketFileWriter::WritePacket(const unsigned char* data, unsigned int da
   // Set UDP-frame length (which is 8 + dataLength), in Network (Big) Endian
   packetBuffer[2 * 19] = ((dataLength + 8) & 0xFF00) >> 8;
   packetBuffer[2 * 19 + 1] = ((dataLength + 8) & 0x00FF) >> 0;
+  // Set UDP-frame source and destination ports, in Network (Big) Endian, so that
+  // the packets of several sensors recorded in the same file can be told apart
+  if (port != 0)
+  {
+    packetBuffer[2 * 17] = packetBuffer[2 * 18] = (port & 0xFF00) >> 8;
+    packetBuffer[2 * 17 + 1] = packetBuffer[2 * 18 + 1] = (port & 0x00FF) >> 0;
+  }
 
   pcap_dump((u_char*)this->PCAPDump, &header, &(packetBuffer[0]));
   return true;
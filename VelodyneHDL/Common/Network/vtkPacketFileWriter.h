@@ -35,8 +35,9 @@
 #include <pcap.h>
 #include <string>
 #include <vector>
+#include <vtkSystemIncludes.h>
 
-class vtkPacketFileWriter
+class VTK_EXPORT vtkPacketFileWriter
 {
 public:
   // note these values are little endian, pcap wants the packet header and
@@ -59,7 +60,9 @@ public:
 
   const std::string& GetFileName();
 
-  bool WritePacket(const unsigned char* data, unsigned int dataLength);
+  // Write an UDP packet from the data, port is the source and destination port
+  // written in the UDP header, 0 keeps the default lidar or position port
+  bool WritePacket(const unsigned char* data, unsigned int dataLength, unsigned short port = 0);
 
   bool WritePacket(pcap_pkthdr* packetHeader, unsigned char* packetData);
 
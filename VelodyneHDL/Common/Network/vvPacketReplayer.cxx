@@ -0,0 +1,337 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#include "vvPacketReplayer.h"
+#include "vtkPacketFileReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/socket.h>
+#endif
+
+namespace
+{
+//! Below this delay, the replay spins instead of sleeping to be on time
+const std::chrono::microseconds SPIN_DURATION(200);
+//! Longest sleep between two checks of a stop request
+const std::chrono::milliseconds MAX_SLEEP_DURATION(100);
+//! Size of the socket send buffer, large enough to absorb the bursts of a batch
+const int SEND_BUFFER_SIZE = 4 * 1024 * 1024;
+}
+
+//-----------------------------------------------------------------------------
+struct vvPacketReplayer::Capture
+{
+  std::string FileName;
+  vtkPacketFileReader Reader;
+  boost::asio::ip::udp::endpoint LidarEndpoint;
+  boost::asio::ip::udp::endpoint PositionEndpoint;
+
+  //! pcap timestamp of the first packet of the capture
+  double FirstPacketTime = -1;
+
+  //! next packet to send, with its time since the first packet of the capture
+  std::string NextData;
+  double NextTime = 0;
+  bool NextIsPosition = false;
+  bool Done = false;
+};
+
+//-----------------------------------------------------------------------------
+struct vvPacketReplayer::Packet
+{
+  std::string Data;
+  const boost::asio::ip::udp::endpoint* Endpoint;
+};
+
+//-----------------------------------------------------------------------------
+vvPacketReplayer::vvPacketReplayer()
+  : Socket(this->IOService)
+  , ShouldStop(false)
+  , StartTime(Clock::time_point())
+  , NumberOfPackets(0)
+  , NumberOfBytes(0)
+  , NumberOfSendErrors(0)
+  , NumberOfLoops(0)
+  , MaxLateness(0)
+  , ElapsedTime(0)
+  , IsRunning(false)
+{
+  this->Socket.open(boost::asio::ip::udp::v4());
+  // Allow to send the packet on the same machine
+  this->Socket.set_option(boost::asio::ip::multicast::enable_loopback(true));
+  // A failure only limits the achievable rate
+  boost::system::error_code errCode;
+  this->Socket.set_option(boost::asio::socket_base::send_buffer_size(SEND_BUFFER_SIZE), errCode);
+}
+
+//-----------------------------------------------------------------------------
+vvPacketReplayer::~vvPacketReplayer() = default;
+
+//-----------------------------------------------------------------------------
+void vvPacketReplayer::AddCapture(
+  const std::string& pcapFile, const std::string& destinationIp, int lidarPort, int positionPort)
+{
+  std::unique_ptr<Capture> capture(new Capture);
+  capture->FileName = pcapFile;
+  capture->LidarEndpoint = boost::asio::ip::udp::endpoint(
+    boost::asio::ip::address_v4::from_string(destinationIp), lidarPort);
+  capture->PositionEndpoint = boost::asio::ip::udp::endpoint(
+    boost::asio::ip::address_v4::from_string(destinationIp), positionPort);
+  if (!capture->Reader.Open(pcapFile))
+  {
+    throw std::runtime_error("Unable to open packet file " + pcapFile);
+  }
+  this->Captures.push_back(std::move(capture));
+}
+
+//-----------------------------------------------------------------------------
+void vvPacketReplayer::SetProgressCallback(
+  std::function<void(const ReplayStatistics&)> callback, unsigned long interval)
+{
+  this->ProgressCallback = callback;
+  this->ProgressInterval = interval;
+}
+
+//-----------------------------------------------------------------------------
+void vvPacketReplayer::Stop()
+{
+  this->ShouldStop = true;
+}
+
+//-----------------------------------------------------------------------------
+ReplayStatistics vvPacketReplayer::GetStatistics() const
+{
+  ReplayStatistics stats;
+  stats.NumberOfPackets = this->NumberOfPackets;
+  stats.NumberOfBytes = this->NumberOfBytes;
+  stats.NumberOfSendErrors = this->NumberOfSendErrors;
+  stats.NumberOfLoops = this->NumberOfLoops;
+  stats.MaxLateness = this->MaxLateness;
+  if (this->IsRunning)
+  {
+    stats.ElapsedTime = std::chrono::duration<double>(Clock::now() - this->StartTime.load()).count();
+  }
+  else
+  {
+    stats.ElapsedTime = this->ElapsedTime;
+  }
+  return stats;
+}
+
+//-----------------------------------------------------------------------------
+bool vvPacketReplayer::ReadNextPacket(Capture& capture)
+{
+  const unsigned char* data = 0;
+  unsigned int dataLength = 0;
+  double timeSinceStart = 0;
+  if (!capture.Reader.NextPacket(data, dataLength, timeSinceStart))
+  {
+    return false;
+  }
+
+  if (capture.FirstPacketTime < 0)
+  {
+    capture.FirstPacketTime = timeSinceStart;
+  }
+  capture.NextTime = timeSinceStart - capture.FirstPacketTime;
+  capture.NextData.assign(reinterpret_cast<const char*>(data), dataLength);
+  // same rule as vvPacketSender to tell position packets apart
+  capture.NextIsPosition = (dataLength == 512);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vvPacketReplayer::RewindCaptures()
+{
+  bool hasPacket = false;
+  for (const auto& capture : this->Captures)
+  {
+    capture->Reader.Close();
+    capture->FirstPacketTime = -1;
+    capture->Done = !capture->Reader.Open(capture->FileName) || !this->ReadNextPacket(*capture);
+    hasPacket |= !capture->Done;
+  }
+  return hasPacket;
+}
+
+//-----------------------------------------------------------------------------
+void vvPacketReplayer::Flush()
+{
+  if (this->Batch.empty())
+  {
+    return;
+  }
+
+  const unsigned long packetsBefore = this->NumberOfPackets;
+  const size_t nbPackets = this->Batch.size();
+
+#ifdef __linux__
+  std::vector<iovec> iovecs(nbPackets);
+  std::vector<mmsghdr> messages(nbPackets);
+  for (size_t i = 0; i < nbPackets; ++i)
+  {
+    Packet& packet = this->Batch[i];
+    iovecs[i].iov_base = &packet.Data[0];
+    iovecs[i].iov_len = packet.Data.size();
+    messages[i] = mmsghdr();
+    messages[i].msg_hdr.msg_name = const_cast<sockaddr*>(
+      reinterpret_cast<const sockaddr*>(packet.Endpoint->data()));
+    messages[i].msg_hdr.msg_namelen = static_cast<socklen_t>(packet.Endpoint->size());
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  const int socket = this->Socket.native_handle();
+  size_t sent = 0;
+  while (sent < nbPackets)
+  {
+    int result = sendmmsg(socket, &messages[sent], static_cast<unsigned int>(nbPackets - sent), 0);
+    if (result < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      // the first message of the remaining ones could not be sent, skip it
+      this->NumberOfSendErrors++;
+      sent++;
+      continue;
+    }
+
+    for (size_t i = sent; i < sent + result; ++i)
+    {
+      this->NumberOfBytes += this->Batch[i].Data.size();
+    }
+    this->NumberOfPackets += result;
+    sent += result;
+  }
+#else
+  for (const Packet& packet : this->Batch)
+  {
+    boost::system::error_code errCode;
+    this->Socket.send_to(boost::asio::buffer(packet.Data), *packet.Endpoint, 0, errCode);
+    if (errCode)
+    {
+      this->NumberOfSendErrors++;
+      continue;
+    }
+    this->NumberOfBytes += packet.Data.size();
+    this->NumberOfPackets++;
+  }
+#endif
+
+  this->Batch.clear();
+
+  if (this->ProgressCallback && this->ProgressInterval > 0 &&
+    packetsBefore / this->ProgressInterval != this->NumberOfPackets / this->ProgressInterval)
+  {
+    this->ProgressCallback(this->GetStatistics());
+  }
+}
+
+//-----------------------------------------------------------------------------
+ReplayStatistics vvPacketReplayer::Run()
+{
+  this->ShouldStop = false;
+  this->NumberOfPackets = 0;
+  this->NumberOfBytes = 0;
+  this->NumberOfSendErrors = 0;
+  this->NumberOfLoops = 0;
+  this->MaxLateness = 0;
+  this->Batch.clear();
+  this->Batch.reserve(this->BatchSize);
+
+  bool hasPacket = this->RewindCaptures();
+  this->StartTime = Clock::now();
+  this->IsRunning = true;
+  Clock::time_point loopStartTime = this->StartTime.load();
+
+  while (hasPacket && !this->ShouldStop)
+  {
+    // The captures are interleaved by their time since their own beginning
+    Capture* next = nullptr;
+    for (const auto& capture : this->Captures)
+    {
+      if (!capture->Done && (!next || capture->NextTime < next->NextTime))
+      {
+        next = capture.get();
+      }
+    }
+
+    if (!next)
+    {
+      this->Flush();
+      this->NumberOfLoops++;
+      hasPacket = this->Loop && this->RewindCaptures();
+      loopStartTime = Clock::now();
+      continue;
+    }
+
+    if (this->Speed > 0)
+    {
+      const Clock::time_point dueTime = loopStartTime +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(next->NextTime / this->Speed));
+      Clock::time_point now = Clock::now();
+      if (dueTime > now)
+      {
+        // nothing else is due, send what is pending before waiting
+        this->Flush();
+        while (!this->ShouldStop && dueTime - now > SPIN_DURATION)
+        {
+          std::this_thread::sleep_for(std::min<Clock::duration>(dueTime - now - SPIN_DURATION, MAX_SLEEP_DURATION));
+          now = Clock::now();
+        }
+        if (this->ShouldStop)
+        {
+          break;
+        }
+        while (Clock::now() < dueTime)
+        {
+        }
+      }
+      else
+      {
+        double lateness = std::chrono::duration<double>(now - dueTime).count();
+        if (lateness > this->MaxLateness)
+        {
+          this->MaxLateness = lateness;
+        }
+      }
+    }
+
+    Packet packet;
+    packet.Data.swap(next->NextData);
+    packet.Endpoint = next->NextIsPosition ? &next->PositionEndpoint : &next->LidarEndpoint;
+    this->Batch.push_back(std::move(packet));
+    next->Done = !this->ReadNextPacket(*next);
+
+    if (this->Batch.size() >= this->BatchSize)
+    {
+      this->Flush();
+    }
+  }
+
+  this->Flush();
+  this->ElapsedTime = std::chrono::duration<double>(Clock::now() - this->StartTime.load()).count();
+  this->IsRunning = false;
+  return this->GetStatistics();
+}
@@ -0,0 +1,154 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef VVPACKETREPLAYER_H
+#define VVPACKETREPLAYER_H
+
+#include <vtkSystemIncludes.h>
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class vtkPacketFileReader;
+
+/**
+ * @brief The ReplayStatistics struct contains what has actually been achieved by a replay
+ */
+struct ReplayStatistics
+{
+  unsigned long NumberOfPackets = 0;      /*!< Number of packets sent */
+  unsigned long NumberOfBytes = 0;        /*!< Number of payload bytes sent */
+  unsigned long NumberOfSendErrors = 0;   /*!< Number of packets the system refused to send */
+  unsigned long NumberOfLoops = 0;        /*!< Number of times all captures have been replayed */
+  double ElapsedTime = 0;                 /*!< Wall clock time since the start, in seconds */
+  double MaxLateness = 0;                 /*!< Highest delay of a packet compared to its schedule, in seconds */
+
+  double GetPacketRate() const { return this->ElapsedTime > 0 ? this->NumberOfPackets / this->ElapsedTime : 0; }
+  double GetByteRate() const { return this->ElapsedTime > 0 ? this->NumberOfBytes / this->ElapsedTime : 0; }
+};
+
+/**
+ * \class vvPacketReplayer
+ * \brief Replay one or several pcap captures on the network at a controlled rate.
+ *
+ * Packets are scheduled from their pcap timestamps against a monotonic clock,
+ * scaled by a speed factor. When several captures are given, their packets are
+ * interleaved according to their time since the beginning of their own capture,
+ * each capture being sent to its own ports. Packets which are due are sent by
+ * batches (with sendmmsg on Linux) so that high rates can be sustained, which
+ * makes it usable as a load generator for the live receive path.
+ */
+class VTK_EXPORT vvPacketReplayer
+{
+public:
+  vvPacketReplayer();
+  ~vvPacketReplayer();
+
+  /**
+   * @brief AddCapture add a pcap to replay
+   * @param pcapFile the capture to replay
+   * @param destinationIp the ip to send the packets to
+   * @param lidarPort the port to send the lidar packets to
+   * @param positionPort the port to send the position packets (512 bytes) to
+   * @throw std::runtime_error if the capture can't be opened
+   */
+  void AddCapture(const std::string& pcapFile, const std::string& destinationIp = "127.0.0.1",
+    int lidarPort = 2368, int positionPort = 8308);
+
+  /**
+   * @brief Run replay all captures, until they are all over or Stop is called.
+   * This call is blocking.
+   * @return the statistics of the replay
+   */
+  ReplayStatistics Run();
+
+  /**
+   * @brief Stop interrupt the replay, can be called from any thread
+   */
+  void Stop();
+
+  /**
+   * @brief GetStatistics return the statistics of the replay, can be called from any thread
+   */
+  ReplayStatistics GetStatistics() const;
+
+  //! Playback speed factor, 2 means twice as fast as recorded. 0 means as fast as possible
+  void SetSpeed(double speed) { this->Speed = speed; }
+  double GetSpeed() const { return this->Speed; }
+
+  //! Restart the captures once they are all over, until Stop is called
+  void SetLoop(bool loop) { this->Loop = loop; }
+  bool GetLoop() const { return this->Loop; }
+
+  //! Maximum number of packets sent with a single system call
+  void SetBatchSize(unsigned int batchSize) { this->BatchSize = std::max(1u, batchSize); }
+  unsigned int GetBatchSize() const { return this->BatchSize; }
+
+  /**
+   * @brief SetProgressCallback set a function called with the current statistics
+   * every interval sent packets
+   */
+  void SetProgressCallback(std::function<void(const ReplayStatistics&)> callback, unsigned long interval);
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Capture;
+  struct Packet;
+
+  //! Read the next packet of a capture, return false at the end of the capture
+  bool ReadNextPacket(Capture& capture);
+
+  //! Reopen all captures for a new loop, return false if none could be reopened
+  bool RewindCaptures();
+
+  //! Send all packets of the batch
+  void Flush();
+
+  std::vector<std::unique_ptr<Capture> > Captures;
+  std::vector<Packet> Batch;
+
+  boost::asio::io_service IOService;
+  boost::asio::ip::udp::socket Socket;
+
+  double Speed = 1;
+  bool Loop = false;
+  unsigned int BatchSize = 32;
+
+  std::function<void(const ReplayStatistics&)> ProgressCallback;
+  unsigned long ProgressInterval = 0;
+
+  std::atomic<bool> ShouldStop;
+  //! written by the replay thread, read by GetStatistics from any thread
+  std::atomic<Clock::time_point> StartTime;
+  std::atomic<unsigned long> NumberOfPackets;
+  std::atomic<unsigned long> NumberOfBytes;
+  std::atomic<unsigned long> NumberOfSendErrors;
+  std::atomic<unsigned long> NumberOfLoops;
+  std::atomic<double> MaxLateness;
+  std::atomic<double> ElapsedTime;
+  std::atomic<bool> IsRunning;
+};
+
+#endif // VVPACKETREPLAYER_H
@@ -1,5 +1,6 @@
 #include "vtkCarGeometricCalibration.h"
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <random>
@@ -8,25 +9,29 @@
 
 #include <vtkMath.h>
 
+#include <boost/thread/thread.hpp>
+
 #include <Eigen/Geometry>
 
 #include "vtkConversions.h"
 #include "vtkEigenTools.h"
 
-Eigen::Vector3d GetXYZ(const vtkSmartPointer<vtkVelodyneTransformInterpolator> trajectory,
+Eigen::Vector3d GetXYZ(vtkVelodyneTransformInterpolator* trajectory,
                        double time)
 {
-  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
-  trajectory->InterpolateTransform(time, transform);
-  return PositionVectorFromTransform(transform);
+  Eigen::Quaterniond orientation;
+  Eigen::Vector3d position;
+  trajectory->InterpolateTransform(time, orientation, position);
+  return position;
 }
 
-Eigen::Matrix3d GetR(const vtkSmartPointer<vtkVelodyneTransformInterpolator> trajectory,
+Eigen::Matrix3d GetR(vtkVelodyneTransformInterpolator* trajectory,
                      double time)
 {
-  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
-  trajectory->InterpolateTransform(time, transform);
-  return RotationMatrixFromTransform(transform);
+  Eigen::Quaterniond orientation;
+  Eigen::Vector3d position;
+  trajectory->InterpolateTransform(time, orientation, position);
+  return orientation.toRotationMatrix();
 }
 
 // method to identify a directions in straight lines
@@ -91,11 +96,10 @@ std::vector<std::vector<double>> ComputeTurns(
               << poseTrajectory->GetNumberOfTransforms()
               << " samples" << std::endl;
   }
-  for (int i = 0; i < poseTrajectory->GetNumberOfTransforms(); i++)
+  std::vector<double> times = poseTrajectory->GetTimes();
+  for (int i = 0; i < static_cast<int>(times.size()); i++)
   {
-    vtkSmartPointer<vtkTransform> sample = vtkSmartPointer<vtkTransform>::New();
-    double t;
-    poseTrajectory->GetSample(i, sample, t);
+    double t = times[i];
     if (t - 0.5 * timeWindow < poseTrajectory->GetMinimumT()
         || t + 0.5 * timeWindow > poseTrajectory->GetMaximumT())
     {
@@ -103,13 +107,22 @@ std::vector<std::vector<double>> ComputeTurns(
     }
     sampleId.push_back(i);
     sampleTime.push_back(t);
+  }
 
-    vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-    poseTrajectory->InterpolateTransform(t - 0.5 * timeWindow, prev);
-    vtkSmartPointer<vtkTransform> next = vtkSmartPointer<vtkTransform>::New();
-    poseTrajectory->InterpolateTransform(t + 0.5 * timeWindow, next);
-    Eigen::AngleAxisd aa = Eigen::AngleAxisd(RotationMatrixFromTransform(next)
-		    * RotationMatrixFromTransform(prev).transpose());
+  // orientations at the bounds of the window centered on each sample
+  std::vector<double> prevTimes(sampleTime.size()), nextTimes(sampleTime.size());
+  for (size_t k = 0; k < sampleTime.size(); k++)
+  {
+    prevTimes[k] = sampleTime[k] - 0.5 * timeWindow;
+    nextTimes[k] = sampleTime[k] + 0.5 * timeWindow;
+  }
+  vtkVelodyneTransformInterpolator::QuaternionVector prev, next;
+  std::vector<Eigen::Vector3d> positions;
+  poseTrajectory->InterpolateTransforms(prevTimes, prev, positions);
+  poseTrajectory->InterpolateTransforms(nextTimes, next, positions);
+  for (size_t k = 0; k < sampleTime.size(); k++)
+  {
+    Eigen::AngleAxisd aa = Eigen::AngleAxisd(next[k] * prev[k].conjugate());
     double curvature = std::abs(aa.angle()) / timeWindow;
     sampleStatus.push_back(curvature >= curveTreshold);
   }
@@ -207,16 +220,13 @@ std::vector<std::vector<double>> ComputeTurns(
   length.reserve(poseTrajectory->GetNumberOfTransforms());
   std::vector<double> lengthTimes = std::vector<double>();
   lengthTimes.reserve(poseTrajectory->GetNumberOfTransforms());
-  vtkSmartPointer<vtkTransform> sample = vtkSmartPointer<vtkTransform>::New();
-  double time;
-  poseTrajectory->GetSample(0, sample, time);
-  Eigen::Vector3d previousPos = PositionVectorFromTransform(sample);
-  for (int i = 0; i < poseTrajectory->GetNumberOfTransforms(); i++)
-  {
-    poseTrajectory->GetSample(i, sample, time);
-    Eigen::Vector3d pos = PositionVectorFromTransform(sample);
+  poseTrajectory->InterpolateTransforms(times, prev, positions);
+  Eigen::Vector3d previousPos = positions.empty() ? Eigen::Vector3d::Zero() : positions[0];
+  for (size_t i = 0; i < times.size(); i++)
+  {
+    const Eigen::Vector3d& pos = positions[i];
     currentLength += (pos - previousPos).norm();
-    lengthTimes.push_back(time);
+    lengthTimes.push_back(times[i]);
     length.push_back(currentLength);
     previousPos = pos;
   }
@@ -421,8 +431,8 @@ std::vector<std::vector<double>> ComputeTurns(
 }
 
 bool ProcessTurn(
-        const vtkSmartPointer<vtkVelodyneTransformInterpolator> reference,
-        const vtkSmartPointer<vtkVelodyneTransformInterpolator> aligned,
+        vtkVelodyneTransformInterpolator* reference,
+        vtkVelodyneTransformInterpolator* aligned,
         double t0, double t1, double t2, double t3,
         DIRECTION_METHOD directionMethod,
         NORMAL_METHOD normalMethod,
@@ -550,8 +560,8 @@ bool ProcessTurn(
 }
 
 bool ProcessTurn(
-        const vtkSmartPointer<vtkVelodyneTransformInterpolator> reference,
-        const vtkSmartPointer<vtkVelodyneTransformInterpolator> aligned,
+        vtkVelodyneTransformInterpolator* reference,
+        vtkVelodyneTransformInterpolator* aligned,
         double t0, double t1, double t2, double t3,
         Eigen::Matrix3d& rotationBefore, // 1st result
         Eigen::Matrix3d& rotationAfter, // 2nd result
@@ -588,6 +598,7 @@ void estimateL2ChordalSVD(const std::vector<Eigen::Matrix3d>& rotations,
   {
     result = Eigen::Matrix3d::Identity();
     valid = false;
+    return;
   }
 
   Eigen::Matrix3d S = Eigen::Matrix3d::Zero();
@@ -613,72 +624,185 @@ void estimateL2ChordalSVD(const std::vector<Eigen::Matrix3d>& rotations,
   valid = true;
 }
 
+namespace
+{
+//! Number of observations scored by all the remaining hypotheses
+//! before half of them are discarded
+const int RansacBlockSize = 20;
+
+//! Call function(begin, end) on contiguous ranges splitting [0, n),
+//! one range per core, and wait for all of them
+template <typename Function>
+void ParallelFor(int n, Function function)
+{
+  const int nbThreads = std::min(n, static_cast<int>(std::max(1u, boost::thread::hardware_concurrency())));
+  if (nbThreads <= 1)
+  {
+    function(0, n);
+    return;
+  }
+  boost::thread_group threads;
+  for (int i = 0; i < nbThreads; ++i)
+  {
+    const int begin = static_cast<int>(static_cast<long>(n) * i / nbThreads);
+    const int end = static_cast<int>(static_cast<long>(n) * (i + 1) / nbThreads);
+    threads.create_thread([&function, begin, end]() { function(begin, end); });
+  }
+  threads.join_all();
+}
+
+//! Number of observations closer than maxAngleToFit to the rotation estimation
+int CountInliers(const Eigen::Matrix3d& estimation, const std::vector<Eigen::Matrix3d>& rotations,
+                 const std::vector<int>& order, int begin, int end, double maxAngleToFit)
+{
+  int inliers = 0;
+  for (int j = begin; j < end; j++)
+  {
+    double angle = Eigen::AngleAxisd(estimation.transpose() * rotations[order[j]]).angle();
+    if (angle <= maxAngleToFit)
+    {
+      inliers++;
+    }
+  }
+  return inliers;
+}
+}
+
+// Preemptive RANSAC: maxIterations hypotheses are estimated from random
+// samples, then they are all scored on a first block of observations, the
+// worst half is discarded, the others are scored on the next block, and so
+// on until one hypothesis is left or all observations have been used. The
+// best scoring hypothesis is kept, and validated by its number of inliers.
+// Each hypothesis uses its own generator, seeded with the seed and its index,
+// so that the result does not depend on the number of threads.
 void RansacRotation(const std::vector<Eigen::Matrix3d>& rotations,
                     ROTATION_ESTIMATOR estimator,
                     int maxIterations,
                     int sampleToEstimate,
                     int sampleToValidate,
                     float maxAngleToFit,
+                    unsigned int seed,
                     Eigen::Matrix3d& result,
                     bool& valid,
                     int& samplesUsed)
 {
-  std::default_random_engine rng = std::default_random_engine();
-  std::vector<int> shuffled(rotations.size());
-  std::iota(std::begin(shuffled), std::end(shuffled), 0); //0 is the starting number
-
+  result = Eigen::Matrix3d::Identity();
+  valid = false;
+  samplesUsed = 0;
   if (estimator != ROTATION_ESTIMATOR::ESTIMATOR_L2_CHORDAL_SVD)
   {
     std::cerr << "Unknown estimator passed to RansacRotation" << std::endl;
-    result = Eigen::Matrix3d::Identity();
-    valid = false;
     return;
   }
-  for (int i = 0; i < maxIterations; i++)
+  const int nbRotations = static_cast<int>(rotations.size());
+  if (nbRotations == 0 || maxIterations <= 0)
   {
-    // re-shuffle
-    std::shuffle(std::begin(shuffled), std::end(shuffled), rng);
-    std::vector<Eigen::Matrix3d> samples = std::vector<Eigen::Matrix3d>(sampleToEstimate);
-    for (int j = 0; j < sampleToEstimate; j++)
+    return;
+  }
+  sampleToEstimate = std::min(sampleToEstimate, nbRotations);
+
+  // Estimate the hypotheses
+  std::vector<Eigen::Matrix3d> hypotheses(maxIterations);
+  std::vector<char> hypothesesValid(maxIterations, 0);
+  ParallelFor(maxIterations, [&](int begin, int end)
+  {
+    std::vector<int> shuffled(nbRotations);
+    std::vector<Eigen::Matrix3d> samples(sampleToEstimate);
+    for (int i = begin; i < end; i++)
     {
-      samples[j] = rotations[shuffled[j]];
+      std::seed_seq seeds = { seed, static_cast<unsigned int>(i) };
+      std::mt19937 rng(seeds);
+      // partial Fisher-Yates shuffle, only the first samples are needed
+      std::iota(std::begin(shuffled), std::end(shuffled), 0);
+      for (int j = 0; j < sampleToEstimate; j++)
+      {
+        std::uniform_int_distribution<int> pick(j, nbRotations - 1);
+        std::swap(shuffled[j], shuffled[pick(rng)]);
+        samples[j] = rotations[shuffled[j]];
+      }
+      bool estimationValid = false;
+      estimateL2ChordalSVD(samples, hypotheses[i], estimationValid);
+      hypothesesValid[i] = estimationValid;
     }
+  });
 
-    Eigen::Matrix3d estimation;
-    bool estimationValid = false;
-    estimateL2ChordalSVD(samples, estimation, estimationValid);
-    if (!estimationValid)
+  // Observations are scored in a random order, so that each block is
+  // representative of the whole data
+  std::vector<int> order(nbRotations);
+  std::iota(std::begin(order), std::end(order), 0);
+  std::mt19937 rng(seed);
+  std::shuffle(std::begin(order), std::end(order), rng);
+
+  std::vector<int> survivors;
+  for (int i = 0; i < maxIterations; i++)
+  {
+    if (hypothesesValid[i])
     {
-      continue;
+      survivors.push_back(i);
     }
+  }
+  if (survivors.empty())
+  {
+    return;
+  }
 
-    // count how many rotations are close enough:
-    std::vector<Eigen::Matrix3d> samplesFitting = std::vector<Eigen::Matrix3d>();
-    samplesFitting.reserve(rotations.size());
-    for (unsigned int j = 0; j < rotations.size(); j++)
+  // Preemptive scoring
+  std::vector<int> scores(maxIterations, 0);
+  int scored = 0;
+  while (scored < nbRotations)
+  {
+    const int blockEnd = std::min(nbRotations, scored + RansacBlockSize);
+    ParallelFor(static_cast<int>(survivors.size()), [&](int begin, int end)
     {
-      double angle = Eigen::AngleAxisd(estimation.transpose() * rotations[j]).angle();
-      if (angle <= maxAngleToFit)
+      for (int k = begin; k < end; k++)
       {
-        samplesFitting.push_back(rotations[j]);
+        const int i = survivors[k];
+        scores[i] += CountInliers(hypotheses[i], rotations, order, scored, blockEnd, maxAngleToFit);
       }
+    });
+    scored = blockEnd;
+
+    // best scores first, ties broken by the hypothesis index to be deterministic
+    std::sort(std::begin(survivors), std::end(survivors), [&scores](int a, int b)
+    {
+      return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    });
+    if (survivors.size() == 1)
+    {
+      break;
     }
+    if (scored < nbRotations)
+    {
+      survivors.resize((survivors.size() + 1) / 2);
+    }
+  }
 
-    if (static_cast<int>(samplesFitting.size()) >= sampleToValidate)
+  // Validate the best hypothesis with all the observations
+  const Eigen::Matrix3d& best = hypotheses[survivors.front()];
+  std::vector<Eigen::Matrix3d> samplesFitting;
+  samplesFitting.reserve(rotations.size());
+  for (int j = 0; j < nbRotations; j++)
+  {
+    double angle = Eigen::AngleAxisd(best.transpose() * rotations[j]).angle();
+    if (angle <= maxAngleToFit)
     {
-      // do a final estimation, then return
-      samplesUsed = samplesFitting.size();
-      Eigen::Matrix3d estimation;
-      bool estimationValid = false;
-      estimateL2ChordalSVD(samplesFitting, estimation, estimationValid);
-      result = estimation;
-      valid = estimationValid;
-      return;
+      samplesFitting.push_back(rotations[j]);
     }
   }
 
-  result = Eigen::Matrix3d::Identity();
-  valid = false;
+  if (static_cast<int>(samplesFitting.size()) >= sampleToValidate)
+  {
+    // do a final estimation with all the inliers
+    samplesUsed = samplesFitting.size();
+    Eigen::Matrix3d estimation;
+    bool estimationValid = false;
+    estimateL2ChordalSVD(samplesFitting, estimation, estimationValid);
+    if (estimationValid)
+    {
+      result = estimation;
+      valid = true;
+    }
+  }
 }
 
 void ComputeCarCalibrationRotationScale(
@@ -696,7 +820,8 @@ void ComputeCarCalibrationRotationScale(
         Eigen::Matrix3d& result,
         double& scale,
         bool& validResult,
-        bool verbose
+        bool verbose,
+        unsigned int ransacSeed
         )
 {
   vtkSmartPointer<vtkVelodyneTransformInterpolator> referenceI
@@ -716,33 +841,51 @@ void ComputeCarCalibrationRotationScale(
     std::cout << "Processing " << turns.size() << " turns" << std::endl;
   }
 
+  // Process the turns concurrently, ProcessTurn only reads the linear
+  // interpolators (given as raw pointers, so that their reference count is
+  // not modified by several threads). The results are then gathered in the
+  // order of the turns.
+  const int nbTurns = static_cast<int>(turns.size());
+  std::vector<char> turnProcessed(nbTurns, 0);
+  std::vector<Eigen::Matrix3d> turnRBefore(nbTurns), turnRAfter(nbTurns);
+  std::vector<double> turnScaleBefore(nbTurns), turnScaleAfter(nbTurns);
+  const double alignedMinimumT = alignedI->GetMinimumT();
+  const double alignedMaximumT = alignedI->GetMaximumT();
+  ParallelFor(nbTurns, [&](int begin, int end)
+  {
+    for (int i = begin; i < end; i++)
+    {
+      if (turns[i][0] < alignedMinimumT || turns[i][3] > alignedMaximumT)
+      {
+        // if this turn (that was seen in "reference")
+        // is not contained in aligned, skip it
+        continue;
+      }
+      turnProcessed[i] = ProcessTurn(referenceI.Get(), alignedI.Get(),
+                                     turns[i][0], turns[i][1], turns[i][2], turns[i][3],
+                                     directionMethod,
+                                     normalMethod,
+                                     normalBasedDirectionOptimisation,
+                                     orientationMethod,
+                                     turnRBefore[i],
+                                     turnRAfter[i],
+                                     turnScaleBefore[i],
+                                     turnScaleAfter[i]);
+    }
+  });
+
   std::vector<Eigen::Matrix3d> rotations = std::vector<Eigen::Matrix3d>();
   std::vector<double> scales;
-  for (unsigned int i = 0; i < turns.size(); i++)
+  for (int i = 0; i < nbTurns; i++)
   {
-    if (turns[i][0] < alignedI->GetMinimumT()
-                    || turns[i][3] > alignedI->GetMaximumT())
+    if (!turnProcessed[i])
     {
-      // if this turn (that was seen in "reference")
-      // is not contained in aligned, skip it
       continue;
     }
-    Eigen::Matrix3d RBefore;
-    Eigen::Matrix3d RAfter;
-    double scaleBefore, scaleAfter;
-    ProcessTurn(referenceI, alignedI,
-                turns[i][0], turns[i][1], turns[i][2], turns[i][3],
-                    directionMethod,
-                    normalMethod,
-                    normalBasedDirectionOptimisation,
-                    orientationMethod,
-                    RBefore,
-                    RAfter,
-                    scaleBefore,
-                    scaleAfter);
-
-    scales.push_back(scaleBefore);
-    scales.push_back(scaleAfter);
+    const Eigen::Matrix3d& RBefore = turnRBefore[i];
+    const Eigen::Matrix3d& RAfter = turnRAfter[i];
+    scales.push_back(turnScaleBefore[i]);
+    scales.push_back(turnScaleAfter[i]);
 
     Eigen::Vector3d yprBefore = (180.0 / vtkMath::Pi()) * RBefore.eulerAngles(2,1,0);
     Eigen::Vector3d yprAfter = (180.0 / vtkMath::Pi()) * RAfter.eulerAngles(2,1,0);
@@ -794,6 +937,7 @@ void ComputeCarCalibrationRotationScale(
                  std::max(1, static_cast<int>(vtkMath::Round(ransacFittingRatio * static_cast<double>(rotations.size())))),
                  std::max(1, static_cast<int>(vtkMath::Round(ransacValidationRatio * static_cast<double>(rotations.size())))),
                  (vtkMath::Pi() / 180.0) * ransacMaxAngleToFit,
+                 ransacSeed,
                  R,
                  valid,
                  sampleUsed);
@@ -839,7 +983,8 @@ void ComputeCarCalibrationRotationScale(
         Eigen::Matrix3d& result,
         double& scale,
         bool& validResult,
-        bool verbose
+        bool verbose,
+        unsigned int ransacSeed
         )
 {
   ComputeCarCalibrationRotationScale(reference, aligned, curveTreshold,
@@ -849,5 +994,5 @@ void ComputeCarCalibrationRotationScale(
         NORMAL_METHOD::CROSS_PRODUCT,
         DIRECTION_OPTIMIZATION_METHOD::NONE,
         AVERAGE_ORIENTATION_METHOD::SINGLE_POINT,
-        result, scale, validResult, verbose);
+        result, scale, validResult, verbose, ransacSeed);
 }
@@ -107,6 +107,8 @@ std::vector<std::vector<double>> ComputeTurns(
 * is sufficient to estimate a rotation.
 * \param ransacValidationRatio between 0 and 1, should be taken as big as
 * possible but I had to lower it down to 0.15 for some real life datasets.
+* \param ransacSeed seed of the random samples drawn by the ransac, the result
+* is the same for a given seed whatever the number of cores.
 **/
 void VelodyneHDLPlugin_EXPORT ComputeCarCalibrationRotationScale(
         const vtkSmartPointer<vtkTemporalTransforms> reference,
@@ -119,5 +121,6 @@ void VelodyneHDLPlugin_EXPORT ComputeCarCalibrationRotationScale(
         Eigen::Matrix3d& result,
         double& scale,
         bool& validResult,
-        bool verbose = false
+        bool verbose = false,
+        unsigned int ransacSeed = 0
         );
@@ -27,6 +27,8 @@
 // STD
 #include <stdlib.h>
 #include <ctime>
+#include <limits>
+#include <vector>
 
 // VTK
 #include <vtkDoubleArray.h>
@@ -39,25 +41,31 @@
 
 //----------------------------------------------------------------------------
 std::pair<double, AnglePositionVector> EstimateCalibrationFromPoses(const std::string& sourceSensorFilename,
-                                                                    const std::string& targetSensorFilename)
+                                                                    const std::string& targetSensorFilename,
+                                                                    bool informativeSamplesOnly,
+                                                                    int* numberOfConstraints)
 {
   vtkSmartPointer<vtkTemporalTransforms> trans1, trans2;
   trans1 = vtkTemporalTransformsReader::OpenTemporalTransforms(sourceSensorFilename);
   trans2 = vtkTemporalTransformsReader::OpenTemporalTransforms(targetSensorFilename);
-  return EstimateCalibrationFromPoses(trans1, trans2);
+  return EstimateCalibrationFromPoses(trans1, trans2, informativeSamplesOnly, numberOfConstraints);
 }
 
 //----------------------------------------------------------------------------
 std::pair<double, AnglePositionVector> EstimateCalibrationFromPoses(
                                               vtkSmartPointer<vtkTemporalTransforms> sourceSensor,
-                                              vtkSmartPointer<vtkTemporalTransforms> targetSensor)
+                                              vtkSmartPointer<vtkTemporalTransforms> targetSensor,
+                                              bool informativeSamplesOnly,
+                                              int* numberOfConstraints)
 {
   // Multi resolution time analysis parameters
   const double multipleScaleTimeBound = 5.0; // in seconds
   const double deltaScaleTime = 0.2; // in seconds
   const double timeStep = 0.4; // in seconds
+  // Below this rotation between t0 and t1, the constraint is on a straight segment
+  const double straightSegmentAngle = vtkMath::RadiansFromDegrees(2.0);
 
-  Eigen::Matrix3d P1, P2, Q1, Q2;
+  Eigen::Matrix3d P1, Q1, Q2;
   Eigen::Vector3d U1, U2, V1, V2;
 
   // Parameters to estimate
@@ -72,54 +80,94 @@ std::pair<double, AnglePositionVector> EstimateCalibrationFromPoses(
   targetSensorTransforms->SetInterpolationTypeToLinear();
   double tmin = std::max(sourceSensorTransforms->GetMinimumT(), targetSensorTransforms->GetMinimumT());
   double tmax = std::min(sourceSensorTransforms->GetMaximumT(), targetSensorTransforms->GetMaximumT());
-  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
 
-  // We want to estimate our 6-DOF parameters using a non
-  // linear least square minimization. The non linear part
-  // comes from the Euler Angle parametrization of the rotation
-  // endomorphism SO(3). To minimize it we use CERES to perform
-  // the Levenberg-Marquardt algorithm.
-  ceres::Problem problem;
-
-  // Loop over the time index
+  // Times around which the solid-system constraints are expressed
+  std::vector<double> times;
   for (double time = tmin + multipleScaleTimeBound; time < tmax - multipleScaleTimeBound; time += timeStep)
   {
-    // Loop over the deltaTime multi-resolution "solid-system" assumption constraint
-    for (double dt = 0; dt <= multipleScaleTimeBound;  dt += deltaScaleTime)
+    times.push_back(time);
+  }
+
+  // All the constraints are summed in a single residual block, see
+  // AggregatedRotationAndTranslationCalibrationResidual
+  CostFunctions::AggregatedRotationAndTranslationCalibrationResidual* constraints =
+    new CostFunctions::AggregatedRotationAndTranslationCalibrationResidual;
+
+  // Poses of the sensors, interpolated at all the times for a given dt
+  std::vector<double> times0(times.size()), times1(times.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector sensor1T0Orientations, sensor2T0Orientations;
+  vtkVelodyneTransformInterpolator::QuaternionVector sensor1T1Orientations, sensor2T1Orientations;
+  std::vector<Eigen::Vector3d> sensor1T0Positions, sensor2T0Positions;
+  std::vector<Eigen::Vector3d> sensor1T1Positions, sensor2T1Positions;
+
+  // Loop over the deltaTime multi-resolution "solid-system" assumption constraint
+  for (double dt = 0; dt <= multipleScaleTimeBound;  dt += deltaScaleTime)
+  {
+    // t0 = t1 gives a null constraint
+    if (informativeSamplesOnly && dt == 0)
+    {
+      continue;
+    }
+
+    // The two time positions that will be used to express
+    // the solid-system geometric constraints that link
+    // the two sensor poses trajectories
+    for (size_t k = 0; k < times.size(); ++k)
+    {
+      times0[k] = times[k] - dt;
+      times1[k] = times[k] + dt;
+    }
+    sourceSensorTransforms->InterpolateTransforms(times0, sensor1T0Orientations, sensor1T0Positions);
+    targetSensorTransforms->InterpolateTransforms(times0, sensor2T0Orientations, sensor2T0Positions);
+    sourceSensorTransforms->InterpolateTransforms(times1, sensor1T1Orientations, sensor1T1Positions);
+    targetSensorTransforms->InterpolateTransforms(times1, sensor2T1Orientations, sensor2T1Positions);
+
+    // Loop over the time index
+    double lastStraightTime = -std::numeric_limits<double>::infinity();
+    for (size_t k = 0; k < times.size(); ++k)
     {
-      // The two time positions that will be used to express
-      // the solid-system geometric constraints that link
-      // the two sensor poses trajectories
-      double t0 = time - dt;
-      double t1 = time + dt;
+      // On a straight segment, the constraints of overlapping time intervals
+      // are nearly the same: only keep the ones whose interval [t - dt, t + dt]
+      // overlaps the previous kept one by at most half, so that each of them
+      // brings at least dt of new motion (a small tolerance absorbs the rounding
+      // of the accumulated times)
+      if (informativeSamplesOnly &&
+          sensor1T0Orientations[k].angularDistance(sensor1T1Orientations[k]) < straightSegmentAngle)
+      {
+        if (times[k] - lastStraightTime < dt - 1e-6)
+        {
+          continue;
+        }
+        lastStraightTime = times[k];
+      }
 
       //======================== Time: t0 ==================================
-      // Sensor 1
-      sourceSensorTransforms->InterpolateTransform(t0, transform);
-      std::pair<Eigen::Vector3d, Eigen::Vector3d> sensor1T0Pose = GetPoseParamsFromTransform(transform);
-      Q1 = RollPitchYawToMatrix(sensor1T0Pose.first); U1 = sensor1T0Pose.second;
-      // Sensor 2
-      targetSensorTransforms->InterpolateTransform(t0, transform);
-      std::pair<Eigen::Vector3d, Eigen::Vector3d> sensor2T0Pose = GetPoseParamsFromTransform(transform);
-      P1 = RollPitchYawToMatrix(sensor2T0Pose.first); V1 = sensor2T0Pose.second;
+      Q1 = sensor1T0Orientations[k].toRotationMatrix(); U1 = sensor1T0Positions[k];
+      P1 = sensor2T0Orientations[k].toRotationMatrix(); V1 = sensor2T0Positions[k];
 
       //======================== Time: t1 ==================================
-      // Sensor 1
-      sourceSensorTransforms->InterpolateTransform(t1, transform);
-      std::pair<Eigen::Vector3d, Eigen::Vector3d> sensor1T1Pose = GetPoseParamsFromTransform(transform);
-      Q2 = RollPitchYawToMatrix(sensor1T1Pose.first); U2 = sensor1T1Pose.second;
-      // Sensor 2
-      targetSensorTransforms->InterpolateTransform(t1, transform);
-      std::pair<Eigen::Vector3d, Eigen::Vector3d> sensor2T1Pose = GetPoseParamsFromTransform(transform);
-      P2 = RollPitchYawToMatrix(sensor2T1Pose.first); V2 = sensor2T1Pose.second;
+      Q2 = sensor1T1Orientations[k].toRotationMatrix(); U2 = sensor1T1Positions[k];
+      V2 = sensor2T1Positions[k];
 
       // add this geometric constraint non-linear least square residu to the global
       // cost function that is the sum of all residuals functions
-      ceres::CostFunction* cost_function = new ceres::AutoDiffCostFunction<CostFunctions::FrobeniusDistanceRotationAndTranslationCalibrationResidual, 1, 6>
-                (new CostFunctions::FrobeniusDistanceRotationAndTranslationCalibrationResidual(P1, P2, Q1, Q2, V1, V2, U1, U2));
-      problem.AddResidualBlock(cost_function, nullptr, calibEstimation.data());
-    } // Loop over the deltaTime multi-resolution "solid-system" assumption constraint
-  } // Loop over the time
+      constraints->AddConstraint(P1, Q1, Q2, V1, V2, U1, U2);
+    } // Loop over the time
+  } // Loop over the deltaTime multi-resolution "solid-system" assumption constraint
+  constraints->Finalize();
+  const int nbConstraints = constraints->GetNumberOfConstraints();
+  if (numberOfConstraints)
+  {
+    *numberOfConstraints = nbConstraints;
+  }
+
+  // We want to estimate our 6-DOF parameters using a non
+  // linear least square minimization. The non linear part
+  // comes from the Euler Angle parametrization of the rotation
+  // endomorphism SO(3). To minimize it we use CERES to perform
+  // the Levenberg-Marquardt algorithm.
+  ceres::Problem problem;
+  problem.AddResidualBlock(constraints, nullptr, calibEstimation.data());
 
   // Solve the optimization problem
   // Option of the solver
@@ -130,7 +178,7 @@ std::pair<double, AnglePositionVector> EstimateCalibrationFromPoses(
   // Solve
   ceres::Solver::Summary summary;
   ceres::Solve(options, &problem, &summary);
-  std::cout << summary.BriefReport() << ", Number Blocks: " << summary.num_residuals << std::endl;
+  std::cout << summary.BriefReport() << ", Number Constraints: " << nbConstraints << std::endl;
 
   return std::pair<double, AnglePositionVector>(summary.final_cost, calibEstimation);
 }
@@ -323,22 +371,27 @@ std::pair<double, AnglePositionVector> MatchTrajectoriesWithIsometry(vtkSmartPoi
   double tmax = std::min(sourceSensorTransforms->GetMaximumT(), targetSensorTransforms->GetMaximumT());
   const double deltaTime = 0.2; // 200ms
 
-  // usefull transform
-  auto currTransform = vtkSmartPointer<vtkTransform>::New();
+  // Positions of the sensors at each time
+  std::vector<double> times;
+  for (double time = tmin; time < tmax; time += deltaTime)
+  {
+    times.push_back(time);
+  }
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> sourcePositions, targetPositions;
+  sourceSensorTransforms->InterpolateTransforms(times, orientations, sourcePositions);
+  targetSensorTransforms->InterpolateTransforms(times, orientations, targetPositions);
 
   ceres::Problem problem;
   Eigen::Vector3d X, Y;
   AnglePositionVector transformParams = AnglePositionVector::Zero();
 
   // Loop over the time
-  for (double time = tmin; time < tmax; time += deltaTime)
+  for (size_t k = 0; k < times.size(); ++k)
   {
-    // Get the position of the sensor 1 for time
-    sourceSensorTransforms->InterpolateTransform(time, currTransform);
-    Y = GetPoseParamsFromTransform(currTransform).second;
-    // Get the position of the sensor 2 for time
-    targetSensorTransforms->InterpolateTransform(time, currTransform);
-    X = GetPoseParamsFromTransform(currTransform).second;
+    // Position of the sensor 1 and of the sensor 2 for time
+    Y = sourcePositions[k];
+    X = targetPositions[k];
 
     // Add the geometric contraint residual function
     // to the non-linear least square problem
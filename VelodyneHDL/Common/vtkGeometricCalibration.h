@@ -119,12 +119,19 @@ void EstimateEulerAngleConvention(const std::string& sourceSensorFilename,
 *
 * \@param targetSensor Poses trajectory of the first sensor
 * \@param sourceSensor Poses trajectory of the second sensor
+* \@param informativeSamplesOnly if true, drop the constraints which nearly
+*        duplicate another one on the straight segments of the trajectory
+* \@param numberOfConstraints if not null, set to the number of constraints used
 */
 std::pair<double, AnglePositionVector> EstimateCalibrationFromPoses(
                                             vtkSmartPointer<vtkTemporalTransforms> sourceSensor,
-                                            vtkSmartPointer<vtkTemporalTransforms> targetSensor);
+                                            vtkSmartPointer<vtkTemporalTransforms> targetSensor,
+                                            bool informativeSamplesOnly = false,
+                                            int* numberOfConstraints = nullptr);
 std::pair<double, AnglePositionVector> EstimateCalibrationFromPoses(const std::string& sourceSensorFilename,
-                                                                    const std::string& targetSensorFilename);
+                                                                    const std::string& targetSensorFilename,
+                                                                    bool informativeSamplesOnly = false,
+                                                                    int* numberOfConstraints = nullptr);
 vtkSmartPointer<vtkTemporalTransforms> EstimateCalibrationFromPosesAndApply(
                                             vtkSmartPointer<vtkTemporalTransforms> targetSensor,
                                             vtkSmartPointer<vtkTemporalTransforms> sourceSensor);
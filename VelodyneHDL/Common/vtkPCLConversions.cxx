@@ -16,6 +16,7 @@
 //=========================================================================
 
 #include "vtkPCLConversions.h"
+#include "vtkVertexCells.h"
 
 #include <vtkObjectFactory.h>
 #include <vtkPolyData.h>
@@ -325,18 +326,7 @@ pcl::PointCloud<pcl::PointXYZ>::Ptr vtkPCLConversions::PointCloudFromPolyData(vt
 //----------------------------------------------------------------------------
 vtkSmartPointer<vtkCellArray> vtkPCLConversions::NewVertexCells(vtkIdType numberOfVerts)
 {
-  vtkNew<vtkIdTypeArray> cells;
-  cells->SetNumberOfValues(numberOfVerts*2);
-  vtkIdType* ids = cells->GetPointer(0);
-  for (vtkIdType i = 0; i < numberOfVerts; ++i)
-    {
-    ids[i*2] = 1;
-    ids[i*2+1] = i;
-    }
-
-  vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
-  cellArray->SetCells(numberOfVerts, cells.GetPointer());
-  return cellArray;
+  return ::NewVertexCells(numberOfVerts);
 }
 
 //----------------------------------------------------------------------------
@@ -50,28 +50,74 @@ std::string ToString(CorrelationStrategy correlationStrategy)
   }
 }
 
-Interpolator1D<double> compute_speed_window(
+namespace
+{
+// Interpolate the poses of the trajectory at times + shift, times being
+// sorted so that the interpolator walks along the trajectory
+void InterpolatePoses(const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
+                      const std::vector<double>& times, double shift,
+                      vtkVelodyneTransformInterpolator::QuaternionVector& orientations,
+                      std::vector<Eigen::Vector3d>& positions)
+{
+  std::vector<double> shiftedTimes(times.size());
+  for (size_t i = 0; i < times.size(); i++)
+  {
+    shiftedTimes[i] = times[i] + shift;
+  }
+  transform->InterpolateTransforms(shiftedTimes, orientations, positions);
+}
+
+// Centers of the windows of width window_width contained in the
+// trajectory, sampled at the period of the trajectory
+std::vector<double> WindowCenters(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
     double window_width)
 {
   std::vector<double> times = std::vector<double>();
-  std::vector<double> speeds = std::vector<double>();
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> next = vtkSmartPointer<vtkTransform>::New();
-
   double minMidWindowTime = transform->GetMinimumT() + 0.5 * window_width;
   double maxMidWindowTime = transform->GetMaximumT() - 0.5 * window_width;
   double period = transform->GetPeriod();
   double time = minMidWindowTime;
   while (time < maxMidWindowTime)
   {
-    transform->InterpolateTransform(time - 0.5 * window_width, prev);
-    transform->InterpolateTransform(time + 0.5 * window_width, next);
-    speeds.push_back((PositionVectorFromTransform(next)
-			    - PositionVectorFromTransform(prev)).norm() / window_width);
     times.push_back(time);
     time = time + period;
   }
+  return times;
+}
+
+// Centers of the windows used by the derivated signals: steps samples
+// from the first window center, at the period of the trajectory
+std::vector<double> SampleTimes(
+    const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
+    double window_width)
+{
+  double tMin = transform->GetMinimumT() + 0.5 * window_width;
+  double tMax = transform->GetMaximumT() - 0.5 * window_width;
+  int steps = (tMax - tMin) / transform->GetPeriod() + 1;
+  std::vector<double> times = std::vector<double>(steps);
+  for (int i = 0; i < steps; i++)
+  {
+    times[i] = tMin + i * transform->GetPeriod();
+  }
+  return times;
+}
+}
+
+Interpolator1D<double> compute_speed_window(
+    const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
+    double window_width)
+{
+  std::vector<double> times = WindowCenters(transform, window_width);
+  std::vector<double> speeds = std::vector<double>(times.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> prev, next;
+  InterpolatePoses(transform, times, -0.5 * window_width, orientations, prev);
+  InterpolatePoses(transform, times, 0.5 * window_width, orientations, next);
+  for (size_t i = 0; i < times.size(); i++)
+  {
+    speeds[i] = (next[i] - prev[i]).norm() / window_width;
+  }
 
   return Interpolator1D<double>(times, speeds);
 }
@@ -80,27 +126,17 @@ Interpolator1D<double> compute_acc_window(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
     double window_width)
 {
-  std::vector<double> times = std::vector<double>();
-  std::vector<double> accs = std::vector<double>();
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> next = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> curr = vtkSmartPointer<vtkTransform>::New();
-
-  double minMidWindowTime = transform->GetMinimumT() + 0.5 * window_width;
-  double maxMidWindowTime = transform->GetMaximumT() - 0.5 * window_width;
-  double period = transform->GetPeriod();
-  double time = minMidWindowTime;
-  while (time < maxMidWindowTime)
+  std::vector<double> times = WindowCenters(transform, window_width);
+  std::vector<double> accs = std::vector<double>(times.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> prev, curr, next;
+  InterpolatePoses(transform, times, -0.5 * window_width, orientations, prev);
+  InterpolatePoses(transform, times, 0.0, orientations, curr);
+  InterpolatePoses(transform, times, 0.5 * window_width, orientations, next);
+  for (size_t i = 0; i < times.size(); i++)
   {
-    transform->InterpolateTransform(time - 0.5 * window_width, prev);
-    transform->InterpolateTransform(time, curr);
-    transform->InterpolateTransform(time + 0.5 * window_width, next);
-    Eigen::Vector3d a = (PositionVectorFromTransform(next)
-		    + PositionVectorFromTransform(prev)
-		    - 2 * PositionVectorFromTransform(curr)) / (window_width * window_width);
-    accs.push_back(a.norm());
-    times.push_back(time);
-    time = time + period;
+    Eigen::Vector3d a = (next[i] + prev[i] - 2 * curr[i]) / (window_width * window_width);
+    accs[i] = a.norm();
   }
 
   return Interpolator1D<double>(times, accs);
@@ -110,31 +146,18 @@ Interpolator1D<double> compute_jerk_window(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
     double window_width)
 {
-  std::vector<double> times = std::vector<double>();
-  std::vector<double> jerks = std::vector<double>();
-  vtkSmartPointer<vtkTransform> t1 = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> t2 = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> t3 = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> t4 = vtkSmartPointer<vtkTransform>::New();
-
-  double minMidWindowTime = transform->GetMinimumT() + 0.5 * window_width;
-  double maxMidWindowTime = transform->GetMaximumT() - 0.5 * window_width;
-  double period = transform->GetPeriod();
-  double time = minMidWindowTime;
-  while (time < maxMidWindowTime)
+  std::vector<double> times = WindowCenters(transform, window_width);
+  std::vector<double> jerks = std::vector<double>(times.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> t1, t2, t3, t4;
+  InterpolatePoses(transform, times, - 0.5 * window_width, orientations, t1);
+  InterpolatePoses(transform, times, (- 0.5 + 1.0/3.0) * window_width, orientations, t2);
+  InterpolatePoses(transform, times, (- 0.5 + 2.0/3.0) * window_width, orientations, t3);
+  InterpolatePoses(transform, times, (- 0.5 + 3.0/3.0) * window_width, orientations, t4);
+  for (size_t i = 0; i < times.size(); i++)
   {
-    transform->InterpolateTransform(time - 0.5 * window_width, t1);
-    transform->InterpolateTransform(time + (- 0.5 + 1.0/3.0) * window_width, t2);
-    transform->InterpolateTransform(time + (- 0.5 + 2.0/3.0) * window_width, t3);
-    transform->InterpolateTransform(time + (- 0.5 + 3.0/3.0) * window_width, t4);
-    Eigen::Vector3d j = (PositionVectorFromTransform(t4)
-		   - 3 * PositionVectorFromTransform(t3)
-		   + 3 * PositionVectorFromTransform(t2)
-		   - PositionVectorFromTransform(t1))
-	    / std::pow(window_width, 3.0);
-    jerks.push_back(j.norm());
-    times.push_back(time);
-    time = time + period;
+    Eigen::Vector3d j = (t4[i] - 3 * t3[i] + 3 * t2[i] - t1[i]) / std::pow(window_width, 3.0);
+    jerks[i] = j.norm();
   }
 
   return Interpolator1D<double>(times, jerks);
@@ -143,24 +166,21 @@ Interpolator1D<double> compute_jerk_window(
 Interpolator1D<double> compute_dPos(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform)
 {
-  std::vector<std::vector<double>> transforms = transform->GetTransformList();
-  std::vector<double> t = std::vector<double>(transforms.size() - 1);
-  std::vector<double> x = std::vector<double>(transforms.size() - 1);
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> curr = vtkSmartPointer<vtkTransform>::New();
-  for (unsigned int i = 0; i < transforms.size() - 1; i++)
+  std::vector<double> samples = transform->GetTimes();
+  std::vector<double> t = std::vector<double>(samples.size() - 1);
+  std::vector<double> x = std::vector<double>(samples.size() - 1);
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> positions;
+  transform->InterpolateTransforms(samples, orientations, positions);
+  for (unsigned int i = 0; i < samples.size() - 1; i++)
   {
-    double t0 = transforms[i][0];
-    double t1 = transforms[i+1][0];
+    double t0 = samples[i];
+    double t1 = samples[i+1];
     t[i] = 0.5 * (t0 + t1);
-    transform->InterpolateTransform(t0, prev);
-    transform->InterpolateTransform(t1, curr);
     if (std::abs(t1 - t0) < 0.0001) {
       x[i] = 0.0;
     } else {
-      x[i] = (PositionVectorFromTransform(curr)
-		      - PositionVectorFromTransform(prev)).norm()
-	      / (t1 - t0);
+      x[i] = (positions[i+1] - positions[i]).norm() / (t1 - t0);
     }
   }
   return Interpolator1D<double>(t, x);
@@ -169,20 +189,15 @@ Interpolator1D<double> compute_dPos(
 Interpolator1D<double> compute_length(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform)
 {
-  std::vector<std::vector<double>> transforms = transform->GetTransformList();
-  std::vector<double> t = std::vector<double>(transforms.size());
-  std::vector<double> x = std::vector<double>(transforms.size());
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> curr = vtkSmartPointer<vtkTransform>::New();
-  t[0] = transforms[0][0];
+  std::vector<double> t = transform->GetTimes();
+  std::vector<double> x = std::vector<double>(t.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> positions;
+  transform->InterpolateTransforms(t, orientations, positions);
   x[0] = 0.0;
-  for (unsigned int i = 1; i < transforms.size(); i++)
+  for (unsigned int i = 1; i < t.size(); i++)
   {
-    t[i] = transforms[i][0];
-    transform->InterpolateTransform(t[i-1], prev);
-    transform->InterpolateTransform(t[i], curr);
-    x[i] = x[i - 1] + (PositionVectorFromTransform(curr)
-		    - PositionVectorFromTransform(prev)).norm();
+    x[i] = x[i - 1] + (positions[i] - positions[i-1]).norm();
   }
 
   return Interpolator1D<double>(t, x);
@@ -194,15 +209,11 @@ Interpolator1D<double> compute_derivated_length(
     double window_width)
 {
   Interpolator1D<double> length = compute_length(transform);
-  double tMin = transform->GetMinimumT() + 0.5 * window_width;
-  double tMax = transform->GetMaximumT() - 0.5 * window_width;
-  int steps = (tMax - tMin) / transform->GetPeriod() + 1;
-  std::vector<double> derivated_length = std::vector<double>(steps);
-  std::vector<double> times = std::vector<double>(steps);
-  for (int i = 0; i < steps; i++)
+  std::vector<double> times = SampleTimes(transform, window_width);
+  std::vector<double> derivated_length = std::vector<double>(times.size());
+  for (size_t i = 0; i < times.size(); i++)
   {
-    double time = tMin + i * transform->GetPeriod();
-    times[i] = time;
+    double time = times[i];
     // length is an interpolator so no need to check that the sample instants
     // are not the same (they are not, even if the interpolation mode of
     // this->Reference/Aligned is "NEAREST")
@@ -217,19 +228,17 @@ Interpolator1D<double> compute_derivated_length(
 Interpolator1D<double> compute_dRot(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform)
 {
-  std::vector<std::vector<double>> transforms = transform->GetTransformList();
-  std::vector<double> t = std::vector<double>(transforms.size() - 1);
-  std::vector<double> x = std::vector<double>(transforms.size() - 1);
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> curr = vtkSmartPointer<vtkTransform>::New();
-  for (int i = 0; i < static_cast<int>(transforms.size()) - 1; i++)
+  std::vector<double> samples = transform->GetTimes();
+  std::vector<double> t = std::vector<double>(samples.size() - 1);
+  std::vector<double> x = std::vector<double>(samples.size() - 1);
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> positions;
+  transform->InterpolateTransforms(samples, orientations, positions);
+  for (int i = 0; i < static_cast<int>(samples.size()) - 1; i++)
   {
-    double t0 = transforms[i][0];
-    double t1 = transforms[i+1][0];
-    transform->InterpolateTransform(t0, prev);
-    transform->InterpolateTransform(t1, curr);
-    Eigen::AngleAxisd aa = Eigen::AngleAxisd(RotationMatrixFromTransform(curr)
-		    * RotationMatrixFromTransform(prev).transpose());
+    double t0 = samples[i];
+    double t1 = samples[i+1];
+    Eigen::AngleAxisd aa = Eigen::AngleAxisd(orientations[i+1] * orientations[i].conjugate());
     t[i] = 0.5 * (t0 + t1);
     if (std::abs(t1 - t0) < 0.0001) {
       x[i] = 0.0;
@@ -245,25 +254,16 @@ Interpolator1D<double> compute_trajectory_angle(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
     double window_width)
 {
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> curr = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> next = vtkSmartPointer<vtkTransform>::New();
-  double tMin = transform->GetMinimumT() + 0.5 * window_width;
-  double tMax = transform->GetMaximumT() - 0.5 * window_width;
-  int steps = (tMax - tMin) / transform->GetPeriod() + 1;
-  std::vector<double> trajectory_angle = std::vector<double>(steps);
-  std::vector<double> times = std::vector<double>(steps);
-  for (int i = 0; i < steps; i++)
+  std::vector<double> times = SampleTimes(transform, window_width);
+  std::vector<double> trajectory_angle = std::vector<double>(times.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> prev, curr, next;
+  InterpolatePoses(transform, times, -0.5 * window_width, orientations, prev);
+  InterpolatePoses(transform, times, 0.0, orientations, curr);
+  InterpolatePoses(transform, times, 0.5 * window_width, orientations, next);
+  for (size_t i = 0; i < times.size(); i++)
   {
-    double time = tMin + i * transform->GetPeriod();
-    transform->InterpolateTransform(time - 0.5 * window_width, prev);
-    transform->InterpolateTransform(time, curr);
-    transform->InterpolateTransform(time + 0.5 * window_width, next);
-    times[i] = time;
-    trajectory_angle[i] = SignedAngle(PositionVectorFromTransform(curr)
-		    - PositionVectorFromTransform(prev),
-		    PositionVectorFromTransform(next)
-		    - PositionVectorFromTransform(curr));
+    trajectory_angle[i] = SignedAngle(curr[i] - prev[i], next[i] - curr[i]);
   }
 
   return Interpolator1D<double>(times, trajectory_angle);
@@ -273,20 +273,15 @@ Interpolator1D<double> compute_trajectory_angle(
 Interpolator1D<double> compute_orientation_arc(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform)
 {
-  std::vector<std::vector<double>> transforms = transform->GetTransformList();
-  std::vector<double> t = std::vector<double>(transforms.size());
-  std::vector<double> x = std::vector<double>(transforms.size());
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> curr = vtkSmartPointer<vtkTransform>::New();
-  t[0] = transforms[0][0];
+  std::vector<double> t = transform->GetTimes();
+  std::vector<double> x = std::vector<double>(t.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> positions;
+  transform->InterpolateTransforms(t, orientations, positions);
   x[0] = 0.0;
-  for (unsigned int i = 1; i < transforms.size(); i++)
+  for (unsigned int i = 1; i < t.size(); i++)
   {
-    t[i] = transforms[i][0];
-    transform->InterpolateTransform(t[i-1], prev);
-    transform->InterpolateTransform(t[i], curr);
-    Eigen::AngleAxisd aa = Eigen::AngleAxisd(RotationMatrixFromTransform(curr)
-		    * RotationMatrixFromTransform(prev).transpose());
+    Eigen::AngleAxisd aa = Eigen::AngleAxisd(orientations[i] * orientations[i-1].conjugate());
     x[i] = x[i - 1] + std::abs(aa.angle());
   }
 
@@ -299,15 +294,11 @@ Interpolator1D<double> compute_derivated_orientation_arc(
     double window_width)
 {
   Interpolator1D<double> orientation_arc = compute_orientation_arc(transform);
-  double tMin = transform->GetMinimumT() + 0.5 * window_width;
-  double tMax = transform->GetMaximumT() - 0.5 * window_width;
-  int steps = (tMax - tMin) / transform->GetPeriod() + 1;
-  std::vector<double> derivated_orientation_arc = std::vector<double>(steps);
-  std::vector<double> times = std::vector<double>(steps);
-  for (int i = 0; i < steps; i++)
+  std::vector<double> times = SampleTimes(transform, window_width);
+  std::vector<double> derivated_orientation_arc = std::vector<double>(times.size());
+  for (size_t i = 0; i < times.size(); i++)
   {
-    double time = tMin + i * transform->GetPeriod();
-    times[i] = time;
+    double time = times[i];
     // length is an interpolator so no need to check that the sample instants
     // are not the same (they are not, even if the interpolation mode of
     // this->Reference/Aligned is "NEAREST")
@@ -326,21 +317,15 @@ Interpolator1D<double> compute_orientation_angle(
     const vtkSmartPointer<vtkVelodyneTransformInterpolator>& transform,
     double window_width)
 {
-  vtkSmartPointer<vtkTransform> prev = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkTransform> next = vtkSmartPointer<vtkTransform>::New();
-  double tMin = transform->GetMinimumT() + 0.5 * window_width;
-  double tMax = transform->GetMaximumT() - 0.5 * window_width;
-  int steps = (tMax - tMin) / transform->GetPeriod() + 1;
-  std::vector<double> orientation_angle = std::vector<double>(steps);
-  std::vector<double> times = std::vector<double>(steps);
-  for (int i = 0; i < steps; i++)
+  std::vector<double> times = SampleTimes(transform, window_width);
+  std::vector<double> orientation_angle = std::vector<double>(times.size());
+  vtkVelodyneTransformInterpolator::QuaternionVector prev, next;
+  std::vector<Eigen::Vector3d> positions;
+  InterpolatePoses(transform, times, -0.5 * window_width, prev, positions);
+  InterpolatePoses(transform, times, 0.5 * window_width, next, positions);
+  for (size_t i = 0; i < times.size(); i++)
   {
-    double time = tMin + i * transform->GetPeriod();
-    transform->InterpolateTransform(time - 0.5 * window_width, prev);
-    transform->InterpolateTransform(time + 0.5 * window_width, next);
-    times[i] = time;
-    Eigen::AngleAxisd angleAxis(RotationMatrixFromTransform(next)
-		    * RotationMatrixFromTransform(prev).transpose());
+    Eigen::AngleAxisd angleAxis(next[i] * prev[i].conjugate());
     orientation_angle[i] = angleAxis.angle();
   }
 
@@ -21,17 +21,17 @@
 #include "vtkPatchVeloView/vtkVeloViewQuaternionInterpolator.h"
 #include "vtkTransform.h"
 #include "vtkPatchVeloView/vtkVeloViewTupleInterpolator.h"
-#include <list>
 #include <vector>
 #include <set>
 #include <algorithm>
 #include <iterator>
+#include <utility>
 
 vtkStandardNewMacro(vtkVelodyneTransformInterpolator);
 
-// PIMPL STL encapsulation for list of transforms, and list of
-// quaternions. This just keeps track of all the data the user specifies,
-// which is later dumped into the interpolators.
+// PIMPL STL encapsulation of the transforms, and their quaternions. This
+// just keeps track of all the data the user specifies, which is later
+// dumped into the interpolators.
 struct vtkQTransform
 {
   double Time;
@@ -70,46 +70,146 @@ struct vtkQTransform
   }
 };
 
-class vtkQTransformComparator
+// The transforms are stored as a structure of arrays, arranged in
+// increasing order in T, so that the interpolators are filled from
+// contiguous arrays and a time is found by bisection
+class vtkTransformList
 {
 public:
-  bool operator () ( const vtkQTransform& transform1,
-                     const vtkQTransform& transform2 )
+  std::vector<double> Time;
+  std::vector<double> Position[3];
+  std::vector<double> Scale[3];
+  std::vector<vtkVeloViewQuaterniond> Orientation;
+
+  size_t size() const { return this->Time.size(); }
+  bool empty() const { return this->Time.empty(); }
+
+  void clear()
+  {
+    this->resize(0);
+  }
+
+  void reserve(size_t n)
+  {
+    this->Time.reserve(n);
+    this->Orientation.reserve(n);
+    for (int k = 0; k < 3; ++k)
     {
-      return transform1.Time < transform2.Time;
+      this->Position[k].reserve(n);
+      this->Scale[k].reserve(n);
     }
-};
+  }
 
-// The list is arranged in increasing order in T
-class vtkTransformList : public std::list<vtkQTransform>
-{
+  void resize(size_t n)
+  {
+    this->Time.resize(n);
+    this->Orientation.resize(n);
+    for (int k = 0; k < 3; ++k)
+    {
+      this->Position[k].resize(n);
+      this->Scale[k].resize(n);
+    }
+  }
+
+  // index of the first transform which is not before t
+  size_t LowerBound(double t) const
+  {
+    return std::lower_bound(this->Time.begin(), this->Time.end(), t) - this->Time.begin();
+  }
+
+  void Set(size_t i, const vtkQTransform& transform)
+  {
+    this->Time[i] = transform.Time;
+    this->Orientation[i] = transform.Q;
+    for (int k = 0; k < 3; ++k)
+    {
+      this->Position[k][i] = transform.P[k];
+      this->Scale[k][i] = transform.S[k];
+    }
+  }
+
+  vtkQTransform Get(size_t i) const
+  {
+    vtkQTransform transform;
+    transform.Time = this->Time[i];
+    transform.Q = this->Orientation[i];
+    for (int k = 0; k < 3; ++k)
+    {
+      transform.P[k] = this->Position[k][i];
+      transform.S[k] = this->Scale[k][i];
+    }
+    return transform;
+  }
+
+  void Insert(size_t i, const vtkQTransform& transform)
+  {
+    this->Time.insert(this->Time.begin() + i, transform.Time);
+    this->Orientation.insert(this->Orientation.begin() + i, transform.Q);
+    for (int k = 0; k < 3; ++k)
+    {
+      this->Position[k].insert(this->Position[k].begin() + i, transform.P[k]);
+      this->Scale[k].insert(this->Scale[k].begin() + i, transform.S[k]);
+    }
+  }
+
+  void Erase(size_t i)
+  {
+    this->Time.erase(this->Time.begin() + i);
+    this->Orientation.erase(this->Orientation.begin() + i);
+    for (int k = 0; k < 3; ++k)
+    {
+      this->Position[k].erase(this->Position[k].begin() + i);
+      this->Scale[k].erase(this->Scale[k].begin() + i);
+    }
+  }
+
+  // Sort the transforms in increasing order in T. When several transforms
+  // have the same time, the last one added is kept.
+  void SortAndRemoveDuplicates()
+  {
+    std::vector<size_t> order(this->size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) { return this->Time[a] < this->Time[b]; });
+
+    vtkTransformList sorted;
+    sorted.reserve(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+      if (i + 1 < order.size() && this->Time[order[i + 1]] == this->Time[order[i]])
+      {
+        continue;
+      }
+      sorted.resize(sorted.size() + 1);
+      sorted.Set(sorted.size() - 1, this->Get(order[i]));
+    }
+    std::swap(*this, sorted);
+  }
 };
-typedef vtkTransformList::iterator TransformListIterator;
 
 //----------------------------------------------------------------------------
 std::vector<std::vector<double> > vtkVelodyneTransformInterpolator::GetTransformList()
 {
-  this->InitializeInterpolation();
-
-  std::vector<std::vector<double> > transforms;
-  // Okay, insert in sorted order
-  for (TransformListIterator iter = this->TransformList->begin(); iter != this->TransformList->end(); ++iter)
+  std::vector<std::vector<double> > transforms(this->TransformList->size());
+  for (size_t i = 0; i < this->TransformList->size(); ++i)
   {
-    std::vector<double> currentTransform(7, 0);
+    std::vector<double>& currentTransform = transforms[i];
+    currentTransform.resize(7, 0);
     // time
-    currentTransform[0] = iter->Time;
+    currentTransform[0] = this->TransformList->Time[i];
     // position
-    currentTransform[4] = iter->P[0];
-    currentTransform[5] = iter->P[1];
-    currentTransform[6] = iter->P[2];
+    currentTransform[4] = this->TransformList->Position[0][i];
+    currentTransform[5] = this->TransformList->Position[1][i];
+    currentTransform[6] = this->TransformList->Position[2][i];
     // orientation
     double A[3][3];
-    iter->Q.ToMatrix3x3(A);
+    this->TransformList->Orientation[i].ToMatrix3x3(A);
     currentTransform[1] = std::atan2(A[2][1], A[2][2]);
     currentTransform[2] = -std::asin(A[2][0]);
     currentTransform[3] = std::atan2(A[1][0], A[0][0]);
-
-    transforms.push_back(currentTransform);
   }
 
   return transforms;
@@ -129,6 +229,8 @@ vtkVelodyneTransformInterpolator::vtkVelodyneTransformInterpolator()
   // Quaternion interpolation
   this->TransformList = new vtkTransformList;
   this->Initialized = 0;
+  this->InitializedInterpolationType = this->InterpolationType;
+  this->NumberOfInitializedTransforms = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -191,22 +293,21 @@ void vtkVelodyneTransformInterpolator::GetSample(int n,
     return;
   }
 
-  this->InitializeInterpolation();
-
-  if (n < 0 || n >= static_cast<int>(this->TransformVector.size()))
+  if (n < 0 || n >= static_cast<int>(this->TransformList->size()))
   {
     return;
   }
 
   // Get the transform
+  const vtkQTransform transform = this->TransformList->Get(n);
   xform->Identity();
-  xform->Translate(this->TransformVector[n].P);
+  xform->Translate(transform.P);
   double Q[4];
-  Q[0] = vtkMath::DegreesFromRadians(this->TransformVector[n].Q.GetRotationAngleAndAxis(Q+1));
+  Q[0] = vtkMath::DegreesFromRadians(transform.Q.GetRotationAngleAndAxis(Q+1));
   xform->RotateWXYZ(Q[0],Q+1);
-  xform->Scale(this->TransformVector[n].S);
+  xform->Scale(transform.S);
 
-  xformTime = this->TransformVector[n].Time;
+  xformTime = transform.Time;
 }
 
 //----------------------------------------------------------------------------
@@ -218,7 +319,7 @@ double vtkVelodyneTransformInterpolator::GetMinimumT()
   }
   else
   {
-    return this->TransformList->front().Time;
+    return this->TransformList->Time.front();
   }
 }
 
@@ -231,7 +332,7 @@ double vtkVelodyneTransformInterpolator::GetMaximumT()
   }
   else
   {
-    return this->TransformList->back().Time;
+    return this->TransformList->Time.back();
   }
 }
 
@@ -245,43 +346,31 @@ double vtkVelodyneTransformInterpolator::GetPeriod()
 void vtkVelodyneTransformInterpolator::Initialize()
 {
   this->TransformList->clear();
+  this->TransformsModifiedTime.Modified();
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkVelodyneTransformInterpolator::AddTransform(double t, vtkTransform* xform)
 {
-  int size = static_cast<int>(this->TransformList->size());
+  const vtkQTransform transform(t, xform);
+  const size_t index = this->TransformList->LowerBound(t);
 
-  // Check special cases: t at beginning or end of list
-  if (size <= 0 || t < this->TransformList->front().Time)
+  if (index == this->TransformList->size())
   {
-    this->TransformList->push_front(vtkQTransform(t, xform));
-    return;
+    // appended transforms are added to the interpolators without reloading them
+    this->TransformList->resize(index + 1);
+    this->TransformList->Set(index, transform);
   }
-  else if (t > this->TransformList->back().Time)
+  else if (this->TransformList->Time[index] == t)
   {
-    this->TransformList->push_back(vtkQTransform(t, xform));
-    return;
+    this->TransformList->Set(index, transform);
+    this->TransformsModifiedTime.Modified();
   }
-  else if (size == 1 && t == this->TransformList->back().Time)
+  else
   {
-    this->TransformList->front() = vtkQTransform(t, xform);
-    return;
-  }
-
-  // Okay, insert in sorted order
-  TransformListIterator iter = this->TransformList->begin();
-  TransformListIterator nextIter = ++(this->TransformList->begin());
-  for (int i = 0; i < (size - 1); i++, ++iter, ++nextIter)
-  {
-    if (t == iter->Time)
-    {
-      (*iter) = vtkQTransform(t, xform);
-    }
-    else if (t > iter->Time && t < nextIter->Time)
-    {
-      this->TransformList->insert(nextIter, vtkQTransform(t, xform));
-    }
+    this->TransformList->Insert(index, transform);
+    this->TransformsModifiedTime.Modified();
   }
 
   this->Modified();
@@ -303,20 +392,61 @@ void vtkVelodyneTransformInterpolator::AddTransform(double t, vtkProp3D* prop3D)
 }
 
 //----------------------------------------------------------------------------
-void vtkVelodyneTransformInterpolator::RemoveTransform(double t)
+void vtkVelodyneTransformInterpolator::AddTransforms(int n, const double* times,
+                                                     const double* quaternions,
+                                                     const double* positions)
 {
-  if (t < this->TransformList->front().Time || t > this->TransformList->back().Time)
+  if (n <= 0)
   {
     return;
   }
 
-  TransformListIterator iter = this->TransformList->begin();
-  for (; iter->Time != t && iter != this->TransformList->end(); ++iter)
+  vtkTransformList& list = *this->TransformList;
+  const size_t offset = list.size();
+  bool isAppend = list.empty() || times[0] > list.Time.back();
+
+  list.resize(offset + n);
+  for (int i = 0; i < n; ++i)
   {
+    const size_t index = offset + i;
+    list.Time[index] = times[i];
+    for (int k = 0; k < 3; ++k)
+    {
+      list.Position[k][index] = positions[3 * i + k];
+      list.Scale[k][index] = 1.0;
+    }
+    vtkVeloViewQuaterniond& q = list.Orientation[index];
+    q.Set(quaternions[4 * i], quaternions[4 * i + 1], quaternions[4 * i + 2], quaternions[4 * i + 3]);
+    q.Normalize();
+    if (q.GetW() < 0.0)
+    {
+      q = q * -1;
+    }
+
+    if (i > 0 && times[i] <= times[i - 1])
+    {
+      isAppend = false;
+    }
   }
-  if (iter != this->TransformList->end())
+
+  if (!isAppend)
   {
-    this->TransformList->erase(iter);
+    list.SortAndRemoveDuplicates();
+    this->TransformsModifiedTime.Modified();
+  }
+
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkVelodyneTransformInterpolator::RemoveTransform(double t)
+{
+  const size_t index = this->TransformList->LowerBound(t);
+  if (index < this->TransformList->size() && this->TransformList->Time[index] == t)
+  {
+    this->TransformList->Erase(index);
+    this->TransformsModifiedTime.Modified();
+    this->Modified();
   }
 }
 
@@ -334,6 +464,7 @@ void vtkVelodyneTransformInterpolator::SetPositionInterpolator(vtkVeloViewTupleI
     {
       this->PositionInterpolator->Register(this);
     }
+    this->Initialized = 0;
     this->Modified();
   }
 }
@@ -352,6 +483,7 @@ void vtkVelodyneTransformInterpolator::SetScaleInterpolator(vtkVeloViewTupleInte
     {
       this->ScaleInterpolator->Register(this);
     }
+    this->Initialized = 0;
     this->Modified();
   }
 }
@@ -370,6 +502,7 @@ void vtkVelodyneTransformInterpolator::SetRotationInterpolator(vtkVeloViewQuater
     {
       this->RotationInterpolator->Register(this);
     }
+    this->Initialized = 0;
     this->Modified();
   }
 }
@@ -382,8 +515,23 @@ void vtkVelodyneTransformInterpolator::InitializeInterpolation()
     return;
   }
 
+  vtkMTimeType interpolatorsMTime = 0;
+  if (this->PositionInterpolator && this->ScaleInterpolator && this->RotationInterpolator)
+  {
+    interpolatorsMTime = std::max(this->PositionInterpolator->GetMTime(),
+                         std::max(this->ScaleInterpolator->GetMTime(),
+                                  this->RotationInterpolator->GetMTime()));
+  }
+  const bool isLinear = this->InterpolationType == INTERPOLATION_TYPE_LINEAR
+                     || this->InterpolationType == INTERPOLATION_TYPE_NEAREST
+                     || this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED;
+
   // Set up the interpolators if we need to
-  if (!this->Initialized || this->GetMTime() > this->InitializeTime)
+  if (!this->Initialized
+      || this->InterpolationType != this->InitializedInterpolationType
+      || this->TransformsModifiedTime > this->InitializeTime
+      || interpolatorsMTime > this->InitializeTime
+      || (!isLinear && this->NumberOfInitializedTransforms != static_cast<int>(this->TransformList->size())))
   {
     if (!this->PositionInterpolator)
     {
@@ -398,20 +546,11 @@ void vtkVelodyneTransformInterpolator::InitializeInterpolation()
       this->RotationInterpolator = vtkVeloViewQuaternionInterpolator::New();
     }
 
-    if (this->InterpolationType == INTERPOLATION_TYPE_LINEAR
-             || this->InterpolationType == INTERPOLATION_TYPE_NEAREST
-             || this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
+    if (isLinear)
     {
       this->PositionInterpolator->SetInterpolationTypeToLinear();
       this->ScaleInterpolator->SetInterpolationTypeToLinear();
       this->RotationInterpolator->SetInterpolationTypeToLinear();
-      this->TransformVector.clear();
-      this->TransformVector.resize(0);
-      std::list<vtkQTransform>::iterator transform;
-      for (transform = this->TransformList->begin(); transform != this->TransformList->end(); ++transform)
-      {
-        this->TransformVector.push_back(*transform);
-      }
     }
     else if (this->InterpolationType == INTERPOLATION_TYPE_SPLINE)
     {
@@ -431,52 +570,44 @@ void vtkVelodyneTransformInterpolator::InitializeInterpolation()
     this->PositionInterpolator->SetNumberOfComponents(3);
     this->ScaleInterpolator->SetNumberOfComponents(3);
 
-    // Okay, now we can load the interpolators with data
-    // Initialize the data pointers
-    int nb = this->TransformList->size();
-    double *time = new double[nb];
-    double **Position = new double*[3];
-    double **Scale = new double*[3];
-    for (int k = 0; k < 3; ++k)
-    {
-      Position[k] = new double[nb];
-      Scale[k] = new double[nb];
-    }
+    this->NumberOfInitializedTransforms = 0;
+    this->Initialized = 1;
+    this->InitializedInterpolationType = this->InterpolationType;
+  }
 
-    // Fill the data pointers
-    TransformListIterator iter = this->TransformList->begin();
-    int count = 0;
-    for ( ; iter != this->TransformList->end(); ++iter)
-    {
-      /*this->PositionInterpolator->AddTuple(iter->Time,iter->P);
-      this->ScaleInterpolator->AddTuple(iter->Time,iter->S);*/
-      Position[0][count] = iter->P[0];
-      Position[1][count] = iter->P[1];
-      Position[2][count] = iter->P[2];
-      Scale[0][count] = iter->S[0];
-      Scale[1][count] = iter->S[1];
-      Scale[2][count] = iter->S[2];
-      time[count] = iter->Time;
-      this->RotationInterpolator->AddQuaternion(iter->Time,iter->Q);
-      count++;
-    }
+  // Okay, now we can load the interpolators with the transforms which
+  // are not in them yet: all of them, or the ones appended since the
+  // last initialization
+  const int first = this->NumberOfInitializedTransforms;
+  const int nb = static_cast<int>(this->TransformList->size()) - first;
+  if (nb <= 0)
+  {
+    return;
+  }
+
+  vtkTransformList& list = *this->TransformList;
+  double *time = &list.Time[first];
+  double *Position[3] = { &list.Position[0][first], &list.Position[1][first], &list.Position[2][first] };
+  double *Scale[3] = { &list.Scale[0][first], &list.Scale[1][first], &list.Scale[2][first] };
+  for (size_t i = first; i < list.size(); ++i)
+  {
+    this->RotationInterpolator->AddQuaternion(list.Time[i], list.Orientation[i]);
+  }
 
-    // Fill the interpolators
+  // Fill the interpolators
+  if (first == 0)
+  {
     this->PositionInterpolator->FillFromData(nb, time, Position);
     this->ScaleInterpolator->FillFromData(nb, time, Scale);
-
-    for (int k = 0; k < 3; ++k)
-    {
-      delete [] Position[k];
-      delete [] Scale[k];
-    }
-
-    delete [] Position;
-    delete [] Scale;
-
-    this->Initialized = 1;
-    this->InitializeTime.Modified();
   }
+  else
+  {
+    this->PositionInterpolator->AppendFromData(nb, time, Position);
+    this->ScaleInterpolator->AppendFromData(nb, time, Scale);
+  }
+
+  this->NumberOfInitializedTransforms = static_cast<int>(list.size());
+  this->InitializeTime.Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -499,14 +630,14 @@ void vtkVelodyneTransformInterpolator::InterpolateTransform(double t, vtkTransfo
   this->InitializeInterpolation();
 
   // Evaluate the interpolators
-  if (t < this->TransformList->front().Time)
+  if (t < this->TransformList->Time.front())
   {
-    t = this->TransformList->front().Time;
+    t = this->TransformList->Time.front();
   }
 
-  else if (t > this->TransformList->back().Time)
+  else if (t > this->TransformList->Time.back())
   {
-    t = this->TransformList->back().Time;
+    t = this->TransformList->Time.back();
   }
 
   double P[3], S[3], Q[4];
@@ -521,6 +652,117 @@ void vtkVelodyneTransformInterpolator::InterpolateTransform(double t, vtkTransfo
   xform->Scale(S);
 }
 
+//----------------------------------------------------------------------------
+void vtkVelodyneTransformInterpolator::InterpolateTransform(double t,
+                                                            Eigen::Quaterniond& orientation,
+                                                            Eigen::Vector3d& position)
+{
+  size_t index = 0;
+  this->InterpolatePose(t, index, orientation, position);
+}
+
+//----------------------------------------------------------------------------
+void vtkVelodyneTransformInterpolator::InterpolateTransforms(const std::vector<double>& times,
+                                                             QuaternionVector& orientations,
+                                                             std::vector<Eigen::Vector3d>& positions)
+{
+  orientations.resize(times.size());
+  positions.resize(times.size());
+  size_t index = 0;
+  for (size_t i = 0; i < times.size(); ++i)
+  {
+    this->InterpolatePose(times[i], index, orientations[i], positions[i]);
+  }
+}
+
+//----------------------------------------------------------------------------
+std::vector<double> vtkVelodyneTransformInterpolator::GetTimes()
+{
+  return this->TransformList->Time;
+}
+
+//----------------------------------------------------------------------------
+void vtkVelodyneTransformInterpolator::InterpolatePose(double t, size_t& index,
+                                                       Eigen::Quaterniond& orientation,
+                                                       Eigen::Vector3d& position)
+{
+  const vtkTransformList& list = *this->TransformList;
+  if (list.empty())
+  {
+    orientation.setIdentity();
+    position.setZero();
+    return;
+  }
+
+  // Splines are evaluated by the interpolators
+  if (this->InterpolationType == INTERPOLATION_TYPE_SPLINE
+      || this->InterpolationType == INTERPOLATION_TYPE_MANUAL)
+  {
+    this->InitializeInterpolation();
+    t = std::min(std::max(t, list.Time.front()), list.Time.back());
+    vtkVeloViewQuaterniond q;
+    this->PositionInterpolator->InterpolateTupleDichotomic(t, position.data());
+    this->RotationInterpolator->InterpolateQuaternion(t, q);
+    orientation = Eigen::Quaterniond(q.GetW(), q.GetX(), q.GetY(), q.GetZ());
+    return;
+  }
+
+  // Find the last transform at or before t, walking from the previous
+  // one when t is just after it, by bisection otherwise
+  t = std::min(std::max(t, list.Time.front()), list.Time.back());
+  const size_t n = list.size();
+  if (index >= n || list.Time[index] > t)
+  {
+    index = 0;
+  }
+  int steps = 0;
+  while (index + 1 < n && list.Time[index + 1] <= t && steps < 8)
+  {
+    ++index;
+    ++steps;
+  }
+  if (index + 1 < n && list.Time[index + 1] <= t)
+  {
+    index = std::upper_bound(list.Time.begin() + index + 1, list.Time.end(), t)
+            - list.Time.begin() - 1;
+  }
+
+  size_t sample = index;
+  if (this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
+  {
+    // last transform strictly before t, as InterpolateTransformNearest
+    if (list.Time[index] == t && index > 0)
+    {
+      sample = index - 1;
+    }
+  }
+  else if (this->InterpolationType == INTERPOLATION_TYPE_NEAREST)
+  {
+    if (index + 1 < n && t - list.Time[index] > list.Time[index + 1] - t)
+    {
+      sample = index + 1;
+    }
+  }
+  else if (index + 1 < n)
+  {
+    // linear interpolation
+    const double alpha = (t - list.Time[index]) / (list.Time[index + 1] - list.Time[index]);
+    for (int k = 0; k < 3; ++k)
+    {
+      position(k) = (1.0 - alpha) * list.Position[k][index] + alpha * list.Position[k][index + 1];
+    }
+    const vtkVeloViewQuaterniond& q0 = list.Orientation[index];
+    const vtkVeloViewQuaterniond& q1 = list.Orientation[index + 1];
+    orientation = Eigen::Quaterniond(q0.GetW(), q0.GetX(), q0.GetY(), q0.GetZ()).slerp(
+      alpha, Eigen::Quaterniond(q1.GetW(), q1.GetX(), q1.GetY(), q1.GetZ()));
+    return;
+  }
+
+  const vtkVeloViewQuaterniond& q = list.Orientation[sample];
+  orientation = Eigen::Quaterniond(q.GetW(), q.GetX(), q.GetY(), q.GetZ());
+  position << list.Position[0][sample], list.Position[1][sample], list.Position[2][sample];
+}
+
 //----------------------------------------------------------------------------
 void vtkVelodyneTransformInterpolator::InterpolateTransformNearest(double t,
                                                     vtkTransform *xform)
@@ -534,27 +776,23 @@ void vtkVelodyneTransformInterpolator::InterpolateTransformNearest(double t,
   xform->Identity();
   this->InitializeInterpolation();
 
-  if (this->TransformVector.size() < 2)
+  const std::vector<double>& times = this->TransformList->Time;
+  if (times.size() < 2)
   {
     return;
   }
 
-  // vtkQTransform order relation based on the Time
-  vtkQTransformComparator comparatorTimeTransform;
-
   // Get the low bound to procees to a nearest
   // low bounded interpolator
-  vtkQTransform transform;
-  transform.Time = t;
-  std::vector<vtkQTransform>::iterator lowerBound;
-  lowerBound = std::lower_bound(this->TransformVector.begin(), this->TransformVector.end(), transform, comparatorTimeTransform);
+  t = std::min(std::max(t, times.front()), times.back());
+  size_t lowerBound = this->TransformList->LowerBound(t);
 
   if (this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
   {
     // Are we before the first node? If not take the
     // previous transform to have a low bounded nearest
     // interpolator.
-    if (!(lowerBound == this->TransformVector.begin()))
+    if (lowerBound != 0)
     {
       lowerBound--;
     }
@@ -565,22 +803,23 @@ void vtkVelodyneTransformInterpolator::InterpolateTransformNearest(double t,
     // its predecessor to keep the closest in time to t.
 
     // Because t has already been clamped,
-    // lowerBound->Time - t should be positive
+    // times[lowerBound] - t should be positive
     // but adding std::abs makes the code more robust.
-    if (lowerBound != this->TransformVector.begin() &&
-        t - (lowerBound - 1)->Time <= std::abs(lowerBound->Time - t))
+    if (lowerBound != 0 &&
+        t - times[lowerBound - 1] <= std::abs(times[lowerBound] - t))
     {
       lowerBound--;
     }
   }
 
   // Get the transform
+  const vtkQTransform transform = this->TransformList->Get(lowerBound);
   xform->Identity();
-  xform->Translate(lowerBound->P);
+  xform->Translate(transform.P);
   double Q[4];
-  Q[0] = vtkMath::DegreesFromRadians(lowerBound->Q.GetRotationAngleAndAxis(Q+1));
+  Q[0] = vtkMath::DegreesFromRadians(transform.Q.GetRotationAngleAndAxis(Q+1));
   xform->RotateWXYZ(Q[0],Q+1);
-  xform->Scale(lowerBound->S);
+  xform->Scale(transform.S);
 }
 
 //----------------------------------------------------------------------------
@@ -38,11 +38,13 @@
 //
 // .SECTION Caveats
 // The interpolator classes are initialized when the InterpolateTransform()
-// is called. Any changes to the interpolators, or additions to the list of
-// transforms to be interpolated, causes a reinitialization of the
-// interpolators the next time InterpolateTransform() is invoked. Thus the
-// best performance is obtained by 1) configuring the interpolators, 2) adding
-// all the transforms, and 3) finally performing interpolation.
+// is called. Any changes to the interpolators, or insertions of transforms
+// before the last one, causes a reinitialization of the interpolators the
+// next time InterpolateTransform() is invoked. Transforms added after the
+// last one are appended to the linear interpolators without reinitializing
+// them. Thus the best performance is obtained by 1) configuring the
+// interpolators, 2) adding the transforms in increasing time order, ideally
+// with AddTransforms(), and 3) finally performing interpolation.
 
 #ifndef __vtkVelodyneTransformInterpolator_h
 #define __vtkVelodyneTransformInterpolator_h
@@ -50,13 +52,15 @@
 #include <vtkObject.h>
 #include <vector>
 
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
 class vtkTransform;
 class vtkMatrix4x4;
 class vtkProp3D;
 class vtkVeloViewTupleInterpolator;
 class vtkVeloViewQuaternionInterpolator;
 class vtkTransformList;
-struct vtkQTransform;
 
 class VTK_EXPORT vtkVelodyneTransformInterpolator : public vtkObject
 {
@@ -99,6 +103,15 @@ public:
   void AddTransform(double t, vtkMatrix4x4* matrix);
   void AddTransform(double t, vtkProp3D* prop3D);
 
+  // Description:
+  // Add n transforms at once: times[i], the orientation quaternion
+  // (w, x, y, z) stored at quaternions + 4 * i and the position stored at
+  // positions + 3 * i. The scale of these transforms is 1. When the times
+  // are increasing and after the last transform, they are appended in
+  // amortized linear time, otherwise the transforms are sorted again.
+  void AddTransforms(int n, const double* times, const double* quaternions,
+                     const double* positions);
+
   // Description:
   // Delete the transform at a particular parameter t. If there is no
   // transform defined at location t, then the method does nothing.
@@ -110,6 +123,31 @@ public:
   // (min,max) values, then t is clamped.
   void InterpolateTransform(double t, vtkTransform* xform);
 
+  // Description:
+  // Interpolate the orientation and the position of the transform at t,
+  // without creating any VTK object. The scale is ignored. If t is
+  // outside the range of (min,max) values, then t is clamped. With the
+  // linear and nearest interpolation types, the transforms are only read,
+  // so several threads can interpolate at the same time.
+  void InterpolateTransform(double t, Eigen::Quaterniond& orientation,
+                            Eigen::Vector3d& position);
+
+  // Description:
+  // Interpolate the orientations and the positions of the transforms at
+  // the given times, without creating any VTK object. The times should be
+  // sorted in increasing order, so that the transforms surrounding each
+  // time are found from the ones of the previous time. The outputs are
+  // resized to the number of times, their memory is reused from a call to
+  // the next.
+  typedef std::vector<Eigen::Quaterniond, Eigen::aligned_allocator<Eigen::Quaterniond> > QuaternionVector;
+  void InterpolateTransforms(const std::vector<double>& times,
+                             QuaternionVector& orientations,
+                             std::vector<Eigen::Vector3d>& positions);
+
+  // Description:
+  // Return the times of the transforms, in increasing order
+  std::vector<double> GetTimes();
+
   // Description:
   // Return the transform list
   std::vector<std::vector<double> > GetTransformList();
@@ -180,6 +218,11 @@ protected:
   int InterpolationType;
   void InterpolateTransformNearest(double t, vtkTransform *xform);
 
+  // Interpolate the pose at t. index is the one of the last transform at
+  // or before the previous interpolated time, updated for t.
+  void InterpolatePose(double t, size_t& index, Eigen::Quaterniond& orientation,
+                       Eigen::Vector3d& position);
+
   // Interpolators
   vtkVeloViewTupleInterpolator* PositionInterpolator;
   vtkVeloViewTupleInterpolator* ScaleInterpolator;
@@ -190,9 +233,17 @@ protected:
   vtkTimeStamp InitializeTime;
   void InitializeInterpolation();
 
-  // Keep track of inserted data
+  // Number of transforms loaded in the interpolators and their
+  // interpolation type, to only add the transforms appended since then
+  int NumberOfInitializedTransforms;
+  int InitializedInterpolationType;
+
+  // Last modification of the transforms, appends excepted,
+  // which requires to reload all the transforms
+  vtkTimeStamp TransformsModifiedTime;
+
+  // Keep track of inserted data, sorted by time
   vtkTransformList* TransformList;
-  std::vector<vtkQTransform> TransformVector;
 
 private:
   vtkVelodyneTransformInterpolator(const vtkVelodyneTransformInterpolator&); // Not implemented.
@@ -0,0 +1,40 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+// LOCAL
+#include "vtkVertexCells.h"
+
+// VTK
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkCellArray> NewVertexCells(vtkIdType numberOfVerts)
+{
+  vtkNew<vtkIdTypeArray> cells;
+  cells->SetNumberOfValues(numberOfVerts * 2);
+  vtkIdType* ids = cells->GetPointer(0);
+  for (vtkIdType i = 0; i < numberOfVerts; ++i)
+  {
+    ids[i * 2] = 1;
+    ids[i * 2 + 1] = i;
+  }
+
+  vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
+  cellArray->SetCells(numberOfVerts, cells.GetPointer());
+  return cellArray;
+}
@@ -0,0 +1,36 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef VTK_VERTEX_CELLS_H
+#define VTK_VERTEX_CELLS_H
+
+// VTK
+#include <vtkCellArray.h>
+#include <vtkSmartPointer.h>
+
+#include "vvConfigure.h"
+
+/**
+ * @brief NewVertexCells creates a vtkCellArray in which each of the first
+ *        numberOfVerts points is a vertex (connectivity [1, 0, 1, 1, ..., 1, N-1]).
+ *        Each returned cell array owns its connectivity, so it can be modified
+ *        (Reset, InsertNextCell, ReplaceCell) without affecting the other ones.
+ * @param numberOfVerts number of vertex cells
+ */
+vtkSmartPointer<vtkCellArray> VelodyneHDLPlugin_EXPORT NewVertexCells(vtkIdType numberOfVerts);
+
+#endif // VTK_VERTEX_CELLS_H
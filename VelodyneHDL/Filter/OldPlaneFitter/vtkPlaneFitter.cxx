@@ -28,16 +28,98 @@
 
 #include "vtkPlaneFitter.h"
 
-#include "vtkDoubleArray.h"
-#include "vtkNew.h"
+#include "vtkDataArray.h"
 #include "vtkObjectFactory.h"
+#include "vtkPointData.h"
 #include "vtkPointSet.h"
+#include "vtkPoints.h"
 #include "vtkSmartPointer.h"
-#include "vtkThreshold.h"
-#include "vtkUnstructuredGrid.h"
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// First and second order moments of a set of points. The points are shifted
+// by a point of the set, so that the sums keep their precision far from the
+// origin.
+struct PointMoments
+{
+  PointMoments()
+    : Count(0)
+    , Sum(Eigen::Vector3d::Zero())
+    , SquaredSum(Eigen::Matrix3d::Zero())
+  {
+  }
+
+  void Add(const Eigen::Vector3d& point)
+  {
+    this->Count++;
+    this->Sum += point;
+    this->SquaredSum.noalias() += point * point.transpose();
+  }
+
+  Eigen::Vector3d Mean() const { return this->Sum / this->Count; }
+
+  // Sum of (p - mean) * (p - mean)'
+  Eigen::Matrix3d Scatter() const
+  {
+    return this->SquaredSum - this->Sum * this->Sum.transpose() / this->Count;
+  }
+
+  vtkIdType Count;
+  Eigen::Vector3d Sum;
+  Eigen::Matrix3d SquaredSum;
+};
+
+//-----------------------------------------------------------------------------
+// Accumulate in one pass the moments of all the points, and of the points of
+// each channel, channel being given by the laser_id array
+template <typename T>
+void AccumulateMoments(const T* points, vtkIdType n, vtkDataArray* laserIds,
+  const Eigen::Vector3d& shift, PointMoments& all, std::vector<PointMoments>& channels)
+{
+  const double nchannels = static_cast<double>(channels.size());
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    const Eigen::Vector3d point(static_cast<double>(points[3 * i]) - shift(0),
+      static_cast<double>(points[3 * i + 1]) - shift(1),
+      static_cast<double>(points[3 * i + 2]) - shift(2));
+    all.Add(point);
+    if (laserIds)
+    {
+      const double laserId = laserIds->GetComponent(i, 0);
+      if (laserId >= 0 && laserId < nchannels)
+      {
+        channels[static_cast<size_t>(laserId)].Add(point);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void DistanceRange(const T* points, vtkIdType n, const Eigen::Vector3d& origin,
+  const Eigen::Vector3d& normal, double& minDist, double& maxDist)
+{
+  minDist = std::numeric_limits<double>::max();
+  maxDist = std::numeric_limits<double>::lowest();
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    const double distance = normal(0) * (points[3 * i] - origin(0)) +
+      normal(1) * (points[3 * i + 1] - origin(1)) + normal(2) * (points[3 * i + 2] - origin(2));
+    minDist = std::min(minDist, distance);
+    maxDist = std::max(maxDist, distance);
+  }
+}
+}
+
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkPlaneFitter);
 
@@ -62,91 +144,79 @@ void vtkPlaneFitter::PlaneFit(vtkPointSet* pts, double origin[3], double normal[
   double& maxDist, double& stdDev, double channelMean[], double channelStdDev[],
   vtkIdType channelNpts[], unsigned int nchannels)
 {
-  using namespace Eigen;
-
-  vtkSmartPointer<vtkDoubleArray> ptdata = vtkSmartPointer<vtkDoubleArray>::New();
-  ptdata->DeepCopy(pts->GetPoints()->GetData());
-
+  vtkDataArray* ptdata = pts->GetPoints()->GetData();
   const vtkIdType n = ptdata->GetNumberOfTuples();
   if (n < 1)
   {
     return;
   }
-
   assert(ptdata->GetNumberOfComponents() == 3);
-  Map<MatrixXd> eigpointsraw(static_cast<double*>(ptdata->GetVoidPointer(0)),
-    ptdata->GetNumberOfComponents(), ptdata->GetNumberOfTuples());
-
-  MatrixXd eigpoints = eigpointsraw.transpose();
-
-  VectorXd mean(3);
 
-  mean = eigpoints.colwise().sum() / n;
-  assert(mean.size() == 3);
-
-  for (int i = 0; i < 3; ++i)
+  // The float and double points are read in place, other types are converted
+  vtkSmartPointer<vtkDataArray> converted;
+  if (ptdata->GetDataType() != VTK_FLOAT && ptdata->GetDataType() != VTK_DOUBLE)
   {
-    origin[i] = mean[i];
+    converted = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(VTK_DOUBLE));
+    converted->DeepCopy(ptdata);
+    ptdata = converted;
+  }
+  vtkDataArray* laserIds = pts->GetPointData()->GetArray("laser_id");
+
+  // Moments of all the points and of each channel, in a single pass
+  double firstPoint[3];
+  ptdata->GetTuple(0, firstPoint);
+  const Eigen::Vector3d shift(firstPoint);
+  PointMoments all;
+  std::vector<PointMoments> channels(nchannels);
+  if (ptdata->GetDataType() == VTK_FLOAT)
+  {
+    AccumulateMoments(static_cast<float*>(ptdata->GetVoidPointer(0)), n, laserIds, shift, all, channels);
+  }
+  else
+  {
+    AccumulateMoments(static_cast<double*>(ptdata->GetVoidPointer(0)), n, laserIds, shift, all, channels);
   }
 
-  eigpoints.rowwise() -= mean.transpose();
-
-  JacobiSVD<MatrixXd> svd(eigpoints, ComputeThinU | ComputeThinV);
-
-  VectorXd enormal = svd.matrixV().col(2);
-  assert(enormal.size() == 3);
+  // The normal is the direction of least variance
+  const Eigen::Vector3d mean = all.Mean();
+  const Eigen::Matrix3d scatter = all.Scatter();
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen(scatter);
+  const Eigen::Vector3d enormal = eigen.eigenvectors().col(0);
   assert(std::fabs(enormal.norm() - 1.0) < 1.0e-8);
 
+  const Eigen::Vector3d eorigin = mean + shift;
   for (int i = 0; i < 3; ++i)
   {
+    origin[i] = eorigin[i];
     normal[i] = enormal[i];
   }
 
-  VectorXd distances = eigpoints * enormal;
-  assert(distances.size() == n);
-
-  minDist = distances.minCoeff();
-  maxDist = distances.maxCoeff();
+  if (ptdata->GetDataType() == VTK_FLOAT)
+  {
+    DistanceRange(static_cast<float*>(ptdata->GetVoidPointer(0)), n, eorigin, enormal, minDist, maxDist);
+  }
+  else
+  {
+    DistanceRange(static_cast<double*>(ptdata->GetVoidPointer(0)), n, eorigin, enormal, minDist, maxDist);
+  }
 
-  stdDev = std::sqrt(distances.squaredNorm() / (n - 1));
+  // The distances to the plane have a null mean, their variance is the one
+  // of the points along the normal
+  stdDev = n > 1 ? std::sqrt(std::max(0.0, enormal.dot(scatter * enormal)) / (n - 1)) : 0.0;
 
   for (unsigned int i = 0; i < nchannels; ++i)
   {
-    vtkNew<vtkThreshold> threshold;
-    threshold->ThresholdBetween(i, i);
-    threshold->SetInputData(pts);
-    threshold->SetInputArrayToProcess(0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, "laser_id");
-    threshold->SetOutputPointsPrecision(vtkAlgorithm::DEFAULT_PRECISION);
-    threshold->Update();
-
-    channelNpts[i] = threshold->GetOutput()->GetNumberOfPoints();
-
-    vtkSmartPointer<vtkDoubleArray> threshdata = vtkSmartPointer<vtkDoubleArray>::New();
-    threshdata->DeepCopy(threshold->GetOutput()->GetPoints()->GetData());
-
-    const vtkIdType n = threshdata->GetNumberOfTuples();
-    if (n < 2)
+    const PointMoments& channel = channels[i];
+    channelNpts[i] = channel.Count;
+    if (channel.Count < 2)
     {
       channelMean[i] = 0.0;
       channelStdDev[i] = 0.0;
       continue;
     }
 
-    assert(threshdata->GetNumberOfComponents() == 3);
-    assert(threshdata->GetNumberOfTuples() >= 2);
-    Map<MatrixXd> channelraw(static_cast<double*>(threshdata->GetVoidPointer(0)),
-      threshdata->GetNumberOfComponents(), threshdata->GetNumberOfTuples());
-
-    MatrixXd channelpts = channelraw.transpose();
-    channelpts.rowwise() -= mean.transpose();
-
-    VectorXd channelds = channelpts * enormal;
-
-    double cmean = channelds.sum() / channelds.size();
-    double cstddev =
-      std::sqrt((channelds.array() - cmean).matrix().squaredNorm() / (channelds.size() - 1));
-
-    channelMean[i] = cmean;
-    channelStdDev[i] = cstddev;
+    channelMean[i] = enormal.dot(channel.Mean() - mean);
+    channelStdDev[i] =
+      std::sqrt(std::max(0.0, enormal.dot(channel.Scatter() * enormal)) / (channel.Count - 1));
   }
 }
@@ -44,6 +44,10 @@ public:
 
   virtual void PrintSelf(ostream& os, vtkIndent indent);
 
+  // Fit a plane to the points, and compute the distances of the points to
+  // this plane, for all the points and for each of the nchannels channels
+  // given by the laser_id array. The points are read in one pass, float
+  // and double points without copy.
   static void PlaneFit(vtkPointSet* pts, double origin[3], double normal[3], double& minDist,
     double& maxDist, double& stdDev, double channelMean[], double channelStdDev[],
     vtkIdType channelNpts[], unsigned int nchannels);
@@ -22,17 +22,21 @@
 #include <vtkCellData.h>
 #include <vtkDataArray.h>
 #include <vtkDataSet.h>
+#include <vtkDoubleArray.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkIntArray.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
+#include <vtkTable.h>
 #include <vtkUnsignedCharArray.h>
 #include <vtkUnsignedIntArray.h>
 
 // pcl includes
+#include <pcl/features/normal_3d_omp.h>
 #include <pcl/point_types.h>
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/sac_model_circle.h>
@@ -43,13 +47,163 @@
 #include <pcl/sample_consensus/sac_model_line.h>
 #include <pcl/sample_consensus/sac_model_plane.h>
 
+// boost includes
+#include <boost/thread/thread.hpp>
+
+// std includes
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <random>
+
+namespace
+{
+//----------------------------------------------------------------------------
+//! Instantiate the model, searching the points of indices
+pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr CreateModel(int modelType,
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud, pcl::PointCloud<pcl::Normal>::Ptr normals,
+  double normalDistanceWeight, const std::vector<int>& indices)
+{
+  pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr model;
+  switch (modelType)
+  {
+    case vtkPCLRansacModel::Circle2D:
+      model.reset(new pcl::SampleConsensusModelCircle2D<pcl::PointXYZ>(cloud, indices));
+      break;
+
+    case vtkPCLRansacModel::Circle3D:
+      model.reset(new pcl::SampleConsensusModelCircle3D<pcl::PointXYZ>(cloud, indices));
+      break;
+
+    case vtkPCLRansacModel::Cone:
+    {
+      pcl::SampleConsensusModelCone<pcl::PointXYZ, pcl::Normal>* cone =
+        new pcl::SampleConsensusModelCone<pcl::PointXYZ, pcl::Normal>(cloud, indices);
+      cone->setInputNormals(normals);
+      cone->setNormalDistanceWeight(normalDistanceWeight);
+      model.reset(cone);
+      break;
+    }
+
+    case vtkPCLRansacModel::Cylinder:
+    {
+      pcl::SampleConsensusModelCylinder<pcl::PointXYZ, pcl::Normal>* cylinder =
+        new pcl::SampleConsensusModelCylinder<pcl::PointXYZ, pcl::Normal>(cloud, indices);
+      cylinder->setInputNormals(normals);
+      cylinder->setNormalDistanceWeight(normalDistanceWeight);
+      model.reset(cylinder);
+      break;
+    }
+
+    case vtkPCLRansacModel::Shpere:
+      model.reset(new pcl::SampleConsensusModelSphere<pcl::PointXYZ>(cloud, indices));
+      break;
+
+    case vtkPCLRansacModel::Line:
+      model.reset(new pcl::SampleConsensusModelLine<pcl::PointXYZ>(cloud, indices));
+      break;
+
+    case vtkPCLRansacModel::Plane:
+      model.reset(new pcl::SampleConsensusModelPlane<pcl::PointXYZ>(cloud, indices));
+      break;
+
+    default:
+      break;
+  }
+  return model;
+}
+
+//----------------------------------------------------------------------------
+//! Run the ransac on the points of indices, the iterations being shared by
+//! nbThreads threads. Each thread searches the same points, listed in a
+//! different order, so that they draw different samples. The best model is
+//! kept.
+bool ComputeModel(int modelType, pcl::PointCloud<pcl::PointXYZ>::Ptr cloud,
+  pcl::PointCloud<pcl::Normal>::Ptr normals, double normalDistanceWeight,
+  const std::vector<int>& indices, double threshold, int maxIterations, int nbThreads,
+  Eigen::VectorXf& coefficients, std::vector<int>& inliers)
+{
+  nbThreads = std::max(1, std::min(nbThreads, maxIterations));
+  std::vector<Eigen::VectorXf> threadCoefficients(nbThreads);
+  std::vector<std::vector<int> > threadInliers(nbThreads);
+  std::vector<char> threadFound(nbThreads, 0);
+
+  auto run = [&](int thread)
+  {
+    std::vector<int> threadIndices = indices;
+    if (thread > 0)
+    {
+      std::mt19937 rng(thread);
+      std::shuffle(threadIndices.begin(), threadIndices.end(), rng);
+    }
+    pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr model =
+      CreateModel(modelType, cloud, normals, normalDistanceWeight, threadIndices);
+    if (!model)
+    {
+      return;
+    }
+    pcl::RandomSampleConsensus<pcl::PointXYZ> ransac(model, threshold);
+    ransac.setMaxIterations((maxIterations + thread) / nbThreads);
+    if (ransac.computeModel())
+    {
+      ransac.getModelCoefficients(threadCoefficients[thread]);
+      ransac.getInliers(threadInliers[thread]);
+      threadFound[thread] = 1;
+    }
+  };
+
+  if (nbThreads == 1)
+  {
+    run(0);
+  }
+  else
+  {
+    boost::thread_group threads;
+    for (int thread = 0; thread < nbThreads; ++thread)
+    {
+      threads.create_thread([&run, thread]() { run(thread); });
+    }
+    threads.join_all();
+  }
+
+  // keep the model with the most inliers, the first one on a tie
+  int best = -1;
+  for (int thread = 0; thread < nbThreads; ++thread)
+  {
+    if (threadFound[thread] &&
+      (best < 0 || threadInliers[thread].size() > threadInliers[best].size()))
+    {
+      best = thread;
+    }
+  }
+  if (best < 0)
+  {
+    return false;
+  }
+  coefficients = threadCoefficients[best];
+  inliers.swap(threadInliers[best]);
+  std::sort(inliers.begin(), inliers.end());
+  return true;
+}
+}
+
 // Implementation of the New function
 vtkStandardNewMacro(vtkPCLRansacModel);
 
 //----------------------------------------------------------------------------
 vtkPCLRansacModel::vtkPCLRansacModel()
 {
-
+  this->DistanceThreshold = 0.2;
+  this->ModelType = vtkPCLRansacModel::Line;
+  this->NumberOfModels = 1;
+  this->MinimumNumberOfInliers = 10;
+  this->MaxIterations = 1000;
+  this->NormalNeighbors = 10;
+  this->NormalDistanceWeight = 0.1;
+  this->NumberOfThreads = 1;
+  this->CloudTime = 0;
+  this->CloudNormalNeighbors = 0;
+  this->SetNumberOfOutputPorts(2);
 }
 
 //----------------------------------------------------------------------------
@@ -62,96 +216,142 @@ vtkPCLRansacModel::~vtkPCLRansacModel()
 void vtkPCLRansacModel::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "DistanceThreshold: " << this->DistanceThreshold << endl;
+  os << indent << "ModelType: " << this->ModelType << endl;
+  os << indent << "NumberOfModels: " << this->NumberOfModels << endl;
+  os << indent << "MinimumNumberOfInliers: " << this->MinimumNumberOfInliers << endl;
+  os << indent << "MaxIterations: " << this->MaxIterations << endl;
+  os << indent << "NormalNeighbors: " << this->NormalNeighbors << endl;
+  os << indent << "NormalDistanceWeight: " << this->NormalDistanceWeight << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
 }
 
 //-----------------------------------------------------------------------------
-int vtkPCLRansacModel::RequestData(vtkInformation *vtkNotUsed(request),
-  vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+int vtkPCLRansacModel::FillOutputPortInformation(int port, vtkInformation* info)
 {
+  if (port == 1)
+  {
+    info->Set(vtkDataObject::DATA_TYPE_NAME(), "vtkTable");
+    return 1;
+  }
+  return this->Superclass::FillOutputPortInformation(port, info);
+}
 
-  // Get the input
-  vtkPolyData * input = vtkPolyData::GetData(inputVector[0]->GetInformationObject(0));
-  
-  // Convert input data in pcl format
-  pcl::PointCloud<pcl::PointXYZ>::Ptr pointCloud = vtkPCLConversions::PointCloudFromPolyData(input);
-
-  // inliers's index according to the model and threshold
-  std::vector<int> inliers;
-
-  // instantiate the model
-  pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr RANSACModel;
+//-----------------------------------------------------------------------------
+void vtkPCLRansacModel::UpdateCloud(vtkPolyData* input)
+{
+  const bool needNormals =
+    this->ModelType == vtkPCLRansacModel::Cone || this->ModelType == vtkPCLRansacModel::Cylinder;
 
-  switch (ModelType) {
+  if (!this->Cloud || input->GetMTime() != this->CloudTime ||
+    static_cast<vtkIdType>(this->Cloud->size()) != input->GetNumberOfPoints())
+  {
+    // Convert input data in pcl format
+    this->Cloud = vtkPCLConversions::PointCloudFromPolyData(input);
+    this->CloudTime = input->GetMTime();
+    this->KdTree.reset();
+    this->Normals.reset();
+  }
 
-    case vtkPCLRansacModel::Circle2D:
-      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-            new pcl::SampleConsensusModelCircle2D<pcl::PointXYZ> (pointCloud));
-      break;
+  if (needNormals && (!this->Normals || this->CloudNormalNeighbors != this->NormalNeighbors))
+  {
+    // the kdtree is built once for the cloud, and reused when the number of
+    // neighbors changes
+    if (!this->KdTree)
+    {
+      this->KdTree.reset(new pcl::search::KdTree<pcl::PointXYZ>);
+      this->KdTree->setInputCloud(this->Cloud);
+    }
+    pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> normalEstimation;
+    normalEstimation.setInputCloud(this->Cloud);
+    normalEstimation.setSearchMethod(this->KdTree);
+    normalEstimation.setKSearch(this->NormalNeighbors);
+    this->Normals.reset(new pcl::PointCloud<pcl::Normal>);
+    normalEstimation.compute(*this->Normals);
+    this->CloudNormalNeighbors = this->NormalNeighbors;
+  }
+}
 
-    case vtkPCLRansacModel::Circle3D:
-      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-            new pcl::SampleConsensusModelCircle3D<pcl::PointXYZ> (pointCloud));
-      break;
+//-----------------------------------------------------------------------------
+int vtkPCLRansacModel::RequestData(vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+  // Get the input and the outputs
+  vtkPolyData * input = vtkPolyData::GetData(inputVector[0]->GetInformationObject(0));
+  vtkPolyData *output = vtkPolyData::GetData(outputVector->GetInformationObject(0));
+  vtkTable* models = vtkTable::GetData(outputVector->GetInformationObject(1));
+  output->ShallowCopy(input);
 
-// The Cone Model and the Cylinder Model require to compute the normal, so this is not wrap
-//    case vtkPCLRansacModel::Cone:
-//      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-//            new pcl::SampleConsensusModelCone<pcl::PointXYZ, pcl::Normal> (pointCloud));
-//      break;
+  const vtkIdType nbPoints = input->GetNumberOfPoints();
+  this->UpdateCloud(input);
 
-//    case vtkPCLRansacModel::Cylinder:
-//      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-//            new pcl::SampleConsensusModelCylinder<pcl::PointXYZ, pcl::Normal> (pointCloud));
-//      break;
+  // Per point results
+  vtkSmartPointer<vtkUnsignedIntArray> InlierOutlierArray = vtkSmartPointer<vtkUnsignedIntArray>::New();
+  InlierOutlierArray->SetName("inliers");
+  InlierOutlierArray->SetNumberOfTuples(nbPoints);
+  unsigned int* inlierOutlier = InlierOutlierArray->GetPointer(0);
+  std::fill(inlierOutlier, inlierOutlier + nbPoints, 0);
+  vtkSmartPointer<vtkIntArray> labelArray = vtkSmartPointer<vtkIntArray>::New();
+  labelArray->SetName("ransac_label");
+  labelArray->SetNumberOfTuples(nbPoints);
+  int* labels = labelArray->GetPointer(0);
+  std::fill(labels, labels + nbPoints, -1);
 
-    case vtkPCLRansacModel::Shpere:
-      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-            new pcl::SampleConsensusModelSphere<pcl::PointXYZ> (pointCloud));
-      break;
+  // Parameters of the models
+  vtkNew<vtkIntArray> modelIndexArray;
+  modelIndexArray->SetName("model");
+  vtkNew<vtkIntArray> nbInliersArray;
+  nbInliersArray->SetName("number_of_inliers");
+  vtkNew<vtkDoubleArray> coefficientsArray;
+  coefficientsArray->SetName("coefficients");
 
-    case vtkPCLRansacModel::Line:
-      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-            new pcl::SampleConsensusModelLine<pcl::PointXYZ> (pointCloud));
-      break;
+  const int nbThreads = this->NumberOfThreads > 0 ? this->NumberOfThreads
+                                                  : std::max(1u, boost::thread::hardware_concurrency());
 
-    case vtkPCLRansacModel::Plane:
-      RANSACModel = pcl::SampleConsensusModel<pcl::PointXYZ>::Ptr(
-            new pcl::SampleConsensusModelLine<pcl::PointXYZ> (pointCloud));
+  // Extract the models one after the other, from the remaining points
+  std::vector<int> remaining(nbPoints);
+  std::iota(remaining.begin(), remaining.end(), 0);
+  std::vector<int> inliers, outliers;
+  for (int k = 0; k < this->NumberOfModels; ++k)
+  {
+    Eigen::VectorXf coefficients;
+    if (static_cast<int>(remaining.size()) < std::max(1, this->MinimumNumberOfInliers) ||
+      !ComputeModel(this->ModelType, this->Cloud, this->Normals, this->NormalDistanceWeight,
+        remaining, this->DistanceThreshold, this->MaxIterations, nbThreads, coefficients, inliers))
+    {
       break;
-
-    default:
-      cerr << "No model : " << ModelType << endl;
+    }
+    if (static_cast<int>(inliers.size()) < this->MinimumNumberOfInliers)
+    {
       break;
-  }
+    }
 
-  // Instanciate and launch the random consensus
-  pcl::RandomSampleConsensus<pcl::PointXYZ> ransac (RANSACModel);
-  ransac.setDistanceThreshold (this->DistanceThreshold);
-  ransac.computeModel(); // compute ransac
-  ransac.getInliers(inliers); // get inlier list
-  std::cout << "Inliers size : " << inliers.size() << std::endl;
-  // Add inlier / outlier array information to vtkPolyData input
-  vtkSmartPointer<vtkUnsignedIntArray> InlierOutlierArray = vtkSmartPointer<vtkUnsignedIntArray>::New();
-  InlierOutlierArray->Allocate(input->GetNumberOfPoints());
-  InlierOutlierArray->SetName("inliers");
-  InlierOutlierArray->SetNumberOfTuples(0);
+    for (int inlier : inliers)
+    {
+      inlierOutlier[inlier] = 255;
+      labels[inlier] = k;
+    }
+    outliers.clear();
+    std::set_difference(remaining.begin(), remaining.end(), inliers.begin(), inliers.end(),
+      std::back_inserter(outliers));
+    remaining.swap(outliers);
 
-  // populate the new array
-  for (int k = 0; k < input->GetNumberOfPoints(); ++k)
-  {
-    InlierOutlierArray->InsertNextValue(0);
+    if (coefficientsArray->GetNumberOfTuples() == 0)
+    {
+      coefficientsArray->SetNumberOfComponents(coefficients.size());
+    }
+    const Eigen::VectorXd coefficientsd = coefficients.cast<double>();
+    modelIndexArray->InsertNextValue(k);
+    nbInliersArray->InsertNextValue(static_cast<int>(inliers.size()));
+    coefficientsArray->InsertNextTuple(coefficientsd.data());
   }
-  for (int k = 0; k < inliers.size(); ++k)
-  {
-    InlierOutlierArray->SetValue(inliers[k], 255);
-  }
-
-  // Get the output
-  vtkPolyData *output = vtkPolyData::GetData(outputVector->GetInformationObject(0));
-  output->ShallowCopy(input);
 
-  // Add the array
+  // Add the arrays
   output->GetPointData()->AddArray(InlierOutlierArray);
+  output->GetPointData()->AddArray(labelArray);
+  models->AddColumn(modelIndexArray.GetPointer());
+  models->AddColumn(nbInliersArray.GetPointer());
+  models->AddColumn(coefficientsArray.GetPointer());
 
   return 1;
 }
@@ -21,9 +21,21 @@
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkSmartPointer.h>
 
+// pcl includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+
 /**
  * @brief The vtkPCLRansacModel class will quickly be replace by classes from the pcl plugin
  * so no time should be spend developping this class
+ *
+ * Up to NumberOfModels models are extracted one after the other, the inliers
+ * of a model being removed from the points searched for the next one. Each
+ * point gets the index of its model in the "ransac_label" array (-1 for the
+ * points of no model), and the parameters of the models are given by the
+ * second output. The Cone and Cylinder models use the normals of the points,
+ * estimated from their NormalNeighbors nearest neighbors.
  */
 class VTK_EXPORT vtkPCLRansacModel : public vtkPolyDataAlgorithm
 {
@@ -35,8 +47,8 @@ class VTK_EXPORT vtkPCLRansacModel : public vtkPolyDataAlgorithm
   enum Model {
     Circle2D = 0,
     Circle3D,
-    Cone,       // not implemented
-    Cylinder,   // not implemented
+    Cone,
+    Cylinder,
     Shpere,
     Line,
     Plane
@@ -48,6 +60,24 @@ class VTK_EXPORT vtkPCLRansacModel : public vtkPolyDataAlgorithm
   vtkGetMacro(ModelType, int)
   vtkSetMacro(ModelType, int)
 
+  vtkGetMacro(NumberOfModels, int)
+  vtkSetMacro(NumberOfModels, int)
+
+  vtkGetMacro(MinimumNumberOfInliers, int)
+  vtkSetMacro(MinimumNumberOfInliers, int)
+
+  vtkGetMacro(MaxIterations, int)
+  vtkSetMacro(MaxIterations, int)
+
+  vtkGetMacro(NormalNeighbors, int)
+  vtkSetMacro(NormalNeighbors, int)
+
+  vtkGetMacro(NormalDistanceWeight, double)
+  vtkSetMacro(NormalDistanceWeight, double)
+
+  vtkGetMacro(NumberOfThreads, int)
+  vtkSetMacro(NumberOfThreads, int)
+
 protected:
   // constructor / destructor
   vtkPCLRansacModel();
@@ -56,12 +86,43 @@ protected:
   // Request data
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
 
+  int FillOutputPortInformation(int port, vtkInformation* info);
+
+  //! Convert the input and estimate its normals, if it changed since the last call
+  void UpdateCloud(vtkPolyData* input);
+
   //! Maxinum distance from point to model, to consider the point part of the model
   double DistanceThreshold;
 
   //! Model to approximate
   int ModelType;
 
+  //! Maximum number of models extracted
+  int NumberOfModels;
+
+  //! The extraction stops when a model has less inliers
+  int MinimumNumberOfInliers;
+
+  //! Number of ransac iterations for each model
+  int MaxIterations;
+
+  //! Number of neighbors used to estimate the normals
+  int NormalNeighbors;
+
+  //! Weight of the angle to the normal in the distance of the normal based models, in [0, 1]
+  double NormalDistanceWeight;
+
+  //! Number of threads sharing the ransac iterations, 0 means one per core
+  int NumberOfThreads;
+
+  //! Input converted to pcl, its normals and the kdtree they were estimated with,
+  //! kept while the input does not change
+  pcl::PointCloud<pcl::PointXYZ>::Ptr Cloud;
+  pcl::PointCloud<pcl::Normal>::Ptr Normals;
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr KdTree;
+  vtkMTimeType CloudTime;
+  int CloudNormalNeighbors;
+
 
 private:
   // copy operators
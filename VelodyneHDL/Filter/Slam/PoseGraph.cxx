@@ -0,0 +1,240 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "PoseGraph.h"
+#include "CeresCostFunctions.h"
+
+#include <ceres/ceres.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+constexpr double ScanContext::SensorHeight;
+
+//-----------------------------------------------------------------------------
+Eigen::Isometry3d PoseToIsometry(const Eigen::Matrix<double, 6, 1>& pose)
+{
+  Eigen::Isometry3d isometry = Eigen::Isometry3d::Identity();
+  isometry.linear() = Eigen::Matrix3d(
+          Eigen::AngleAxisd(pose(2), Eigen::Vector3d::UnitZ())
+        * Eigen::AngleAxisd(pose(1), Eigen::Vector3d::UnitY())
+        * Eigen::AngleAxisd(pose(0), Eigen::Vector3d::UnitX()));
+  isometry.translation() = pose.tail(3);
+  return isometry;
+}
+
+//-----------------------------------------------------------------------------
+Eigen::Matrix<double, 6, 1> IsometryToPose(const Eigen::Isometry3d& isometry)
+{
+  // eulerAngles(2, 1, 0) gives (rz, ry, rx) such that R = Rz * Ry * Rx
+  const Eigen::Vector3d angles = isometry.linear().eulerAngles(2, 1, 0);
+  Eigen::Matrix<double, 6, 1> pose;
+  pose << angles(2), angles(1), angles(0), isometry.translation();
+  return pose;
+}
+
+//-----------------------------------------------------------------------------
+int ScanContext::GetSector(double azimuth) const
+{
+  const int sector = static_cast<int>((azimuth + M_PI) / (2. * M_PI) * NbSectors);
+  return std::max(0, std::min(NbSectors - 1, sector));
+}
+
+//-----------------------------------------------------------------------------
+void ScanContext::ComputeRingKey()
+{
+  this->RingKey.resize(NbRings);
+  for (int ring = 0; ring < NbRings; ++ring)
+  {
+    const int occupied = (this->Grid.row(ring).array() > 0.f).count();
+    this->RingKey(ring) = static_cast<float>(occupied) / NbSectors;
+  }
+}
+
+//-----------------------------------------------------------------------------
+double ScanContext::RingKeyDistance(const ScanContext& other) const
+{
+  return (this->RingKey - other.RingKey).norm();
+}
+
+//-----------------------------------------------------------------------------
+double ScanContext::Distance(const ScanContext& other, int& bestShift) const
+{
+  // norms of the columns, to compute the cosine similarity of the columns
+  Eigen::VectorXf norms = this->Grid.colwise().norm();
+  Eigen::VectorXf otherNorms = other.Grid.colwise().norm();
+
+  double bestDistance = 1.;
+  bestShift = 0;
+  for (int shift = 0; shift < NbSectors; ++shift)
+  {
+    double sum = 0.;
+    int count = 0;
+    for (int sector = 0; sector < NbSectors; ++sector)
+    {
+      const int otherSector = (sector + shift) % NbSectors;
+      if (norms(sector) == 0.f || otherNorms(otherSector) == 0.f)
+      {
+        continue;
+      }
+      const double similarity = this->Grid.col(sector).dot(other.Grid.col(otherSector))
+                                / (norms(sector) * otherNorms(otherSector));
+      sum += 1. - similarity;
+      count++;
+    }
+    if (count > 0 && sum / count < bestDistance)
+    {
+      bestDistance = sum / count;
+      bestShift = shift;
+    }
+  }
+  return bestDistance;
+}
+
+//-----------------------------------------------------------------------------
+double ScanContext::ShiftToYaw(int shift)
+{
+  return 2. * M_PI * shift / NbSectors;
+}
+
+//-----------------------------------------------------------------------------
+void PoseGraph::Reset()
+{
+  this->Poses.clear();
+  this->Descriptors.clear();
+  this->Constraints.clear();
+  this->NbLoopClosures = 0;
+}
+
+//-----------------------------------------------------------------------------
+int PoseGraph::AddKeyframe(const Eigen::Isometry3d& pose, const ScanContext& descriptor)
+{
+  if (!this->Poses.empty())
+  {
+    Constraint odometry;
+    odometry.From = static_cast<int>(this->Poses.size()) - 1;
+    odometry.To = odometry.From + 1;
+    odometry.RelativePose = this->Poses.back().inverse() * pose;
+    odometry.IsLoopClosure = false;
+    this->Constraints.push_back(odometry);
+  }
+  this->Poses.push_back(pose);
+  this->Descriptors.push_back(descriptor);
+  return static_cast<int>(this->Poses.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<PoseGraph::LoopCandidate> PoseGraph::FindLoopCandidates(int keyframe, int minGap,
+                                                                    double maxDistance,
+                                                                    size_t maxCandidates) const
+{
+  std::vector<LoopCandidate> candidates;
+  const int nbOldKeyframes = keyframe - minGap + 1;
+  if (nbOldKeyframes <= 0)
+  {
+    return candidates;
+  }
+
+  // preselect the keyframes with the closest ring keys
+  const ScanContext& descriptor = this->Descriptors[keyframe];
+  std::vector<std::pair<double, int> > ringKeyDistances(nbOldKeyframes);
+  for (int k = 0; k < nbOldKeyframes; ++k)
+  {
+    ringKeyDistances[k] = std::make_pair(descriptor.RingKeyDistance(this->Descriptors[k]), k);
+  }
+  const size_t nbPreselected = std::min(maxCandidates, ringKeyDistances.size());
+  std::partial_sort(ringKeyDistances.begin(), ringKeyDistances.begin() + nbPreselected,
+                    ringKeyDistances.end());
+
+  // then compare the whole descriptors
+  for (size_t i = 0; i < nbPreselected; ++i)
+  {
+    LoopCandidate candidate;
+    candidate.Keyframe = ringKeyDistances[i].second;
+    candidate.Distance = descriptor.Distance(this->Descriptors[candidate.Keyframe], candidate.Shift);
+    if (candidate.Distance < maxDistance)
+    {
+      candidates.push_back(candidate);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const LoopCandidate& a, const LoopCandidate& b) { return a.Distance < b.Distance; });
+  return candidates;
+}
+
+//-----------------------------------------------------------------------------
+void PoseGraph::AddLoopClosure(int from, int to, const Eigen::Isometry3d& relativePose)
+{
+  Constraint loop;
+  loop.From = from;
+  loop.To = to;
+  loop.RelativePose = relativePose;
+  loop.IsLoopClosure = true;
+  this->Constraints.push_back(loop);
+  this->NbLoopClosures++;
+}
+
+//-----------------------------------------------------------------------------
+bool PoseGraph::Optimize(int maxIterations)
+{
+  if (this->Poses.size() < 2)
+  {
+    return true;
+  }
+
+  // Ceres parameters blocks, using the same parametrization as vtkSlam
+  std::vector<std::array<double, 6> > parameters(this->Poses.size());
+  for (size_t k = 0; k < this->Poses.size(); ++k)
+  {
+    Eigen::Matrix<double, 6, 1> pose = IsometryToPose(this->Poses[k]);
+    std::copy(pose.data(), pose.data() + 6, parameters[k].begin());
+  }
+
+  ceres::Problem problem;
+  for (const Constraint& constraint : this->Constraints)
+  {
+    ceres::CostFunction* costFunction =
+      new ceres::AutoDiffCostFunction<CostFunctions::RelativePoseResidual, 6, 6, 6>(
+        new CostFunctions::RelativePoseResidual(constraint.RelativePose.linear(),
+                                                constraint.RelativePose.translation(),
+                                                1. / this->RotationStdDev,
+                                                1. / this->TranslationStdDev));
+    // a wrong loop closure must not break the whole trajectory
+    ceres::LossFunction* loss = constraint.IsLoopClosure ? new ceres::CauchyLoss(1.0) : nullptr;
+    problem.AddResidualBlock(costFunction, loss, parameters[constraint.From].data(),
+                             parameters[constraint.To].data());
+  }
+  problem.SetParameterBlockConstant(parameters[0].data());
+
+  ceres::Solver::Options options;
+  options.max_num_iterations = maxIterations;
+  options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
+  std::string error;
+  if (!options.IsValid(&error))
+  {
+    // ceres built without sparse linear algebra library
+    options.linear_solver_type = ceres::DENSE_QR;
+  }
+  options.minimizer_progress_to_stdout = false;
+
+  ceres::Solver::Summary summary;
+  ceres::Solve(options, &problem, &summary);
+
+  for (size_t k = 0; k < this->Poses.size(); ++k)
+  {
+    this->Poses[k] = PoseToIsometry(Eigen::Map<const Eigen::Matrix<double, 6, 1> >(parameters[k].data()));
+  }
+  return summary.termination_type == ceres::CONVERGENCE;
+}
@@ -0,0 +1,172 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef POSE_GRAPH_H
+#define POSE_GRAPH_H
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
+#include <pcl/point_cloud.h>
+
+#include <cmath>
+#include <vector>
+
+#include "vvConfigure.h"
+
+//! Convert a pose stored as in vtkSlam (rx, ry, rz, tx, ty, tz),
+//! with R = Rz(rz) * Ry(ry) * Rx(rx), to an isometry
+Eigen::Isometry3d VelodyneHDLPlugin_EXPORT PoseToIsometry(const Eigen::Matrix<double, 6, 1>& pose);
+
+//! Convert an isometry to a pose stored as in vtkSlam (rx, ry, rz, tx, ty, tz)
+Eigen::Matrix<double, 6, 1> VelodyneHDLPlugin_EXPORT IsometryToPose(const Eigen::Isometry3d& isometry);
+
+/**
+ * @brief ScanContext is a place recognition descriptor of a lidar frame.
+ *
+ * The points around the sensor are binned in a polar grid of the horizontal
+ * plane (rings x sectors), each bin storing the maximum height of its points.
+ * A rotation of the sensor around its vertical axis shifts the columns of the
+ * grid, so two descriptors are compared for all the column shifts, which also
+ * gives the yaw between the two frames. The ring key, the occupancy of each
+ * ring, does not depend on this rotation and is used to select the candidates.
+ */
+class VelodyneHDLPlugin_EXPORT ScanContext
+{
+public:
+  static const int NbRings = 20;
+  static const int NbSectors = 60;
+
+  //! Height of the sensor above the ground, so that the ground has a positive height
+  static constexpr double SensorHeight = 2.0;
+
+  /**
+   * @brief Compute the descriptor of cloud, expressed in the sensor frame
+   * @param maxRadius points further than maxRadius from the sensor are ignored
+   */
+  template <typename PointT>
+  void Compute(const pcl::PointCloud<PointT>& cloud, double maxRadius)
+  {
+    this->Grid = Eigen::MatrixXf::Zero(NbRings, NbSectors);
+    for (const PointT& point : cloud.points)
+    {
+      const double radius = std::sqrt(point.x * point.x + point.y * point.y);
+      if (radius >= maxRadius || !std::isfinite(point.z))
+      {
+        continue;
+      }
+      const int ring = std::min(NbRings - 1, static_cast<int>(radius / maxRadius * NbRings));
+      const int sector = this->GetSector(std::atan2(point.y, point.x));
+      const float height = std::max(0.f, static_cast<float>(point.z + SensorHeight));
+      this->Grid(ring, sector) = std::max(this->Grid(ring, sector), height);
+    }
+    this->ComputeRingKey();
+  }
+
+  /**
+   * @brief Distance between two descriptors, in [0, 1], 0 meaning identical
+   * @param bestShift set to the number of sectors that column c of this
+   *        descriptor must be shifted by to match column c + bestShift of other
+   */
+  double Distance(const ScanContext& other, int& bestShift) const;
+
+  //! Rotation invariant distance, cheap to compute
+  double RingKeyDistance(const ScanContext& other) const;
+
+  //! Yaw of the rotation from the frame of this descriptor to the frame of other,
+  //! given the shift found by Distance
+  static double ShiftToYaw(int shift);
+
+private:
+  int GetSector(double azimuth) const;
+  void ComputeRingKey();
+
+  Eigen::MatrixXf Grid;
+  Eigen::VectorXf RingKey;
+};
+
+/**
+ * @brief PoseGraph stores the poses of the keyframes selected by the slam,
+ * linked by the relative motions estimated by the odometry, and by the loop
+ * closures found when the sensor comes back to an already visited place.
+ * Optimizing the graph spreads the error found by a loop closure along the
+ * loop, which bounds the drift of the odometry.
+ */
+class VelodyneHDLPlugin_EXPORT PoseGraph
+{
+public:
+  //! Keyframe which may close a loop with a new keyframe
+  struct LoopCandidate
+  {
+    int Keyframe;     /*!< Index of the old keyframe */
+    int Shift;        /*!< Descriptor shift, see ScanContext::ShiftToYaw */
+    double Distance;  /*!< Descriptor distance */
+  };
+
+  void Reset();
+
+  /**
+   * @brief Add a keyframe, linked to the previous keyframe by the relative
+   * motion between their poses
+   * @param pose world pose of the keyframe estimated by the odometry
+   * @return index of the keyframe
+   */
+  int AddKeyframe(const Eigen::Isometry3d& pose, const ScanContext& descriptor);
+
+  /**
+   * @brief Find the keyframes looking like keyframe, sorted by increasing
+   * descriptor distance
+   * @param minGap only the keyframes added at least minGap keyframes before are considered
+   * @param maxDistance maximal descriptor distance
+   * @param maxCandidates number of candidates checked with the whole descriptor,
+   *        among the closest ones according to the ring key
+   */
+  std::vector<LoopCandidate> FindLoopCandidates(int keyframe, int minGap, double maxDistance,
+                                                size_t maxCandidates) const;
+
+  //! Add the relative pose of keyframe to in the frame of keyframe from, found by registration
+  void AddLoopClosure(int from, int to, const Eigen::Isometry3d& relativePose);
+
+  /**
+   * @brief Optimize the keyframe poses, the first keyframe being fixed
+   * @return true if the optimization converged
+   */
+  bool Optimize(int maxIterations);
+
+  const Eigen::Isometry3d& GetPose(int keyframe) const { return this->Poses[keyframe]; }
+  int GetNumberOfKeyframes() const { return static_cast<int>(this->Poses.size()); }
+  int GetNumberOfLoopClosures() const { return this->NbLoopClosures; }
+
+  //! Expected standard deviation of the relative motions
+  double RotationStdDev = 0.01;
+  double TranslationStdDev = 0.1;
+
+private:
+  struct Constraint
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    int From;
+    int To;
+    Eigen::Isometry3d RelativePose;
+    bool IsLoopClosure;
+  };
+
+  std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d> > Poses;
+  std::vector<ScanContext> Descriptors;
+  std::vector<Constraint, Eigen::aligned_allocator<Constraint> > Constraints;
+  int NbLoopClosures = 0;
+};
+
+#endif // POSE_GRAPH_H
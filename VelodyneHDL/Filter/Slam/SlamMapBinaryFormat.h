@@ -0,0 +1,103 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SLAMMAPBINARYFORMAT_H
+#define SLAMMAPBINARYFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Layout of the map files saved and loaded by vtkSlam.
+ *
+ * The file starts with a SlamMapBinaryHeader, followed by NumberOfMaps maps.
+ * Each map is the content of a rolling grid:
+ * - a SlamMapBinaryGridHeader
+ * - NumberOfVoxels SlamMapBinaryVoxel, the non empty voxels of the grid
+ * - the points of these voxels, in the same order, each point being
+ *   PointComponents floats: x, y, z, intensity, normal_x, normal_y, normal_z
+ *
+ * All values are stored in the byte order of the machine which wrote the file.
+ *
+ * A rolling grid only covers VoxelSize^3 voxels around the last pose of the
+ * sensor, so the points which left it are not part of the file.
+ */
+struct SlamMapBinaryHeader
+{
+  char Magic[8];                  /*!< "VVSLAMAP" */
+  uint32_t Version;               /*!< Version of the format */
+  uint32_t ByteOrderMark;         /*!< ByteOrderMark in the byte order of the writer */
+  uint32_t NumberOfMaps;          /*!< Number of grids following the header */
+  uint32_t Reserved;              /*!< Unused, set to 0 */
+  double Pose[6];                 /*!< Last pose of the sensor (rx, ry, rz, x, y, z) */
+};
+
+struct SlamMapBinaryGridHeader
+{
+  uint32_t MapType;               /*!< One of SlamMapBinaryFormat::MapType */
+  int32_t VoxelSize;              /*!< The grid has VoxelSize^3 voxels */
+  double VoxelResolution;         /*!< Resolution of a voxel */
+  double LeafSize;                /*!< Leaf size of the downsampling filter */
+  int32_t VoxelGridPosition[3];   /*!< Position of the grid */
+  uint32_t Reserved;              /*!< Unused, set to 0 */
+  uint64_t NumberOfVoxels;        /*!< Number of non empty voxels */
+  uint64_t NumberOfPoints;        /*!< Total number of points */
+};
+
+struct SlamMapBinaryVoxel
+{
+  int32_t Index[3];               /*!< Position of the voxel in the grid */
+  uint32_t NumberOfPoints;        /*!< Number of points of the voxel */
+};
+
+namespace SlamMapBinaryFormat
+{
+const char Magic[8] = { 'V', 'V', 'S', 'L', 'A', 'M', 'A', 'P' };
+const uint32_t Version = 1;
+const uint32_t ByteOrderMark = 0x01020304;
+
+//! Number of floats stored for each point
+const int PointComponents = 7;
+
+//! Largest VoxelSize accepted when reading a grid
+const int32_t MaximumVoxelSize = 200;
+
+enum MapType
+{
+  EdgesMap = 0,
+  PlanarsMap = 1,
+  BlobsMap = 2,
+  NumberOfMapTypes = 3
+};
+
+inline SlamMapBinaryHeader CreateHeader(uint32_t numberOfMaps, const double pose[6])
+{
+  SlamMapBinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, Magic, sizeof(Magic));
+  header.Version = Version;
+  header.ByteOrderMark = ByteOrderMark;
+  header.NumberOfMaps = numberOfMaps;
+  std::memcpy(header.Pose, pose, sizeof(header.Pose));
+  return header;
+}
+
+inline bool IsValid(const SlamMapBinaryHeader& header)
+{
+  return std::memcmp(header.Magic, Magic, sizeof(Magic)) == 0 &&
+    header.Version == Version && header.ByteOrderMark == ByteOrderMark;
+}
+}
+
+#endif // SLAMMAPBINARYFORMAT_H
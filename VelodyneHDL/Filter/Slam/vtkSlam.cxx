@@ -73,12 +73,17 @@
 #include "vtkVelodyneTransformInterpolator.h"
 #include "vtkPCLConversions.h"
 #include "CeresCostFunctions.h"
+#include "SlamMapBinaryFormat.h"
 // STD
 #include <sstream>
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cfloat>
+#include <chrono>
 #include <ctime>
+#include <fstream>
+#include <limits>
 // VTK
 #include <vtkCellArray.h>
 #include <vtkCellData.h>
@@ -107,6 +112,7 @@
 #include <Eigen/Dense>
 // PCL
 #include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
 #include <pcl/filters/voxel_grid.h>
 // CERES
 #include <ceres/ceres.h>
@@ -118,6 +124,21 @@ vtkStandardNewMacro(vtkSlam);
 
 
 namespace {
+//-----------------------------------------------------------------------------
+//! Time of the first point of a frame in microseconds, read from adjustedtime or, when the
+//! interpreter does not produce it, from timestamp. In the latter case isHourly is set, as
+//! timestamp is the time since the top of the hour and wraps every hour.
+double GetFrameRawTime(vtkPolyData* frame, bool& isHourly)
+{
+  vtkDataArray* time = frame->GetPointData()->GetArray("adjustedtime");
+  isHourly = !time;
+  if (!time)
+  {
+    time = frame->GetPointData()->GetArray("timestamp");
+  }
+  return time && time->GetNumberOfTuples() > 0 ? time->GetTuple1(0) : 0.;
+}
+
 //-----------------------------------------------------------------------------
 class LineFitting
 {
@@ -284,22 +305,54 @@ std::vector<size_t> sortIdx(const std::vector<T> &v)
 }
 
 //-----------------------------------------------------------------------------
-std::clock_t startTime;
+void SetStatistic(SlamStatistics& statistics, const std::string& name, double value)
+{
+  auto inserted = statistics.Index.emplace(name, statistics.Values.size());
+  if (inserted.second)
+  {
+    statistics.Values.emplace_back(name, value);
+  }
+  else
+  {
+    statistics.Values[inserted.first->second].second = value;
+  }
+}
 
 //-----------------------------------------------------------------------------
-void InitTime()
+void ClearStatistics(SlamStatistics& statistics)
 {
-  startTime = std::clock();
+  statistics.Values.clear();
+  statistics.Index.clear();
 }
 
 //-----------------------------------------------------------------------------
-void StopTimeAndDisplay(std::string functionName)
+double ElapsedTime(const std::chrono::steady_clock::time_point& start)
 {
-  std::clock_t endTime = std::clock();
-  double dt = static_cast<double>(endTime - startTime) / CLOCKS_PER_SEC;
-  std::cout << "  -time elapsed in function <" << functionName << "> : " << dt << " sec" << std::endl;
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  return dt.count();
 }
 
+//-----------------------------------------------------------------------------
+// Record the wall time elapsed in its scope as a statistic
+class ScopedTimer
+{
+public:
+  ScopedTimer(SlamStatistics& statistics, const std::string& name)
+    : Statistics(statistics), Name(name), Start(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~ScopedTimer()
+  {
+    SetStatistic(this->Statistics, this->Name, ElapsedTime(this->Start));
+  }
+
+private:
+  SlamStatistics& Statistics;
+  std::string Name;
+  std::chrono::steady_clock::time_point Start;
+};
+
 //-----------------------------------------------------------------------------
 double Rad2Deg(double val)
 {
@@ -446,13 +499,24 @@ public:
     }
   }
 
+  // identifier of the region of the grid returned by Get(T): position
+  // of the frame center in the grid and size of the region
+  std::array<int, 4> GetRegion(Eigen::Matrix<double, 6, 1> &T) const
+  {
+    return {{ static_cast<int>(std::floor(T[3] / this->VoxelSize) - this->VoxelGridPosition[0]),
+              static_cast<int>(std::floor(T[4] / this->VoxelSize) - this->VoxelGridPosition[1]),
+              static_cast<int>(std::floor(T[5] / this->VoxelSize) - this->VoxelGridPosition[2]),
+              this->PointCloudSize }};
+  }
+
   // get points arround T
   pcl::PointCloud<Point>::Ptr Get(Eigen::Matrix<double, 6, 1> &T)
   {
     // compute the position of the new frame center in the grid
-    int frameCenterX = std::floor(T[3] / this->VoxelSize) - this->VoxelGridPosition[0];
-    int frameCenterY = std::floor(T[4] / this->VoxelSize) - this->VoxelGridPosition[1];
-    int frameCenterZ = std::floor(T[5] / this->VoxelSize) - this->VoxelGridPosition[2];
+    const std::array<int, 4> region = this->GetRegion(T);
+    int frameCenterX = region[0];
+    int frameCenterY = region[1];
+    int frameCenterZ = region[2];
 
     pcl::PointCloud<Point>::Ptr intersection(new pcl::PointCloud<Point>);
 
@@ -584,6 +648,146 @@ public:
     }
   }
 
+  // remove all points, the grid position is kept
+  void Clear()
+  {
+    for (int i = 0; i < this->VoxelSize; i++)
+    {
+      for (int j = 0; j < this->VoxelSize; j++)
+      {
+        for (int k = 0; k < this->VoxelSize; k++)
+        {
+          grid[i][j][k].reset(new pcl::PointCloud<Point>());
+        }
+      }
+    }
+  }
+
+  // write the grid and its non empty voxels, see SlamMapBinaryFormat.h
+  bool Write(std::ostream& out, uint32_t mapType) const
+  {
+    SlamMapBinaryGridHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.MapType = mapType;
+    header.VoxelSize = this->VoxelSize;
+    header.VoxelResolution = this->VoxelResolution;
+    header.LeafSize = this->LeafSize;
+    std::copy(this->VoxelGridPosition, this->VoxelGridPosition + 3, header.VoxelGridPosition);
+
+    std::vector<SlamMapBinaryVoxel> voxels;
+    for (int i = 0; i < this->VoxelSize; i++)
+    {
+      for (int j = 0; j < this->VoxelSize; j++)
+      {
+        for (int k = 0; k < this->VoxelSize; k++)
+        {
+          if (!this->grid[i][j][k]->empty())
+          {
+            SlamMapBinaryVoxel voxel = {{ i, j, k }, static_cast<uint32_t>(this->grid[i][j][k]->size()) };
+            voxels.push_back(voxel);
+            header.NumberOfPoints += voxel.NumberOfPoints;
+          }
+        }
+      }
+    }
+    header.NumberOfVoxels = voxels.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(voxels.data()), voxels.size() * sizeof(SlamMapBinaryVoxel));
+    std::vector<float> values;
+    for (const SlamMapBinaryVoxel& voxel : voxels)
+    {
+      const pcl::PointCloud<Point>& points = *this->grid[voxel.Index[0]][voxel.Index[1]][voxel.Index[2]];
+      values.resize(points.size() * SlamMapBinaryFormat::PointComponents);
+      float* value = values.data();
+      for (const Point& p : points.points)
+      {
+        *value++ = p.x; *value++ = p.y; *value++ = p.z; *value++ = p.intensity;
+        *value++ = p.normal_x; *value++ = p.normal_y; *value++ = p.normal_z;
+      }
+      out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    }
+    return out.good();
+  }
+
+  // replace the grid by the one read from in, see SlamMapBinaryFormat.h
+  bool Read(std::istream& in, uint32_t& mapType)
+  {
+    SlamMapBinaryGridHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.VoxelSize <= 0 || header.VoxelSize > SlamMapBinaryFormat::MaximumVoxelSize)
+    {
+      return false;
+    }
+
+    // check the counts of the header against the grid and the rest of the
+    // stream before allocating anything from them
+    const std::streampos start = in.tellg();
+    if (start < 0 || !in.seekg(0, std::ios::end))
+    {
+      return false;
+    }
+    const uint64_t remaining = static_cast<uint64_t>(in.tellg() - start);
+    in.seekg(start);
+    const uint64_t numberOfGridVoxels = static_cast<uint64_t>(header.VoxelSize) * header.VoxelSize * header.VoxelSize;
+    const uint64_t pointBytes = SlamMapBinaryFormat::PointComponents * sizeof(float);
+    if (header.NumberOfVoxels > numberOfGridVoxels ||
+        header.NumberOfVoxels > remaining / sizeof(SlamMapBinaryVoxel) ||
+        header.NumberOfPoints > (remaining - header.NumberOfVoxels * sizeof(SlamMapBinaryVoxel)) / pointBytes)
+    {
+      return false;
+    }
+
+    std::vector<SlamMapBinaryVoxel> voxels(header.NumberOfVoxels);
+    if (!in.read(reinterpret_cast<char*>(voxels.data()), voxels.size() * sizeof(SlamMapBinaryVoxel)))
+    {
+      return false;
+    }
+    uint64_t numberOfPoints = 0;
+    for (const SlamMapBinaryVoxel& voxel : voxels)
+    {
+      numberOfPoints += voxel.NumberOfPoints;
+    }
+    if (numberOfPoints != header.NumberOfPoints)
+    {
+      return false;
+    }
+
+    mapType = header.MapType;
+    this->SetSize(header.VoxelSize);
+    this->VoxelResolution = header.VoxelResolution;
+    this->LeafSize = header.LeafSize;
+    std::copy(header.VoxelGridPosition, header.VoxelGridPosition + 3, this->VoxelGridPosition);
+
+    std::vector<float> values;
+    for (const SlamMapBinaryVoxel& voxel : voxels)
+    {
+      for (int c = 0; c < 3; c++)
+      {
+        if (voxel.Index[c] < 0 || voxel.Index[c] >= this->VoxelSize)
+        {
+          return false;
+        }
+      }
+      values.resize(static_cast<size_t>(voxel.NumberOfPoints) * SlamMapBinaryFormat::PointComponents);
+      if (!in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float)))
+      {
+        return false;
+      }
+      pcl::PointCloud<Point>::Ptr points(new pcl::PointCloud<Point>());
+      points->resize(voxel.NumberOfPoints);
+      const float* value = values.data();
+      for (Point& p : points->points)
+      {
+        p.x = *value++; p.y = *value++; p.z = *value++; p.intensity = *value++;
+        p.normal_x = *value++; p.normal_y = *value++; p.normal_z = *value++;
+        p.curvature = 0;
+      }
+      this->grid[voxel.Index[0]][voxel.Index[1]][voxel.Index[2]] = points;
+    }
+    return true;
+  }
+
   void SetResolution(double resolution) { this->VoxelResolution = resolution; }
 
   void SetLeafSize(double size) { this->LeafSize = size; }
@@ -618,41 +822,94 @@ vtkInformationVector **inputVector, vtkInformationVector *outputVector)
     this->UpdateLaserIdMapping(calib);
   }
 
+  // The prior map is loaded before the first frame
+  if (this->NbrFrameProcessed == 0 && !this->HasPriorMap && !this->InitialMapFileName.empty())
+  {
+    if (this->LoadMaps(this->InitialMapFileName))
+    {
+      this->Tworld = Eigen::Map<Eigen::Matrix<double, 6, 1> >(this->InitialPose);
+      this->PreviousTworld = this->Tworld;
+    }
+  }
+
   // Get the input
   vtkPolyData *input = vtkPolyData::GetData(inputVector[0]->GetInformationObject(0));
 
-  this->AddFrame(input);
+  // the optional arrays of the lidar frames may be disabled, but these ones are required
+  for (const char* name : { "laser_id", "timestamp", "intensity" })
+  {
+    if (!input->GetPointData()->GetArray(name))
+    {
+      vtkErrorMacro(<< "The input frame has no '" << name << "' array, which is required by the slam");
+      return 0;
+    }
+  }
+
+  if (!this->PipelineFrames)
+  {
+    this->AddFrame(input);
+    this->FillOutputs(outputVector);
+    return 1;
+  }
+
+  // The frame registered during this step is the previous one
+  this->StartPipelineStep(input);
+  if (!this->FlushPipelineAfterFrame)
+  {
+    this->FillOutputs(outputVector);
+  }
+  this->FinishPipelineStep();
+
+  if (this->FlushPipelineAfterFrame)
+  {
+    this->FlushPipeline();
+    this->FillOutputs(outputVector);
+  }
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::FillOutputs(vtkInformationVector* outputVector)
+{
   // output 0 - Current Frame
+  // (no frame is registered yet at the first step of the pipelined mode)
   vtkInformation *outInfo0 = outputVector->GetInformationObject(0);
   vtkPolyData *output0 = vtkPolyData::SafeDownCast(
       outInfo0->Get(vtkDataObject::DATA_OBJECT()));
-  // add all debug information if displayMode == True
-  if (this->DisplayMode == true && this->NbrFrameProcessed > 0)
-  {
-    this->DisplayLaserIdMapping(this->vtkCurrentFrame);
-    this->DisplayRelAdv(this->vtkCurrentFrame);
-    this->DisplayUsedKeypoints(this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<double, vtkDoubleArray>(this->Angles, "angles_line", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<double, vtkDoubleArray>(this->LengthResolution, "length_resolution", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<double, vtkDoubleArray>(this->SaillantPoint, "saillant_point", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<double, vtkDoubleArray>(this->DepthGap, "depth_gap", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<double, vtkDoubleArray>(this->IntensityGap, "intensity_gap", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<double, vtkDoubleArray>(this->BlobScore, "blob_score", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<int, vtkIntArray>(this->IsPointValid, "is_point_valid", this->vtkCurrentFrame);
-    AddVectorToPolydataPoints<int, vtkIntArray>(this->Label, "keypoint_label", this->vtkCurrentFrame);
-  }
-  // get transform
-  vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
-  transform->Translate(Tworld[3], Tworld[4], Tworld[5]);
-  transform->RotateX(Rad2Deg(Tworld[0]));
-  transform->RotateY(Rad2Deg(Tworld[1]));
-  transform->RotateZ(Rad2Deg(Tworld[2]));
-  // create transform filter and transformt the current frame
-  vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  transformFilter->SetInputData(this->vtkCurrentFrame);
-  transformFilter->SetTransform(transform);
-  transformFilter->Update();
-  output0->ShallowCopy(transformFilter->GetOutput());
+  if (!this->vtkCurrentFrame)
+  {
+    output0->Initialize();
+  }
+  else
+  {
+    // add all debug information if displayMode == True
+    if (this->DisplayMode == true && this->NbrFrameProcessed > 0)
+    {
+      this->DisplayLaserIdMapping(this->vtkCurrentFrame);
+      this->DisplayRelAdv(this->vtkCurrentFrame);
+      this->DisplayUsedKeypoints(this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<double, vtkDoubleArray>(this->Angles, "angles_line", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<double, vtkDoubleArray>(this->LengthResolution, "length_resolution", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<double, vtkDoubleArray>(this->SaillantPoint, "saillant_point", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<double, vtkDoubleArray>(this->DepthGap, "depth_gap", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<double, vtkDoubleArray>(this->IntensityGap, "intensity_gap", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<double, vtkDoubleArray>(this->BlobScore, "blob_score", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<int, vtkIntArray>(this->IsPointValid, "is_point_valid", this->vtkCurrentFrame);
+      AddVectorToPolydataPoints<int, vtkIntArray>(this->Label, "keypoint_label", this->vtkCurrentFrame);
+    }
+    // get transform
+    vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
+    transform->Translate(Tworld[3], Tworld[4], Tworld[5]);
+    transform->RotateX(Rad2Deg(Tworld[0]));
+    transform->RotateY(Rad2Deg(Tworld[1]));
+    transform->RotateZ(Rad2Deg(Tworld[2]));
+    // create transform filter and transformt the current frame
+    vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    transformFilter->SetInputData(this->vtkCurrentFrame);
+    transformFilter->SetTransform(transform);
+    transformFilter->Update();
+    output0->ShallowCopy(transformFilter->GetOutput());
+  }
 
   // output 1 - Trajectory
   auto *output1 = vtkPolyData::GetData(outputVector->GetInformationObject(1));
@@ -673,7 +930,11 @@ vtkInformationVector **inputVector, vtkInformationVector *outputVector)
   auto BlobMap = vtkPCLConversions::PolyDataFromPointCloud(this->BlobsPointsLocalMap->Get());
   output4->ShallowCopy(BlobMap);
 
-  return 1;
+  // output 5 - Statistics
+  // the rows of the next frames are appended to the same columns, the rows
+  // already output are never modified
+  auto *output5 = vtkTable::GetData(outputVector->GetInformationObject(5));
+  output5->ShallowCopy(this->Statistics);
 }
 
 //-----------------------------------------------------------------------------
@@ -702,19 +963,28 @@ void vtkSlam::PrintSelf(ostream& os, vtkIndent indent)
   PrintParameter(EgoMotionMinimumLineNeighborRejection)
   PrintParameter(MappingMinimumLineNeighborRejection)
   PrintParameter(MappingLineMaxDistInlier)
+  PrintParameter(LoopClosure)
+  PrintParameter(KeyframeDistance)
+  PrintParameter(LoopClosureMinKeyframeGap)
+  PrintParameter(LoopClosureDescriptorThreshold)
+  PrintParameter(LoopClosureMaxDistance)
+  PrintParameter(InitialMapFileName)
+  PrintParameter(LocalizationOnly)
 }
 
 //-----------------------------------------------------------------------------
 vtkSlam::vtkSlam()
 {
   this->SetNumberOfInputPorts(2);
-  this->SetNumberOfOutputPorts(5);
+  this->SetNumberOfOutputPorts(6);
   this->Reset();
 }
 
 //-----------------------------------------------------------------------------
 void vtkSlam::Reset()
 {
+  this->StopPipeline();
+
   this->EdgesPointsLocalMap = std::make_shared<RollingGrid>();
   this->PlanarPointsLocalMap = std::make_shared<RollingGrid>();
   this->BlobsPointsLocalMap = std::make_shared<RollingGrid>();
@@ -734,6 +1004,8 @@ void vtkSlam::Reset()
 
   this->LaserIdMapping.clear();
   this->NbrFrameProcessed = 0;
+  this->LastHourlyFrameTime = -1;
+  this->HourlyFrameTimeOffset = 0;
   this->Tworld = Eigen::Matrix<double, 6, 1>::Zero();
 
   // add the required array in the trajectory
@@ -745,12 +1017,25 @@ void vtkSlam::Reset()
   CreateDataArray<vtkIntArray>("EgoMotion: edges used", 0, this->Trajectory);
   CreateDataArray<vtkIntArray>("EgoMotion: planes used", 0, this->Trajectory);
   CreateDataArray<vtkIntArray>("EgoMotion: total keypoints used", 0, this->Trajectory);
+
+  // reset the prior map
+  this->HasPriorMap = false;
+  this->FrozenMapCacheValid = false;
+
+  // reset the loop closure
+  this->ResetPoseGraph(0);
+
+  // reset the instrumentation
+  this->Statistics = vtkSmartPointer<vtkTable>::New();
+  this->StatisticsColumns.clear();
+  ClearStatistics(this->FrameStatistics);
+  this->StatisticsLog.close();
 }
 
 //-----------------------------------------------------------------------------
 vtkSlam::~vtkSlam()
 {
-
+  this->StopPipeline();
 }
 
 //-----------------------------------------------------------------------------
@@ -769,6 +1054,17 @@ int vtkSlam::FillInputPortInformation(int port, vtkInformation *info)
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int vtkSlam::FillOutputPortInformation(int port, vtkInformation *info)
+{
+  if ( port == 5 )
+  {
+    info->Set(vtkDataObject::DATA_TYPE_NAME(), "vtkTable" );
+    return 1;
+  }
+  return this->Superclass::FillOutputPortInformation(port, info);
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlam::GetWorldTransform(double* Tworld)
 {
@@ -939,6 +1235,18 @@ void vtkSlam::AddFrame(vtkPolyData* newFrame)
     vtkGenericWarningMacro("Slam entry is a null pointer data");
     return;
   }
+
+  this->ExtractKeypoints(newFrame);
+
+  const auto registrationStart = std::chrono::steady_clock::now();
+  this->RegisterFrame();
+  this->AppendFrameStatistics(this->KeypointsExtractionTime + ElapsedTime(registrationStart));
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::ExtractKeypoints(vtkPolyData* newFrame)
+{
+  const auto extractionStart = std::chrono::steady_clock::now();
   this->vtkCurrentFrame = newFrame;
 
   // Check if the number of lasers has been set
@@ -947,30 +1255,55 @@ void vtkSlam::AddFrame(vtkPolyData* newFrame)
     vtkGenericWarningMacro("Frame added without specifying the number of lasers");
   }
 
-  std::cout << "#########################################################" << std::endl
-            << "Processing frame : " << this->NbrFrameProcessed << std:: endl
-            << "#########################################################" << std::endl
-            << std::endl;
-
   // Reset the members variables used during the last
   // processed frame so that they can be used again
   PrepareDataForNextFrame();
 
-  // Update the kalman filter time
-  double time = newFrame->GetPointData()->GetArray("adjustedtime")->GetTuple1(0) * 1e-6;
+  ClearStatistics(this->FrameStatistics);
+  SetStatistic(this->FrameStatistics, "Frame", this->NbrFrameProcessed);
+  SetStatistic(this->FrameStatistics, "Points", newFrame->GetNumberOfPoints());
 
-  // If the new frame is the first one we just add the
-  // extracted keypoints into the map without running
-  // odometry and mapping steps
+  // Convert the new frame into pcl format and sort
+  // the laser scan-lines by vertical angle
+  {
+    ScopedTimer timer(this->FrameStatistics, "Time: Sorting lines");
+    this->ConvertAndSortScanLines(vtkCurrentFrame);
+  }
+
+  // Compute the edges and planars keypoints
+  {
+    ScopedTimer timer(this->FrameStatistics, "Time: Keypoints extraction");
+    this->ComputeKeyPoints(vtkCurrentFrame);
+  }
+
+  this->KeypointsExtractionTime = ElapsedTime(extractionStart);
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::RegisterFrame()
+{
+  // The statistics log is restarted with the slam
   if (this->NbrFrameProcessed == 0)
   {
-    // Convert the new frame into pcl format and sort
-    // the laser scan-lines by vertical angle
-    this->ConvertAndSortScanLines(newFrame);
+    this->StatisticsLog.close();
+    if (!this->StatisticsFileName.empty())
+    {
+      this->StatisticsLog.open(this->StatisticsFileName, std::ios::out | std::ios::trunc);
+      if (!this->StatisticsLog.is_open())
+      {
+        vtkGenericWarningMacro("Could not open the statistics file: " << this->StatisticsFileName);
+      }
+    }
+  }
 
-    // Compute the edges and planars keypoints
-    this->ComputeKeyPoints(newFrame);
+  double time = this->GetFrameTime(this->vtkCurrentFrame);
+  SetStatistic(this->FrameStatistics, "Timestamp", time);
 
+  // If the new frame is the first one we just add the
+  // extracted keypoints into the map without running
+  // odometry and mapping steps, unless there is a prior map
+  if (this->NbrFrameProcessed == 0 && !this->HasPriorMap)
+  {
     // update map using tworld
     this->UpdateMapsUsingTworld();
 
@@ -979,36 +1312,37 @@ void vtkSlam::AddFrame(vtkPolyData* newFrame)
     this->PreviousPlanarsPoints = this->CurrentPlanarsPoints;
     this->PreviousBlobsPoints = this->CurrentBlobsPoints;
     this->NbrFrameProcessed++;
+
+    if (this->LoopClosure)
+    {
+      this->UpdatePoseGraph();
+    }
     return;
   }
 
-  // Convert the new frame into pcl format and sort
-  // the laser scan-lines by vertical angle
-  InitTime();
-  this->ConvertAndSortScanLines(vtkCurrentFrame);
-  StopTimeAndDisplay("Sorting lines");
-
-  // Compute the edges and planars keypoints
-  InitTime();
-  this->ComputeKeyPoints(vtkCurrentFrame);
-  StopTimeAndDisplay("Keypoints extraction");
-
-  // Perfom EgoMotion
-  InitTime();
-  this->ComputeEgoMotion();
-  StopTimeAndDisplay("Ego-Motion");
+  // Perfom EgoMotion. The first frame is directly
+  // registered on the prior map from the initial pose
+  if (this->NbrFrameProcessed == 0)
+  {
+    this->FillEgoMotionInfoArrayWithDefaultValues();
+    this->PreviousBlobsPoints = this->CurrentBlobsPoints;
+  }
+  else
+  {
+    ScopedTimer timer(this->FrameStatistics, "Time: Ego-Motion");
+    this->ComputeEgoMotion();
+  }
 
   // Transform the current keypoints to the
   // referential of the sensor at the end of
   // frame acquisition
-  InitTime();
   //this->TransformCurrentKeypointsToEnd();
-  StopTimeAndDisplay("Undistortion");
 
   // Perform Mapping
-  InitTime();
-  this->Mapping();
-  StopTimeAndDisplay("Mapping");
+  {
+    ScopedTimer timer(this->FrameStatistics, "Time: Mapping");
+    this->Mapping();
+  }
 
   // Current keypoints become previous ones
   this->PreviousEdgesPoints = this->CurrentEdgesPoints;
@@ -1016,14 +1350,17 @@ void vtkSlam::AddFrame(vtkPolyData* newFrame)
   this->NbrFrameProcessed++;
 
   // Motion and localization parameters estimation information display
-  Eigen::Vector3d angles, trans;
-  angles << Rad2Deg(this->Trelative(0)), Rad2Deg(this->Trelative(1)), Rad2Deg(this->Trelative(2));
-  trans << this->Trelative(3), this->Trelative(4), this->Trelative(5);
-  std::cout << "Ego-Motion estimation: angles = [" << angles.transpose() << "] translation: [" << trans.transpose() << "]" << std::endl;
-  angles << Rad2Deg(this->Tworld(0)), Rad2Deg(this->Tworld(1)), Rad2Deg(this->Tworld(2));
-  trans << this->Tworld(3), this->Tworld(4), this->Tworld(5);
-  std::cout << "Localiazion estimation: angles = [" << angles.transpose() << "] translation: [" << trans.transpose() << "]"
-            << std::endl << std::endl << std::endl;
+  if (this->Verbose)
+  {
+    Eigen::Vector3d angles, trans;
+    angles << Rad2Deg(this->Trelative(0)), Rad2Deg(this->Trelative(1)), Rad2Deg(this->Trelative(2));
+    trans << this->Trelative(3), this->Trelative(4), this->Trelative(5);
+    std::cout << "Ego-Motion estimation: angles = [" << angles.transpose() << "] translation: [" << trans.transpose() << "]" << std::endl;
+    angles << Rad2Deg(this->Tworld(0)), Rad2Deg(this->Tworld(1)), Rad2Deg(this->Tworld(2));
+    trans << this->Tworld(3), this->Tworld(4), this->Tworld(5);
+    std::cout << "Localiazion estimation: angles = [" << angles.transpose() << "] translation: [" << trans.transpose() << "]"
+              << std::endl;
+  }
 
   // Update Trajectory
   Eigen::AngleAxisd orientation = Eigen::AngleAxisd(
@@ -1032,9 +1369,222 @@ void vtkSlam::AddFrame(vtkPolyData* newFrame)
       * Eigen::AngleAxisd(this->Tworld[2], Eigen::Vector3d::UnitZ()));
   this->Trajectory->PushBack(time, orientation, Tworld.tail(3));
 
+  if (this->LoopClosure)
+  {
+    this->UpdatePoseGraph();
+  }
+
   // Indicate the filter has been modify
   this->Modified();
-  return;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::StartPipelineStep(vtkPolyData* newFrame)
+{
+  if (!this->KeypointsExtractor)
+  {
+    this->KeypointsExtractor = vtkSmartPointer<vtkSlam>::New();
+  }
+  this->CopyKeypointsParameters(this->KeypointsExtractor);
+  this->KeypointsExtractor->NbrFrameProcessed = this->NbrFrameProcessed + (this->HasExtractedFrame ? 1 : 0);
+
+  // The pipeline may reuse its output for the next frame while this
+  // one is still being processed, so the slam keeps its own copy
+  auto frame = vtkSmartPointer<vtkPolyData>::New();
+  frame->ShallowCopy(newFrame);
+
+  this->PipelineStepStart = std::chrono::steady_clock::now();
+  vtkSlam* extractor = this->KeypointsExtractor;
+  this->ExtractionThread = boost::thread([extractor, frame]() { extractor->ExtractKeypoints(frame); });
+
+  // Register the previous frame meanwhile
+  this->RegistrationTime = 0;
+  if (this->HasExtractedFrame)
+  {
+    const auto registrationStart = std::chrono::steady_clock::now();
+    this->RegisterFrame();
+    this->RegistrationTime = ElapsedTime(registrationStart);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::FinishPipelineStep()
+{
+  const auto waitStart = std::chrono::steady_clock::now();
+  this->ExtractionThread.join();
+  const double waitTime = ElapsedTime(waitStart);
+  const double stepTime = ElapsedTime(this->PipelineStepStart);
+
+  // The occupancy of each stage during this step is recorded with the registered frame
+  if (this->HasExtractedFrame)
+  {
+    SetStatistic(this->FrameStatistics, "Pipeline: waiting for keypoints", waitTime);
+    SetStatistic(this->FrameStatistics, "Pipeline: registration occupancy",
+                 stepTime > 0 ? this->RegistrationTime / stepTime : 0);
+    SetStatistic(this->FrameStatistics, "Pipeline: extraction occupancy",
+                 stepTime > 0 ? this->KeypointsExtractor->KeypointsExtractionTime / stepTime : 0);
+    this->AppendFrameStatistics(this->KeypointsExtractionTime + this->RegistrationTime);
+  }
+
+  // The frame just extracted is the next one to register
+  this->SwapFrameData(this->KeypointsExtractor);
+  this->HasExtractedFrame = true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::FlushPipeline()
+{
+  if (!this->HasExtractedFrame)
+  {
+    return;
+  }
+  const auto registrationStart = std::chrono::steady_clock::now();
+  this->RegisterFrame();
+  this->AppendFrameStatistics(this->KeypointsExtractionTime + ElapsedTime(registrationStart));
+  this->HasExtractedFrame = false;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::StopPipeline()
+{
+  if (this->ExtractionThread.joinable())
+  {
+    this->ExtractionThread.join();
+  }
+  this->HasExtractedFrame = false;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::CopyKeypointsParameters(vtkSlam* extractor) const
+{
+  extractor->NLasers = this->NLasers;
+  extractor->LaserIdMapping = this->LaserIdMapping;
+  extractor->NeighborWidth = this->NeighborWidth;
+  extractor->AngleResolution = this->AngleResolution;
+  extractor->MinDistanceToSensor = this->MinDistanceToSensor;
+  extractor->EdgeSinAngleThreshold = this->EdgeSinAngleThreshold;
+  extractor->PlaneSinAngleThreshold = this->PlaneSinAngleThreshold;
+  extractor->EdgeDepthGapThreshold = this->EdgeDepthGapThreshold;
+  extractor->DistToLineThreshold = this->DistToLineThreshold;
+  extractor->FastSlam = this->FastSlam;
+  extractor->UseBlob = this->UseBlob;
+  extractor->SphericityThreshold = this->SphericityThreshold;
+  extractor->IncertitudeCoef = this->IncertitudeCoef;
+  extractor->DisplayMode = this->DisplayMode;
+  extractor->Verbose = this->Verbose;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::SwapFrameData(vtkSlam* other)
+{
+  std::swap(this->vtkCurrentFrame, other->vtkCurrentFrame);
+  std::swap(this->pclCurrentFrame, other->pclCurrentFrame);
+  std::swap(this->pclCurrentFrameByScan, other->pclCurrentFrameByScan);
+  std::swap(this->FromVTKtoPCLMapping, other->FromVTKtoPCLMapping);
+  std::swap(this->FromPCLtoVTKMapping, other->FromPCLtoVTKMapping);
+  std::swap(this->EdgesIndex, other->EdgesIndex);
+  std::swap(this->PlanarIndex, other->PlanarIndex);
+  std::swap(this->BlobIndex, other->BlobIndex);
+  std::swap(this->EdgePointRejectionEgoMotion, other->EdgePointRejectionEgoMotion);
+  std::swap(this->PlanarPointRejectionEgoMotion, other->PlanarPointRejectionEgoMotion);
+  std::swap(this->EdgePointRejectionMapping, other->EdgePointRejectionMapping);
+  std::swap(this->PlanarPointRejectionMapping, other->PlanarPointRejectionMapping);
+  std::swap(this->CurrentEdgesPoints, other->CurrentEdgesPoints);
+  std::swap(this->CurrentPlanarsPoints, other->CurrentPlanarsPoints);
+  std::swap(this->CurrentBlobsPoints, other->CurrentBlobsPoints);
+  std::swap(this->Angles, other->Angles);
+  std::swap(this->DepthGap, other->DepthGap);
+  std::swap(this->BlobScore, other->BlobScore);
+  std::swap(this->LengthResolution, other->LengthResolution);
+  std::swap(this->SaillantPoint, other->SaillantPoint);
+  std::swap(this->IntensityGap, other->IntensityGap);
+  std::swap(this->IsPointValid, other->IsPointValid);
+  std::swap(this->Label, other->Label);
+  std::swap(this->FarestKeypointDist, other->FarestKeypointDist);
+  std::swap(this->FrameStatistics, other->FrameStatistics);
+  std::swap(this->KeypointsExtractionTime, other->KeypointsExtractionTime);
+}
+
+//-----------------------------------------------------------------------------
+double vtkSlam::GetFrameTime(vtkPolyData* frame)
+{
+  bool isHourly = false;
+  double time = GetFrameRawTime(frame, isHourly);
+  if (isHourly)
+  {
+    // the frames are a fraction of a second apart, so a time going back
+    // by more than half an hour means that the timestamp has wrapped
+    static const double hourInMicroseconds = 3600.0 * 1e6;
+    if (this->LastHourlyFrameTime >= 0 && time < this->LastHourlyFrameTime - 0.5 * hourInMicroseconds)
+    {
+      this->HourlyFrameTimeOffset += hourInMicroseconds;
+    }
+    this->LastHourlyFrameTime = time;
+    time += this->HourlyFrameTimeOffset;
+  }
+  return time * 1e-6;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::AppendFrameStatistics(double totalTime)
+{
+  SetStatistic(this->FrameStatistics, "Time: Total", totalTime);
+
+  // add the columns of the statistics that appear for the first time,
+  // the previous frames have no value for them
+  vtkIdType row = this->Statistics->GetNumberOfRows();
+  for (const auto& statistic : this->FrameStatistics.Values)
+  {
+    vtkDoubleArray*& column = this->StatisticsColumns[statistic.first];
+    if (!column)
+    {
+      vtkSmartPointer<vtkDoubleArray> newColumn = vtkSmartPointer<vtkDoubleArray>::New();
+      newColumn->SetName(statistic.first.c_str());
+      newColumn->SetNumberOfTuples(row);
+      newColumn->FillComponent(0, vtkMath::Nan());
+      this->Statistics->AddColumn(newColumn);
+      column = newColumn;
+    }
+  }
+  for (vtkIdType col = 0; col < this->Statistics->GetNumberOfColumns(); ++col)
+  {
+    static_cast<vtkDoubleArray*>(this->Statistics->GetColumn(col))->InsertNextValue(vtkMath::Nan());
+  }
+  for (const auto& statistic : this->FrameStatistics.Values)
+  {
+    this->StatisticsColumns[statistic.first]->SetValue(row, statistic.second);
+  }
+
+  if (this->StatisticsLog.is_open())
+  {
+    this->StatisticsLog << "{";
+    const auto& values = this->FrameStatistics.Values;
+    for (size_t k = 0; k < values.size(); ++k)
+    {
+      this->StatisticsLog << (k > 0 ? ", " : "") << "\"" << values[k].first << "\": ";
+      if (std::isfinite(values[k].second))
+      {
+        this->StatisticsLog << values[k].second;
+      }
+      else
+      {
+        this->StatisticsLog << "null";
+      }
+    }
+    this->StatisticsLog << "}" << std::endl;
+  }
+
+  if (this->Verbose)
+  {
+    std::cout << "========== Statistics ==========" << std::endl;
+    for (const auto& statistic : this->FrameStatistics.Values)
+    {
+      std::cout << "  " << statistic.first << " : " << statistic.second << std::endl;
+    }
+    std::cout << std::endl;
+  }
+
+  ClearStatistics(this->FrameStatistics);
 }
 
 //-----------------------------------------------------------------------------
@@ -1653,9 +2203,9 @@ void vtkSlam::SetKeyPointsLabels(vtkSmartPointer<vtkPolyData> vtkNotUsed(input))
   this->PlanarPointRejectionMapping.clear(); this->PlanarPointRejectionMapping.resize(this->CurrentPlanarsPoints->size());
 
   // keypoints extraction informations
-  std::cout << "Extracted Edges: " << this->CurrentEdgesPoints->size() << " Planars: "
-            << this->CurrentPlanarsPoints->size() << " Blobs: "
-            << this->CurrentBlobsPoints->size() << std::endl;
+  SetStatistic(this->FrameStatistics, "Keypoints: edges", this->CurrentEdgesPoints->size());
+  SetStatistic(this->FrameStatistics, "Keypoints: planars", this->CurrentPlanarsPoints->size());
+  SetStatistic(this->FrameStatistics, "Keypoints: blobs", this->CurrentBlobsPoints->size());
 }
 
 //-----------------------------------------------------------------------------
@@ -2307,12 +2857,17 @@ void vtkSlam::ComputeEgoMotion()
   kdtreePreviousPlanes->setInputCloud(this->PreviousPlanarsPoints);
   kdtreePreviousBlobs->setInputCloud(this->PreviousBlobsPoints);
 
-  std::cout << "========== Ego-Motion ==========" << std::endl;
-  std::cout << "previous <-> current edges : " << this->PreviousEdgesPoints->size() << " <-> " << this->CurrentEdgesPoints->size()
-            << "previous <-> current planes : " << this->PreviousPlanarsPoints->size() << " <-> " << this->CurrentPlanarsPoints->size() << std::endl;
+  if (this->Verbose)
+  {
+    std::cout << "========== Ego-Motion ==========" << std::endl;
+  }
+  SetStatistic(this->FrameStatistics, "EgoMotion: previous edges", this->PreviousEdgesPoints->size());
+  SetStatistic(this->FrameStatistics, "EgoMotion: previous planes", this->PreviousPlanarsPoints->size());
 
   unsigned int usedEdges = 0;
   unsigned int usedPlanes = 0;
+  unsigned int icpIterations = 0;
+  unsigned int lmIterations = 0;
   Point currentPoint, transformedPoint;
 
   // ICP - Levenberg-Marquardt loop:
@@ -2322,6 +2877,8 @@ void vtkSlam::ComputeEgoMotion()
   // function using a Levenberg-Marquardt algorithm
   for (unsigned int icpCount = 0; icpCount < this->EgoMotionICPMaxIter; ++icpCount)
   {
+    icpIterations++;
+
     // Rotation and translation at this step
     Eigen::Matrix3d R = GetRotationMatrix(this->Trelative);
     Eigen::Vector3d T;
@@ -2414,7 +2971,12 @@ void vtkSlam::ComputeEgoMotion()
 
     ceres::Solver::Summary summary;
     ceres::Solve(options, &problem, &summary);
-    std::cout << summary.BriefReport() << std::endl;
+    lmIterations += summary.iterations.size();
+    SetStatistic(this->FrameStatistics, "EgoMotion: final cost", summary.final_cost);
+    if (this->Verbose)
+    {
+      std::cout << summary.BriefReport() << std::endl;
+    }
 
     // If no L-M iteration has been made since the
     // last ICP matching it means we reached a local
@@ -2426,13 +2988,16 @@ void vtkSlam::ComputeEgoMotion()
   }
 
   // Provide information about keypoints-neighborhood matching rejections
-  this->RejectionInformationDisplay();
+  this->RejectionInformationDisplay("EgoMotion");
 
   static_cast<vtkIntArray*>(this->Trajectory->GetPointData()->GetArray("EgoMotion: edges used"))->InsertNextValue(usedEdges);
   static_cast<vtkIntArray*>(this->Trajectory->GetPointData()->GetArray("EgoMotion: planes used"))->InsertNextValue(usedPlanes);
   static_cast<vtkIntArray*>(this->Trajectory->GetPointData()->GetArray("EgoMotion: total keypoints used"))->InsertNextValue(this->Xvalues.size());
-  std::cout << "used keypoints : " << this->Xvalues.size() << std::endl;
-  std::cout << "edges : " << usedEdges << " planes : " << usedPlanes << std::endl;
+  SetStatistic(this->FrameStatistics, "EgoMotion: edges used", usedEdges);
+  SetStatistic(this->FrameStatistics, "EgoMotion: planes used", usedPlanes);
+  SetStatistic(this->FrameStatistics, "EgoMotion: total keypoints used", this->Xvalues.size());
+  SetStatistic(this->FrameStatistics, "EgoMotion: ICP iterations", icpIterations);
+  SetStatistic(this->FrameStatistics, "EgoMotion: LM iterations", lmIterations);
 
   // Integrate the relative motion
   // to the world transformation
@@ -2452,34 +3017,51 @@ void vtkSlam::Mapping()
     return;
   }
 
-  // contruct kd-tree for fast search
-  pcl::KdTreeFLANN<Point>::Ptr kdtreeEdges(new pcl::KdTreeFLANN<Point>());
-  pcl::KdTreeFLANN<Point>::Ptr kdtreePlanes(new pcl::KdTreeFLANN<Point>());
-  pcl::KdTreeFLANN<Point>::Ptr kdtreeBlobs(new pcl::KdTreeFLANN<Point>());
-
   // Set the FarestPoint to reduce the map to the minimun since
   this->SetLidarMaximunRange(this->FarestKeypointDist);
 
-  pcl::PointCloud<Point>::Ptr subEdgesPointsLocalMap = this->EdgesPointsLocalMap->Get(this->Tworld);
-  pcl::PointCloud<Point>::Ptr subPlanarPointsLocalMap = this->PlanarPointsLocalMap->Get(this->Tworld);
+  if (this->Verbose)
+  {
+    std::cout << "========== Mapping ==========" << std::endl;
+  }
 
-  std::cout << "========== Mapping ==========" << std::endl;
-  std::cout << "Edges extracted from map: " << subEdgesPointsLocalMap->points.size()
-            << "Planes extracted from map: " << subPlanarPointsLocalMap->points.size() << std::endl;
+  // contruct kd-tree for fast search. A frozen map does not change,
+  // so its kd-trees are kept while the sensor stays in the same region
+  const std::array<int, 4> mapRegion = this->EdgesPointsLocalMap->GetRegion(this->Tworld);
+  if (!this->IsMapFrozen() || !this->FrozenMapCacheValid || mapRegion != this->FrozenMapRegion ||
+      (!this->FastSlam && !this->MappingKdTreeBlobs->getInputCloud()))
+  {
+    this->MappingKdTreeEdges.reset(new pcl::KdTreeFLANN<Point>());
+    this->MappingKdTreePlanes.reset(new pcl::KdTreeFLANN<Point>());
+    this->MappingKdTreeBlobs.reset(new pcl::KdTreeFLANN<Point>());
 
-  kdtreeEdges->setInputCloud(subEdgesPointsLocalMap);
-  kdtreePlanes->setInputCloud(subPlanarPointsLocalMap);
+    this->MappingKdTreeEdges->setInputCloud(this->EdgesPointsLocalMap->Get(this->Tworld));
+    this->MappingKdTreePlanes->setInputCloud(this->PlanarPointsLocalMap->Get(this->Tworld));
+    if (!this->FastSlam)
+    {
+      this->MappingKdTreeBlobs->setInputCloud(this->BlobsPointsLocalMap->Get(this->Tworld));
+    }
+    this->FrozenMapRegion = mapRegion;
+    this->FrozenMapCacheValid = this->IsMapFrozen();
+  }
+  pcl::KdTreeFLANN<Point>::Ptr kdtreeEdges = this->MappingKdTreeEdges;
+  pcl::KdTreeFLANN<Point>::Ptr kdtreePlanes = this->MappingKdTreePlanes;
+  pcl::KdTreeFLANN<Point>::Ptr kdtreeBlobs = this->MappingKdTreeBlobs;
+  pcl::PointCloud<Point>::ConstPtr subEdgesPointsLocalMap = kdtreeEdges->getInputCloud();
+  pcl::PointCloud<Point>::ConstPtr subPlanarPointsLocalMap = kdtreePlanes->getInputCloud();
 
+  SetStatistic(this->FrameStatistics, "Mapping: map edges", subEdgesPointsLocalMap->points.size());
+  SetStatistic(this->FrameStatistics, "Mapping: map planes", subPlanarPointsLocalMap->points.size());
   if (!this->FastSlam)
   {
-    pcl::PointCloud<Point>::Ptr subBlobPointsLocalMap = this->BlobsPointsLocalMap->Get(this->Tworld);
-    kdtreeBlobs->setInputCloud(subBlobPointsLocalMap);
-    std::cout << "blobs map : " << subBlobPointsLocalMap->points.size() << std::endl;
+    SetStatistic(this->FrameStatistics, "Mapping: map blobs", kdtreeBlobs->getInputCloud()->points.size());
   }
 
   unsigned int usedEdges = 0;
   unsigned int usedPlanes = 0;
   unsigned int usedBlobs = 0;
+  unsigned int icpIterations = 0;
+  unsigned int lmIterations = 0;
   Point currentPoint;
   Eigen::MatrixXd estimatorCovariance(6, 6);
 
@@ -2490,6 +3072,8 @@ void vtkSlam::Mapping()
   // function using a Levenberg-Marquardt algorithm
   for (unsigned int icpCount = 0; icpCount < this->MappingICPMaxIter; ++icpCount)
   {
+    icpIterations++;
+
     // clear all keypoints matching data
     this->ResetDistanceParameters();
 
@@ -2551,7 +3135,6 @@ void vtkSlam::Mapping()
     if ((usedPlanes + usedEdges + usedBlobs) < 20)
     {
       vtkGenericWarningMacro("Too few geometric features, loop breaked");
-      std::cout << "planes: " << usedPlanes << " edges: " << usedEdges << " Blobs: " << usedBlobs << std::endl;
       break;
     }
 
@@ -2591,7 +3174,12 @@ void vtkSlam::Mapping()
 
     ceres::Solver::Summary summary;
     ceres::Solve(options, &problem, &summary);
-    std::cout << summary.BriefReport() << std::endl;
+    lmIterations += summary.iterations.size();
+    SetStatistic(this->FrameStatistics, "Mapping: final cost", summary.final_cost);
+    if (this->Verbose)
+    {
+      std::cout << summary.BriefReport() << std::endl;
+    }
 
     // If no L-M iteration has been made since the
     // last ICP matching it means we reached a local
@@ -2621,7 +3209,7 @@ void vtkSlam::Mapping()
   }
 
   // Provide information about keypoints-neighborhood matching rejections
-  this->RejectionInformationDisplay();
+  this->RejectionInformationDisplay("Mapping");
 
   Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(estimatorCovariance);
   Eigen::MatrixXd D = eig.eigenvalues();
@@ -2632,10 +3220,17 @@ void vtkSlam::Mapping()
   static_cast<vtkIntArray*>(this->Trajectory->GetPointData()->GetArray("Mapping: blobs used"))->InsertNextValue(usedBlobs);
   static_cast<vtkIntArray*>(this->Trajectory->GetPointData()->GetArray("Mapping: total keypoints used"))->InsertNextValue(this->Xvalues.size());
 
-  std::cout << "Matches used: Total: " << this->Xvalues.size()
-            << " edges: " << usedEdges << " planes: " << usedPlanes << " blobs: " << usedBlobs << std::endl;
-  std::cout << "Covariance Eigen values: " << D.transpose() << std::endl;
-  std::cout << "Maximum variance: " << D(5) << std::endl;
+  SetStatistic(this->FrameStatistics, "Mapping: edges used", usedEdges);
+  SetStatistic(this->FrameStatistics, "Mapping: planes used", usedPlanes);
+  SetStatistic(this->FrameStatistics, "Mapping: blobs used", usedBlobs);
+  SetStatistic(this->FrameStatistics, "Mapping: total keypoints used", this->Xvalues.size());
+  SetStatistic(this->FrameStatistics, "Mapping: ICP iterations", icpIterations);
+  SetStatistic(this->FrameStatistics, "Mapping: LM iterations", lmIterations);
+  SetStatistic(this->FrameStatistics, "Mapping: maximum variance", D(5));
+  if (this->Verbose)
+  {
+    std::cout << "Covariance Eigen values: " << D.transpose() << std::endl;
+  }
 
   // Add the current computed transform to the list
   this->TworldList.push_back(this->Tworld);
@@ -2650,6 +3245,12 @@ void vtkSlam::Mapping()
 //-----------------------------------------------------------------------------
 void vtkSlam::UpdateMapsUsingTworld()
 {
+  // In localization only mode the map is not modified
+  if (this->IsMapFrozen())
+  {
+    return;
+  }
+
   // Init the mapping interpolator
   if (this->Undistortion)
   {
@@ -2690,6 +3291,309 @@ void vtkSlam::UpdateMapsUsingTworld()
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkSlam::UpdatePoseGraph()
+{
+  // A frozen map can not be corrected
+  if (this->IsMapFrozen())
+  {
+    return;
+  }
+
+  ScopedTimer timer(this->FrameStatistics, "Time: Loop closure");
+
+  // The frames registered while the loop closure was disabled are not
+  // attached to keyframes, so restart the pose graph from the current frame
+  const vtkIdType nbTrajectoryPoints = this->Trajectory->GetNumberOfPoints();
+  if (nbTrajectoryPoints > this->TrajectoryKeyframesStart + static_cast<vtkIdType>(this->TrajectoryKeyframes.size()) + 1)
+  {
+    this->ResetPoseGraph(nbTrajectoryPoints - 1);
+  }
+
+  // Number of keyframes after a loop closure before looking for another one
+  const int loopClosureCooldown = 10;
+  // Number of candidates registered
+  const size_t maxCandidates = 3;
+
+  const Eigen::Isometry3d pose = PoseToIsometry(this->Tworld);
+  int nbKeyframes = this->KeyframesGraph.GetNumberOfKeyframes();
+  const bool isKeyframe = nbKeyframes == 0 ||
+    (pose.translation() - this->KeyframesGraph.GetPose(nbKeyframes - 1).translation()).norm() > this->KeyframeDistance;
+
+  if (isKeyframe)
+  {
+    // Keep the keypoints at full resolution, undistorted as when they were
+    // added to the maps, in the coordinate system of the keyframe. The maps
+    // rebuilt after a loop closure are downsampled by the rolling grids as
+    // usual, so they do not get sparser with each loop closure
+    const Eigen::Matrix4f worldToKeyframe = pose.inverse().matrix().cast<float>();
+    auto toKeyframe = [&](pcl::PointCloud<Point>::Ptr keypoints) -> pcl::PointCloud<Point>::Ptr
+    {
+      pcl::PointCloud<Point>::Ptr worldPoints(new pcl::PointCloud<Point>());
+      for (unsigned int i = 0; i < keypoints->size(); ++i)
+      {
+        worldPoints->push_back(keypoints->at(i));
+        this->TransformToWorld(worldPoints->back());
+      }
+      pcl::PointCloud<Point>::Ptr keyframePoints(new pcl::PointCloud<Point>());
+      pcl::transformPointCloud(*worldPoints, *keyframePoints, worldToKeyframe);
+      return keyframePoints;
+    };
+    this->KeyframesEdges.push_back(toKeyframe(this->CurrentEdgesPoints));
+    this->KeyframesPlanars.push_back(toKeyframe(this->CurrentPlanarsPoints));
+
+    ScanContext descriptor;
+    descriptor.Compute(*this->pclCurrentFrame, std::max(this->FarestKeypointDist, 1.));
+    this->KeyframesGraph.AddKeyframe(pose, descriptor);
+    nbKeyframes++;
+  }
+
+  // Attach the trajectory point of this frame to the last keyframe
+  if (nbTrajectoryPoints > this->TrajectoryKeyframesStart + static_cast<vtkIdType>(this->TrajectoryKeyframes.size()))
+  {
+    this->TrajectoryKeyframes.push_back(nbKeyframes - 1);
+    this->TrajectoryRelativePoses.push_back(this->KeyframesGraph.GetPose(nbKeyframes - 1).inverse() * pose);
+  }
+  SetStatistic(this->FrameStatistics, "Loop closure: keyframes", nbKeyframes);
+
+  const int keyframe = nbKeyframes - 1;
+  if (!isKeyframe ||
+      (this->LastLoopClosureKeyframe >= 0 && keyframe - this->LastLoopClosureKeyframe < loopClosureCooldown))
+  {
+    return;
+  }
+
+  std::vector<PoseGraph::LoopCandidate> candidates = this->KeyframesGraph.FindLoopCandidates(
+    keyframe, this->LoopClosureMinKeyframeGap, this->LoopClosureDescriptorThreshold, maxCandidates);
+  SetStatistic(this->FrameStatistics, "Loop closure: candidates", candidates.size());
+
+  for (const PoseGraph::LoopCandidate& candidate : candidates)
+  {
+    Eigen::Isometry3d relativePose;
+    if (this->RegisterLoopClosure(keyframe, candidate, relativePose))
+    {
+      this->KeyframesGraph.AddLoopClosure(candidate.Keyframe, keyframe, relativePose);
+      this->LastLoopClosureKeyframe = keyframe;
+      if (this->Verbose)
+      {
+        std::cout << "Loop closure between keyframes " << candidate.Keyframe << " and " << keyframe << std::endl;
+      }
+
+      {
+        ScopedTimer optimizationTimer(this->FrameStatistics, "Time: Pose graph optimization");
+        this->KeyframesGraph.Optimize(100);
+      }
+      this->ApplyPoseGraphCorrection();
+      break;
+    }
+  }
+  SetStatistic(this->FrameStatistics, "Loop closure: total", this->KeyframesGraph.GetNumberOfLoopClosures());
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::ResetPoseGraph(vtkIdType firstTrajectoryPoint)
+{
+  this->KeyframesGraph.Reset();
+  this->KeyframesEdges.clear();
+  this->KeyframesPlanars.clear();
+  this->TrajectoryKeyframes.clear();
+  this->TrajectoryRelativePoses.clear();
+  this->TrajectoryKeyframesStart = firstTrajectoryPoint;
+  this->LastLoopClosureKeyframe = -1;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlam::RegisterLoopClosure(int keyframe, const PoseGraph::LoopCandidate& candidate,
+                                  Eigen::Isometry3d& relativePose)
+{
+  // Number of keyframes on each side of the candidate used to build the map
+  const int submapHalfSize = 5;
+
+  // Build the map around the candidate, in world coordinates
+  pcl::PointCloud<Point>::Ptr mapEdges(new pcl::PointCloud<Point>());
+  pcl::PointCloud<Point>::Ptr mapPlanars(new pcl::PointCloud<Point>());
+  const int lastMapKeyframe = std::min(candidate.Keyframe + submapHalfSize, keyframe - this->LoopClosureMinKeyframeGap);
+  for (int k = std::max(0, candidate.Keyframe - submapHalfSize); k <= lastMapKeyframe; ++k)
+  {
+    const Eigen::Matrix4f keyframeToWorld = this->KeyframesGraph.GetPose(k).matrix().cast<float>();
+    pcl::PointCloud<Point> points;
+    pcl::transformPointCloud(*this->KeyframesEdges[k], points, keyframeToWorld);
+    *mapEdges += points;
+    pcl::transformPointCloud(*this->KeyframesPlanars[k], points, keyframeToWorld);
+    *mapPlanars += points;
+  }
+  if (mapEdges->size() <= 10 || mapPlanars->size() <= 10)
+  {
+    return false;
+  }
+
+  pcl::KdTreeFLANN<Point>::Ptr kdtreeEdges(new pcl::KdTreeFLANN<Point>());
+  pcl::KdTreeFLANN<Point>::Ptr kdtreePlanes(new pcl::KdTreeFLANN<Point>());
+  kdtreeEdges->setInputCloud(mapEdges);
+  kdtreePlanes->setInputCloud(mapPlanars);
+
+  // The initial guess is the candidate pose, rotated by the yaw
+  // found when comparing the descriptors
+  const Eigen::Isometry3d initialPose = this->KeyframesGraph.GetPose(candidate.Keyframe)
+    * Eigen::AngleAxisd(ScanContext::ShiftToYaw(candidate.Shift), Eigen::Vector3d::UnitZ());
+  Eigen::Matrix<double, 6, 1> T = IsometryToPose(initialPose);
+
+  // The keyframes keypoints are already undistorted
+  const bool undistortion = this->Undistortion;
+  this->Undistortion = false;
+
+  // The matching resets the rejection histograms: keep the ones of the
+  // mapping of the current frame aside and count the loop closure apart
+  std::vector<double> mappingRejectionsLine, mappingRejectionsPlane, mappingRejectionsBlob;
+  std::swap(mappingRejectionsLine, this->MatchRejectionHistogramLine);
+  std::swap(mappingRejectionsPlane, this->MatchRejectionHistogramPlane);
+  std::swap(mappingRejectionsBlob, this->MatchRejectionHistogramBlob);
+  this->ResetDistanceParameters();
+
+  // Same ICP - Levenberg-Marquardt loop as the mapping
+  const pcl::PointCloud<Point>::Ptr& edges = this->KeyframesEdges[keyframe];
+  const pcl::PointCloud<Point>::Ptr& planars = this->KeyframesPlanars[keyframe];
+  for (unsigned int icpCount = 0; icpCount < this->MappingICPMaxIter; ++icpCount)
+  {
+    this->ResetDistanceParameters();
+    Eigen::Matrix3d R = GetRotationMatrix(T);
+    Eigen::Vector3d dT = T.tail(3);
+    for (unsigned int k = 0; k < edges->size(); ++k)
+    {
+      int rejectionIndex = this->ComputeLineDistanceParameters(kdtreeEdges, R, dT, edges->points[k], "mapping");
+      this->MatchRejectionHistogramLine[rejectionIndex] += 1;
+    }
+    for (unsigned int k = 0; k < planars->size(); ++k)
+    {
+      int rejectionIndex = this->ComputePlaneDistanceParameters(kdtreePlanes, R, dT, planars->points[k], "mapping");
+      this->MatchRejectionHistogramPlane[rejectionIndex] += 1;
+    }
+    if (this->Xvalues.size() < 20)
+    {
+      break;
+    }
+
+    ceres::Problem problem;
+    for (unsigned int k = 0; k < this->Xvalues.size(); ++k)
+    {
+      ceres::CostFunction* cost_function = new ceres::AutoDiffCostFunction<CostFunctions::MahalanobisDistanceAffineIsometryResidual, 1, 6>(
+                                           new CostFunctions::MahalanobisDistanceAffineIsometryResidual(this->Avalues[k], this->Pvalues[k],
+                                                                                                        this->Xvalues[k], this->residualCoefficient[k]));
+      problem.AddResidualBlock(cost_function, new ceres::ArctanLoss(2.0), T.data());
+    }
+
+    ceres::Solver::Options options;
+    options.max_num_iterations = this->MappingLMMaxIter;
+    options.linear_solver_type = ceres::DENSE_QR;
+    options.minimizer_progress_to_stdout = false;
+    ceres::Solver::Summary summary;
+    ceres::Solve(options, &problem, &summary);
+
+    if (summary.num_successful_steps == 1)
+    {
+      break;
+    }
+  }
+  this->Undistortion = undistortion;
+
+  // Evaluate the registration with the matches of the final pose
+  const size_t nbKeypoints = edges->size() + planars->size();
+  const size_t nbMatches = this->Xvalues.size();
+  const Eigen::Matrix3d R = GetRotationMatrix(T);
+  const Eigen::Vector3d dT = T.tail(3);
+  double meanDistance = 0;
+  for (size_t k = 0; k < nbMatches; ++k)
+  {
+    const Eigen::Vector3d Y = R * this->Xvalues[k] + dT - this->Pvalues[k];
+    meanDistance += std::sqrt(Y.dot(this->Avalues[k] * Y));
+  }
+  meanDistance = nbMatches > 0 ? meanDistance / nbMatches : std::numeric_limits<double>::infinity();
+  this->RejectionInformationDisplay("Loop closure");
+  this->ResetDistanceParameters();
+  std::swap(mappingRejectionsLine, this->MatchRejectionHistogramLine);
+  std::swap(mappingRejectionsPlane, this->MatchRejectionHistogramPlane);
+  std::swap(mappingRejectionsBlob, this->MatchRejectionHistogramBlob);
+
+  SetStatistic(this->FrameStatistics, "Loop closure: matched ratio", nbKeypoints > 0 ? static_cast<double>(nbMatches) / nbKeypoints : 0);
+  SetStatistic(this->FrameStatistics, "Loop closure: mean distance", meanDistance);
+
+  if (nbMatches < 20 || nbMatches < 0.5 * nbKeypoints || meanDistance > this->LoopClosureMaxDistance)
+  {
+    return false;
+  }
+  relativePose = this->KeyframesGraph.GetPose(candidate.Keyframe).inverse() * PoseToIsometry(T);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::ApplyPoseGraphCorrection()
+{
+  // Trajectory
+  vtkDataArray* orientations = this->Trajectory->GetOrientationArray();
+  vtkDataArray* positions = this->Trajectory->GetTranslationArray();
+  for (size_t i = 0; i < this->TrajectoryKeyframes.size(); ++i)
+  {
+    const Eigen::Isometry3d pose = this->KeyframesGraph.GetPose(this->TrajectoryKeyframes[i]) * this->TrajectoryRelativePoses[i];
+    const Eigen::Matrix<double, 6, 1> T = IsometryToPose(pose);
+    // same orientation as the one pushed when the frame was registered
+    Eigen::AngleAxisd orientation = Eigen::AngleAxisd(
+        Eigen::AngleAxisd(T[0], Eigen::Vector3d::UnitX())
+        * Eigen::AngleAxisd(T[1],  Eigen::Vector3d::UnitY())
+        * Eigen::AngleAxisd(T[2], Eigen::Vector3d::UnitZ()));
+    const vtkIdType pointId = this->TrajectoryKeyframesStart + i;
+    orientations->SetTuple4(pointId, orientation.axis()[0], orientation.axis()[1], orientation.axis()[2], orientation.angle());
+    positions->SetTuple3(pointId, T[3], T[4], T[5]);
+  }
+  orientations->Modified();
+  positions->Modified();
+  this->Trajectory->Modified();
+
+  // Current pose: the current frame is the last keyframe
+  const int lastKeyframe = this->KeyframesGraph.GetNumberOfKeyframes() - 1;
+  const Eigen::Isometry3d previousPose = PoseToIsometry(this->Tworld);
+  this->Tworld = IsometryToPose(this->KeyframesGraph.GetPose(lastKeyframe));
+  this->PreviousTworld = this->Tworld;
+  const Eigen::Isometry3d correction = PoseToIsometry(this->Tworld) * previousPose.inverse();
+
+  // Edges and planars maps are rebuilt from the keyframes around the sensor,
+  // the blobs map is only moved by the correction of the current pose. Only
+  // the keypoints of the keyframes are kept, so the rebuilt maps lack the
+  // contribution of the frames in between, which the next frames fill again
+  const double radius = 2 * std::max(this->FarestKeypointDist, 1.);
+  pcl::PointCloud<Point>::Ptr mapEdges(new pcl::PointCloud<Point>());
+  pcl::PointCloud<Point>::Ptr mapPlanars(new pcl::PointCloud<Point>());
+  for (int k = 0; k <= lastKeyframe; ++k)
+  {
+    const Eigen::Isometry3d& pose = this->KeyframesGraph.GetPose(k);
+    if ((pose.translation() - this->Tworld.tail(3)).norm() > radius)
+    {
+      continue;
+    }
+    pcl::PointCloud<Point> points;
+    pcl::transformPointCloud(*this->KeyframesEdges[k], points, pose.matrix().cast<float>());
+    *mapEdges += points;
+    pcl::transformPointCloud(*this->KeyframesPlanars[k], points, pose.matrix().cast<float>());
+    *mapPlanars += points;
+  }
+  pcl::PointCloud<Point>::Ptr mapBlobs(new pcl::PointCloud<Point>());
+  pcl::transformPointCloud(*this->BlobsPointsLocalMap->Get(), *mapBlobs, correction.matrix().cast<float>());
+
+  auto rebuild = [this](std::shared_ptr<RollingGrid>& map, pcl::PointCloud<Point>::Ptr points)
+  {
+    map->Clear();
+    map->Roll(this->Tworld);
+    if (!points->empty())
+    {
+      map->Add(points);
+    }
+  };
+  rebuild(this->EdgesPointsLocalMap, mapEdges);
+  rebuild(this->PlanarPointsLocalMap, mapPlanars);
+  rebuild(this->BlobsPointsLocalMap, mapBlobs);
+
+  this->Modified();
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlam::FillMappingInfoArrayWithDefaultValues()
 {
@@ -2886,6 +3790,103 @@ void vtkSlam::UpdateTworldUsingTrelative()
   this->Tworld(5) = newTw(2);
 }
 
+//-----------------------------------------------------------------------------
+void vtkSlam::SetInitialPose(double rx, double ry, double rz, double x, double y, double z)
+{
+  const double pose[6] = { rx, ry, rz, x, y, z };
+  if (!std::equal(pose, pose + 6, this->InitialPose))
+  {
+    std::copy(pose, pose + 6, this->InitialPose);
+    this->Modified();
+    this->ParametersModificationTime.Modified();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlam::SaveMaps(const std::string& filename)
+{
+  std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    vtkErrorMacro("Could not open the map file: " << filename);
+    return false;
+  }
+
+  const SlamMapBinaryHeader header = SlamMapBinaryFormat::CreateHeader(SlamMapBinaryFormat::NumberOfMapTypes, this->Tworld.data());
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  this->EdgesPointsLocalMap->Write(file, SlamMapBinaryFormat::EdgesMap);
+  this->PlanarPointsLocalMap->Write(file, SlamMapBinaryFormat::PlanarsMap);
+  this->BlobsPointsLocalMap->Write(file, SlamMapBinaryFormat::BlobsMap);
+  if (!file.good())
+  {
+    vtkErrorMacro("Could not write the map file: " << filename);
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void vtkSlam::SaveMaps()
+{
+  if (this->SaveMapsFileName.empty())
+  {
+    vtkErrorMacro("No file name given to save the maps");
+    return;
+  }
+  this->SaveMaps(this->SaveMapsFileName);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkSlam::LoadMaps(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file.is_open())
+  {
+    vtkErrorMacro("Could not open the map file: " << filename);
+    return false;
+  }
+
+  SlamMapBinaryHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !SlamMapBinaryFormat::IsValid(header))
+  {
+    vtkErrorMacro(<< filename << " is not a map file of this version, or was written on a machine with another byte order");
+    return false;
+  }
+
+  // The current maps are only replaced if the whole file is valid
+  std::vector<std::shared_ptr<RollingGrid> > maps(SlamMapBinaryFormat::NumberOfMapTypes);
+  for (uint32_t i = 0; i < header.NumberOfMaps; ++i)
+  {
+    auto map = std::make_shared<RollingGrid>();
+    uint32_t mapType;
+    if (!map->Read(file, mapType))
+    {
+      vtkErrorMacro("Could not read the map file: " << filename);
+      return false;
+    }
+    if (mapType < maps.size())
+    {
+      maps[mapType] = map;
+    }
+  }
+  if (!maps[SlamMapBinaryFormat::EdgesMap] || !maps[SlamMapBinaryFormat::PlanarsMap])
+  {
+    vtkErrorMacro(<< filename << " has no edges or planars map");
+    return false;
+  }
+
+  this->EdgesPointsLocalMap = maps[SlamMapBinaryFormat::EdgesMap];
+  this->PlanarPointsLocalMap = maps[SlamMapBinaryFormat::PlanarsMap];
+  if (maps[SlamMapBinaryFormat::BlobsMap])
+  {
+    this->BlobsPointsLocalMap = maps[SlamMapBinaryFormat::BlobsMap];
+  }
+  this->HasPriorMap = true;
+  this->FrozenMapCacheValid = false;
+  this->Modified();
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 void vtkSlam::SetVoxelGridLeafSize(double size)
 {
@@ -2943,7 +3944,7 @@ void vtkSlam::UpdateLaserIdMapping(vtkTable *calib)
 }
 
 //-----------------------------------------------------------------------------
-void vtkSlam::RejectionInformationDisplay()
+void vtkSlam::RejectionInformationDisplay(const std::string& step)
 {
   double totalRejectionsLine = 0;
   double totalRejectionsPlane = 0;
@@ -2951,6 +3952,13 @@ void vtkSlam::RejectionInformationDisplay()
   {
     totalRejectionsLine += this->MatchRejectionHistogramLine[k];
     totalRejectionsPlane += this->MatchRejectionHistogramPlane[k];
+    SetStatistic(this->FrameStatistics, step + ": line rejection " + std::to_string(k), this->MatchRejectionHistogramLine[k]);
+    SetStatistic(this->FrameStatistics, step + ": plane rejection " + std::to_string(k), this->MatchRejectionHistogramPlane[k]);
+  }
+
+  if (!this->Verbose)
+  {
+    return;
   }
   std::cout << "Rejection frequencies lines: [";
   for (int k = 0; k < this->NrejectionCauses; ++k)
@@ -74,20 +74,27 @@
 // LOCAL
 #include "vtkPCLConversions.h"
 // STD
+#include <array>
+#include <chrono>
 #include <string>
 #include <ctime>
+#include <fstream>
+#include <unordered_map>
 // VTK
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkSmartPointer.h>
 #include <vtkNew.h>
 // EIGEN
 #include <Eigen/Dense>
+
+#include <boost/thread/thread.hpp>
 // PCL
 #include <pcl/point_types.h>
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/kdtree/kdtree_flann.h>
 
 #include "KalmanFilter.h"
+#include "PoseGraph.h"
 #include "vtkTemporalTransforms.h"
 
 // This custom macro is needed to make the SlamManager time agnostic
@@ -111,8 +118,16 @@ virtual void Set##name (type _arg) \
 class vtkVelodyneTransformInterpolator;
 class RollingGrid;
 class vtkTable;
+class vtkDoubleArray;
 typedef pcl::PointXYZINormal Point;
 
+// Named values in insertion order, along with the position of each name
+struct SlamStatistics
+{
+  std::vector<std::pair<std::string, double> > Values;
+  std::unordered_map<std::string, size_t> Index;
+};
+
 class VTK_EXPORT vtkSlam : public vtkPolyDataAlgorithm
 {
 public:
@@ -149,6 +164,53 @@ public:
   vtkSetMacro(Undistortion, bool)
   vtkGetMacro(Undistortion, bool)
 
+  // Get/Set Loop closure
+  vtkGetMacro(LoopClosure, bool)
+  vtkCustomSetMacro(LoopClosure, bool)
+
+  vtkGetMacro(KeyframeDistance, double)
+  vtkCustomSetMacro(KeyframeDistance, double)
+
+  vtkGetMacro(LoopClosureMinKeyframeGap, int)
+  vtkCustomSetMacro(LoopClosureMinKeyframeGap, int)
+
+  vtkGetMacro(LoopClosureDescriptorThreshold, double)
+  vtkCustomSetMacro(LoopClosureDescriptorThreshold, double)
+
+  vtkGetMacro(LoopClosureMaxDistance, double)
+  vtkCustomSetMacro(LoopClosureMaxDistance, double)
+
+  // Get/Set Instrumentation
+  vtkGetMacro(Verbose, bool)
+  vtkSetMacro(Verbose, bool)
+
+  vtkGetMacro(StatisticsFileName, std::string)
+  vtkSetMacro(StatisticsFileName, std::string)
+
+  // Save the keypoints maps, see SlamMapBinaryFormat.h. Only the
+  // voxel grids around the last pose are saved, not the whole trajectory
+  bool SaveMaps(const std::string& filename);
+
+  // Save the keypoints maps in SaveMapsFileName
+  void SaveMaps();
+
+  // Load keypoints maps saved by SaveMaps. They are used as a prior
+  // map: the next first frame is registered on them from InitialPose
+  bool LoadMaps(const std::string& filename);
+
+  // Get/Set Prior map
+  vtkGetMacro(SaveMapsFileName, std::string)
+  vtkSetMacro(SaveMapsFileName, std::string)
+
+  vtkGetMacro(InitialMapFileName, std::string)
+  vtkCustomSetMacro(InitialMapFileName, std::string)
+
+  vtkGetVector6Macro(InitialPose, double)
+  void SetInitialPose(double rx, double ry, double rz, double x, double y, double z);
+
+  vtkGetMacro(LocalizationOnly, bool)
+  vtkCustomSetMacro(LocalizationOnly, bool)
+
   // Set RollingGrid Parameters
   void SetVoxelGridLeafSize(double size);
   void SetVoxelGridSize(unsigned int size);
@@ -242,6 +304,7 @@ protected:
   ~vtkSlam();
 
   int FillInputPortInformation(int port, vtkInformation* info) override;
+  int FillOutputPortInformation(int port, vtkInformation* info) override;
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) override;
 
   // Keeps track of the time the parameters have been modified
@@ -249,6 +312,18 @@ protected:
   // MTime is a much more general mecanism so we can't rely on it
   vtkTimeStamp ParametersModificationTime;
 
+  // Fill the filter outputs with the last registered frame
+  void FillOutputs(vtkInformationVector* outputVector);
+
+  // Pipelined processing, set by the SlamManager: the keypoints of the
+  // input frame are extracted by a worker thread while the previous frame
+  // is registered. The pipeline is one frame deep, so the outputs lag one
+  // frame behind until it is flushed, and the results are the same as AddFrame
+  bool PipelineFrames = false;
+
+  // Register the frame still in the pipeline once the input frame is extracted
+  bool FlushPipelineAfterFrame = false;
+
 private:
   vtkSlam(const vtkSlam&);
   void operator = (const vtkSlam&);
@@ -453,9 +528,76 @@ private:
   int NrejectionCauses = 7;
   void ResetDistanceParameters();
 
-  // Display information about the keypoints - neighborhood
-  // mathching rejections
-  void RejectionInformationDisplay();
+  // Record (and display in verbose mode) information about
+  // the keypoints - neighborhood mathching rejections
+  void RejectionInformationDisplay(const std::string& step);
+
+  // Statistics of the frame being processed: elapsed time of each
+  // stage (in seconds) and counters (keypoints, matches, rejections...)
+  // stored by name in insertion order
+  SlamStatistics FrameStatistics;
+
+  // One row per processed frame and one column per statistic. The rows are
+  // only appended, so the table is shallow copied to the output
+  vtkSmartPointer<vtkTable> Statistics;
+  // Column of the Statistics table of each statistic name
+  std::unordered_map<std::string, vtkDoubleArray*> StatisticsColumns;
+
+  // Optional log of the statistics, one JSON object per line and frame
+  std::ofstream StatisticsLog;
+
+  // Append the statistics of the current frame to the
+  // Statistics table and to the log file
+  void AppendFrameStatistics(double totalTime);
+
+  // First stage of AddFrame: sort the scan lines and extract the
+  // keypoints. It only depends on the frame and on the keypoints
+  // parameters, so that it can run on another vtkSlam instance
+  void ExtractKeypoints(vtkPolyData* newFrame);
+
+  // Second stage of AddFrame: ego-motion and mapping of the extracted
+  // keypoints, update of the maps and of the trajectory
+  void RegisterFrame();
+
+  // Duration of the keypoints extraction of the current frame
+  double KeypointsExtractionTime = 0;
+
+  // Time of the first point of a frame in seconds. Without adjustedtime,
+  // the hourly timestamp array is unwrapped using the previous frames
+  double GetFrameTime(vtkPolyData* frame);
+  double LastHourlyFrameTime = -1;
+  double HourlyFrameTimeOffset = 0;
+
+  // Pipelined processing: launch the extraction of newFrame on the
+  // KeypointsExtractor and register the previously extracted frame
+  void StartPipelineStep(vtkPolyData* newFrame);
+
+  // Pipelined processing: wait for the extraction launched by
+  // StartPipelineStep and take its keypoints as the next frame to register
+  void FinishPipelineStep();
+
+  // Register the extracted frame left in the pipeline, if any
+  void FlushPipeline();
+
+  // Wait for the worker and discard the frame left in the pipeline
+  void StopPipeline();
+
+  // Copy the parameters used by ExtractKeypoints
+  void CopyKeypointsParameters(vtkSlam* extractor) const;
+
+  // Exchange the data of the current frame with the one of other
+  void SwapFrameData(vtkSlam* other);
+
+  // Instance extracting the keypoints of the next frame in the pipelined mode
+  vtkSmartPointer<vtkSlam> KeypointsExtractor;
+  boost::thread ExtractionThread;
+
+  // This instance holds the keypoints of a frame which is not registered yet
+  bool HasExtractedFrame = false;
+
+  // Occupancy measurement of the current pipeline step
+  std::chrono::steady_clock::time_point PipelineStepStart;
+  double RegistrationTime = 0;
 
   // Add a default point to the trajectories
   void AddDefaultPoint(double x, double y, double z, double rx, double ry, double rz, double t);
@@ -566,6 +708,88 @@ private:
   // world reference frame coordinate system
   void UpdateMapsUsingTworld();
 
+  // File where SaveMaps() writes the maps
+  std::string SaveMapsFileName;
+
+  // Maps loaded when the slam starts, empty to start with empty maps
+  std::string InitialMapFileName;
+
+  // Pose of the sensor on the prior map at the first frame
+  double InitialPose[6] = { 0., 0., 0., 0., 0., 0. };
+
+  // Only register the frames on the prior map, without updating it
+  bool LocalizationOnly = false;
+
+  // A prior map has been loaded
+  bool HasPriorMap = false;
+
+  // The maps are not updated in localization only mode
+  bool IsMapFrozen() const { return this->LocalizationOnly && this->HasPriorMap; }
+
+  // Kd-trees of the maps used by the last mapping step, kept on frozen maps
+  // while the region of the map around the sensor does not change
+  pcl::KdTreeFLANN<Point>::Ptr MappingKdTreeEdges;
+  pcl::KdTreeFLANN<Point>::Ptr MappingKdTreePlanes;
+  pcl::KdTreeFLANN<Point>::Ptr MappingKdTreeBlobs;
+  std::array<int, 4> FrozenMapRegion;
+  bool FrozenMapCacheValid = false;
+
+  // Loop closure: the keypoints of a frame are kept every KeyframeDistance
+  // meters, with a place recognition descriptor, as a keyframe of a pose
+  // graph. When a new keyframe looks like an old one, the loop is confirmed
+  // by registering its keypoints on the map around the old keyframe. The
+  // pose graph is then optimized and the trajectory and maps are corrected
+  bool LoopClosure = false;
+
+  // Distance travelled by the sensor between two keyframes
+  double KeyframeDistance = 5.0;
+
+  // Number of keyframes after which a keyframe can be part of a loop
+  int LoopClosureMinKeyframeGap = 50;
+
+  // Maximal descriptor distance, in [0, 1], of a loop closure candidate
+  double LoopClosureDescriptorThreshold = 0.25;
+
+  // Maximal mean distance between the keypoints of a loop closure
+  // candidate and the map around the old keyframe once registered
+  double LoopClosureMaxDistance = 0.1;
+
+  PoseGraph KeyframesGraph;
+
+  // Keypoints of each keyframe, in the keyframe coordinate system
+  std::vector<pcl::PointCloud<Point>::Ptr> KeyframesEdges;
+  std::vector<pcl::PointCloud<Point>::Ptr> KeyframesPlanars;
+
+  // Each point of the trajectory from TrajectoryKeyframesStart is stored
+  // relatively to the last keyframe before it, so that it follows the
+  // corrections of the keyframes poses
+  std::vector<int> TrajectoryKeyframes;
+  std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d> > TrajectoryRelativePoses;
+  vtkIdType TrajectoryKeyframesStart = 0;
+
+  // Keyframe of the last loop closure
+  int LastLoopClosureKeyframe = -1;
+
+  // Remove the keyframes, the trajectory points from firstTrajectoryPoint
+  // being attached to the next ones
+  void ResetPoseGraph(vtkIdType firstTrajectoryPoint);
+
+  // Add the current frame to the pose graph, look for a
+  // loop closure if it is a keyframe and correct the
+  // trajectory and the maps if one is found
+  void UpdatePoseGraph();
+
+  // Register the keypoints of keyframe on the map built from the keyframes
+  // around candidate. Return true if the registration is good enough to
+  // close the loop, relativePose being then the pose of keyframe in the
+  // coordinate system of the candidate
+  bool RegisterLoopClosure(int keyframe, const PoseGraph::LoopCandidate& candidate,
+                           Eigen::Isometry3d& relativePose);
+
+  // Apply the optimized keyframes poses to the trajectory, the current
+  // pose and the maps
+  void ApplyPoseGraphCorrection();
+
   // Display infos
   template<typename T, typename Tvtk>
   void AddVectorToPolydataPoints(const std::vector<std::vector<T>>& vec, const char* name, vtkPolyData* pd);
@@ -585,6 +809,14 @@ private:
   // the keypoints extracted, curvature etc
   bool DisplayMode = false;
 
+  // Print the statistics and the optimization reports
+  // of each processed frame on the standard output
+  bool Verbose = false;
+
+  // If not empty, the statistics of each processed frame are
+  // written in this file as JSON lines
+  std::string StatisticsFileName = "";
+
   // Identity matrix
   Eigen::Matrix3d I3 = Eigen::Matrix3d::Identity();
   Eigen::Matrix<double, 6, 6> I6 = Eigen::Matrix<double, 6, 6>::Identity();
@@ -34,6 +34,7 @@ void vtkSlamManager::PrintSelf(std::ostream &os, vtkIndent indent)
   PrintParameter(StartFrame)
   PrintParameter(EndFrame)
   PrintParameter(StepSize)
+  PrintParameter(Asynchronous)
   vtkIndent paramIndent = indent.GetNextIndent();
   this->Superclass::PrintSelf(os, paramIndent);
 }
@@ -92,7 +93,7 @@ int vtkSlamManager::RequestData(vtkInformation *request, vtkInformationVector **
     {
       for (int i = 0; i < this->GetNumberOfOutputPorts(); ++i)
       {
-        auto *output = vtkPolyData::GetData(outputVector->GetInformationObject(i));
+        auto *output = vtkDataObject::GetData(outputVector->GetInformationObject(i));
         output->ShallowCopy(this->Cache[i]);
       }
       return 1;
@@ -122,6 +123,8 @@ int vtkSlamManager::RequestData(vtkInformation *request, vtkInformationVector **
   this->UpdateProgress(progress);
 
   // process the frame
+  this->PipelineFrames = this->Asynchronous;
+  this->FlushPipelineAfterFrame = LastIteration;
   vtkSlam::RequestData(request, inputVector, outputVector);
 
   // save data to the cache at the end
@@ -130,8 +133,10 @@ int vtkSlamManager::RequestData(vtkInformation *request, vtkInformationVector **
     this->Cache.clear();
     for (int i = 0; i < this->GetNumberOfOutputPorts(); ++i)
     {
-      auto output = vtkSmartPointer<vtkPolyData>::New();
-      output->DeepCopy(vtkPolyData::GetData(outputVector->GetInformationObject(i)));
+      auto *data = vtkDataObject::GetData(outputVector->GetInformationObject(i));
+      vtkSmartPointer<vtkDataObject> output;
+      output.TakeReference(data->NewInstance());
+      output->DeepCopy(data);
       this->Cache.push_back(output);
     }
   }
@@ -47,6 +47,11 @@ public:
   vtkCustomSetMacro(AllFrame, bool)
   //! @}
 
+  //! @{ @copydoc Asynchronous
+  vtkGetMacro(Asynchronous, bool)
+  vtkSetMacro(Asynchronous, bool)
+  //! @}
+
 protected:
   vtkSlamManager();
   int RequestUpdateExtent(vtkInformation*,
@@ -69,6 +74,10 @@ protected:
   //! Process one frame every step size (ex: every frame, every 2 frame, 3 frame, ...)
   int StepSize = 1;
 
+  //! Extract the keypoints of a frame on a worker thread while the previous
+  //! frame is registered. The result is the same as the sequential processing
+  bool Asynchronous = false;
+
 private:
   vtkSlamManager(const vtkSlamManager&) = delete;
   void operator = (const vtkSlamManager&) = delete;
@@ -76,7 +85,7 @@ private:
   bool FirstIteration = true;
   int CurrentFrame = 0;
   vtkMTimeType LastModifyTime = 0;
-  std::vector<vtkSmartPointer<vtkPolyData>> Cache;
+  std::vector<vtkSmartPointer<vtkDataObject>> Cache;
 };
 
 #endif // VTKSLAMMANAGER_H
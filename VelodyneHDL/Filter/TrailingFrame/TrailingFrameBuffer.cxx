@@ -0,0 +1,329 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "TrailingFrameBuffer.h"
+#include "vtkVertexCells.h"
+
+#include <vtkDataArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+template <typename T>
+void ReadPoint(const T* data, double point[3])
+{
+  point[0] = static_cast<double>(data[0]);
+  point[1] = static_cast<double>(data[1]);
+  point[2] = static_cast<double>(data[2]);
+}
+
+//-----------------------------------------------------------------------------
+//! Arrays of the frame which are buffered: the named numeric arrays with one tuple per point
+std::vector<vtkDataArray*> GetBufferedArrays(vtkPolyData* frame)
+{
+  std::vector<vtkDataArray*> arrays;
+  vtkPointData* pointData = frame->GetPointData();
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i)
+  {
+    vtkDataArray* array = pointData->GetArray(i);
+    if (array && array->GetName() && array->GetDataType() != VTK_BIT &&
+        array->GetNumberOfTuples() == frame->GetNumberOfPoints())
+    {
+      arrays.push_back(array);
+    }
+  }
+  return arrays;
+}
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::Clear()
+{
+  this->Points = ArrayBuffer();
+  this->Arrays.clear();
+  this->Frames.clear();
+  this->Start = 0;
+  this->End = 0;
+  this->Voxels.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool TrailingFrameBuffer::MatchArrays(vtkPolyData* frame)
+{
+  vtkDataArray* points = frame->GetPoints()->GetData();
+  std::vector<vtkDataArray*> arrays = GetBufferedArrays(frame);
+
+  // the buffers have not been created yet
+  if (this->Points.TupleSize == 0)
+  {
+    auto createBuffer = [](vtkDataArray* array) {
+      ArrayBuffer buffer;
+      buffer.Name = array->GetName() ? array->GetName() : "";
+      buffer.DataType = array->GetDataType();
+      buffer.NumberOfComponents = array->GetNumberOfComponents();
+      buffer.TupleSize = static_cast<size_t>(array->GetDataTypeSize()) * buffer.NumberOfComponents;
+      return buffer;
+    };
+    this->Points = createBuffer(points);
+    this->Arrays.clear();
+    for (vtkDataArray* array : arrays)
+    {
+      this->Arrays.push_back(createBuffer(array));
+    }
+    return true;
+  }
+
+  auto matchBuffer = [](const ArrayBuffer& buffer, vtkDataArray* array) {
+    return buffer.DataType == array->GetDataType() &&
+           buffer.NumberOfComponents == array->GetNumberOfComponents() &&
+           buffer.Name == (array->GetName() ? array->GetName() : "");
+  };
+  if (!matchBuffer(this->Points, points) || arrays.size() != this->Arrays.size())
+  {
+    return false;
+  }
+  for (size_t i = 0; i < arrays.size(); ++i)
+  {
+    if (!matchBuffer(this->Arrays[i], arrays[i]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::Reserve(vtkIdType n)
+{
+  // move the live tuples to the front once the evicted ones outnumber them,
+  // so that each tuple is moved at most once per buffer length
+  const vtkIdType live = this->End - this->Start;
+  const bool compact = this->Start > 0 && this->Start >= live;
+
+  auto reserveBuffer = [&](ArrayBuffer& buffer) {
+    if (compact)
+    {
+      std::memmove(buffer.Data.data(), buffer.Data.data() + this->Start * buffer.TupleSize,
+                   live * buffer.TupleSize);
+    }
+    const size_t required = (compact ? live + n : this->End + n) * buffer.TupleSize;
+    if (required > buffer.Data.size())
+    {
+      buffer.Data.resize(std::max(required, 2 * buffer.Data.size()));
+    }
+  };
+  reserveBuffer(this->Points);
+  for (ArrayBuffer& buffer : this->Arrays)
+  {
+    reserveBuffer(buffer);
+  }
+
+  if (compact)
+  {
+    this->Start = 0;
+    this->End = live;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::Append(int timeIndex, vtkPolyData* frame)
+{
+  const vtkIdType n = frame && frame->GetPoints() ? frame->GetNumberOfPoints() : 0;
+  if (n == 0)
+  {
+    this->Frames.push_back({ timeIndex, 0 });
+    return;
+  }
+
+  if (!this->MatchArrays(frame))
+  {
+    this->Clear();
+    this->MatchArrays(frame);
+  }
+
+  this->Reserve(n);
+  std::memcpy(this->Points.Data.data() + this->End * this->Points.TupleSize,
+              frame->GetPoints()->GetData()->GetVoidPointer(0), n * this->Points.TupleSize);
+  std::vector<vtkDataArray*> arrays = GetBufferedArrays(frame);
+  for (size_t i = 0; i < arrays.size(); ++i)
+  {
+    ArrayBuffer& buffer = this->Arrays[i];
+    std::memcpy(buffer.Data.data() + this->End * buffer.TupleSize,
+                arrays[i]->GetVoidPointer(0), n * buffer.TupleSize);
+  }
+
+  this->UpdateLevelOfDetail(this->End, this->End + n, 1);
+  this->End += n;
+  this->Frames.push_back({ timeIndex, n });
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::EvictBefore(int timeIndex)
+{
+  while (!this->Frames.empty() && this->Frames.front().TimeIndex < timeIndex)
+  {
+    const vtkIdType n = this->Frames.front().NumberOfPoints;
+    this->UpdateLevelOfDetail(this->Start, this->Start + n, -1);
+    this->Start += n;
+    this->Frames.pop_front();
+  }
+  if (this->Frames.empty())
+  {
+    this->Start = 0;
+    this->End = 0;
+    this->Voxels.clear();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::SetVoxelSize(double voxelSize)
+{
+  if (this->VoxelSize != voxelSize)
+  {
+    this->VoxelSize = voxelSize;
+    this->Voxels.clear();
+    this->UpdateLevelOfDetail(this->Start, this->End, 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+uint64_t TrailingFrameBuffer::GetVoxelKey(const double point[3]) const
+{
+  // 21 bits per coordinate, centered on the origin
+  uint64_t key = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    const int64_t index = static_cast<int64_t>(std::floor(point[i] / this->VoxelSize)) + (1 << 20);
+    key = (key << 21) | (static_cast<uint64_t>(index) & ((1 << 21) - 1));
+  }
+  return key;
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::UpdateLevelOfDetail(vtkIdType first, vtkIdType last, int sign)
+{
+  if (this->VoxelSize <= 0. || first >= last)
+  {
+    return;
+  }
+
+  const unsigned char* data = this->Points.Data.data();
+  for (vtkIdType i = first; i < last; ++i)
+  {
+    double point[3];
+    const void* tuple = data + i * this->Points.TupleSize;
+    switch (this->Points.DataType)
+    {
+      vtkTemplateMacro(ReadPoint(static_cast<const VTK_TT*>(tuple), point));
+      default:
+        return;
+    }
+
+    const uint64_t key = this->GetVoxelKey(point);
+    if (sign > 0)
+    {
+      Voxel& voxel = this->Voxels[key];
+      for (int k = 0; k < 3; ++k)
+      {
+        voxel.Sum[k] += point[k];
+      }
+      voxel.Count++;
+    }
+    else
+    {
+      auto it = this->Voxels.find(key);
+      if (it == this->Voxels.end())
+      {
+        continue;
+      }
+      if (--it->second.Count == 0)
+      {
+        this->Voxels.erase(it);
+        continue;
+      }
+      for (int k = 0; k < 3; ++k)
+      {
+        it->second.Sum[k] -= point[k];
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::GetPoints(vtkPolyData* output) const
+{
+  output->Initialize();
+  const vtkIdType n = this->End - this->Start;
+  if (n == 0)
+  {
+    return;
+  }
+
+  vtkNew<vtkPoints> points;
+  points->SetDataType(this->Points.DataType);
+  points->SetNumberOfPoints(n);
+  std::memcpy(points->GetVoidPointer(0),
+              this->Points.Data.data() + this->Start * this->Points.TupleSize,
+              n * this->Points.TupleSize);
+  output->SetPoints(points.GetPointer());
+
+  for (const ArrayBuffer& buffer : this->Arrays)
+  {
+    auto array = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(buffer.DataType));
+    array->SetName(buffer.Name.c_str());
+    array->SetNumberOfComponents(buffer.NumberOfComponents);
+    array->SetNumberOfTuples(n);
+    std::memcpy(array->GetVoidPointer(0), buffer.Data.data() + this->Start * buffer.TupleSize,
+                n * buffer.TupleSize);
+    output->GetPointData()->AddArray(array);
+  }
+
+  output->SetVerts(NewVertexCells(n));
+}
+
+//-----------------------------------------------------------------------------
+void TrailingFrameBuffer::GetLevelOfDetail(vtkPolyData* output) const
+{
+  output->Initialize();
+  const vtkIdType n = static_cast<vtkIdType>(this->Voxels.size());
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(n);
+  vtkNew<vtkIdTypeArray> counts;
+  counts->SetName("voxel_count");
+  counts->SetNumberOfValues(n);
+  vtkIdType i = 0;
+  for (const auto& keyVoxel : this->Voxels)
+  {
+    const Voxel& voxel = keyVoxel.second;
+    points->SetPoint(i, voxel.Sum[0] / voxel.Count, voxel.Sum[1] / voxel.Count,
+                     voxel.Sum[2] / voxel.Count);
+    counts->SetValue(i, voxel.Count);
+    ++i;
+  }
+  output->SetPoints(points.GetPointer());
+  output->GetPointData()->AddArray(counts.GetPointer());
+  output->SetVerts(NewVertexCells(n));
+}
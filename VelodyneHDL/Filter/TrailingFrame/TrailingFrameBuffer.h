@@ -0,0 +1,122 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRAILINGFRAMEBUFFER_H
+#define TRAILINGFRAMEBUFFER_H
+
+#include <vtkType.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class vtkPolyData;
+
+/**
+ * @brief TrailingFrameBuffer accumulates the points of consecutive frames in
+ * contiguous buffers, one for the points and one for each point data array.
+ *
+ * Frames are appended after the newest one and evicted from the oldest one,
+ * both in time proportional to the number of points of the frame: the evicted
+ * points are only skipped, and the buffers are compacted once the skipped
+ * points outnumber the live ones.
+ *
+ * A level of detail, keeping the centroid of the points of each occupied voxel,
+ * is updated along with the buffers when the voxel size is not null.
+ */
+class TrailingFrameBuffer
+{
+public:
+  //! Remove all the frames
+  void Clear();
+
+  bool IsEmpty() const { return this->Frames.empty(); }
+
+  //! Time index of the oldest frame
+  int GetFirstFrame() const { return this->Frames.front().TimeIndex; }
+
+  //! Time index following the one of the newest frame
+  int GetEndFrame() const { return this->Frames.back().TimeIndex + 1; }
+
+  vtkIdType GetNumberOfPoints() const { return this->End - this->Start; }
+
+  /**
+   * @brief Append frame after the newest one. If its point data arrays do not
+   * match the ones of the buffered frames, the buffer is first cleared.
+   * @param timeIndex time index of the frame, GetEndFrame() if the buffer is not empty
+   */
+  void Append(int timeIndex, vtkPolyData* frame);
+
+  //! Evict the frames older than timeIndex
+  void EvictBefore(int timeIndex);
+
+  //! Size of the voxels of the level of detail, 0 to disable it
+  void SetVoxelSize(double voxelSize);
+  double GetVoxelSize() const { return this->VoxelSize; }
+
+  //! Fill output with the points and point data of all the frames
+  void GetPoints(vtkPolyData* output) const;
+
+  //! Fill output with the centroids of the points of each voxel
+  void GetLevelOfDetail(vtkPolyData* output) const;
+
+private:
+  //! Contiguous storage of the tuples of an array
+  struct ArrayBuffer
+  {
+    std::string Name;
+    int DataType = VTK_VOID;
+    int NumberOfComponents = 0;
+    size_t TupleSize = 0; // in bytes, 0 until the buffer is created
+    std::vector<unsigned char> Data;
+  };
+
+  struct Frame
+  {
+    int TimeIndex;
+    vtkIdType NumberOfPoints;
+  };
+
+  struct Voxel
+  {
+    double Sum[3];
+    vtkIdType Count;
+  };
+
+  //! Check that the arrays of frame match the buffers, or create them if there are none
+  bool MatchArrays(vtkPolyData* frame);
+
+  //! Make room for n more tuples at the end of the buffers
+  void Reserve(vtkIdType n);
+
+  //! Add the points [first, last[ of the buffer to the level of detail, or remove them
+  void UpdateLevelOfDetail(vtkIdType first, vtkIdType last, int sign);
+
+  uint64_t GetVoxelKey(const double point[3]) const;
+
+  ArrayBuffer Points;
+  std::vector<ArrayBuffer> Arrays;
+  std::deque<Frame> Frames;
+
+  //! Tuples [Start, End[ of the buffers are the points of the frames
+  vtkIdType Start = 0;
+  vtkIdType End = 0;
+
+  double VoxelSize = 0.;
+  std::unordered_map<uint64_t, Voxel> Voxels;
+};
+
+#endif // TRAILINGFRAMEBUFFER_H
@@ -1,4 +1,5 @@
 #include "vtkTrailingFrame.h"
+#include "TrailingFrameBuffer.h"
 
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkInformationVector.h>
@@ -10,6 +11,9 @@ vtkStandardNewMacro(vtkTrailingFrame)
 //----------------------------------------------------------------------------
 vtkTrailingFrame::vtkTrailingFrame()
   : NumberOfTrailingFrames(0),
+    AccumulationMode(false),
+    LevelOfDetailVoxelSize(0.),
+    Buffer(new TrailingFrameBuffer),
     PipelineTime(0),
     LastTimeProcessedIndex(-1),
     FirstFilterIteration(true)
@@ -18,6 +22,9 @@ vtkTrailingFrame::vtkTrailingFrame()
   this->CacheTimeRange[1] = -1;
 }
 
+//----------------------------------------------------------------------------
+vtkTrailingFrame::~vtkTrailingFrame() = default;
+
 //----------------------------------------------------------------------------
 void vtkTrailingFrame::SetNumberOfTrailingFrames(const unsigned int value)
 {
@@ -30,6 +37,21 @@ void vtkTrailingFrame::SetNumberOfTrailingFrames(const unsigned int value)
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkTrailingFrame::SetAccumulationMode(bool value)
+{
+  if (this->AccumulationMode != value)
+  {
+    this->AccumulationMode = value;
+    // the cache of the other mode has not been kept up to date
+    this->CacheTimeRange[0] = -1;
+    this->CacheTimeRange[1] = -1;
+    this->Cache->Initialize();
+    this->Buffer->Clear();
+    this->Modified();
+  }
+}
+
 //----------------------------------------------------------------------------
 int vtkTrailingFrame::FillOutputPortInformation(int port, vtkInformation *info)
 {
@@ -74,6 +96,14 @@ int vtkTrailingFrame::RequestUpdateExtent(vtkInformation* vtkNotUsed(request),
       if (this->TimeSteps[this->PipelineIndex] - this->PipelineTime > this->PipelineTime - this->TimeSteps[this->PipelineIndex - 1])
         this->PipelineIndex -= 1;
     }
+    if (this->AccumulationMode)
+    {
+      this->InitializeAccumulation();
+      this->FirstFilterIteration = false;
+      inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP(),
+                  this->TimeSteps[this->LastTimeProcessedIndex]);
+      return 1;
+    }
     // save old TimeRange and update new one
     int previousCacheTimeRange[2] = {this->CacheTimeRange[0], this->CacheTimeRange[1]};
     this->CacheTimeRange[0] = std::max(this->PipelineIndex - static_cast<int>(this->NumberOfTrailingFrames), 0);
@@ -133,6 +163,11 @@ int vtkTrailingFrame::RequestData(vtkInformation* request,
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
   vtkMultiBlockDataSet* output = vtkMultiBlockDataSet::GetData(outputVector);
 
+  if (this->AccumulationMode)
+  {
+    return this->RequestAccumulationData(request, inInfo, input, output);
+  }
+
   if ((this->LastTimeProcessedIndex == this->CacheTimeRange[0] && this->Direction == -1)
       || (this->LastTimeProcessedIndex == this->CacheTimeRange[1]-1 && this->Direction == 1))
   {
@@ -188,3 +223,65 @@ int vtkTrailingFrame::RequestData(vtkInformation* request,
   }
   return 1;
 }
+
+//----------------------------------------------------------------------------
+void vtkTrailingFrame::InitializeAccumulation()
+{
+  this->CacheTimeRange[0] = std::max(this->PipelineIndex - static_cast<int>(this->NumberOfTrailingFrames), 0);
+  this->CacheTimeRange[1] = this->PipelineIndex + 1;
+  this->Buffer->SetVoxelSize(this->LevelOfDetailVoxelSize);
+
+  // frames can only be appended after the newest one, the buffer is refilled
+  // when jumping backward or when the window grows toward the past
+  if (!this->Buffer->IsEmpty() &&
+      (this->CacheTimeRange[0] < this->Buffer->GetFirstFrame() ||
+       this->CacheTimeRange[1] < this->Buffer->GetEndFrame()))
+  {
+    this->Buffer->Clear();
+  }
+  this->Buffer->EvictBefore(this->CacheTimeRange[0]);
+
+  // request the frames which are not buffered yet, or at least the current one
+  // as the pipeline loop needs one input update
+  this->Direction = 1;
+  this->LastTimeProcessedIndex = this->Buffer->IsEmpty() ?
+        this->CacheTimeRange[0] : std::min(this->Buffer->GetEndFrame(), this->CacheTimeRange[1] - 1);
+}
+
+//----------------------------------------------------------------------------
+int vtkTrailingFrame::RequestAccumulationData(vtkInformation* request,
+                                              vtkInformation* inInfo,
+                                              vtkPolyData* input,
+                                              vtkMultiBlockDataSet* output)
+{
+  if (this->Buffer->IsEmpty() || this->LastTimeProcessedIndex == this->Buffer->GetEndFrame())
+  {
+    this->Buffer->Append(this->LastTimeProcessedIndex, input);
+  }
+
+  if (this->LastTimeProcessedIndex < this->CacheTimeRange[1] - 1)
+  {
+    // force the pipeline loop
+    request->Set(vtkStreamingDemandDrivenPipeline::CONTINUE_EXECUTING(), 1);
+    return 1;
+  }
+
+  // Stop the pipeline loop
+  request->Remove(vtkStreamingDemandDrivenPipeline::CONTINUE_EXECUTING());
+  this->FirstFilterIteration = true;
+  inInfo->Set(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP(),
+              this->PipelineTime);
+
+  // the merged frames are the only copy of the points done at each time step
+  vtkNew<vtkPolyData> merged;
+  this->Buffer->GetPoints(merged.GetPointer());
+  output->Initialize();
+  output->SetBlock(0, merged.GetPointer());
+  if (this->LevelOfDetailVoxelSize > 0.)
+  {
+    vtkNew<vtkPolyData> levelOfDetail;
+    this->Buffer->GetLevelOfDetail(levelOfDetail.GetPointer());
+    output->SetBlock(1, levelOfDetail.GetPointer());
+  }
+  return 1;
+}
@@ -1,16 +1,25 @@
 #ifndef VTKTRAILINGFRAME_H
 #define VTKTRAILINGFRAME_H
 
+#include <memory>
 #include <queue>
 
 #include "vtkPolyDataAlgorithm.h"
 #include <vtkNew.h>
 #include <vtkMultiBlockDataSet.h>
 
+class TrailingFrameBuffer;
+
 /**
  * @brief The vtkTrailingFrame class is a filter that combine consecutive timestep
  * of its input to produce a multiblock.
  * The input of this filter must produce only consecutive interger timestep.
+ *
+ * In accumulation mode, the frames are instead appended to a buffer when time
+ * moves forward, so that each new time step only requests the new frame from
+ * the input and evicts the frames which left the window. The output multiblock
+ * then contains a single polydata merging all the frames, followed by a
+ * voxelized level of detail of it if LevelOfDetailVoxelSize is not null.
  */
 class VTK_EXPORT vtkTrailingFrame : public vtkPolyDataAlgorithm
 {
@@ -24,8 +33,22 @@ public:
   void SetNumberOfTrailingFrames(const unsigned int value);
   //! @}
 
+  //! @{
+  //! @copydoc AccumulationMode
+  vtkGetMacro(AccumulationMode, bool)
+  void SetAccumulationMode(bool value);
+  vtkBooleanMacro(AccumulationMode, bool)
+  //! @}
+
+  //! @{
+  //! @copydoc LevelOfDetailVoxelSize
+  vtkGetMacro(LevelOfDetailVoxelSize, double)
+  vtkSetMacro(LevelOfDetailVoxelSize, double)
+  //! @}
+
 protected:
   vtkTrailingFrame();
+  ~vtkTrailingFrame() override;
 
   int FillOutputPortInformation(int port, vtkInformation* info) override;
   int RequestUpdateExtent(vtkInformation*,
@@ -36,9 +59,21 @@ protected:
                   vtkInformationVector* outputVector) override;
 
 private:
+  //! Set the window and the first time step to request in accumulation mode
+  void InitializeAccumulation();
+  int RequestAccumulationData(vtkInformation* request, vtkInformation* inInfo,
+                              vtkPolyData* input, vtkMultiBlockDataSet* output);
+
   //! Number of previous timestep to display
   unsigned int NumberOfTrailingFrames;
 
+  //! Merge the frames in a single polydata, only requesting the new frames from the input
+  bool AccumulationMode;
+  //! Size of the voxels of the level of detail of the merged frames, 0 to disable it
+  double LevelOfDetailVoxelSize;
+  //! Points of the frames [CacheTimeRange[0], CacheTimeRange[1][ in accumulation mode
+  std::unique_ptr<TrailingFrameBuffer> Buffer;
+
   //! Original pipeline time which must be restored after modifying the input filter time
   double PipelineTime;
   //! Index of time step corresponding to PipelineTime
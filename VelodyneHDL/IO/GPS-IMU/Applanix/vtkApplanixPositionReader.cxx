@@ -42,9 +42,13 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
 
+#include <algorithm>
 #include <map>
 
+#include "TextFileParsing.h"
+
 #define DATA_ARRAY(name)                                                                           \
   vtkNew<vtkDoubleArray> name##Data;                                                               \
   name##Data->SetName(#name)
@@ -53,6 +57,93 @@ namespace
 {
 typedef std::map<std::string, size_t> FieldIndexMap;
 typedef std::map<size_t, vtkDoubleArray*> FieldDataMap;
+
+//! Below this size, the data is parsed by a single thread
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+//-----------------------------------------------------------------------------
+//! A range of complete lines of the data section, parsed by one thread
+struct DataChunk
+{
+  const char* Begin = nullptr;
+  const char* End = nullptr;
+
+  //! First row of the arrays this chunk writes to
+  vtkIdType FirstRow = 0;
+  //! Number of rows actually parsed
+  vtkIdType NumberOfRows = 0;
+
+  vtkIdType NumberOfInvalidLines = 0;
+  std::string FirstInvalidLine;
+  size_t FirstInvalidLineFields = 0;
+};
+
+//-----------------------------------------------------------------------------
+/**
+ * @brief ParseChunk parse the lines of a chunk in place
+ * @param chunk the chunk to parse, its FirstRow must be set
+ * @param columns for each field of a line, the array where to write it, or null
+ */
+void ParseChunk(DataChunk& chunk, const std::vector<double*>& columns)
+{
+  const size_t numFields = columns.size();
+  const char* it = chunk.Begin;
+  while (it < chunk.End)
+  {
+    const char* lineEnd = std::find(it, chunk.End, '\n');
+    const char* lineBegin = it;
+    const vtkIdType row = chunk.FirstRow + chunk.NumberOfRows;
+
+    // Split the line on spaces and parse the needed fields where they are
+    size_t field = 0;
+    bool valid = true;
+    while (field < numFields)
+    {
+      while (it < lineEnd && IsBlank(*it))
+      {
+        ++it;
+      }
+      if (it == lineEnd)
+      {
+        break;
+      }
+      const char* tokenEnd = it;
+      if (columns[field])
+      {
+        tokenEnd = ParseDouble(it, lineEnd, columns[field][row]);
+        valid &= tokenEnd != it && (tokenEnd == lineEnd || IsBlank(*tokenEnd));
+      }
+      while (tokenEnd < lineEnd && !IsBlank(*tokenEnd))
+      {
+        ++tokenEnd;
+      }
+      it = tokenEnd;
+      ++field;
+    }
+
+    it = lineEnd == chunk.End ? chunk.End : lineEnd + 1;
+
+    // skip empty lines
+    if (field == 0)
+    {
+      continue;
+    }
+
+    if (field < numFields || !valid)
+    {
+      if (chunk.NumberOfInvalidLines == 0)
+      {
+        chunk.FirstInvalidLine.assign(lineBegin, lineEnd);
+        chunk.FirstInvalidLineFields = field;
+      }
+      chunk.NumberOfInvalidLines++;
+    }
+    else
+    {
+      chunk.NumberOfRows++;
+    }
+  }
+}
 }
 
 //-----------------------------------------------------------------------------
@@ -91,6 +182,7 @@ vtkApplanixPositionReader::vtkApplanixPositionReader()
   this->BaseRoll = 0.0;
   this->BasePitch = 0.0;
   this->TimeOffset = 16.0; // correct for at least 2012-Jul - 2015-May
+  this->NumberOfThreads = 0;
   this->Internal->CalibrationTransform->Identity();
 
   this->SetNumberOfInputPorts(0);
@@ -141,21 +233,34 @@ int vtkApplanixPositionReader::RequestData(
   vtkNew<vtkIntArray> zoneData;
   zoneData->SetName("zone");
 
-  // Open data file
-  std::ifstream f(this->FileName);
-  if (!f.good())
+  // Map data file
+  MappedTextFile file;
+  try
   {
-    vtkErrorMacro("Failed to open input file \"" << this->FileName << "\"");
+    file.Open(this->FileName, true);
+  }
+  catch (const std::exception& e)
+  {
+    vtkErrorMacro("Failed to open input file \"" << this->FileName << "\": " << e.what());
     return VTK_ERROR;
   }
 
+  this->Internal->Fields.clear();
+  this->Internal->FieldMapping.clear();
+
   std::string line;
   std::string lastLine;
 
   // Read header
+  const char* it = file.Begin();
+  const char* const end = file.End();
   size_t numFields = 0;
-  while (std::getline(f, line))
+  while (it < end)
   {
+    const char* lineEnd = std::find(it, end, '\n');
+    line.assign(it, lineEnd);
+    it = lineEnd == end ? end : lineEnd + 1;
+
     boost::algorithm::trim(line);
     if (line.empty())
     {
@@ -204,37 +309,92 @@ int vtkApplanixPositionReader::RequestData(
   this->Internal->SetMapping("PITCH", pitchData);
   this->Internal->SetMapping("HEADING", headingData);
 
-  // Read data
-  vtkIdType count = 0;
-  while (std::getline(f, line))
+  // Split the data in chunks of complete lines, one per thread
+  int nbThreads = this->NumberOfThreads > 0 ? this->NumberOfThreads
+                                            : std::max(1u, boost::thread::hardware_concurrency());
+  nbThreads = static_cast<int>(
+    std::max<size_t>(1, std::min<size_t>(nbThreads, (end - it) / MIN_CHUNK_SIZE)));
+  std::vector<DataChunk> chunks(nbThreads);
+  for (int i = 0; i < nbThreads; ++i)
   {
-    boost::algorithm::trim(line);
-    if (line.empty())
+    chunks[i].Begin = i == 0 ? it : chunks[i - 1].End;
+    const char* chunkEnd = (i == nbThreads - 1) ? end : it + (end - it) * (i + 1) / nbThreads;
+    const char* newLine = std::find(std::max(chunkEnd, chunks[i].Begin), end, '\n');
+    chunks[i].End = newLine == end ? end : newLine + 1;
+  }
+
+  // Count the lines of each chunk to preallocate the arrays. Each chunk then
+  // writes its rows from its own offset, without any synchronization.
+  std::vector<vtkIdType> linesPerChunk(nbThreads);
+  {
+    boost::thread_group threads;
+    for (int i = 0; i < nbThreads; ++i)
     {
-      continue;
+      threads.create_thread([&chunks, &linesPerChunk, i]()
+      {
+        linesPerChunk[i] = std::count(chunks[i].Begin, chunks[i].End, '\n') + 1;
+      });
     }
+    threads.join_all();
+  }
+  vtkIdType maxRows = 0;
+  for (int i = 0; i < nbThreads; ++i)
+  {
+    chunks[i].FirstRow = maxRows;
+    maxRows += linesPerChunk[i];
+  }
 
-    // Split into fields
-    std::vector<std::string> fields;
-    boost::algorithm::split(
-      fields, line, boost::is_any_of(" "), boost::algorithm::token_compress_on);
+  std::vector<double*> columns(numFields, nullptr);
+  for (FieldDataMap::iterator iter = this->Internal->FieldMapping.begin();
+       iter != this->Internal->FieldMapping.end(); ++iter)
+  {
+    iter->second->SetNumberOfTuples(maxRows);
+    columns[iter->first] = iter->second->GetPointer(0);
+  }
 
-    if (fields.size() < numFields)
+  // Read data
+  {
+    boost::thread_group threads;
+    for (int i = 1; i < nbThreads; ++i)
     {
-      vtkWarningMacro("Line '" << line << "' has only " << fields.size() << "fields "
-                               << "(expected " << numFields << ")");
-      continue;
+      threads.create_thread([&chunks, &columns, i]() { ParseChunk(chunks[i], columns); });
     }
+    ParseChunk(chunks[0], columns);
+    threads.join_all();
+  }
 
-    // Assign values to data arrays
-    for (FieldDataMap::iterator iter = this->Internal->FieldMapping.begin();
-         iter != this->Internal->FieldMapping.end(); ++iter)
+  // Make the rows of all chunks contiguous and report the invalid lines
+  vtkIdType count = 0;
+  for (const DataChunk& chunk : chunks)
+  {
+    if (chunk.NumberOfInvalidLines > 0)
     {
-      const double value = boost::lexical_cast<double>(fields[iter->first]);
-      iter->second->InsertNextValue(value);
+      vtkWarningMacro("Line '" << chunk.FirstInvalidLine << "' has only "
+                               << chunk.FirstInvalidLineFields << " valid fields "
+                               << "(expected " << numFields << ")"
+                               << (chunk.NumberOfInvalidLines > 1 ? ", skipping " : "")
+                               << (chunk.NumberOfInvalidLines > 1
+                                  ? std::to_string(chunk.NumberOfInvalidLines - 1) +
+                                      " similar lines"
+                                  : std::string()));
     }
-
-    ++count;
+    if (chunk.FirstRow != count)
+    {
+      for (double* column : columns)
+      {
+        if (column)
+        {
+          std::copy(column + chunk.FirstRow, column + chunk.FirstRow + chunk.NumberOfRows,
+            column + count);
+        }
+      }
+    }
+    count += chunk.NumberOfRows;
+  }
+  for (FieldDataMap::iterator iter = this->Internal->FieldMapping.begin();
+       iter != this->Internal->FieldMapping.end(); ++iter)
+  {
+    iter->second->SetNumberOfTuples(count);
   }
 
   // Verify position information
@@ -255,6 +415,11 @@ int vtkApplanixPositionReader::RequestData(
   this->Internal->Interpolator->SetInterpolationTypeToLinear();
   this->Internal->Interpolator->Initialize();
 
+  // The transform from the vehicule to the GPS is the same for all poses
+  vtkNew<vtkMatrix4x4> vehiculeToGps;
+  this->Internal->CalibrationTransform->GetMatrix(vehiculeToGps.Get());
+  vehiculeToGps->Invert();
+
   double pos[3] = { 0.0, 0.0, 0.0 };
   double firstPos[3];
   for (vtkIdType n = 0; n < count; ++n)
@@ -292,10 +457,8 @@ int vtkApplanixPositionReader::RequestData(
 
     // Compute transform from vehicule to GPS
     // and then compose with the transform GPS to world
-    vtkNew<vtkMatrix4x4> gpsToWorld, vehiculeToGps, vehiculeToWorld;
-    this->Internal->CalibrationTransform->GetMatrix(vehiculeToGps.Get());
+    vtkNew<vtkMatrix4x4> gpsToWorld, vehiculeToWorld;
     transformGpsWorld->GetMatrix(gpsToWorld.Get());
-    vehiculeToGps->Invert();
     vtkMatrix4x4::Multiply4x4(gpsToWorld.Get(), vehiculeToGps.Get(), vehiculeToWorld.Get());
     transformVehiculeWorld->SetMatrix(vehiculeToWorld.Get());
     transformVehiculeWorld->Modified();
@@ -340,4 +503,5 @@ void vtkApplanixPositionReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
   os << indent << "FileName: " << this->FileName << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
 }
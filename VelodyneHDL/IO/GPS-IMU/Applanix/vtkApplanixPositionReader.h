@@ -73,6 +73,11 @@ public:
   vtkSetMacro(TimeOffset, double);
   vtkGetMacro(TimeOffset, double);
 
+  // Description:
+  // Set/Get the number of threads parsing the file, 0 means one per core.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
   void SetCalibrationTransform(vtkTransform* transform);
 
   // Description:
@@ -92,6 +97,8 @@ protected:
 
   double TimeOffset;
 
+  int NumberOfThreads;
+
   class vtkInternal;
   vtkInternal* Internal;
 
@@ -22,14 +22,30 @@
 #include "PacketFileWriter.h"
 #include "PacketConsumer.h"
 
+#include <algorithm>
+
 #define LIDAR_PACKET_TO_STORE_CRASH_ANALYSIS 5000
 #define GPS_PACKET_TO_STORE_CRASH_ANALYSIS 5000
 
+//-----------------------------------------------------------------------------
+NetworkSource::SensorBinding::~SensorBinding()
+{
+  this->Receiver.reset();
+  this->DummyWork.reset();
+  if (this->Thread)
+  {
+    this->Thread->join();
+  }
+}
+
 //-----------------------------------------------------------------------------
 NetworkSource::~NetworkSource()
 {
   this->Stop();
 
+  // Each sensor joins its own thread
+  this->Sensors.clear();
+
   delete this->DummyWork;
 
   if (this->Thread)
@@ -39,28 +55,93 @@ NetworkSource::~NetworkSource()
 }
 
 //-----------------------------------------------------------------------------
-void NetworkSource::QueuePackets(std::string *packet)
+void NetworkSource::QueuePackets(std::string *packet, int sensor)
 {
+  // GPS packets are given to the first sensor consumer but not counted in its statistics.
+  // They are rare and not dropped when its queue is full, so that the positions are
+  // kept even while the lidar packets are shed
+  SensorBinding& binding = *this->Sensors[std::max(sensor, 0)];
+  if (sensor >= 0)
+  {
+    binding.ReceivedPackets++;
+  }
+
   std::string* packet2 = 0;
   if (this->Writer)
   {
     packet2 = new std::string(*packet);
   }
 
-  if (this->Consumer)
+  if (binding.Consumer)
   {
-    this->Consumer->Enqueue(packet);
+    if (!binding.Consumer->Enqueue(packet, sensor >= 0))
+    {
+      if (sensor >= 0)
+      {
+        binding.DroppedPackets++;
+      }
+      delete packet;
+    }
+
+    unsigned int depth = binding.Consumer->GetQueueSize();
+    if (depth > binding.MaxQueueDepth)
+    {
+      binding.MaxQueueDepth = depth;
+    }
+  }
+  else
+  {
+    delete packet;
   }
 
   if (this->Writer)
   {
-    this->Writer->Enqueue(packet2);
+    // each sensor is recorded with its own port, so that a recording of several
+    // sensors can be replayed or split by sensor
+    const int port = sensor >= 0 ? binding.Port : this->GPSPort;
+    this->Writer->Enqueue(packet2, static_cast<unsigned short>(port));
+  }
+}
+
+//-----------------------------------------------------------------------------
+int NetworkSource::AddSensor(std::shared_ptr<PacketConsumer> consumer, int port, int forwardedPort)
+{
+  this->Sensors.emplace_back(new SensorBinding(port, forwardedPort, consumer));
+  return static_cast<int>(this->Sensors.size()) - 1;
+}
+
+//-----------------------------------------------------------------------------
+void NetworkSource::RemoveAdditionalSensors()
+{
+  this->Sensors.resize(1);
+}
+
+//-----------------------------------------------------------------------------
+SensorStatistics NetworkSource::GetSensorStatistics(int sensor) const
+{
+  SensorStatistics stats;
+  if (sensor < 0 || sensor >= this->GetNumberOfSensors())
+  {
+    return stats;
   }
+
+  const SensorBinding& binding = *this->Sensors[sensor];
+  stats.Port = binding.Port;
+  stats.ReceivedPackets = binding.ReceivedPackets;
+  stats.DroppedPackets = binding.DroppedPackets;
+  stats.QueueDepth = binding.Consumer ? binding.Consumer->GetQueueSize() : 0;
+  stats.MaxQueueDepth = binding.MaxQueueDepth;
+  return stats;
 }
 
 //-----------------------------------------------------------------------------
 void NetworkSource::Start()
 {
+  // The first sensor follows the public configuration
+  this->Sensors[0]->Port = this->LIDARPort;
+  this->Sensors[0]->ForwardedPort = this->ForwardedLIDARPort;
+  this->Sensors[0]->Consumer = this->Consumer;
+
   if (!this->Thread)
   {
     std::cout << "Start listen" << std::endl;
@@ -68,14 +149,27 @@ void NetworkSource::Start()
       new boost::thread(boost::bind(&boost::asio::io_service::run, &this->IOService)));
   }
 
-  // Create work
-  this->LIDARPortReceiver = boost::shared_ptr<PacketReceiver>(new PacketReceiver(
-    this->IOService, LIDARPort, ForwardedLIDARPort, ForwardedIpAddress, IsForwarding, this));
+  // Create work, each sensor receives its packets on its own thread
+  for (size_t i = 0; i < this->Sensors.size(); ++i)
+  {
+    SensorBinding& binding = *this->Sensors[i];
+    if (!binding.Thread)
+    {
+      binding.Thread.reset(
+        new boost::thread(boost::bind(&boost::asio::io_service::run, &binding.IOService)));
+    }
+    binding.ReceivedPackets = 0;
+    binding.DroppedPackets = 0;
+    binding.MaxQueueDepth = 0;
+    binding.Receiver = boost::shared_ptr<PacketReceiver>(new PacketReceiver(binding.IOService,
+      binding.Port, binding.ForwardedPort, ForwardedIpAddress,
+      IsForwarding && (i == 0 || binding.ForwardedPort > 0), this, static_cast<int>(i)));
+  }
 
   if (this->ListenGPS)
   {
     this->PositionPortReceiver = boost::shared_ptr<PacketReceiver>(new PacketReceiver(
-      this->IOService, GPSPort, ForwardedGPSPort, ForwardedIpAddress, IsForwarding, this));
+      this->IOService, GPSPort, ForwardedGPSPort, ForwardedIpAddress, IsForwarding, this, -1));
   }
 
   if (this->IsCrashAnalysing)
@@ -108,8 +202,12 @@ void NetworkSource::Start()
       boost::filesystem::create_directory(appDirPath);
     }
 
-    this->LIDARPortReceiver->EnableCrashAnalysing(
-      appDir + "LidarLastData", LIDAR_PACKET_TO_STORE_CRASH_ANALYSIS, this->IsCrashAnalysing);
+    for (size_t i = 0; i < this->Sensors.size(); ++i)
+    {
+      std::string name = i == 0 ? "LidarLastData" : "Lidar" + std::to_string(i) + "LastData";
+      this->Sensors[i]->Receiver->EnableCrashAnalysing(
+        appDir + name, LIDAR_PACKET_TO_STORE_CRASH_ANALYSIS, this->IsCrashAnalysing);
+    }
     if (this->ListenGPS)
     {
       this->PositionPortReceiver->EnableCrashAnalysing(
@@ -117,7 +215,10 @@ void NetworkSource::Start()
     }
   }
 
-  this->LIDARPortReceiver->StartReceive();
+  for (const auto& binding : this->Sensors)
+  {
+    binding->Receiver->StartReceive();
+  }
   if (this->ListenGPS)
   {
       this->PositionPortReceiver->StartReceive();
@@ -128,7 +229,10 @@ void NetworkSource::Start()
 void NetworkSource::Stop()
 {
   // Kill the receivers
-  this->LIDARPortReceiver.reset();
+  for (const auto& binding : this->Sensors)
+  {
+    binding->Receiver.reset();
+  }
   if (this->ListenGPS)
   {
     this->PositionPortReceiver.reset();
@@ -33,15 +33,40 @@
 #include <boost/filesystem.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <atomic>
 #include <deque>
+#include <memory>
 #include <queue>
+#include <vector>
 
 class PacketConsumer;
 class PacketReceiver;
 class PacketFileWriter;
+
+/**
+ * \struct SensorStatistics
+ * \brief Reception statistics of one sensor listened by a NetworkSource
+ */
+struct SensorStatistics
+{
+  int Port = 0;                         /*!< The port the sensor is listened on */
+  unsigned long ReceivedPackets = 0;    /*!< Number of packets received on the port */
+  unsigned long DroppedPackets = 0;     /*!< Number of packets dropped because the queue was full */
+  unsigned int QueueDepth = 0;          /*!< Number of packets currently waiting to be decoded */
+  unsigned int MaxQueueDepth = 0;       /*!< Highest queue depth observed since the start */
+
+  double GetDropRate() const
+  {
+    return this->ReceivedPackets ? static_cast<double>(this->DroppedPackets) / this->ReceivedPackets : 0.;
+  }
+};
+
 /**
 * \class PacketReceiver
-* \brief This class is responsible for the IOService and  two PacketReceiver classes
+* \brief This class is responsible for the IOService and the PacketReceiver classes.
+* Each lidar sensor has its own port, its own receive thread and its own PacketConsumer,
+* so that a sensor which saturates does not slow down the others. The first sensor
+* is the one configured by LIDARPort, additional ones are added with AddSensor.
 * @param _consumer boost::shared_ptr<PacketConsumer>
 * @param argLIDARPort The used port to receive the LIDAR information
 * @param ForwardedLIDARPort_ The port which will receive the lidar forwarded packets
@@ -61,22 +86,52 @@ public:
     , IsCrashAnalysing(isCrashAnalysing_)
     , IOService()
     , Thread()
-    , LIDARPortReceiver()
     , Consumer(_consumer)
     , Writer()
     , DummyWork(new boost::asio::io_service::work(this->IOService))
   {
       this->ListenGPS = false;
+      this->Sensors.emplace_back(new SensorBinding(argLIDARPort, ForwardedLIDARPort_, _consumer));
   }
 
   ~NetworkSource();
 
-  void QueuePackets(std::string* packet);
+  /**
+   * @brief QueuePackets give a received packet to the consumer of a sensor
+   * @param packet the packet, the NetworkSource takes its ownership
+   * @param sensor index of the sensor which has received the packet, -1 for the GPS.
+   * GPS packets are queued to the first sensor consumer regardless of its MaxQueueSize
+   */
+  void QueuePackets(std::string* packet, int sensor = 0);
 
   void Start();
 
   void Stop();
 
+  /**
+   * @brief AddSensor listen to an additional lidar on its own port. This must be
+   * called while the source is stopped.
+   * @param consumer the consumer decoding the packets of this sensor
+   * @param port the port to receive the sensor packets
+   * @param forwardedPort the port to forward the packets to, when IsForwarding is set.
+   * 0 disables the forwarding for this sensor
+   * @return the index of the sensor
+   */
+  int AddSensor(std::shared_ptr<PacketConsumer> consumer, int port, int forwardedPort = 0);
+
+  /**
+   * @brief RemoveAdditionalSensors remove all sensors added with AddSensor, this
+   * must be called while the source is stopped
+   */
+  void RemoveAdditionalSensors();
+
+  int GetNumberOfSensors() const { return static_cast<int>(this->Sensors.size()); }
+
+  /**
+   * @brief GetSensorStatistics return the reception statistics of a sensor
+   */
+  SensorStatistics GetSensorStatistics(int sensor) const;
+
   //! @todo currently evrything is public, but it should be private
   int LIDARPort;                  /*!< The port to receive LIDAR information. Default is 2368 */
   bool ListenGPS;
@@ -87,12 +142,9 @@ public:
   bool IsForwarding;              /*!< Allowing the forwarding of the packets*/
   bool IsCrashAnalysing;
 
-  boost::asio::io_service IOService; /*!< The in/out service which will handle the Packets */
+  boost::asio::io_service IOService; /*!< The in/out service which will handle the GPS Packets */
   boost::shared_ptr<boost::thread> Thread;
 
-  boost::shared_ptr<PacketReceiver>
-    LIDARPortReceiver; /*!< The PacketReceiver configured to receive LIDAR information */
-
   boost::shared_ptr<PacketReceiver>
     PositionPortReceiver; /*!< The PacketReceiver configured to receive GPS information */
 
@@ -100,6 +152,41 @@ public:
   std::shared_ptr<PacketFileWriter> Writer;
 
   boost::asio::io_service::work* DummyWork;
+
+private:
+  /**
+   * \struct SensorBinding
+   * \brief Everything needed to receive the packets of one lidar: its port, its
+   * in/out service running on a dedicated thread and the consumer decoding the packets
+   */
+  struct SensorBinding
+  {
+    SensorBinding(int port, int forwardedPort, std::shared_ptr<PacketConsumer> consumer)
+      : Port(port)
+      , ForwardedPort(forwardedPort)
+      , Consumer(consumer)
+      , DummyWork(new boost::asio::io_service::work(this->IOService))
+    {
+    }
+
+    ~SensorBinding();
+
+    int Port;
+    int ForwardedPort;
+    std::shared_ptr<PacketConsumer> Consumer;
+
+    boost::asio::io_service IOService;
+    std::unique_ptr<boost::asio::io_service::work> DummyWork;
+    boost::shared_ptr<boost::thread> Thread;
+    boost::shared_ptr<PacketReceiver> Receiver;
+
+    std::atomic<unsigned long> ReceivedPackets{ 0 };
+    std::atomic<unsigned long> DroppedPackets{ 0 };
+    std::atomic<unsigned int> MaxQueueDepth{ 0 };
+  };
+
+  //! The first sensor is the one listening LIDARPort and feeding Consumer
+  std::vector<std::unique_ptr<SensorBinding> > Sensors;
 };
 
 
@@ -0,0 +1,132 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "OverloadController.h"
+
+const int OverloadController::MaxLevel;
+constexpr double OverloadController::LowLoad;
+
+//-----------------------------------------------------------------------------
+void OverloadController::EndFrame(double time, unsigned int queueDepth, unsigned int droppedFrames)
+{
+  this->DroppedFrames += droppedFrames;
+  if (this->GetFiringDecimation() > 1 || this->GetLaserStride() > 1)
+  {
+    this->DegradedFrames++;
+  }
+
+  const bool hasPreviousFrame = this->LastFrameTime > 0.;
+  const double period = time - this->LastFrameTime;
+  const double load = hasPreviousFrame && period > 0. ? this->ProcessingTime / period : 0.;
+  this->LastFrameTime = time;
+  this->ProcessingTime = 0.;
+
+  // a queue above the high threshold which is already draining does not need more shedding,
+  // nor does the backlog accumulated before the first frame
+  const bool growingQueue = hasPreviousFrame && queueDepth > this->HighQueueDepth &&
+    queueDepth >= this->LastQueueDepth;
+  this->LastQueueDepth = queueDepth;
+  if (this->CurrentPolicy == Disabled)
+  {
+    return;
+  }
+
+  if (growingQueue)
+  {
+    this->CalmFrames = 0;
+    if (this->Level < MaxLevel)
+    {
+      this->Level++;
+      this->Escalations++;
+    }
+  }
+  else if (queueDepth <= this->LowQueueDepth && load < LowLoad && this->Level > 0)
+  {
+    if (++this->CalmFrames >= this->RecoveryFrames)
+    {
+      this->Level--;
+      this->CalmFrames = 0;
+    }
+  }
+  else
+  {
+    this->CalmFrames = 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void OverloadController::Reset()
+{
+  this->Level = 0;
+  this->CalmFrames = 0;
+  this->ProcessingTime = 0.;
+  this->LastFrameTime = 0.;
+  this->LastQueueDepth = 0;
+  this->DegradedFrames = 0;
+  this->DroppedFrames = 0;
+  this->Escalations = 0;
+}
+
+//-----------------------------------------------------------------------------
+void OverloadController::SetPolicy(int policy)
+{
+  if (this->CurrentPolicy != policy)
+  {
+    this->CurrentPolicy = policy;
+    this->Level = 0;
+    this->CalmFrames = 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int OverloadController::GetFiringDecimation() const
+{
+  switch (this->CurrentPolicy)
+  {
+    case FiringDecimation:
+      return 1 << this->Level;
+    case Progressive:
+      return this->Level >= 1 ? 2 : 1;
+    default:
+      return 1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int OverloadController::GetLaserStride() const
+{
+  switch (this->CurrentPolicy)
+  {
+    case LaserSubsetting:
+      return 1 << this->Level;
+    case Progressive:
+      return this->Level >= 2 ? 2 : 1;
+    default:
+      return 1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int OverloadController::GetFrameDecimation() const
+{
+  switch (this->CurrentPolicy)
+  {
+    case FrameDropping:
+      return this->Level + 1;
+    case Progressive:
+      return this->Level >= 3 ? 2 : 1;
+    default:
+      return 1;
+  }
+}
@@ -0,0 +1,122 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OVERLOADCONTROLLER_H
+#define OVERLOADCONTROLLER_H
+
+#include <vvConfigure.h>
+
+/**
+ * @brief OverloadController decides how much decoding work a live stream consumer
+ * should shed when it falls behind the sensor.
+ *
+ * At the end of each frame, the controller looks at the number of packets waiting
+ * to be decoded:
+ * - above HighQueueDepth, and the queue has not shrunk since the previous frame,
+ *   the overload level increases by one
+ * - below LowQueueDepth with a low decoding load (time spent decoding the frame
+ *   over the time elapsed since the previous one) during RecoveryFrames consecutive
+ *   frames, it decreases by one
+ *
+ * The load alone never escalates: while a backlog is drained (stream start, a
+ * stalled UI...), the consumer never waits for packets and its load is close to 1,
+ * even on a machine fast enough to keep up with the sensor.
+ *
+ * The policy translates the level into a firing decimation, a laser subsetting
+ * and a frame decimation, to be applied by the packet interpreter.
+ */
+class VelodyneHDLPlugin_EXPORT OverloadController
+{
+public:
+  enum Policy
+  {
+    Disabled = 0,         /*!< never shed any work */
+    FiringDecimation = 1, /*!< decode one firing out of 2^level */
+    LaserSubsetting = 2,  /*!< decode one laser out of 2^level */
+    FrameDropping = 3,    /*!< decode one frame out of level + 1 */
+    Progressive = 4,      /*!< decimate the firings, then the lasers, then drop frames */
+  };
+
+  //! Highest overload level
+  static const int MaxLevel = 3;
+
+  //! Load below which the decoding can recover
+  static constexpr double LowLoad = 0.5;
+
+  /**
+   * @brief AddProcessingTime account the time spent to decode a packet
+   * @param seconds decoding duration
+   */
+  void AddProcessingTime(double seconds) { this->ProcessingTime += seconds; }
+
+  /**
+   * @brief EndFrame update the level once a frame has been completed
+   * @param time universal time, in seconds, at which the frame has been completed
+   * @param queueDepth number of packets waiting to be decoded
+   * @param droppedFrames number of frames skipped because of the frame decimation
+   * since the previous call
+   */
+  void EndFrame(double time, unsigned int queueDepth, unsigned int droppedFrames);
+
+  //! Restore the initial level and counters
+  void Reset();
+
+  //! @{
+  //! Decimations to apply for the current level, 1 means no decimation
+  int GetFiringDecimation() const;
+  int GetLaserStride() const;
+  int GetFrameDecimation() const;
+  //! @}
+
+  int GetLevel() const { return this->Level; }
+
+  int GetPolicy() const { return this->CurrentPolicy; }
+  //! Changing the policy resets the level
+  void SetPolicy(int policy);
+
+  unsigned int GetLowQueueDepth() const { return this->LowQueueDepth; }
+  void SetLowQueueDepth(unsigned int depth) { this->LowQueueDepth = depth; }
+
+  unsigned int GetHighQueueDepth() const { return this->HighQueueDepth; }
+  void SetHighQueueDepth(unsigned int depth) { this->HighQueueDepth = depth; }
+
+  int GetRecoveryFrames() const { return this->RecoveryFrames; }
+  void SetRecoveryFrames(int frames) { this->RecoveryFrames = frames; }
+
+  //! Number of frames decoded with a firing decimation or a laser subsetting
+  unsigned long GetNumberOfDegradedFrames() const { return this->DegradedFrames; }
+  //! Number of frames skipped because of the frame decimation
+  unsigned long GetNumberOfDroppedFrames() const { return this->DroppedFrames; }
+  //! Number of times the level has been increased
+  unsigned long GetNumberOfEscalations() const { return this->Escalations; }
+
+private:
+  int CurrentPolicy = Disabled;
+  unsigned int LowQueueDepth = 50;
+  unsigned int HighQueueDepth = 500;
+  int RecoveryFrames = 10;
+
+  int Level = 0;
+  //! Number of consecutive frames below the low thresholds
+  int CalmFrames = 0;
+  double ProcessingTime = 0.;
+  double LastFrameTime = 0.;
+  unsigned int LastQueueDepth = 0;
+
+  unsigned long DegradedFrames = 0;
+  unsigned long DroppedFrames = 0;
+  unsigned long Escalations = 0;
+};
+
+#endif // OVERLOADCONTROLLER_H
@@ -2,6 +2,7 @@
 
 #include "SynchronizedQueue.h"
 #include "vtkAppendPolyData.h"
+#include "vtkTimerLog.h"
 
 //----------------------------------------------------------------------------
 PacketConsumer::PacketConsumer()
@@ -10,8 +11,13 @@ PacketConsumer::PacketConsumer()
   this->ShouldCheckSensor = true;
   this->MaxNumberOfFrames = 1000;
   this->LastTime = 0.0;
+  this->NumberOfProcessedPackets = 0;
+  this->MaxQueueSize = 0;
+  this->LastNumberOfSkippedFrames = 0;
+  this->Interpreter = nullptr;
   this->Timesteps.clear();
   this->Frames.clear();
+  this->ReceptionTimes.clear();
   this->Packets.reset(new SynchronizedQueue<std::string*>);
 }
 
@@ -19,9 +25,20 @@ PacketConsumer::PacketConsumer()
 void PacketConsumer::HandleSensorData(const unsigned char *data, unsigned int length)
 {
   boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+  const double start = vtkTimerLog::GetUniversalTime();
   this->Interpreter->ProcessPacket(data, length);
+  const double end = vtkTimerLog::GetUniversalTime();
+  this->Overload.AddProcessingTime(end - start);
+  this->NumberOfProcessedPackets++;
+  this->PacketProcessed.notify_all();
   if (this->Interpreter->IsNewFrameReady())
   {
+    // the decimations are only changed between two frames
+    const unsigned long skippedFrames = this->Interpreter->GetNumberOfSkippedFrames();
+    this->Overload.EndFrame(end, this->GetQueueSize(), skippedFrames - this->LastNumberOfSkippedFrames);
+    this->LastNumberOfSkippedFrames = skippedFrames;
+    this->ApplyOverloadDecimation();
+
     this->HandleNewData(this->Interpreter->GetLastFrameAvailable());
     this->Interpreter->ClearAllFramesAvailable();
   }
@@ -55,6 +72,40 @@ vtkSmartPointer<vtkPolyData> PacketConsumer::GetFrameForTime(double timeRequest,
   return 0;
 }
 
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> PacketConsumer::GetFrameForReceptionTime(double receptionTime, double tolerance)
+{
+  size_t index = 0;
+  double minDifference = VTK_DOUBLE_MAX;
+  const size_t nFrames = this->ReceptionTimes.size();
+  for (size_t i = 0; i < nFrames; ++i)
+  {
+    double difference = std::abs(this->ReceptionTimes[i] - receptionTime);
+    if (difference < minDifference)
+    {
+      minDifference = difference;
+      index = i;
+    }
+  }
+
+  if (minDifference > tolerance)
+  {
+    return nullptr;
+  }
+  return this->Frames[index];
+}
+
+//----------------------------------------------------------------------------
+double PacketConsumer::GetReceptionTimeForTime(double timeRequest)
+{
+  size_t stepIndex = this->GetIndexForTime(timeRequest);
+  if (stepIndex < this->ReceptionTimes.size())
+  {
+    return this->ReceptionTimes[stepIndex];
+  }
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 std::vector<double> PacketConsumer::GetTimesteps()
 {
@@ -89,7 +140,13 @@ bool PacketConsumer::CheckForNewData()
 void PacketConsumer::ThreadLoop()
 {
   std::string* packet = 0;
-  this->Interpreter->ResetCurrentFrame();
+  {
+    boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+    this->Interpreter->ResetCurrentFrame();
+    this->Overload.Reset();
+    this->ApplyOverloadDecimation();
+    this->LastNumberOfSkippedFrames = this->Interpreter->GetNumberOfSkippedFrames();
+  }
   while (this->Packets->dequeue(packet))
   {
     this->HandleSensorData(
@@ -107,6 +164,11 @@ void PacketConsumer::Start()
   }
 
   this->Packets.reset(new SynchronizedQueue<std::string*>);
+  this->Packets->setMaxSize(this->MaxQueueSize);
+  {
+    boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+    this->NumberOfProcessedPackets = 0;
+  }
   this->Thread = boost::shared_ptr<boost::thread>(
         new boost::thread(boost::bind(&PacketConsumer::ThreadLoop, this)));
 }
@@ -124,13 +186,90 @@ void PacketConsumer::Stop()
 }
 
 //----------------------------------------------------------------------------
-void PacketConsumer::Enqueue(std::string *packet) { this->Packets->enqueue(packet); }
+bool PacketConsumer::Enqueue(std::string *packet, bool bounded)
+{
+  return this->Packets->enqueue(packet, bounded);
+}
+
+//----------------------------------------------------------------------------
+unsigned int PacketConsumer::GetQueueSize()
+{
+  return this->Packets ? this->Packets->size() : 0;
+}
+
+//----------------------------------------------------------------------------
+void PacketConsumer::SetMaxQueueSize(unsigned int maxSize)
+{
+  this->MaxQueueSize = maxSize;
+  if (this->Packets)
+  {
+    this->Packets->setMaxSize(maxSize);
+  }
+}
 
 //----------------------------------------------------------------------------
 void PacketConsumer::UnloadData()
 {
   this->Frames.clear();
   this->Timesteps.clear();
+  this->ReceptionTimes.clear();
+}
+
+//----------------------------------------------------------------------------
+unsigned long PacketConsumer::GetNumberOfProcessedPackets()
+{
+  boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+  return this->NumberOfProcessedPackets;
+}
+
+//----------------------------------------------------------------------------
+void PacketConsumer::WaitForProcessedPackets(unsigned long numberOfPackets)
+{
+  boost::unique_lock<boost::mutex> lock(this->ReaderMutex);
+  while (this->NumberOfProcessedPackets < numberOfPackets)
+  {
+    this->PacketProcessed.wait(lock);
+  }
+}
+
+//----------------------------------------------------------------------------
+void PacketConsumer::SetOverloadPolicy(int policy)
+{
+  boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+  this->Overload.SetPolicy(policy);
+  this->ApplyOverloadDecimation();
+}
+
+//----------------------------------------------------------------------------
+void PacketConsumer::SetOverloadQueueDepths(unsigned int low, unsigned int high)
+{
+  boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+  this->Overload.SetLowQueueDepth(low);
+  this->Overload.SetHighQueueDepth(high);
+}
+
+//----------------------------------------------------------------------------
+void PacketConsumer::SetOverloadRecoveryFrames(int frames)
+{
+  boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+  this->Overload.SetRecoveryFrames(frames);
+}
+
+//----------------------------------------------------------------------------
+OverloadController PacketConsumer::GetOverloadController()
+{
+  boost::lock_guard<boost::mutex> lock(this->ReaderMutex);
+  return this->Overload;
+}
+
+//----------------------------------------------------------------------------
+void PacketConsumer::ApplyOverloadDecimation()
+{
+  if (this->Interpreter)
+  {
+    this->Interpreter->SetOverloadDecimation(this->Overload.GetFiringDecimation(),
+      this->Overload.GetLaserStride(), this->Overload.GetFrameDecimation());
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -144,6 +283,7 @@ void PacketConsumer::UpdateDequeSize()
   {
     this->Frames.pop_front();
     this->Timesteps.pop_front();
+    this->ReceptionTimes.pop_front();
   }
 }
 
@@ -168,11 +308,19 @@ size_t PacketConsumer::GetIndexForTime(double time)
 //----------------------------------------------------------------------------
 void PacketConsumer::HandleNewData(vtkSmartPointer<vtkPolyData> polyData)
 {
-  boost::lock_guard<boost::mutex> lock(this->ConsumerMutex);
+  {
+    boost::lock_guard<boost::mutex> lock(this->ConsumerMutex);
 
-  this->UpdateDequeSize();
-  this->Timesteps.push_back(this->LastTime);
-  this->Frames.push_back(polyData);
-  this->NewData = true;
-  this->LastTime += 1.0;
+    this->UpdateDequeSize();
+    this->Timesteps.push_back(this->LastTime);
+    this->Frames.push_back(polyData);
+    this->ReceptionTimes.push_back(vtkTimerLog::GetUniversalTime());
+    this->NewData = true;
+    this->LastTime += 1.0;
+  }
+
+  if (this->NewFrameCallback)
+  {
+    this->NewFrameCallback();
+  }
 }
@@ -33,9 +33,11 @@
 #include <boost/thread.hpp>
 #include <vtkNew.h>
 #include <deque>
+#include <functional>
 
 #include "vtkSmartPointer.h"
 #include "vtkLidarPacketInterpreter.h"
+#include "OverloadController.h"
 
 
 template<typename T>
@@ -51,6 +53,22 @@ public:
   // You must lock PacketConsumer.ConsumerMutex while calling this function
   vtkSmartPointer<vtkPolyData> GetFrameForTime(double timeRequest, double& actualTime, int numberOfTrailingFrame = 0);
 
+  /**
+   * @brief GetFrameForReceptionTime return the frame whose reception time is the
+   * closest to the requested one, or nullptr if none is within the tolerance.
+   * You must lock PacketConsumer.ConsumerMutex while calling this function
+   * @param receptionTime universal time, in seconds, as returned by vtkTimerLog
+   * @param tolerance maximum allowed difference between the requested and the actual time
+   */
+  vtkSmartPointer<vtkPolyData> GetFrameForReceptionTime(double receptionTime, double tolerance);
+
+  /**
+   * @brief GetReceptionTimeForTime return the universal time at which the frame
+   * matching timeRequest has been completed, or 0 if there is no frame.
+   * You must lock PacketConsumer.ConsumerMutex while calling this function
+   */
+  double GetReceptionTimeForTime(double timeRequest);
+
   std::vector<double> GetTimesteps();
 
   int GetMaxNumberOfFrames() { return this->MaxNumberOfFrames; }
@@ -65,12 +83,65 @@ public:
 
   void Stop();
 
-  void Enqueue(std::string* packet);
+  /**
+   * @brief Enqueue give a packet to the consumer thread
+   * @param bounded if false, the packet is queued even if MaxQueueSize is reached
+   * @return false if the packet has been dropped because the queue is full, in
+   * which case the caller keeps the ownership of the packet
+   */
+  bool Enqueue(std::string* packet, bool bounded = true);
+
+  /**
+   * @brief GetQueueSize return the number of packets waiting to be decoded
+   */
+  unsigned int GetQueueSize();
+
+  /**
+   * @brief SetMaxQueueSize set the maximum number of packets waiting to be decoded,
+   * new packets are dropped once reached. 0 means unbounded.
+   */
+  void SetMaxQueueSize(unsigned int maxSize);
+  unsigned int GetMaxQueueSize() { return this->MaxQueueSize; }
 
   void SetInterpreter(vtkLidarPacketInterpreter* inter) { this->Interpreter = inter;}
 
   void UnloadData();
 
+  /**
+   * @brief SetNewFrameCallback set a function called each time a frame is completed.
+   * It is called from the consumer thread, with ConsumerMutex released, and must be
+   * set while the consumer is stopped.
+   */
+  void SetNewFrameCallback(std::function<void()> callback) { this->NewFrameCallback = callback; }
+
+  /**
+   * @brief GetNumberOfProcessedPackets return the number of packets handled by the
+   * interpreter since the consumer has been started
+   */
+  unsigned long GetNumberOfProcessedPackets();
+
+  /**
+   * @brief WaitForProcessedPackets block until the interpreter has handled at least
+   * numberOfPackets packets since the consumer has been started. The packets must not
+   * be dropped, or this never returns.
+   */
+  void WaitForProcessedPackets(unsigned long numberOfPackets);
+
+  //! @{
+  //! @copydoc OverloadController::SetPolicy
+  void SetOverloadPolicy(int policy);
+  //! @brief SetOverloadQueueDepths set the queue depths below which the decoding can
+  //! recover, and above which it sheds more work
+  void SetOverloadQueueDepths(unsigned int low, unsigned int high);
+  void SetOverloadRecoveryFrames(int frames);
+  //! @}
+
+  /**
+   * @brief GetOverloadController return a copy of the controller, to read its
+   * settings, level and counters
+   */
+  OverloadController GetOverloadController();
+
   // Hold this when running reader code code or modifying its internals
   boost::mutex ReaderMutex;
 
@@ -84,15 +155,32 @@ protected:
 
   void HandleNewData(vtkSmartPointer<vtkPolyData> polyData);
 
+  //! Apply the decimations of the overload controller to the interpreter
+  void ApplyOverloadDecimation();
+
   bool ShouldCheckSensor;
   bool NewData;
   int MaxNumberOfFrames;
   double LastTime;
+  unsigned long NumberOfProcessedPackets;
+  //! notified, with ReaderMutex held, each time NumberOfProcessedPackets increases
+  boost::condition_variable PacketProcessed;
+  unsigned int MaxQueueSize;
+
+  //! Shed decoding work when the packets arrive faster than they are decoded,
+  //! protected by ReaderMutex
+  OverloadController Overload;
+  //! Number of frames skipped by the interpreter when the last frame was completed
+  unsigned long LastNumberOfSkippedFrames;
 
   std::deque<vtkSmartPointer<vtkPolyData> > Frames;
   std::deque<double> Timesteps;
+  //! universal time at which each frame has been completed, used to align several sensors
+  std::deque<double> ReceptionTimes;
   vtkLidarPacketInterpreter* Interpreter;
 
+  std::function<void()> NewFrameCallback;
+
   boost::shared_ptr<SynchronizedQueue<std::string*> > Packets;
 
   boost::shared_ptr<boost::thread> Thread;
@@ -6,13 +6,13 @@
 //-----------------------------------------------------------------------------
 void PacketFileWriter::ThreadLoop()
 {
-  std::string* packet = 0;
+  std::pair<std::string*, unsigned short> packet;
   while (this->Packets->dequeue(packet))
   {
-    this->PacketWriter.WritePacket(
-          reinterpret_cast<const unsigned char*>(packet->c_str()), packet->length());
+    this->PacketWriter.WritePacket(reinterpret_cast<const unsigned char*>(packet.first->c_str()),
+                                   packet.first->length(), packet.second);
 
-    delete packet;
+    delete packet.first;
   }
 }
 
@@ -38,7 +38,7 @@ void PacketFileWriter::Start(const std::string &filename)
     }
   }
 
-  this->Packets.reset(new SynchronizedQueue<std::string*>);
+  this->Packets.reset(new SynchronizedQueue<std::pair<std::string*, unsigned short> >);
   this->Thread = boost::shared_ptr<boost::thread>(
         new boost::thread(boost::bind(&PacketFileWriter::ThreadLoop, this)));
 }
@@ -56,14 +56,14 @@ void PacketFileWriter::Stop()
 }
 
 //-----------------------------------------------------------------------------
-void PacketFileWriter::Enqueue(std::string *packet)
+void PacketFileWriter::Enqueue(std::string *packet, unsigned short port)
 {
   // TODO
   // After capturing a stream and stoping the recording, Packets is NULL
   // and this loop continues until a new reader or stream is selected.
   if (this->Packets != NULL)
   {
-    this->Packets->enqueue(packet);
+    this->Packets->enqueue(std::make_pair(packet, port));
   }
   else
   {
@@ -31,6 +31,7 @@
 
 #include <string>
 #include <queue>
+#include <utility>
 #include <boost/thread/thread.hpp>
 #include <boost/asio.hpp>
 
@@ -46,7 +47,13 @@ public:
 
   void Stop();
 
-  void Enqueue(std::string* packet);
+  /**
+   * @brief Enqueue give a packet to the writing thread
+   * @param packet the packet, the writer takes its ownership
+   * @param port the port the packet has been received on, written in its UDP header.
+   * 0 keeps the default lidar or position port
+   */
+  void Enqueue(std::string* packet, unsigned short port = 0);
 
   bool IsOpen() { return this->PacketWriter.IsOpen(); }
 
@@ -55,7 +62,8 @@ public:
 private:
   vtkPacketFileWriter PacketWriter;
   boost::shared_ptr<boost::thread> Thread;
-  boost::shared_ptr<SynchronizedQueue<std::string*> > Packets;
+  //! packets to write, along with the port they have been received on
+  boost::shared_ptr<SynchronizedQueue<std::pair<std::string*, unsigned short> > > Packets;
 };
 
 
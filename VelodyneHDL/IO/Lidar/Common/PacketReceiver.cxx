@@ -23,13 +23,14 @@
 
 
 //-----------------------------------------------------------------------------
-PacketReceiver::PacketReceiver(boost::asio::io_service &io, int port, int forwardport, std::string forwarddestinationIp, bool isforwarding, NetworkSource *parent)
+PacketReceiver::PacketReceiver(boost::asio::io_service &io, int port, int forwardport, std::string forwarddestinationIp, bool isforwarding, NetworkSource *parent, int sensorIndex)
   : isForwarding(isforwarding)
   , Port(port)
   , PacketCounter(0)
   , Socket(io)
   , ForwardedSocket(io)
   , Parent(parent)
+  , SensorIndex(sensorIndex)
   , IsReceiving(true)
   , ShouldStop(false)
 {
@@ -145,7 +146,7 @@ void PacketReceiver::SocketCallback(
     this->CrashAnalysis.AddPacket(*packet);
   }
 
-  this->Parent->QueuePackets(packet);
+  this->Parent->QueuePackets(packet, this->SensorIndex);
 
   this->StartReceive();
 
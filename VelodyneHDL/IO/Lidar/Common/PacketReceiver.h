@@ -65,9 +65,10 @@ public:
    * @param forwarddestinationIp The IP adress of the computer which will receive the forwarded packets
    * @param isforwarding Allow or not the forwarding of the packets
    * @param parent @todo to replace by a synchronizedQueue
+   * @param sensorIndex index of the sensor in the parent NetworkSource whose queue receives the packets, -1 for the GPS
    */
   PacketReceiver(boost::asio::io_service& io, int port, int forwardport,
-    std::string forwarddestinationIp, bool isforwarding, NetworkSource* parent);
+    std::string forwarddestinationIp, bool isforwarding, NetworkSource* parent, int sensorIndex = 0);
 
   ~PacketReceiver();
 
@@ -109,6 +110,9 @@ private:
   /*!< Network Shouce where the packet will be enqueue */
   NetworkSource* Parent;
 
+  /*!< Index of the sensor in the Network Source */
+  int SensorIndex;
+
   /*!< Buffer which will saved the data. Expecting exactly 1206 bytes, using a larger buffer
    *  so that if a larger packet arrives unexpectedly we'll notice it. */
   char RXBuffer[BUFFER_SIZE];
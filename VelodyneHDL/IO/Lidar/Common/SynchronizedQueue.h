@@ -46,18 +46,28 @@ public:
     , cond_()
     , request_to_end_(false)
     , enqueue_data_(true)
+    , max_size_(0)
   {
   }
 
-  void enqueue(const T &data)
+  /**
+   * @brief enqueue add an element at the end of the queue
+   * @param bounded if false, the element is queued even if the queue is full
+   * @return false if the element has not been queued, either because the queue
+   * is full or because it has been stopped. The caller then keeps its ownership.
+   */
+  bool enqueue(const T &data, bool bounded = true)
   {
     boost::unique_lock<boost::mutex> lock(mutex_);
 
-    if (enqueue_data_)
+    if (!enqueue_data_ || (bounded && max_size_ > 0 && queue_.size() >= max_size_))
     {
-      queue_.push(data);
-      cond_.notify_one();
+      return false;
     }
+
+    queue_.push(data);
+    cond_.notify_one();
+    return true;
   }
 
   bool dequeue(T &result)
@@ -94,6 +104,15 @@ public:
     return static_cast<unsigned int>(queue_.size());
   }
 
+  /**
+   * @brief setMaxSize set the maximum number of queued elements, 0 means unbounded
+   */
+  void setMaxSize(unsigned int maxSize)
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    max_size_ = maxSize;
+  }
+
   bool isEmpty() const
   {
     boost::unique_lock<boost::mutex> lock(mutex_);
@@ -117,6 +136,7 @@ private:
 
   bool request_to_end_;
   bool enqueue_data_;
+  size_t max_size_;
 };
 
 #endif // SYNCHRONIZEDQUEUE_H
@@ -1,26 +1,12 @@
 #include "vtkLidarPacketInterpreter.h"
 
-#include <vtkTransform.h>
-
-namespace {
-//-----------------------------------------------------------------------------
-vtkSmartPointer<vtkCellArray> NewVertexCells(vtkIdType numberOfVerts)
-{
-  vtkNew<vtkIdTypeArray> cells;
-  cells->SetNumberOfValues(numberOfVerts * 2);
-  vtkIdType* ids = cells->GetPointer(0);
-  for (vtkIdType i = 0; i < numberOfVerts; ++i)
-  {
-    ids[i * 2] = 1;
-    ids[i * 2 + 1] = i;
-  }
+#include "vtkVertexCells.h"
 
-  vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
-  cellArray->SetCells(numberOfVerts, cells.GetPointer());
-  return cellArray;
-}
+#include <vtkMath.h>
+#include <vtkTransform.h>
 
-}
+#include <algorithm>
+#include <cmath>
 
 //-----------------------------------------------------------------------------
 bool vtkLidarPacketInterpreter::SplitFrame(bool force)
@@ -31,7 +17,7 @@ bool vtkLidarPacketInterpreter::SplitFrame(bool force)
     return false;
   }
 
-  // add vertex to the polydata
+  // add vertex to the polydata, the connectivity is shared between all frames
   this->CurrentFrame->SetVerts(NewVertexCells(this->CurrentFrame->GetNumberOfPoints()));
   // split the frame
   this->Frames.push_back(this->CurrentFrame);
@@ -42,37 +28,159 @@ bool vtkLidarPacketInterpreter::SplitFrame(bool force)
 }
 
 //-----------------------------------------------------------------------------
-bool vtkLidarPacketInterpreter::shouldBeCroppedOut(double pos[3], double theta)
+void vtkLidarPacketInterpreter::UpdateLaserSelectionMask()
+{
+  this->LaserSelectionMask.assign((this->LaserSelection.size() + 31) / 32, 0);
+  for (size_t laser = 0; laser < this->LaserSelection.size(); ++laser)
+  {
+    if (this->LaserSelection[laser])
+    {
+      this->LaserSelectionMask[laser / 32] |= uint32_t(1) << (laser % 32);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarPacketInterpreter::SetOverloadDecimation(int firingDecimation, int laserStride, int frameDecimation)
+{
+  this->OverloadFiringDecimation = std::max(firingDecimation, 1);
+  this->OverloadFrameDecimation = std::max(frameDecimation, 1);
+
+  // one bit out of laserStride, the pattern is the same for every word of 32 lasers
+  this->OverloadLaserMask = 0;
+  const int stride = std::min(std::max(laserStride, 1), 32);
+  for (int laser = 0; laser < 32; laser += stride)
+  {
+    this->OverloadLaserMask |= uint32_t(1) << laser;
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarPacketInterpreter::StartNewFrame()
 {
+  if (this->SkipCurrentFrame)
+  {
+    this->NumberOfSkippedFrames++;
+  }
+  this->OverloadFrameIndex = (this->OverloadFrameIndex + 1) % this->OverloadFrameDecimation;
+  this->SkipCurrentFrame = this->OverloadFrameIndex != 0;
+  return this->SkipCurrentFrame;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarPacketInterpreter::UpdateCropping()
+{
+  const vtkMTimeType mtime = this->Superclass::GetMTime();
+  if (mtime <= this->CroppingTime)
+  {
+    return;
+  }
+  this->CroppingTime = mtime;
+
+  CroppingBounds& crop = this->Cropping;
+  crop.Mode = this->CropMode;
+  crop.KeepInside = !this->CropOutside;
+  std::copy(this->CropRegion, this->CropRegion + 6, crop.Region);
+
+  // azimuth interval starting in [0, 360[, wrapping around 360 if THETA_min > THETA_max
+  double span = this->CropRegion[1] - this->CropRegion[0];
+  if (span >= 360.)
+  {
+    crop.Azimuth[0] = 0.;
+    crop.Azimuth[1] = 720.;
+  }
+  else
+  {
+    crop.Azimuth[0] = this->CropRegion[0] - 360. * std::floor(this->CropRegion[0] / 360.);
+    crop.Azimuth[1] = crop.Azimuth[0] + (span < 0. ? span + 360. * std::ceil(-span / 360.) : span);
+  }
+
+  // the distances are compared squared, a negative bound is replaced by one which
+  // no squared distance can be below (min) or above (max)
+  crop.SquaredDistance[0] = this->CropRegion[4] > 0. ? this->CropRegion[4] * this->CropRegion[4] : -1.;
+  crop.SquaredDistance[1] = this->CropRegion[5] >= 0. ? this->CropRegion[5] * this->CropRegion[5] : -1.;
+
+  // PHI >= PHI_min <=> z >= tan(PHI_min) * rho <=> z * |z| >= tan(PHI_min) * |tan(PHI_min)| * rho^2
+  // as v -> v * |v| is increasing. A bound of +/-90 degree is replaced by a large slope,
+  // except for the lower bound of -90 and the upper bound of 90 which do not crop anything.
+  crop.HasSlope[0] = this->CropRegion[2] > -90.;
+  crop.HasSlope[1] = this->CropRegion[3] < 90.;
+  for (int i = 0; i < 2; ++i)
+  {
+    const double phi = this->CropRegion[2 + i];
+    const double slope = std::abs(phi) < 90. ? std::tan(vtkMath::RadiansFromDegrees(phi))
+                                              : std::copysign(1e150, phi);
+    crop.SquaredSlope[i] = slope * std::abs(slope);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarPacketInterpreter::shouldBeCroppedOut(const double pos[3], double theta) const
+{
+  const CroppingBounds& crop = this->Cropping;
+  const double* region = crop.Region;
+
+  // the comparisons are combined with bitwise operators, so that the tests have no branch
   bool pointInside = true;
-  switch (this->CropMode)
+  switch (crop.Mode)
   {
     case CROP_MODE::Cartesian:
     {
-      pointInside = pos[0] >= this->CropRegion[0] && pos[0] <= this->CropRegion[1];
-      pointInside &= pos[1] >= this->CropRegion[2] && pos[1] <= this->CropRegion[3];
-      pointInside &= pos[2] >= this->CropRegion[4] && pos[2] <= this->CropRegion[5];
+      pointInside = (pos[0] >= region[0]) & (pos[0] <= region[1]) &
+                    (pos[1] >= region[2]) & (pos[1] <= region[3]) &
+                    (pos[2] >= region[4]) & (pos[2] <= region[5]);
       break;
     }
     case CROP_MODE::Spherical:
     {
-      double R = std::sqrt(pos[0] * pos[0] + pos[1] * pos[1] + pos[2] * pos[2]);
-      double vertAngle = std::atan2(pos[2], std::sqrt(pos[0] * pos[0] + pos[1] * pos[1]));
-      vertAngle *= 180.0 / vtkMath::Pi();
-
-      pointInside = theta >= this->CropRegion[0] && theta <= this->CropRegion[1];
-      pointInside &= theta >= this->CropRegion[0] && theta <= this->CropRegion[1];
-      pointInside &= R >= this->CropRegion[4] && R <= this->CropRegion[5];
+      const double squaredRho = pos[0] * pos[0] + pos[1] * pos[1];
+      const double squaredR = squaredRho + pos[2] * pos[2];
+      const double signedSquaredZ = pos[2] * std::abs(pos[2]);
+      pointInside = (((theta >= crop.Azimuth[0]) & (theta <= crop.Azimuth[1])) |
+                     ((theta + 360. >= crop.Azimuth[0]) & (theta + 360. <= crop.Azimuth[1]))) &
+                    (!crop.HasSlope[0] | (signedSquaredZ >= crop.SquaredSlope[0] * squaredRho)) &
+                    (!crop.HasSlope[1] | (signedSquaredZ <= crop.SquaredSlope[1] * squaredRho)) &
+                    (squaredR >= crop.SquaredDistance[0]) & (squaredR <= crop.SquaredDistance[1]);
       break;
     }
     case CROP_MODE::Cylindric:
     {
-      // space holder for future implementation
+      const double squaredRho = pos[0] * pos[0] + pos[1] * pos[1];
+      pointInside = (((theta >= crop.Azimuth[0]) & (theta <= crop.Azimuth[1])) |
+                     ((theta + 360. >= crop.Azimuth[0]) & (theta + 360. <= crop.Azimuth[1]))) &
+                    (pos[2] >= region[2]) & (pos[2] <= region[3]) &
+                    (squaredRho >= crop.SquaredDistance[0]) & (squaredRho <= crop.SquaredDistance[1]);
+      break;
     }
-    case CROP_MODE::None:
+    default:
       return false;
   }
-  return !((pointInside && !this->CropOutside) || (!pointInside && this->CropOutside));
+  return pointInside != crop.KeepInside;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarPacketInterpreter::IsAzimuthRangeCroppedOut(double thetaMin, double thetaMax) const
+{
+  const CroppingBounds& crop = this->Cropping;
+  // only the points outside of a spherical or cylindric region can be cropped out
+  // from their azimuth alone
+  if (!crop.KeepInside || (crop.Mode != CROP_MODE::Spherical && crop.Mode != CROP_MODE::Cylindric) ||
+      thetaMax - thetaMin >= 360.)
+  {
+    return false;
+  }
+
+  // move the range in [0, 720[ and compare it with the azimuth interval and its copies
+  const double first = thetaMin - 360. * std::floor(thetaMin / 360.);
+  const double last = first + thetaMax - thetaMin;
+  for (double shift : { -360., 0., 360. })
+  {
+    if (first <= crop.Azimuth[1] + shift && last >= crop.Azimuth[0] + shift)
+    {
+      return false;
+    }
+  }
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -22,8 +22,35 @@
 #include <vtkPolyData.h>
 #include <vtkAlgorithm.h>
 
+#include <cstdint>
+#include <memory>
+
 class vtkTransform;
 
+/**
+ * @brief The FrameIndexingState class stores what the previous packets tell about the
+ * frame under construction, which is needed to detect the frame boundaries while indexing
+ * a capture. Each interpreter derives its own state. Keeping it outside of the interpreter
+ * allows to index several parts of a capture independently, and to merge the results once
+ * the states of two parts match.
+ */
+class FrameIndexingState
+{
+public:
+  virtual ~FrameIndexingState() = default;
+
+  /**
+   * @brief Clone return a copy of the state
+   */
+  virtual std::unique_ptr<FrameIndexingState> Clone() const = 0;
+
+  /**
+   * @brief IsEqual return true if the next frame boundaries detected from both states
+   * will be the same, whatever the packets that follow
+   */
+  virtual bool IsEqual(const FrameIndexingState& other) const = 0;
+};
+
 class VTK_EXPORT  vtkLidarPacketInterpreter : public vtkAlgorithm
 {
 public:
@@ -55,6 +82,13 @@ public:
    */
   virtual vtkSmartPointer<vtkTable> GetCalibrationTable() { return this->CalibrationData.Get(); }
 
+  /**
+   * @brief GetLaserStatistics return a table with one row per laser describing the points
+   * of the last frame which is ready, or nullptr if the interpreter does not compute them.
+   * It can be called from another thread than the one processing the packets.
+   */
+  virtual vtkSmartPointer<vtkTable> GetLaserStatistics() { return nullptr; }
+
   /**
    * @brief ProcessPacket process the data packet to create incrementaly the frame.
    * Each time a packet is processed by the function, the points which are encoded
@@ -92,6 +126,44 @@ public:
   virtual void PreProcessPacket(unsigned char const * data, unsigned int dataLength,
                          bool& isNewFrame, int& framePositionInPacket) = 0;
 
+  /**
+   * @brief PreProcessPacket detect the frame boundaries using an explicit indexing state
+   * instead of the interpreter one. Contrary to the previous function, the interpreter is
+   * not modified, so that several parts of a capture can be indexed concurrently.
+   * Only available if NewFrameIndexingState returns a state.
+   * @param data raw data packet
+   * @param dataLength size of the data packet
+   * @param state[in,out] indexing state of the packets preceding this one
+   * @param isNewFrame[out] indicate if a new frame should be created
+   * @param framePositionInPacket[out] indicate the offset of the new frame in the packet
+   */
+  virtual void PreProcessPacket(unsigned char const * data, unsigned int dataLength,
+                                FrameIndexingState& state, bool& isNewFrame,
+                                int& framePositionInPacket) const
+  {
+    isNewFrame = false;
+    framePositionInPacket = 0;
+  }
+
+  /**
+   * @brief NewFrameIndexingState return a state corresponding to the beginning of a capture,
+   * or nullptr if the interpreter does not support indexing with an explicit state
+   */
+  virtual std::unique_ptr<FrameIndexingState> NewFrameIndexingState() const { return nullptr; }
+
+  /**
+   * @brief SetFrameIndexingState replace the indexing state used by the interpreter
+   * PreProcessPacket, for example once a capture has been indexed with explicit states
+   * @param state must have been created by the same kind of interpreter
+   */
+  virtual void SetFrameIndexingState(const FrameIndexingState& state) {}
+
+  /**
+   * @brief ResetFrameIndexingState reset the indexing state used by the interpreter
+   * PreProcessPacket, before indexing a new capture
+   */
+  virtual void ResetFrameIndexingState() {}
+
   /**
    * @brief IsLidarPacket check if the given packet is really a lidar packet
    * @param data raw data packet
@@ -144,11 +216,45 @@ public:
   /**
    * @copydoc LidarPacketInterpreter::LaserSelection
    */
-  virtual void SetLaserSelection(const bool* v) { this->LaserSelection = std::vector<bool>(v, v + this->CalibrationReportedNumLasers); }
+  virtual void SetLaserSelection(const bool* v)
+  {
+    this->LaserSelection = std::vector<bool>(v, v + this->CalibrationReportedNumLasers);
+    this->UpdateLaserSelectionMask();
+  }
   virtual void GetLaserSelection(bool* v) { std::copy(this->LaserSelection.begin(), this->LaserSelection.end(), v);}
-  virtual void SetLaserSelection(const std::vector<bool>& v) { this->LaserSelection = v; }
+  virtual void SetLaserSelection(const std::vector<bool>& v)
+  {
+    this->LaserSelection = v;
+    this->UpdateLaserSelectionMask();
+  }
   virtual std::vector<bool> GetLaserSelection() const { return this->LaserSelection; }
 
+  /**
+   * @brief GetLaserSelectionMask return the selection of the 32 lasers starting at firstLaser,
+   * the bit i being set if the laser firstLaser + i is selected
+   * @param firstLaser multiple of 32
+   */
+  uint32_t GetLaserSelectionMask(int firstLaser) const
+  {
+    const size_t word = static_cast<size_t>(firstLaser / 32);
+    const uint32_t mask = word < this->LaserSelectionMask.size() ? this->LaserSelectionMask[word] : 0;
+    return mask & this->OverloadLaserMask;
+  }
+
+  /**
+   * @brief SetOverloadDecimation reduce the decoding work when the packets arrive
+   * faster than they are decoded, 1 meaning no decimation
+   * @param firingDecimation decode one firing out of firingDecimation, on top of FiringsSkip.
+   * A firing includes all the laser banks and returns fired at the same time, so that the
+   * decimation lowers the horizontal resolution without removing any laser
+   * @param laserStride decode one laser out of laserStride, must be a power of 2 up to 32
+   * @param frameDecimation decode one frame out of frameDecimation, the others are skipped
+   */
+  void SetOverloadDecimation(int firingDecimation, int laserStride, int frameDecimation);
+
+  //! Number of frames skipped because of the overload frame decimation
+  unsigned long GetNumberOfSkippedFrames() const { return this->NumberOfSkippedFrames; }
+
   vtkGetMacro(DistanceResolutionM, double)
   vtkSetMacro(DistanceResolutionM, double)
 
@@ -178,13 +284,29 @@ public:
   vtkMTimeType GetMTime() override;
 
 protected:
+  /**
+   * @brief UpdateCropping precompute the bounds used by the cropping tests from CropMode,
+   * CropOutside and CropRegion, if they have been modified since the last call.
+   * Must be called before processing a packet.
+   */
+  void UpdateCropping();
+
   /**
    * @brief shouldBeCroppedOut Check if a point is inside a region of interest determined
-   * either by its cartesian coordinates system or spherical coordinates system.
+   * either by its cartesian, spherical or cylindric coordinates system.
    * @param pos cartesian coordinates of the point to be check
    * @param theta azimuth of the point to be check. Avoid to recompute this information using an atan2 function
    */
-  bool shouldBeCroppedOut(double pos[3], double theta);
+  bool shouldBeCroppedOut(const double pos[3], double theta) const;
+
+  /**
+   * @brief IsAzimuthRangeCroppedOut check if all the points whose azimuth is in
+   * [thetaMin, thetaMax] are cropped out, whatever their position. This allows to skip
+   * the firings and the lasers before decoding their points.
+   * @param thetaMin first azimuth in degree
+   * @param thetaMax last azimuth in degree, which can exceed 360
+   */
+  bool IsAzimuthRangeCroppedOut(double thetaMin, double thetaMax) const;
 
   //! Buffer to store the frame once they are ready
   std::vector<vtkSmartPointer<vtkPolyData> > Frames;
@@ -211,6 +333,28 @@ protected:
   //! should process/display (true) or ignore (false)
   std::vector<bool> LaserSelection;
 
+  //! LaserSelection as a bitmask of 32 lasers per word, so that the unselected lasers
+  //! of a firing can be skipped at once. Must be updated when LaserSelection is modified.
+  std::vector<uint32_t> LaserSelectionMask;
+
+  void UpdateLaserSelectionMask();
+
+  /**
+   * @brief StartNewFrame must be called each time a frame starts, before its first firing
+   * @return true if the frame must be skipped because of the overload frame decimation
+   */
+  bool StartNewFrame();
+
+  //! Overload decimations, see SetOverloadDecimation
+  int OverloadFiringDecimation = 1;
+  uint32_t OverloadLaserMask = 0xFFFFFFFF;
+  int OverloadFrameDecimation = 1;
+
+  //! Index of the current frame modulo the frame decimation, and whether it is skipped
+  int OverloadFrameIndex = 0;
+  bool SkipCurrentFrame = false;
+  unsigned long NumberOfSkippedFrames = 0;
+
   //! Laser distance resolution (quantum) which also correspond to the points precision
   double DistanceResolutionM = 0;
 
@@ -235,17 +379,43 @@ protected:
   //! Indicate which cropping mode should be used.
   int CropMode = CROP_MODE::None;
 
-  //! If true, the region outside of the area defined by CropRegion is cropped/removed.
-  //! If false, the region within the area is cropped/removed.
+  //! If true, the region within the area defined by CropRegion is cropped/removed.
+  //! If false, the region outside of the area is cropped/removed.
   bool CropOutside = false;
 
   //! Depending on the :CropingMode select this can have different meaning:
   //! - vtkLidarProvider::CropModeEnum::Cartesian it correspond to [X_min, X_max, Y_min, Y_max, Z_min, Z_max]
-  //! - vtkLidarProvider::CropModeEnum::Spherical it correspond to [R_min, R_max, THETA_min, THETA_max, PHI_min, PHI_max]
-  //! - vtkLidarProvider::CropModeEnum::Spherical -> Note implemented yet
-  //! all distance are in cm and all angle are in degree
+  //! - vtkLidarProvider::CropModeEnum::Spherical it correspond to [THETA_min, THETA_max, PHI_min, PHI_max, R_min, R_max]
+  //! - vtkLidarProvider::CropModeEnum::Cylindric it correspond to [THETA_min, THETA_max, Z_min, Z_max, RHO_min, RHO_max]
+  //! THETA is the azimuth, the interval wraps around 360 if THETA_min > THETA_max,
+  //! PHI the vertical angle and RHO the distance to the Z axis.
+  //! all distance are in meter and all angle are in degree
   double CropRegion[6] = {0,0,0,0,0,0};
 
+  /**
+   * @brief The CroppingBounds struct stores the cropping region in the form used by the
+   * tests, so that they do not need any square root nor trigonometric function
+   */
+  struct CroppingBounds
+  {
+    int Mode = CROP_MODE::None;
+    bool KeepInside = true;
+    //! Copy of CropRegion
+    double Region[6] = {0,0,0,0,0,0};
+    //! Azimuth interval [Azimuth[0], Azimuth[1]], with Azimuth[1] possibly greater than 360
+    double Azimuth[2] = {0,0};
+    //! Bounds of the squared distance (R for Spherical, RHO for Cylindric)
+    double SquaredDistance[2] = {0,0};
+    //! Signed squared tangent of PHI bounds, if the bound is within ]-90, 90[
+    double SquaredSlope[2] = {0,0};
+    bool HasSlope[2] = {false,false};
+  };
+
+  //! Cropping bounds precomputed by UpdateCropping
+  CroppingBounds Cropping;
+  //! Modification time of the interpreter when Cropping was computed
+  vtkMTimeType CroppingTime = 0;
+
   vtkLidarPacketInterpreter() = default;
   virtual ~vtkLidarPacketInterpreter() = default;
 
@@ -8,9 +8,267 @@
 #include <vtkInformation.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/**
+ * @brief The IndexingCheckpoint struct is a snapshot of the indexing state after a packet
+ */
+struct IndexingCheckpoint
+{
+  IndexingCheckpoint(long long offset, size_t numberOfFilePositions, std::unique_ptr<FrameIndexingState> state)
+    : Offset(offset), NumberOfFilePositions(numberOfFilePositions), State(std::move(state)) {}
+
+  //! byte offset of the packet record in the pcap
+  long long Offset;
+  //! number of frames found in the chunk until this packet (included)
+  size_t NumberOfFilePositions;
+  //! indexing state after the packet
+  std::unique_ptr<FrameIndexingState> State;
+};
+
+/**
+ * @brief The IndexingChunk struct contains the frame index of a part of a pcap file,
+ * built from an indexing state starting from scratch at the beginning of the part
+ */
+struct IndexingChunk
+{
+  //! byte range [Begin, End[ containing the packet records of the chunk
+  long long Begin = 0;
+  long long End = 0;
+  //! the chunk has been indexed without error
+  bool Success = false;
+  //! indicate if the chunk contains a lidar packet, and the position of the first one
+  bool HasLidarPacket = false;
+  fpos_t FirstLidarPacketPosition;
+  double FirstLidarPacketTime = 0;
+  //! frames found in the chunk
+  std::vector<FramePosition> FilePositions;
+  //! snapshots of the indexing state after each packet starting a frame
+  std::vector<IndexingCheckpoint> Checkpoints;
+  //! indexing state at the end of the chunk
+  std::unique_ptr<FrameIndexingState> State;
+};
+
+//-----------------------------------------------------------------------------
+void IndexChunk(const std::string& filename, vtkLidarPacketInterpreter* interpreter, IndexingChunk& chunk)
+{
+  vtkPacketFileReader reader;
+  if (!reader.Open(filename) || !reader.SetFileOffset(chunk.Begin))
+  {
+    return;
+  }
+
+  const unsigned char* data = 0;
+  unsigned int dataLength = 0;
+  bool isNewFrame = false;
+  int framePositionInPacket = 0;
+  double timeSinceStart = 0;
+  long long offset = 0;
+  fpos_t position;
+
+  chunk.State = interpreter->NewFrameIndexingState();
+  while (true)
+  {
+    reader.GetFilePosition(&position);
+    // the records filtered out are skipped, so the packet can start after the chunk
+    if (!reader.NextPacket(data, dataLength, timeSinceStart) ||
+        !reader.GetLastPacketOffset(offset) || offset >= chunk.End)
+    {
+      break;
+    }
+    if (!interpreter->IsLidarPacket(data, dataLength))
+    {
+      continue;
+    }
+
+    if (!chunk.HasLidarPacket)
+    {
+      chunk.HasLidarPacket = true;
+      chunk.FirstLidarPacketPosition = position;
+      chunk.FirstLidarPacketTime = timeSinceStart;
+    }
+
+    interpreter->PreProcessPacket(data, dataLength, *chunk.State, isNewFrame, framePositionInPacket);
+    if (isNewFrame)
+    {
+      chunk.FilePositions.emplace_back(position, framePositionInPacket, timeSinceStart);
+      chunk.Checkpoints.emplace_back(offset, chunk.FilePositions.size(), chunk.State->Clone());
+    }
+  }
+  chunk.Success = true;
+}
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarReader::ReadFrameInformationInParallel()
+{
+  // the calibration contained in a pcap must be read sequentially
+  if (!this->Interpreter->NewFrameIndexingState() || !this->Interpreter->GetIsCalibrated())
+  {
+    return false;
+  }
+
+  boost::system::error_code error;
+  long long fileSize = boost::filesystem::file_size(this->FileName, error);
+  long long numberOfThreads = this->NumberOfIndexingThreads > 0 ?
+        this->NumberOfIndexingThreads : boost::thread::hardware_concurrency();
+  numberOfThreads = std::min(numberOfThreads, fileSize / std::max(this->MinimalIndexingChunkSize, 1LL));
+  if (error || numberOfThreads < 2)
+  {
+    return false;
+  }
+
+  vtkPacketFileReader reader;
+  long long firstRecordOffset = 0;
+  if (!reader.Open(this->FileName) || !reader.GetFileOffset(firstRecordOffset))
+  {
+    return false;
+  }
+
+  // split the pcap in chunks starting on a packet record
+  std::vector<IndexingChunk> chunks(1);
+  chunks[0].Begin = firstRecordOffset;
+  for (long long i = 1; i < numberOfThreads; ++i)
+  {
+    long long begin = 0;
+    if (reader.FindPacketRecord(fileSize * i / numberOfThreads, begin) && begin > chunks.back().Begin)
+    {
+      chunks.back().End = begin;
+      chunks.emplace_back();
+      chunks.back().Begin = begin;
+    }
+  }
+  chunks.back().End = fileSize;
+  if (chunks.size() < 2)
+  {
+    return false;
+  }
+
+  // index each chunk independently
+  boost::thread_group threads;
+  for (IndexingChunk& chunk : chunks)
+  {
+    IndexingChunk* chunkPtr = &chunk;
+    threads.create_thread([this, chunkPtr]() { IndexChunk(this->FileName, this->Interpreter, *chunkPtr); });
+  }
+  this->UpdateProgress(0.0);
+  threads.join_all();
+
+  // Stitch the chunks. The index of the first chunk is right, as its state started with the pcap.
+  // The state at the end of the previous chunk is then carried through the next chunk until it
+  // matches the state of one of its checkpoints, the index of the chunk is right from there.
+  std::vector<FramePosition> filePositions;
+  std::unique_ptr<FrameIndexingState> carriedState = this->Interpreter->NewFrameIndexingState();
+  bool hasLidarPacket = false;
+  fpos_t firstLidarPacketPosition;
+
+  const unsigned char* data = 0;
+  unsigned int dataLength = 0;
+  bool isNewFrame = false;
+  int framePositionInPacket = 0;
+  double timeSinceStart = 0;
+  long long offset = 0;
+  fpos_t position;
+
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    IndexingChunk& chunk = chunks[i];
+    if (!chunk.Success)
+    {
+      return false;
+    }
+
+    // see ReadFrameInformation for the first lidar packet index
+    if (!hasLidarPacket && chunk.HasLidarPacket)
+    {
+      hasLidarPacket = true;
+      firstLidarPacketPosition = chunk.FirstLidarPacketPosition;
+      filePositions.emplace_back(chunk.FirstLidarPacketPosition, 0, chunk.FirstLidarPacketTime - 1);
+    }
+
+    if (i == 0)
+    {
+      filePositions.insert(filePositions.end(), chunk.FilePositions.begin(), chunk.FilePositions.end());
+      carriedState = std::move(chunk.State);
+      continue;
+    }
+
+    if (!reader.SetFileOffset(chunk.Begin))
+    {
+      return false;
+    }
+    size_t checkpoint = 0;
+    bool isStitched = false;
+    while (!isStitched)
+    {
+      reader.GetFilePosition(&position);
+      if (!reader.NextPacket(data, dataLength, timeSinceStart) ||
+          !reader.GetLastPacketOffset(offset) || offset >= chunk.End)
+      {
+        break;
+      }
+      if (!this->Interpreter->IsLidarPacket(data, dataLength))
+      {
+        continue;
+      }
+
+      this->Interpreter->PreProcessPacket(data, dataLength, *carriedState, isNewFrame, framePositionInPacket);
+      if (isNewFrame)
+      {
+        filePositions.emplace_back(position, framePositionInPacket, timeSinceStart);
+      }
+
+      if (checkpoint < chunk.Checkpoints.size() && chunk.Checkpoints[checkpoint].Offset == offset)
+      {
+        const IndexingCheckpoint& current = chunk.Checkpoints[checkpoint];
+        if (carriedState->IsEqual(*current.State))
+        {
+          filePositions.insert(filePositions.end(),
+                               chunk.FilePositions.begin() + current.NumberOfFilePositions,
+                               chunk.FilePositions.end());
+          carriedState = std::move(chunk.State);
+          isStitched = true;
+        }
+        checkpoint++;
+      }
+    }
+  }
+
+  // the first lidar packet is processed by the interpreter, as when indexing sequentially, to
+  // check that the calibration matches the sensor. The interpreter then gets the final state.
+  vtkPacketFileReader firstPacketReader;
+  if (hasLidarPacket && firstPacketReader.Open(this->FileName))
+  {
+    firstPacketReader.SetFilePosition(&firstLidarPacketPosition);
+    if (firstPacketReader.NextPacket(data, dataLength, timeSinceStart))
+    {
+      this->Interpreter->PreProcessPacket(data, dataLength, isNewFrame, framePositionInPacket);
+    }
+  }
+  this->Interpreter->SetFrameIndexingState(*carriedState);
+
+  this->FilePositions.swap(filePositions);
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 int vtkLidarReader::ReadFrameInformation()
 {
+  this->FilePositions.clear();
+  this->Interpreter->ResetFrameIndexingState();
+
+  // large pcap are indexed in parallel when possible
+  if (this->NumberOfIndexingThreads != 1 && this->ReadFrameInformationInParallel())
+  {
+    return this->GetNumberOfFrames();
+  }
+
   vtkPacketFileReader reader;
   if (!reader.Open(this->FileName))
   {
@@ -25,7 +283,6 @@ int vtkLidarReader::ReadFrameInformation()
   int framePositionInPacket = 0;
   double timeSinceStart = 0;
 
-  this->FilePositions.clear();
   fpos_t lastFilePosition;
   reader.GetFilePosition(&lastFilePosition);
   bool firstIteration = true;
@@ -128,6 +385,24 @@ void vtkLidarReader::SetFileName(const std::string &filename)
   this->Modified();
 }
 
+//-----------------------------------------------------------------------------
+int vtkLidarReader::GetFrameIndexForTime(double time)
+{
+  const double timeOffset = this->Interpreter ? this->Interpreter->GetTimeOffset() : 0.;
+  int index = -1;
+  double minDifference = VTK_DOUBLE_MAX;
+  for (size_t i = 0; i < this->FilePositions.size(); ++i)
+  {
+    const double difference = std::abs(this->FilePositions[i].Time + timeOffset - time);
+    if (difference < minDifference)
+    {
+      minDifference = difference;
+      index = static_cast<int>(i);
+    }
+  }
+  return index;
+}
+
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkLidarReader::GetFrame(int frameNumber)
 {
@@ -322,6 +597,12 @@ int vtkLidarReader::RequestData(vtkInformation *vtkNotUsed(request),
   vtkTable *t = this->Interpreter->GetCalibrationTable();
   calibration->ShallowCopy(t);
 
+  vtkSmartPointer<vtkTable> statistics = this->Interpreter->GetLaserStatistics();
+  if (statistics)
+  {
+    vtkTable::GetData(outputVector, 2)->ShallowCopy(statistics);
+  }
+
   return 1;
 }
 
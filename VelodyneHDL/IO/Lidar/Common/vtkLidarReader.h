@@ -46,6 +46,13 @@ public:
    */
   virtual vtkSmartPointer<vtkPolyData> GetFrame(int frameNumber);
 
+  /**
+   * @brief GetFrameIndexForTime return the index, as used by GetFrame, of the frame
+   * whose timestep is the closest to time, or -1 if there is no frame.
+   * The timesteps are the ones published by the reader, interpreter time offset included.
+   */
+  int GetFrameIndexForTime(double time);
+
   /**
    * @brief Open open the pcap file
    * @todo a decition should be made if the opening/closing of the pcap should be handle by
@@ -72,6 +79,12 @@ public:
   vtkGetMacro(ShowFirstAndLastFrame, bool)
   vtkSetMacro(ShowFirstAndLastFrame, bool)
 
+  vtkGetMacro(NumberOfIndexingThreads, int)
+  vtkSetMacro(NumberOfIndexingThreads, int)
+
+  vtkGetMacro(MinimalIndexingChunkSize, long long)
+  vtkSetMacro(MinimalIndexingChunkSize, long long)
+
 protected:
   vtkLidarReader() = default;
   ~vtkLidarReader() = default;
@@ -91,6 +104,13 @@ protected:
   //! Show/Hide the first and last frame that most of the time are partial frames
   bool ShowFirstAndLastFrame = false;
 
+  //! Maximum number of threads used to build the frame index of large pcap files,
+  //! 0 means one thread per core and 1 disables the parallel indexing
+  int NumberOfIndexingThreads = 0;
+
+  //! Minimal size, in bytes, of the part of a pcap indexed by each thread
+  long long MinimalIndexingChunkSize = 64 * 1024 * 1024;
+
   //! libpcap wrapped reader which enable to get the raw pcap packet from the pcap file
   vtkPacketFileReader* Reader = nullptr;
 
@@ -100,6 +120,14 @@ private:
    * In case the calibration is contained in the pcap file, this will also read it
    */
   int ReadFrameInformation();
+
+  /**
+   * @brief ReadFrameInformationInParallel split the pcap in parts which are indexed concurrently,
+   * then stitch the frame index at the junction of the parts. This is only possible when the
+   * interpreter supports explicit indexing states and the calibration is not contained in the pcap.
+   * @return false if the pcap could not be indexed in parallel, the frame index is then left untouched
+   */
+  bool ReadFrameInformationInParallel();
   /**
    * @brief SetTimestepInformation Set the timestep available
    * @param info
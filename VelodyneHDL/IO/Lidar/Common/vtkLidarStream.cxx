@@ -21,10 +21,33 @@
 #include "PacketConsumer.h"
 #include "PacketFileWriter.h"
 
+// STD
+#include <atomic>
+
 // VTK
+#include <vtkAppendPolyData.h>
 #include <vtkInformationVector.h>
 #include <vtkInformation.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkUnsignedCharArray.h>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> TagWithSensor(vtkPolyData* frame, int sensor)
+{
+  auto tagged = vtkSmartPointer<vtkPolyData>::New();
+  tagged->ShallowCopy(frame);
+  auto sensorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  sensorArray->SetName("sensor");
+  sensorArray->SetNumberOfTuples(frame->GetNumberOfPoints());
+  sensorArray->FillComponent(0, sensor);
+  tagged->GetPointData()->AddArray(sensorArray);
+  return tagged;
+}
+}
 
 class vtkLidarStreamInternal
 {
@@ -44,6 +67,30 @@ public:
   std::shared_ptr<PacketConsumer> Consumer;
   std::shared_ptr<PacketFileWriter> Writer;
   std::unique_ptr<NetworkSource> Network;
+
+  //! set once a notification has been sent, until the next Poll
+  std::atomic<bool> NotificationPending{ false };
+  boost::mutex NewFrameCallbackMutex;
+  std::function<void()> NewFrameCallback;
+
+  //! sensors declared with AddSensorFromCalibration, added on the next Start
+  struct SensorConfiguration
+  {
+    int Port;
+    std::string CalibrationFileName;
+    int ForwardedPort;
+  };
+  std::vector<SensorConfiguration> PendingSensors;
+
+  //! interpreters and consumers of the sensors added with AddSensor
+  std::vector<vtkSmartPointer<vtkLidarPacketInterpreter> > SensorInterpreters;
+  std::vector<std::shared_ptr<PacketConsumer> > SensorConsumers;
+
+  //! return the consumer of a sensor, the main sensor being 0
+  PacketConsumer* GetConsumer(int sensor)
+  {
+    return sensor == 0 ? this->Consumer.get() : this->SensorConsumers[sensor - 1].get();
+  }
 };
 
 
@@ -54,6 +101,7 @@ vtkStandardNewMacro(vtkLidarStream)
 vtkLidarStream::vtkLidarStream()
 {
   this->Internal = new vtkLidarStreamInternal(2368, 2369, "127.0.0.1", false, false);
+  this->Internal->Consumer->SetNewFrameCallback([this]() { this->NotifyNewFrame(0); });
 }
 
 //-----------------------------------------------------------------------------
@@ -173,11 +221,251 @@ void vtkLidarStream::SetIsCrashAnalysing(const bool value)
   this->Internal->Network->IsCrashAnalysing = value;
 }
 
+//-----------------------------------------------------------------------------
+int vtkLidarStream::AddSensor(int port, vtkLidarPacketInterpreter* interpreter, int forwardedPort)
+{
+  if (!interpreter)
+  {
+    vtkErrorMacro(<< "An interpreter is required to add a sensor");
+    return -1;
+  }
+
+  std::shared_ptr<PacketConsumer> consumer(new PacketConsumer);
+  const int sensor = this->GetNumberOfSensors();
+  consumer->SetNewFrameCallback([this, sensor]() { this->NotifyNewFrame(sensor); });
+  consumer->SetInterpreter(interpreter);
+  consumer->SetMaxNumberOfFrames(this->GetCacheSize());
+  consumer->SetMaxQueueSize(this->GetMaxQueueSize());
+  const OverloadController overload = this->Internal->Consumer->GetOverloadController();
+  consumer->SetOverloadPolicy(overload.GetPolicy());
+  consumer->SetOverloadQueueDepths(overload.GetLowQueueDepth(), overload.GetHighQueueDepth());
+  consumer->SetOverloadRecoveryFrames(overload.GetRecoveryFrames());
+  this->Internal->SensorInterpreters.push_back(interpreter);
+  this->Internal->SensorConsumers.push_back(consumer);
+  this->Modified();
+  return this->Internal->Network->AddSensor(consumer, port, forwardedPort);
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::AddSensorFromCalibration(int port, const std::string& calibrationFile,
+                                              int forwardedPort)
+{
+  this->Internal->PendingSensors.push_back({ port, calibrationFile, forwardedPort });
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::RemoveAdditionalSensors()
+{
+  this->Internal->PendingSensors.clear();
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->Stop();
+  }
+  this->Internal->Network->RemoveAdditionalSensors();
+  this->Internal->SensorConsumers.clear();
+  this->Internal->SensorInterpreters.clear();
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkLidarStream::GetNumberOfSensors()
+{
+  return this->Internal->Network->GetNumberOfSensors();
+}
+
+//-----------------------------------------------------------------------------
+unsigned int vtkLidarStream::GetMaxQueueSize()
+{
+  return this->Internal->Consumer->GetMaxQueueSize();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::SetMaxQueueSize(unsigned int maxSize)
+{
+  if (maxSize == this->GetMaxQueueSize())
+  {
+    return;
+  }
+
+  this->Internal->Consumer->SetMaxQueueSize(maxSize);
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->SetMaxQueueSize(maxSize);
+  }
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkLidarStream::GetOverloadPolicy()
+{
+  return this->Internal->Consumer->GetOverloadController().GetPolicy();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::SetOverloadPolicy(int policy)
+{
+  if (policy == this->GetOverloadPolicy())
+  {
+    return;
+  }
+
+  this->Internal->Consumer->SetOverloadPolicy(policy);
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->SetOverloadPolicy(policy);
+  }
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+unsigned int vtkLidarStream::GetOverloadLowQueueDepth()
+{
+  return this->Internal->Consumer->GetOverloadController().GetLowQueueDepth();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::SetOverloadLowQueueDepth(unsigned int depth)
+{
+  const unsigned int high = this->GetOverloadHighQueueDepth();
+  if (depth == this->GetOverloadLowQueueDepth())
+  {
+    return;
+  }
+
+  this->Internal->Consumer->SetOverloadQueueDepths(depth, high);
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->SetOverloadQueueDepths(depth, high);
+  }
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+unsigned int vtkLidarStream::GetOverloadHighQueueDepth()
+{
+  return this->Internal->Consumer->GetOverloadController().GetHighQueueDepth();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::SetOverloadHighQueueDepth(unsigned int depth)
+{
+  const unsigned int low = this->GetOverloadLowQueueDepth();
+  if (depth == this->GetOverloadHighQueueDepth())
+  {
+    return;
+  }
+
+  this->Internal->Consumer->SetOverloadQueueDepths(low, depth);
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->SetOverloadQueueDepths(low, depth);
+  }
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkLidarStream::GetOverloadRecoveryFrames()
+{
+  return this->Internal->Consumer->GetOverloadController().GetRecoveryFrames();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::SetOverloadRecoveryFrames(int frames)
+{
+  if (frames == this->GetOverloadRecoveryFrames())
+  {
+    return;
+  }
+
+  this->Internal->Consumer->SetOverloadRecoveryFrames(frames);
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->SetOverloadRecoveryFrames(frames);
+  }
+  this->Modified();
+}
+
+//-----------------------------------------------------------------------------
+int vtkLidarStream::GetOverloadLevel(int sensor)
+{
+  return this->Internal->GetConsumer(sensor)->GetOverloadController().GetLevel();
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkLidarStream::GetNumberOfDroppedFrames(int sensor)
+{
+  return this->Internal->GetConsumer(sensor)->GetOverloadController().GetNumberOfDroppedFrames();
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkLidarStream::GetNumberOfDegradedFrames(int sensor)
+{
+  return this->Internal->GetConsumer(sensor)->GetOverloadController().GetNumberOfDegradedFrames();
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkLidarStream::GetNumberOfReceivedPackets(int sensor)
+{
+  return this->Internal->Network->GetSensorStatistics(sensor).ReceivedPackets;
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkLidarStream::GetNumberOfDroppedPackets(int sensor)
+{
+  return this->Internal->Network->GetSensorStatistics(sensor).DroppedPackets;
+}
+
+//-----------------------------------------------------------------------------
+double vtkLidarStream::GetDropRate(int sensor)
+{
+  return this->Internal->Network->GetSensorStatistics(sensor).GetDropRate();
+}
+
+//-----------------------------------------------------------------------------
+unsigned int vtkLidarStream::GetQueueDepth(int sensor)
+{
+  return this->Internal->Network->GetSensorStatistics(sensor).QueueDepth;
+}
+
+//-----------------------------------------------------------------------------
+unsigned int vtkLidarStream::GetMaxQueueDepth(int sensor)
+{
+  return this->Internal->Network->GetSensorStatistics(sensor).MaxQueueDepth;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::SetNewFrameCallback(std::function<void()> callback)
+{
+  boost::lock_guard<boost::mutex> lock(this->Internal->NewFrameCallbackMutex);
+  this->Internal->NewFrameCallback = callback;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarStream::NotifyNewFrame(int sensor)
+{
+  if (sensor != 0 && !this->FuseSensors)
+  {
+    return;
+  }
+
+  // coalesce the frames completed until the next Poll into a single notification
+  if (this->Internal->NotificationPending.exchange(true))
+  {
+    return;
+  }
+
+  boost::lock_guard<boost::mutex> lock(this->Internal->NewFrameCallbackMutex);
+  if (this->Internal->NewFrameCallback)
+  {
+    this->Internal->NewFrameCallback();
+  }
+}
+
 //-----------------------------------------------------------------------------
 bool vtkLidarStream::GetNeedsUpdate()
 {
-  Poll();
-  return true;
+  return this->Poll();
 }
 
 //----------------------------------------------------------------------------
@@ -188,6 +476,28 @@ void vtkLidarStream::Start()
     vtkErrorMacro(<< "Please set a Interpreter")
   }
   this->Internal->Consumer->SetInterpreter(this->Interpreter);
+
+  // the interpreters of the declared sensors are of the same kind as the main one
+  if (this->Interpreter)
+  {
+    for (const auto& configuration : this->Internal->PendingSensors)
+    {
+      auto interpreter = vtkSmartPointer<vtkLidarPacketInterpreter>::Take(
+        this->Interpreter->NewInstance());
+      interpreter->SetCalibrationFileName(configuration.CalibrationFileName);
+      interpreter->LoadCalibration(configuration.CalibrationFileName);
+      if (!interpreter->GetIsCalibrated())
+      {
+        vtkErrorMacro(<< "The sensor on port " << configuration.Port
+                      << " is ignored, its calibration file cannot be loaded: "
+                      << configuration.CalibrationFileName);
+        continue;
+      }
+      this->AddSensor(configuration.Port, interpreter, configuration.ForwardedPort);
+    }
+    this->Internal->PendingSensors.clear();
+  }
+
   if (this->Internal->OutputFileName.length())
   {
     this->Internal->Writer->Start(this->Internal->OutputFileName);
@@ -212,6 +522,10 @@ void vtkLidarStream::Start()
 //  }
 
   this->Internal->Consumer->Start();
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->Start();
+  }
 //  this->Internal->Network->LIDARPort = this->LIDARPort;
 //  this->Internal->Network->ForwardedLIDARPort = this->ForwardedLIDARPort;
 //  this->Internal->Network->ForwardedIpAddress = this->ForwardedIpAddress;
@@ -225,16 +539,34 @@ void vtkLidarStream::Stop()
 {
   this->Internal->Network->Stop();
   this->Internal->Consumer->Stop();
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->Stop();
+  }
   this->Internal->Writer->Stop();
 }
 
 //----------------------------------------------------------------------------
-void vtkLidarStream::Poll()
+bool vtkLidarStream::Poll()
 {
-  if (this->Internal->Consumer->CheckForNewData())
+  // frames completed from now on trigger a new notification
+  this->Internal->NotificationPending = false;
+
+  bool newData = this->Internal->Consumer->CheckForNewData();
+  if (this->FuseSensors)
+  {
+    for (const auto& consumer : this->Internal->SensorConsumers)
+    {
+      newData |= consumer->CheckForNewData();
+    }
+  }
+
+  if (newData)
   {
     this->Modified();
+    this->InvokeEvent(NewFrameEvent);
   }
+  return newData;
 }
 
 //----------------------------------------------------------------------------
@@ -252,6 +584,10 @@ void vtkLidarStream::SetCacheSize(int cacheSize)
   }
 
   this->Internal->Consumer->SetMaxNumberOfFrames(cacheSize);
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->SetMaxNumberOfFrames(cacheSize);
+  }
   this->Modified();
 }
 
@@ -259,6 +595,10 @@ void vtkLidarStream::SetCacheSize(int cacheSize)
 void vtkLidarStream::UnloadFrames()
 {
   this->Internal->Consumer->UnloadData();
+  for (const auto& consumer : this->Internal->SensorConsumers)
+  {
+    consumer->UnloadData();
+  }
 }
 
 
@@ -302,6 +642,7 @@ int vtkLidarStream::RequestData(vtkInformation* vtkNotUsed(request),
     timeRequest = outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
   }
 
+  double receptionTime = 0;
   {
     boost::lock_guard<boost::mutex> lock(this->Internal->Consumer->ConsumerMutex);
     double actualTime;
@@ -321,12 +662,42 @@ int vtkLidarStream::RequestData(vtkInformation* vtkNotUsed(request),
       // printf("request %f, returning %f\n", timeRequest, actualTime);
       output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), actualTime);
       output->ShallowCopy(polyData);
+      receptionTime = this->Internal->Consumer->GetReceptionTimeForTime(timeRequest);
     }
   }
 
+  // Append the frames of the other sensors received at the same time
+  const int nbSensors = this->GetNumberOfSensors();
+  if (this->FuseSensors && nbSensors > 1 && receptionTime > 0)
+  {
+    vtkNew<vtkAppendPolyData> append;
+    append->AddInputData(TagWithSensor(vtkPolyData::SafeDownCast(output), 0));
+    for (int sensor = 1; sensor < nbSensors; ++sensor)
+    {
+      PacketConsumer* consumer = this->Internal->GetConsumer(sensor);
+      boost::lock_guard<boost::mutex> lock(consumer->ConsumerMutex);
+      vtkSmartPointer<vtkPolyData> frame =
+        consumer->GetFrameForReceptionTime(receptionTime, this->FusionTimeTolerance);
+      if (frame)
+      {
+        append->AddInputData(TagWithSensor(frame, sensor));
+      }
+    }
+    append->Update();
+    double timeStep = output->GetInformation()->Get(vtkDataObject::DATA_TIME_STEP());
+    output->ShallowCopy(append->GetOutput());
+    output->GetInformation()->Set(vtkDataObject::DATA_TIME_STEP(), timeStep);
+  }
+
   vtkTable* calibration = vtkTable::GetData(outputVector,1);
   vtkTable *t = this->Interpreter->GetCalibrationTable();
   calibration->ShallowCopy(t);
 
+  vtkSmartPointer<vtkTable> statistics = this->Interpreter->GetLaserStatistics();
+  if (statistics)
+  {
+    vtkTable::GetData(outputVector, 2)->ShallowCopy(statistics);
+  }
+
   return 1;
 }
@@ -18,6 +18,10 @@
 
 #include "vtkLidarProvider.h"
 
+#include <vtkCommand.h>
+
+#include <functional>
+
 class vtkLidarStreamInternal;
 
 class VTK_EXPORT vtkLidarStream : public vtkLidarProvider
@@ -26,9 +30,26 @@ public:
   static vtkLidarStream* New();
   vtkTypeMacro(vtkLidarStream, vtkLidarProvider)
 
+  //! Event invoked by Poll when new frames are available
+  enum { NewFrameEvent = vtkCommand::UserEvent + 1 };
+
   int GetNumberOfFrames() override;
 
-  void Poll();
+  /**
+   * @brief Poll check if new frames are available, in which case the stream is
+   * marked as modified and NewFrameEvent is invoked. Must be called from the main thread.
+   * @return true if new frames are available
+   */
+  bool Poll();
+
+  /**
+   * @brief SetNewFrameCallback set a function called when a frame is completed, so
+   * that the UI does not have to poll the stream. It is called from the receiving
+   * thread, so it should only schedule a call to Poll in the main thread. Frames
+   * completed before this call to Poll are coalesced: the function is called again
+   * only after Poll. Frames of the additional sensors only notify when FuseSensors is set.
+   */
+  void SetNewFrameCallback(std::function<void()> callback);
 
   void Start();
   void Stop();
@@ -89,7 +110,114 @@ public:
   void SetIsCrashAnalysing(bool value);
 
   /**
-   * @brief GetNeedsUpdate
+   * @brief AddSensor listen to an additional lidar on its own port. Its packets are
+   * received on a dedicated thread and decoded by the given interpreter, which must
+   * already be calibrated. This must be called while the stream is stopped.
+   * @param port the port to receive the sensor packets
+   * @param interpreter the interpreter decoding the sensor packets
+   * @param forwardedPort the port to forward the packets to, 0 disables the forwarding
+   * @return the index of the sensor, the main sensor being 0
+   */
+  int AddSensor(int port, vtkLidarPacketInterpreter* interpreter, int forwardedPort = 0);
+
+  /**
+   * @brief AddSensorFromCalibration declare an additional lidar of the same kind as the
+   * main one. Its interpreter is created and calibrated when the stream is started,
+   * so that the sensor can be configured before the main interpreter is set, as done
+   * by the "AdditionalSensors" property.
+   * @param port the port to receive the sensor packets
+   * @param calibrationFile the calibration file of the sensor
+   * @param forwardedPort the port to forward the packets to, 0 disables the forwarding
+   */
+  void AddSensorFromCalibration(int port, const std::string& calibrationFile, int forwardedPort);
+
+  /**
+   * @brief RemoveAdditionalSensors remove all sensors added with AddSensor or
+   * AddSensorFromCalibration
+   */
+  void RemoveAdditionalSensors();
+
+  /**
+   * @brief GetNumberOfSensors return the number of sensors, including the main one
+   */
+  int GetNumberOfSensors();
+
+  //! Merge the frames of all sensors into the output, aligned on the main sensor frames
+  vtkGetMacro(FuseSensors, bool)
+  vtkSetMacro(FuseSensors, bool)
+
+  //! Maximum reception time difference, in seconds, to fuse a frame with the main sensor one
+  vtkGetMacro(FusionTimeTolerance, double)
+  vtkSetMacro(FusionTimeTolerance, double)
+
+  /**
+   * @copydoc PacketConsumer::SetMaxQueueSize
+   */
+  unsigned int GetMaxQueueSize();
+  void SetMaxQueueSize(unsigned int maxSize);
+
+  /**
+   * @copydoc OverloadController::Policy
+   * This is applied to all sensors, along with the other overload settings.
+   */
+  int GetOverloadPolicy();
+  void SetOverloadPolicy(int policy);
+
+  //! Queue depth, in packets, below which the decoding of a sensor can recover
+  unsigned int GetOverloadLowQueueDepth();
+  void SetOverloadLowQueueDepth(unsigned int depth);
+
+  //! Queue depth, in packets, above which the decoding of a sensor sheds more work
+  unsigned int GetOverloadHighQueueDepth();
+  void SetOverloadHighQueueDepth(unsigned int depth);
+
+  //! Number of consecutive calm frames required to decrease the overload level
+  int GetOverloadRecoveryFrames();
+  void SetOverloadRecoveryFrames(int frames);
+
+  /**
+   * @brief GetOverloadLevel return how much work the decoding of a sensor currently
+   * sheds, from 0 (none) to OverloadController::MaxLevel
+   */
+  int GetOverloadLevel(int sensor);
+
+  /**
+   * @copydoc OverloadController::GetNumberOfDroppedFrames
+   */
+  unsigned long GetNumberOfDroppedFrames(int sensor);
+
+  /**
+   * @copydoc OverloadController::GetNumberOfDegradedFrames
+   */
+  unsigned long GetNumberOfDegradedFrames(int sensor);
+
+  /**
+   * @copydoc SensorStatistics::ReceivedPackets
+   */
+  unsigned long GetNumberOfReceivedPackets(int sensor);
+
+  /**
+   * @copydoc SensorStatistics::DroppedPackets
+   */
+  unsigned long GetNumberOfDroppedPackets(int sensor);
+
+  /**
+   * @brief GetDropRate return the ratio of dropped packets over the received ones
+   */
+  double GetDropRate(int sensor);
+
+  /**
+   * @copydoc SensorStatistics::QueueDepth
+   */
+  unsigned int GetQueueDepth(int sensor);
+
+  /**
+   * @copydoc SensorStatistics::MaxQueueDepth
+   */
+  unsigned int GetMaxQueueDepth(int sensor);
+
+  /**
+   * @brief GetNeedsUpdate poll the stream, used by the LiveSource behavior
    * @return true if a new frame is ready
    */
   bool GetNeedsUpdate();
@@ -104,7 +232,13 @@ protected:
 
   virtual int RequestInformation(vtkInformation*, vtkInformationVector**, vtkInformationVector*);
 
+  bool FuseSensors = false;
+  double FusionTimeTolerance = 0.05;
+
 private:
+  //! Called from the consumer threads each time a frame is completed
+  void NotifyNewFrame(int sensor);
+
   vtkLidarStreamInternal* Internal;
   vtkLidarStream(const vtkLidarStream&); // not implemented
   void operator=(const vtkLidarStream&); // not implemented
@@ -1,4 +1,5 @@
 #include "vtkLidarKITTIDataSetReader.h"
+#include "vtkVertexCells.h"
 
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkInformationVector.h>
@@ -6,31 +7,17 @@
 #include <vtkPoints.h>
 #include <vtkPointData.h>
 #include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
 #include <vtkPolyData.h>
 #include <vtkMath.h>
 
+#include <fstream>
+#include <iomanip>
 #include <sstream>
 
 # include <boost/filesystem.hpp>
 
 namespace  {
-//-----------------------------------------------------------------------------
-vtkSmartPointer<vtkCellArray> NewVertexCells(vtkIdType numberOfVerts)
-{
-  vtkNew<vtkIdTypeArray> cells;
-  cells->SetNumberOfValues(numberOfVerts * 2);
-  vtkIdType* ids = cells->GetPointer(0);
-  for (vtkIdType i = 0; i < numberOfVerts; ++i)
-  {
-    ids[i * 2] = 1;
-    ids[i * 2 + 1] = i;
-  }
-
-  vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
-  cellArray->SetCells(numberOfVerts, cells.GetPointer());
-  return cellArray;
-}
-
 //-----------------------------------------------------------------------------
 template<typename T>
 vtkSmartPointer<T> CreateDataArray(const char* name, vtkPolyData* pd)
@@ -77,6 +64,7 @@ void vtkLidarKITTIDataSetReader::SetFileName(const std::string &filename)
     *it++;
   }
   this->FileName = filename + "/";
+  this->ClearFrameCache();
   this->Modified();
 }
 
@@ -87,8 +75,74 @@ std::string vtkLidarKITTIDataSetReader::GetSensorInformation()
           The data are the .bin file contain in following folder: " + this->FileName;
 }
 
+//-----------------------------------------------------------------------------
+void vtkLidarKITTIDataSetReader::SetFrameCacheSize(int size)
+{
+  size = std::max(0, size);
+  if (size == this->FrameCacheSize)
+  {
+    return;
+  }
+  this->FrameCacheSize = size;
+  this->Modified();
+  while (static_cast<int>(this->FrameCacheOrder.size()) > this->FrameCacheSize)
+  {
+    this->FrameCache.erase(this->FrameCacheOrder.back());
+    this->FrameCacheOrder.pop_back();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarKITTIDataSetReader::ClearFrameCache()
+{
+  this->FrameCache.clear();
+  this->FrameCacheOrder.clear();
+}
+
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkLidarKITTIDataSetReader::GetFrame(int frameNumber)
+{
+  vtkSmartPointer<vtkPolyData> frame;
+  auto cached = this->FrameCache.find(frameNumber);
+  if (cached != this->FrameCache.end())
+  {
+    frame = cached->second;
+    // move the frame at the front of the LRU list
+    this->FrameCacheOrder.remove(frameNumber);
+    this->FrameCacheOrder.push_front(frameNumber);
+  }
+  else
+  {
+    frame = this->ReadFrame(frameNumber);
+    if (!frame)
+    {
+      // a failure is not cached, so that the file is read again on the next request
+      vtkSmartPointer<vtkPolyData> empty = vtkSmartPointer<vtkPolyData>::New();
+      empty->SetVerts(NewVertexCells(0));
+      return empty;
+    }
+    if (this->FrameCacheSize > 0)
+    {
+      this->FrameCache[frameNumber] = frame;
+      this->FrameCacheOrder.push_front(frameNumber);
+      if (static_cast<int>(this->FrameCacheOrder.size()) > this->FrameCacheSize)
+      {
+        this->FrameCache.erase(this->FrameCacheOrder.back());
+        this->FrameCacheOrder.pop_back();
+      }
+    }
+  }
+
+  // a shallow copy would share the arrays with the cache, and a caller modifying
+  // their values would corrupt the cached frame, so the frame is deep copied. This
+  // is still much cheaper than decoding the .bin file again.
+  vtkSmartPointer<vtkPolyData> poly = vtkSmartPointer<vtkPolyData>::New();
+  poly->DeepCopy(frame);
+  return poly;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> vtkLidarKITTIDataSetReader::ReadFrame(int frameNumber)
 {
   // create a new empty frame
   vtkSmartPointer<vtkPolyData> poly = vtkSmartPointer<vtkPolyData>::New();
@@ -110,75 +164,101 @@ vtkSmartPointer<vtkPolyData> vtkLidarKITTIDataSetReader::GetFrame(int frameNumbe
   vtkSmartPointer<vtkDoubleArray> timestamp = CreateDataArray<vtkDoubleArray>("timestamp", poly);
   vtkSmartPointer<vtkDoubleArray> adjustedTime = CreateDataArray<vtkDoubleArray>("adjustedtime", poly);
 
-  int startFrame = std::max(0, frameNumber);
-  for (int i = startFrame; i <= frameNumber; i++)
+  // produce path to the required .bin file
+  std::stringstream ss;
+  ss << std::setw(10) << std::setfill('0') << frameNumber;
+  std::string filename = this->GetFileName() + ss.str() + ".bin";
+
+  std::ifstream is(filename, std::ios::binary | std::ios::in | std::ios::ate);
+  if (!is.is_open())
   {
-    // produce path to the required .bin file
-    std::stringstream ss;
-    ss << std::setw(10) << std::setfill('0') << i;
-    std::string filename = this->GetFileName() + ss.str() + ".bin";
-
-    ifstream is;
-    is.open(filename, ios::binary|ios::in);
-    // get length of file:
-    is.seekg(0, ios::end);
-    int length = is.tellg();
-    is.seekg(0, ios::beg);
-
-    // variable used to detect a laser jump
-    double old_thetaProj = 0;
-    int laser_id = 0;
-
-    // buffer used to read the points
-    char buffer[16];
-    const int nbPoints = length / 16;
-    for (int i = 0; i < nbPoints; i++)
-    {
-      is.read(buffer, 16);
-      point_t* pt;
-      pt = reinterpret_cast<point_t*>(buffer);
-      double x = pt->x;
-      double y = pt->y;
-      double z = pt->z;
+    vtkErrorMacro(<< "Could not open file: " << filename);
+    return nullptr;
+  }
 
-      double radius = sqrt(x*x + y*y + z*z);
-      double thetaProj = 180 / vtkMath::Pi() * std::atan2(pt->y, pt->x);
-      double azimut = 180 / vtkMath::Pi() * std::atan2(pt->x, pt->y);
+  // load the whole file at once
+  const std::streamsize length = is.tellg();
+  const vtkIdType nbPoints = static_cast<vtkIdType>(length / sizeof(point_t));
+  std::vector<point_t> buffer(nbPoints);
+  is.seekg(0, std::ios::beg);
+  is.read(reinterpret_cast<char*>(buffer.data()), nbPoints * sizeof(point_t));
+  is.close();
 
-      if (azimut < 0)
-        azimut = 360 + azimut;
+  // preallocate all arrays, so that they can be filled through raw pointers
+  points->SetNumberOfPoints(nbPoints);
+  float* pointsPtr = vtkFloatArray::SafeDownCast(points->GetData())->GetPointer(0);
+  double* xPtr = xArray->WritePointer(0, nbPoints);
+  double* yPtr = yArray->WritePointer(0, nbPoints);
+  double* zPtr = zArray->WritePointer(0, nbPoints);
+  double* intensityPtr = intensityArray->WritePointer(0, nbPoints);
+  double* azimutPtr = azimutArray->WritePointer(0, nbPoints);
+  double* elevationPtr = elevationArray->WritePointer(0, nbPoints);
+  double* radiusPtr = radiusArray->WritePointer(0, nbPoints);
+  double* idPtr = idArray->WritePointer(0, nbPoints);
+  double* timestampPtr = timestamp->WritePointer(0, nbPoints);
+  double* adjustedTimePtr = adjustedTime->WritePointer(0, nbPoints);
 
-      if(old_thetaProj < 0 && thetaProj >= 0)
+  // variable used to detect a laser jump
+  double old_thetaProj = 0;
+  int laser_id = 0;
+
+  vtkIdType nbProcessedPoints = 0;
+  for (; nbProcessedPoints < nbPoints; nbProcessedPoints++)
+  {
+    const point_t& pt = buffer[nbProcessedPoints];
+    double x = pt.x;
+    double y = pt.y;
+    double z = pt.z;
+
+    double thetaProj = 180 / vtkMath::Pi() * std::atan2(y, x);
+    if(old_thetaProj < 0 && thetaProj >= 0)
+    {
+      laser_id++;
+      if (laser_id >= this->NbrLaser)
       {
-        laser_id++;
-        if (laser_id >= this->NbrLaser)
-        {
-          vtkErrorMacro(<< "An error occur while parsing the frame, more than 64 laser where detected. The last point won't be processed")
-          break;
-        }
+        vtkErrorMacro(<< "An error occur while parsing the frame, more than 64 laser where detected. The last point won't be processed")
+        break;
       }
-      double projRadius = std::sqrt(pt->x * pt->x + pt->y * pt->y);
-      double elevation = 180 / vtkMath::Pi() * std::atan2(pt->z, projRadius);
-
-      double time = azimut / 360.0;
-
-      // fill the polydata
-      points->InsertNextPoint(pt->x, pt->y, pt->z);
-      xArray->InsertNextValue(pt->x);
-      yArray->InsertNextValue(pt->y);
-      zArray->InsertNextValue(pt->z);
-      radiusArray->InsertNextValue(radius);
-      intensityArray->InsertNextValue(pt->intensity);
-      azimutArray->InsertNextValue(azimut);
-      idArray->InsertNextValue(laser_id);
-      elevationArray->InsertNextValue(elevation);
-      timestamp->InsertNextValue(time);
-      adjustedTime->InsertNextValue(time);
-
-      // update old azimut
-      old_thetaProj = thetaProj;
     }
-    is.close();
+
+    double azimut = 180 / vtkMath::Pi() * std::atan2(x, y);
+    if (azimut < 0)
+      azimut = 360 + azimut;
+
+    double projRadius = std::sqrt(x * x + y * y);
+    double radius = std::sqrt(projRadius * projRadius + z * z);
+    double elevation = 180 / vtkMath::Pi() * std::atan2(z, projRadius);
+
+    double time = azimut / 360.0;
+
+    // fill the polydata
+    const vtkIdType i = nbProcessedPoints;
+    pointsPtr[3 * i] = pt.x;
+    pointsPtr[3 * i + 1] = pt.y;
+    pointsPtr[3 * i + 2] = pt.z;
+    xPtr[i] = x;
+    yPtr[i] = y;
+    zPtr[i] = z;
+    radiusPtr[i] = radius;
+    intensityPtr[i] = pt.intensity;
+    azimutPtr[i] = azimut;
+    idPtr[i] = laser_id;
+    elevationPtr[i] = elevation;
+    timestampPtr[i] = time;
+    adjustedTimePtr[i] = time;
+
+    // update old azimut
+    old_thetaProj = thetaProj;
+  }
+
+  // shrink the arrays in case the parsing stopped before the end of the file
+  if (nbProcessedPoints != nbPoints)
+  {
+    points->SetNumberOfPoints(nbProcessedPoints);
+    for (int k = 0; k < poly->GetPointData()->GetNumberOfArrays(); ++k)
+    {
+      poly->GetPointData()->GetArray(k)->SetNumberOfTuples(nbProcessedPoints);
+    }
   }
 
   poly->SetVerts(NewVertexCells(poly->GetNumberOfPoints()));
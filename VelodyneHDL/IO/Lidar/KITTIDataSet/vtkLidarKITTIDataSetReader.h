@@ -6,6 +6,9 @@
 #include <vtkSmartPointer.h>
 #include <vtkPolyData.h>
 
+#include <list>
+#include <map>
+
 #ifndef _WIN32
 #define notImpementedBody \
 std::cerr << typeid(this).name() << "::" << __func__ << " is not implemented" << std::endl;
@@ -50,6 +53,17 @@ public:
   // return the number of channels
   vtkGetMacro(NbrLaser, int)
 
+  //! @{
+  //! @copydoc FrameCacheSize
+  vtkGetMacro(FrameCacheSize, int)
+  void SetFrameCacheSize(int size);
+  //! @}
+
+  /**
+   * @brief ClearFrameCache drop all decoded frames kept in memory
+   */
+  void ClearFrameCache();
+
 private:
   vtkLidarKITTIDataSetReader() = default;
 
@@ -59,6 +73,15 @@ private:
 
   int RequestInformation(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
 
+  /**
+   * @brief ReadFrame decode a .bin file of the sequence into a new polydata.
+   * The whole file is loaded with a single read and the interleaved x/y/z/intensity
+   * records are dispatched directly into preallocated arrays.
+   * @param frameNumber index of the .bin file to decode
+   * @return the decoded frame, or nullptr if the file cannot be read
+   */
+  vtkSmartPointer<vtkPolyData> ReadFrame(int frameNumber);
+
   //! folder containing all the .bin file for a sequence
   //! this should be named FolderName but to keep the same API we will keep FileName
   std::string FileName = "";
@@ -71,6 +94,17 @@ private:
 
   int NbrLaser = 64;
 
+  //! Maximum number of decoded frames kept in memory. This avoids re-parsing the
+  //! same .bin files when a frame is requested several times (trailing frames,
+  //! back and forth playback, ...). 0 disables the cache.
+  int FrameCacheSize = 10;
+
+  //! Decoded frames indexed by frame number
+  std::map<int, vtkSmartPointer<vtkPolyData> > FrameCache;
+
+  //! Frame numbers contained in the cache, from the most to the least recently used
+  std::list<int> FrameCacheOrder;
+
   vtkLidarKITTIDataSetReader(const vtkLidarKITTIDataSetReader&) = delete;
   void operator=(const vtkLidarKITTIDataSetReader&) = delete;
 };
@@ -3,11 +3,14 @@
 #include <vtkPoints.h>
 #include <vtkPointData.h>
 #include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkTransform.h>
 
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/foreach.hpp>
+#include <boost/thread/lock_guard.hpp>
 #include "vtkDataPacket.h"
 #include "vtkRollingDataAccumulator.h"
 
@@ -42,6 +45,57 @@ vtkSmartPointer<T> CreateDataArray(const char* name, vtkIdType np, vtkIdType pre
   return array;
 }
 
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataArray> CreateOptionalDataArray(const char* name, int storage, vtkIdType np,
+                                                      vtkIdType prereserved_np, vtkPolyData* pd)
+{
+  switch (storage)
+  {
+    case vtkVelodynePacketInterpreter::Float:
+      return CreateDataArray<vtkFloatArray>(name, np, prereserved_np, pd);
+    case vtkVelodynePacketInterpreter::Double:
+      return CreateDataArray<vtkDoubleArray>(name, np, prereserved_np, pd);
+    default:
+      return nullptr;
+  }
+}
+
+//-----------------------------------------------------------------------------
+inline void InsertNextValueIfEnabled(vtkDataArray* array, double value)
+{
+  if (vtkDoubleArray* doubleArray = vtkDoubleArray::FastDownCast(array))
+  {
+    doubleArray->InsertNextValue(value);
+  }
+  else if (vtkFloatArray* floatArray = vtkFloatArray::FastDownCast(array))
+  {
+    floatArray->InsertNextValue(static_cast<float>(value));
+  }
+}
+
+//-----------------------------------------------------------------------------
+//! Index of the lowest set bit of a non null value
+inline int LowestSetBit(uint32_t value)
+{
+  // de Bruijn sequence, as the bit scan intrinsics are not portable
+  static const int position[32] = { 0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+                                    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9 };
+  return position[((value & (~value + 1)) * 0x077CB531u) >> 27];
+}
+
+//-----------------------------------------------------------------------------
+inline void SetValueIfEnabled(vtkDataArray* array, vtkIdType id, double value)
+{
+  if (vtkDoubleArray* doubleArray = vtkDoubleArray::FastDownCast(array))
+  {
+    doubleArray->SetValue(id, value);
+  }
+  else if (vtkFloatArray* floatArray = vtkFloatArray::FastDownCast(array))
+  {
+    floatArray->SetValue(id, static_cast<float>(value));
+  }
+}
+
 // Structure to compute RPM and handle degenerated cases
 struct RPMCalculator
 {
@@ -279,6 +333,43 @@ public:
   {
     return hasChangedWithValue(curValue, hasLastValue, lastValue, lastSlope);
   }
+
+  bool operator==(const FramingState& other) const
+  {
+    return LastAzimuth == other.LastAzimuth && LastAzimuthSlope == other.LastAzimuthSlope;
+  }
+};
+
+//-----------------------------------------------------------------------------
+class VelodyneFrameIndexingState : public FrameIndexingState
+{
+public:
+  std::unique_ptr<FrameIndexingState> Clone() const override
+  {
+    return std::unique_ptr<FrameIndexingState>(new VelodyneFrameIndexingState(*this));
+  }
+
+  bool IsEqual(const FrameIndexingState& other) const override
+  {
+    const VelodyneFrameIndexingState& state = static_cast<const VelodyneFrameIndexingState&>(other);
+    // the counters are only used for debugging purpose
+    return this->Framing == state.Framing && this->IsEmptyFrame == state.IsEmptyFrame;
+  }
+
+  void reset()
+  {
+    this->Framing.reset();
+    this->IsEmptyFrame = true;
+    this->NumberOfFiringPackets = 0;
+    this->LastNumberOfFiringPackets = 0;
+    this->FrameNumber = 0;
+  }
+
+  FramingState Framing;
+  bool IsEmptyFrame = true;
+  int NumberOfFiringPackets = 0;
+  int LastNumberOfFiringPackets = 0;
+  int FrameNumber = 0;
 };
 
 #pragma pack(push, 1)
@@ -450,6 +541,7 @@ vtkVelodynePacketInterpreter::vtkVelodynePacketInterpreter()
   this->OutputPacketProcessingDebugInfo = false;
   this->SensorPowerMode = 0;
   this->CurrentFrameState = new FramingState;
+  this->IndexingState = new VelodyneFrameIndexingState;
   this->LastTimestamp = std::numeric_limits<unsigned int>::max();
   this->TimeAdjust = std::numeric_limits<double>::quiet_NaN();
   this->FiringsSkip = 0;
@@ -458,6 +550,7 @@ vtkVelodynePacketInterpreter::vtkVelodynePacketInterpreter()
   std::fill(this->LastPointId, this->LastPointId + HDL_MAX_NUM_LASERS, -1);
 
   this->LaserSelection.resize(HDL_MAX_NUM_LASERS, true);
+  this->UpdateLaserSelectionMask();
   this->DualReturnFilter = 0;
   this->IsHDL64Data = false;
   this->ReportedFactoryField1 = 0;
@@ -476,6 +569,7 @@ vtkVelodynePacketInterpreter::~vtkVelodynePacketInterpreter()
     delete this->rollingCalibrationData;
   }
   delete this->CurrentFrameState;
+  delete this->IndexingState;
 }
 
 //-----------------------------------------------------------------------------
@@ -750,6 +844,8 @@ void vtkVelodynePacketInterpreter::ProcessPacket(unsigned char const * data, uns
   // transform
   if (SensorTransform) this->SensorTransform->Update();
 
+  this->UpdateCropping();
+
   int firingBlock = startPosition;
 
   bool isVLS128 = dataPacket->isVLS128();
@@ -788,11 +884,27 @@ void vtkVelodynePacketInterpreter::ProcessPacket(unsigned char const * data, uns
   if (dataPacket->isDualModeReturn() && !this->HasDualReturn)
   {
     this->HasDualReturn = true;
+    // the dual return arrays are only filled once dual return has been detected,
+    // so fill them for the points already present in the frame
+    const vtkIdType numberOfPoints = this->Points->GetNumberOfPoints();
+    this->Flags->SetNumberOfValues(numberOfPoints);
+    this->DistanceFlag->SetNumberOfValues(numberOfPoints);
+    this->IntensityFlag->SetNumberOfValues(numberOfPoints);
+    this->DualReturnMatching->SetNumberOfValues(numberOfPoints);
+    std::fill_n(this->Flags->GetPointer(0), numberOfPoints, DUAL_DOUBLED);
+    std::fill_n(this->DistanceFlag->GetPointer(0), numberOfPoints, 0);
+    std::fill_n(this->IntensityFlag->GetPointer(0), numberOfPoints, 0);
+    std::fill_n(this->DualReturnMatching->GetPointer(0), numberOfPoints, -1);
     this->CurrentFrame->GetPointData()->AddArray(this->DistanceFlag.GetPointer());
     this->CurrentFrame->GetPointData()->AddArray(this->IntensityFlag.GetPointer());
     this->CurrentFrame->GetPointData()->AddArray(this->DualReturnMatching.GetPointer());
   }
 
+  // The overload decimation keeps or skips whole firings, made of the blocks of all
+  // the laser banks (upper and lower for HDL-64, four for VLS-128) and of both returns
+  const int blocksPerFiring = (dataPacket->isHDL64() ? 2 : (isVLS128 ? 4 : 1)) *
+    (dataPacket->isDualModeReturn() ? 2 : 1);
+
   for (; firingBlock < HDL_FIRING_PER_PKT; ++firingBlock)
   {
     const HDLFiringData* firingData = &(dataPacket->firingData[firingBlock]);
@@ -814,10 +926,30 @@ void vtkVelodynePacketInterpreter::ProcessPacket(unsigned char const * data, uns
 
     if (this->CurrentFrameState->hasChangedWithValue(*firingData))
     {
-      this->SplitFrame();
+      // a skipped frame is empty, it must not be split
+      if (!this->SkipCurrentFrame)
+      {
+        this->SplitFrame();
+      }
+      this->StartNewFrame();
       this->LastTimestamp = std::numeric_limits<unsigned int>::max();
     }
 
+    if (this->SkipCurrentFrame)
+    {
+      continue;
+    }
+
+    if (firingBlock % blocksPerFiring == 0)
+    {
+      this->KeepOverloadFiring =
+        this->OverloadFiringCounter++ % static_cast<unsigned int>(this->OverloadFiringDecimation) == 0;
+    }
+    if (!this->KeepOverloadFiring)
+    {
+      continue;
+    }
+
     if (isVLS128)
     {
       azimuthDiff = dataPacket->getRotationalDiffForVLS128(firingBlock);
@@ -856,32 +988,49 @@ void vtkVelodynePacketInterpreter::ProcessFiring(const HDLFiringData *firingData
     this->FirstPointIdOfDualReturnPair = this->Points->GetNumberOfPoints();
   }
 
-  for (int dsr = 0; dsr < HDL_LASER_PER_FIRING; dsr++)
+  const bool isVLP16 = this->CalibrationReportedNumLasers == 16;
+  if (isVLP16 && firingBlockLaserOffset != 0)
+  {
+    if (!this->alreadyWarnedForIgnoredHDL64FiringPacket)
+    {
+      vtkGenericWarningMacro("Error: Received a HDL-64 UPPERBLOCK firing packet "
+                             "with a VLP-16 calibration file. Ignoring the firing.");
+      this->alreadyWarnedForIgnoredHDL64FiringPacket = true;
+    }
+    return;
+  }
+
+  // without intra firing adjustment, all the lasers share the azimuth of the firing
+  if (!this->UseIntraFiringAdjustment)
   {
+    const double firingAzimuth = static_cast<double>(firingData->rotationalPosition % 36000) / 100.0;
+    if (this->IsAzimuthRangeCroppedOut(firingAzimuth, firingAzimuth))
+    {
+      return;
+    }
+  }
+
+  // selected lasers of the firing, a VLP-16 firing block contains two firings of the 16 lasers
+  uint32_t selectedLasers = this->GetLaserSelectionMask(firingBlockLaserOffset);
+  if (isVLP16)
+  {
+    selectedLasers = (selectedLasers & 0xFFFF) | (selectedLasers << 16);
+  }
+
+  // only visit the selected lasers, in increasing order
+  for (; selectedLasers != 0; selectedLasers &= selectedLasers - 1)
+  {
+    const int dsr = LowestSetBit(selectedLasers);
     const unsigned char rawLaserId = static_cast<unsigned char>(dsr + firingBlockLaserOffset);
     unsigned char laserId = rawLaserId;
     const unsigned short azimuth = firingData->rotationalPosition;
 
     // Detect VLP-16 data and adjust laser id if necessary
     int firingWithinBlock = 0;
-
-    if (this->CalibrationReportedNumLasers == 16)
+    if (isVLP16 && laserId >= 16)
     {
-      if (firingBlockLaserOffset != 0)
-      {
-        if (!this->alreadyWarnedForIgnoredHDL64FiringPacket)
-        {
-          vtkGenericWarningMacro("Error: Received a HDL-64 UPPERBLOCK firing packet "
-                                 "with a VLP-16 calibration file. Ignoring the firing.");
-          this->alreadyWarnedForIgnoredHDL64FiringPacket = true;
-        }
-        return;
-      }
-      if (laserId >= 16)
-      {
-        laserId -= 16;
-        firingWithinBlock = 1;
-      }
+      laserId -= 16;
+      firingWithinBlock = 1;
     }
 
     // Interpolate azimuths and timestamps per laser within firing blocks
@@ -946,8 +1095,12 @@ void vtkVelodynePacketInterpreter::ProcessFiring(const HDLFiringData *firingData
         azimuthDiff * ((timestampadjustment - blockdsr0) / (nextblockdsr0 - blockdsr0)));
       timestampadjustment = vtkMath::Round(timestampadjustment);
     }
+    // check the azimuth cropping before decoding the point, the azimuth is computed
+    // as in PushFiringData
+    const unsigned short laserAzimuth = static_cast<unsigned short>(azimuth + azimuthadjustment) % 36000;
+    const double laserAzimuthDegree = static_cast<double>(laserAzimuth) / 100.0;
     if ((!this->IgnoreZeroDistances || firingData->laserReturns[dsr].distance != 0.0) &&
-      this->LaserSelection[laserId])
+      !this->IsAzimuthRangeCroppedOut(laserAzimuthDegree, laserAzimuthDegree))
     {
       this->PushFiringData(laserId, rawLaserId, azimuth + azimuthadjustment,
         timestamp + timestampadjustment, rawtime + static_cast<unsigned int>(timestampadjustment),
@@ -995,12 +1148,15 @@ void vtkVelodynePacketInterpreter::PushFiringData(unsigned char laserId, unsigne
     }
     else
     {
+      // both returns come from the same laser, so they share the same distance correction
+      // and comparing the raw distances is equivalent to comparing the corrected ones
       const short dualIntensity = this->Intensity->GetValue(dualPointId);
-      const double dualDistance = this->Distance->GetValue(dualPointId);
+      const unsigned short dualDistance = this->DistanceRaw->GetValue(dualPointId);
+      const unsigned short distanceRaw = laserReturn->distance;
       unsigned int firstFlags = this->Flags->GetValue(dualPointId);
       unsigned int secondFlags = 0;
 
-      if (dualDistance == distanceM && intensity == dualIntensity)
+      if (dualDistance == distanceRaw && intensity == dualIntensity)
       {
         // ignore duplicate point and leave first with original flags
         return;
@@ -1017,7 +1173,7 @@ void vtkVelodynePacketInterpreter::PushFiringData(unsigned char laserId, unsigne
         secondFlags |= DUAL_INTENSITY_LOW;
       }
 
-      if (dualDistance < distanceM)
+      if (dualDistance < distanceRaw)
       {
         firstFlags &= ~DUAL_DISTANCE_FAR;
         secondFlags |= DUAL_DISTANCE_FAR;
@@ -1043,14 +1199,21 @@ void vtkVelodynePacketInterpreter::PushFiringData(unsigned char laserId, unsigne
         {
           // first return does not match filter; replace with second return
           this->Points->SetPoint(dualPointId, pos);
-          this->Distance->SetValue(dualPointId, distanceM);
+          SetValueIfEnabled(this->Distance, dualPointId, distanceM);
           this->DistanceRaw->SetValue(dualPointId, laserReturn->distance);
           this->Intensity->SetValue(dualPointId, intensity);
-          this->Timestamp->SetValue(dualPointId, timestamp);
+          SetValueIfEnabled(this->Timestamp, dualPointId, timestamp);
           this->RawTime->SetValue(dualPointId, rawtime);
           this->Flags->SetValue(dualPointId, secondFlags);
           this->DistanceFlag->SetValue(dualPointId, MapDistanceFlag(secondFlags));
           this->IntensityFlag->SetValue(dualPointId, MapIntensityFlag(secondFlags));
+
+          // the first return was the last point of this laser, its values are replaced too
+          LaserStatistics& statistics = this->CurrentLaserStatistics[laserId];
+          statistics.SumDistance += distanceM - statistics.LastDistance;
+          statistics.SumIntensity += intensity - statistics.LastIntensity;
+          statistics.LastDistance = distanceM;
+          statistics.LastIntensity = intensity;
           return;
         }
       }
@@ -1067,7 +1230,7 @@ void vtkVelodynePacketInterpreter::PushFiringData(unsigned char laserId, unsigne
       this->DualReturnMatching->SetValue(dualPointId, thisPointId);
     }
   }
-  else
+  else if (this->HasDualReturn)
   {
     this->Flags->InsertNextValue(DUAL_DOUBLED);
     this->DistanceFlag->InsertNextValue(0);
@@ -1076,18 +1239,25 @@ void vtkVelodynePacketInterpreter::PushFiringData(unsigned char laserId, unsigne
   }
 
   this->Points->InsertNextPoint(pos);
-  this->PointsX->InsertNextValue(pos[0]);
-  this->PointsY->InsertNextValue(pos[1]);
-  this->PointsZ->InsertNextValue(pos[2]);
+  InsertNextValueIfEnabled(this->PointsX, pos[0]);
+  InsertNextValueIfEnabled(this->PointsY, pos[1]);
+  InsertNextValueIfEnabled(this->PointsZ, pos[2]);
   this->Azimuth->InsertNextValue(azimuth);
   this->Intensity->InsertNextValue(intensity);
   this->LaserId->InsertNextValue(laserId);
-  this->Timestamp->InsertNextValue(timestamp);
+  InsertNextValueIfEnabled(this->Timestamp, timestamp);
   this->RawTime->InsertNextValue(rawtime);
-  this->Distance->InsertNextValue(distanceM);
+  InsertNextValueIfEnabled(this->Distance, distanceM);
   this->DistanceRaw->InsertNextValue(laserReturn->distance);
   this->LastPointId[rawLaserId] = thisPointId;
-  this->VerticalAngle->InsertNextValue(this->laser_corrections_[laserId].verticalCorrection);
+  InsertNextValueIfEnabled(this->VerticalAngle, this->laser_corrections_[laserId].verticalCorrection);
+
+  LaserStatistics& statistics = this->CurrentLaserStatistics[laserId];
+  statistics.NumberOfPoints++;
+  statistics.SumDistance += distanceM;
+  statistics.SumIntensity += intensity;
+  statistics.LastDistance = distanceM;
+  statistics.LastIntensity = intensity;
 }
 
 //-----------------------------------------------------------------------------
@@ -1314,23 +1484,25 @@ vtkSmartPointer<vtkPolyData> vtkVelodynePacketInterpreter::CreateNewEmptyFrame(v
 
   // intensity
   this->Points = points.GetPointer();
-  this->PointsX = CreateDataArray<vtkDoubleArray>("X", numberOfPoints, prereservedNumberOfPoints, polyData);
-  this->PointsY = CreateDataArray<vtkDoubleArray>("Y", numberOfPoints, prereservedNumberOfPoints, polyData);
-  this->PointsZ = CreateDataArray<vtkDoubleArray>("Z", numberOfPoints, prereservedNumberOfPoints, polyData);
+  this->PointsX = CreateOptionalDataArray("X", this->XYZArraysStorage, numberOfPoints, prereservedNumberOfPoints, polyData);
+  this->PointsY = CreateOptionalDataArray("Y", this->XYZArraysStorage, numberOfPoints, prereservedNumberOfPoints, polyData);
+  this->PointsZ = CreateOptionalDataArray("Z", this->XYZArraysStorage, numberOfPoints, prereservedNumberOfPoints, polyData);
   this->Intensity = CreateDataArray<vtkUnsignedCharArray>("intensity", numberOfPoints, prereservedNumberOfPoints, polyData);
   this->LaserId = CreateDataArray<vtkUnsignedCharArray>("laser_id", numberOfPoints, prereservedNumberOfPoints, polyData);
   this->Azimuth = CreateDataArray<vtkUnsignedShortArray>("azimuth", numberOfPoints, prereservedNumberOfPoints, polyData);
-  this->Distance = CreateDataArray<vtkDoubleArray>("distance_m", numberOfPoints, prereservedNumberOfPoints, polyData);
+  this->Distance = CreateOptionalDataArray("distance_m", this->DistanceStorage, numberOfPoints, prereservedNumberOfPoints, polyData);
   this->DistanceRaw =
     CreateDataArray<vtkUnsignedShortArray>("distance_raw", numberOfPoints, prereservedNumberOfPoints, polyData);
-  this->Timestamp = CreateDataArray<vtkDoubleArray>("adjustedtime", numberOfPoints, prereservedNumberOfPoints, polyData);
+  this->Timestamp = CreateOptionalDataArray("adjustedtime", this->AdjustedTimeStorage, numberOfPoints, prereservedNumberOfPoints, polyData);
   this->RawTime = CreateDataArray<vtkUnsignedIntArray>("timestamp", numberOfPoints, prereservedNumberOfPoints, polyData);
-  this->DistanceFlag = CreateDataArray<vtkIntArray>("dual_distance", numberOfPoints, prereservedNumberOfPoints, nullptr);
-  this->IntensityFlag = CreateDataArray<vtkIntArray>("dual_intensity", numberOfPoints, prereservedNumberOfPoints, nullptr);
-  this->Flags = CreateDataArray<vtkUnsignedIntArray>("dual_flags", numberOfPoints, prereservedNumberOfPoints, nullptr);
+  // dual return arrays are only filled with dual return data, so don't reserve memory otherwise
+  const vtkIdType prereservedNumberOfDualPoints = this->HasDualReturn ? prereservedNumberOfPoints : 0;
+  this->DistanceFlag = CreateDataArray<vtkIntArray>("dual_distance", numberOfPoints, prereservedNumberOfDualPoints, nullptr);
+  this->IntensityFlag = CreateDataArray<vtkIntArray>("dual_intensity", numberOfPoints, prereservedNumberOfDualPoints, nullptr);
+  this->Flags = CreateDataArray<vtkUnsignedIntArray>("dual_flags", numberOfPoints, prereservedNumberOfDualPoints, nullptr);
   this->DualReturnMatching =
-    CreateDataArray<vtkIdTypeArray>("dual_return_matching", numberOfPoints, prereservedNumberOfPoints, nullptr);
-  this->VerticalAngle = CreateDataArray<vtkDoubleArray>("vertical_angle", numberOfPoints, prereservedNumberOfPoints, polyData);
+    CreateDataArray<vtkIdTypeArray>("dual_return_matching", numberOfPoints, prereservedNumberOfDualPoints, nullptr);
+  this->VerticalAngle = CreateOptionalDataArray("vertical_angle", this->VerticalAngleStorage, numberOfPoints, prereservedNumberOfPoints, polyData);
 
   // FieldData : RPM
   vtkSmartPointer<vtkDoubleArray> rpmData = vtkSmartPointer<vtkDoubleArray>::New();
@@ -1359,6 +1531,13 @@ bool vtkVelodynePacketInterpreter::SplitFrame(bool force)
     {
       this->LastPointId[n] = -1;
     }
+    {
+      boost::lock_guard<boost::mutex> lock(this->LaserStatisticsMutex);
+      std::copy(this->CurrentLaserStatistics, this->CurrentLaserStatistics + HDL_MAX_NUM_LASERS,
+                this->LastFrameLaserStatistics);
+    }
+    std::fill(this->CurrentLaserStatistics, this->CurrentLaserStatistics + HDL_MAX_NUM_LASERS,
+              LaserStatistics());
     // compute th rpm and add it to the splited frame
     this->Frequency = this->RpmCalculator_->GetRPM();
     this->RpmCalculator_->Reset();
@@ -1376,10 +1555,72 @@ bool vtkVelodynePacketInterpreter::SplitFrame(bool force)
   return false;
 }
 
+//-----------------------------------------------------------------------------
+bool vtkVelodynePacketInterpreter::AddVerticalAngleArray(vtkPolyData* frame, int storage)
+{
+  vtkDataArray* laserId = frame->GetPointData()->GetArray("laser_id");
+  auto verticalCorrection =
+    vtkDataArray::SafeDownCast(this->CalibrationData->GetColumnByName("verticalCorrection"));
+  if (!laserId || !verticalCorrection)
+  {
+    return false;
+  }
+
+  const vtkIdType numberOfPoints = frame->GetNumberOfPoints();
+  const vtkIdType numberOfLasers = verticalCorrection->GetNumberOfTuples();
+  auto verticalAngle = CreateOptionalDataArray("vertical_angle",
+    storage == Float ? Float : Double, numberOfPoints, 0, nullptr);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    const vtkIdType laser = static_cast<vtkIdType>(laserId->GetTuple1(i));
+    if (laser < 0 || laser >= numberOfLasers)
+    {
+      return false;
+    }
+    verticalAngle->SetTuple1(i, verticalCorrection->GetTuple1(laser));
+  }
+  frame->GetPointData()->AddArray(verticalAngle);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkTable> vtkVelodynePacketInterpreter::GetLaserStatistics()
+{
+  const int numberOfLasers = std::max(0, std::min(this->CalibrationReportedNumLasers, HDL_MAX_NUM_LASERS));
+  auto laserId = CreateDataArray<vtkUnsignedCharArray>("laser_id", numberOfLasers, 0, nullptr);
+  auto numberOfPoints = CreateDataArray<vtkIdTypeArray>("number_of_points", numberOfLasers, 0, nullptr);
+  auto meanDistance = CreateDataArray<vtkDoubleArray>("mean_distance_m", numberOfLasers, 0, nullptr);
+  auto meanIntensity = CreateDataArray<vtkDoubleArray>("mean_intensity", numberOfLasers, 0, nullptr);
+  boost::lock_guard<boost::mutex> lock(this->LaserStatisticsMutex);
+  for (int laser = 0; laser < numberOfLasers; ++laser)
+  {
+    const LaserStatistics& statistics = this->LastFrameLaserStatistics[laser];
+    const double n = static_cast<double>(std::max<vtkIdType>(statistics.NumberOfPoints, 1));
+    laserId->SetValue(laser, static_cast<unsigned char>(laser));
+    numberOfPoints->SetValue(laser, statistics.NumberOfPoints);
+    meanDistance->SetValue(laser, statistics.SumDistance / n);
+    meanIntensity->SetValue(laser, statistics.SumIntensity / n);
+  }
+
+  auto table = vtkSmartPointer<vtkTable>::New();
+  table->AddColumn(laserId);
+  table->AddColumn(numberOfPoints);
+  table->AddColumn(meanDistance);
+  table->AddColumn(meanIntensity);
+  return table;
+}
+
 //-----------------------------------------------------------------------------
 void vtkVelodynePacketInterpreter::ResetCurrentFrame()
 {
   std::fill(this->LastPointId, this->LastPointId + HDL_MAX_NUM_LASERS, -1);
+  std::fill(this->CurrentLaserStatistics, this->CurrentLaserStatistics + HDL_MAX_NUM_LASERS,
+            LaserStatistics());
+  {
+    boost::lock_guard<boost::mutex> lock(this->LaserStatisticsMutex);
+    std::fill(this->LastFrameLaserStatistics, this->LastFrameLaserStatistics + HDL_MAX_NUM_LASERS,
+              LaserStatistics());
+  }
   this->CurrentFrameState->reset();
   this->LastTimestamp = std::numeric_limits<unsigned int>::max();
   this->TimeAdjust = std::numeric_limits<double>::quiet_NaN();
@@ -1390,6 +1631,10 @@ void vtkVelodynePacketInterpreter::ResetCurrentFrame()
   this->IsVLS128 = false;
   this->Frames.clear();
   this->CurrentFrame = this->CreateNewEmptyFrame(0);
+  this->OverloadFrameIndex = 0;
+  this->SkipCurrentFrame = false;
+  this->OverloadFiringCounter = 0;
+  this->KeepOverloadFiring = true;
 
   this->ShouldCheckSensor = true;
 }
@@ -1398,17 +1643,6 @@ void vtkVelodynePacketInterpreter::ResetCurrentFrame()
 void vtkVelodynePacketInterpreter::PreProcessPacket(unsigned char const * data, unsigned int dataLength, bool &isNewFrame, int &framePositionInPacket)
 {
   const HDLDataPacket* dataPacket = reinterpret_cast<const HDLDataPacket*>(data);
-  //! @todo don't use static value here this is ugly...
-  static bool isEmptyFrame = true;
-  static FramingState currentFrameState;
-  static int numberOfFiringPackets = 0;
-  static int lastnumberOfFiringPackets = 0;
-  static int frameNumber;
-
-  isNewFrame = false;
-  framePositionInPacket = 0;
-
-  numberOfFiringPackets++;
 
   //! @todo this could be useful at a higher level
   if (this->ShouldCheckSensor)
@@ -1430,13 +1664,39 @@ void vtkVelodynePacketInterpreter::PreProcessPacket(unsigned char const * data,
 
   this->IsVLS128 = dataPacket->isVLS128();
 
+  this->PreProcessPacket(data, dataLength, *this->IndexingState, isNewFrame, framePositionInPacket);
+
+  // Accumulate HDL64 Status byte data
+  if (IsHDL64Data && this->IsCorrectionFromLiveStream &&
+    !this->IsCalibrated)
+  {
+    this->rollingCalibrationData->appendData(dataPacket->gpsTimestamp, dataPacket->factoryField1, dataPacket->factoryField2);
+    this->HDL64LoadCorrectionsFromStreamData();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkVelodynePacketInterpreter::PreProcessPacket(unsigned char const * data, unsigned int dataLength,
+                                                    FrameIndexingState& state, bool &isNewFrame,
+                                                    int &framePositionInPacket) const
+{
+  const HDLDataPacket* dataPacket = reinterpret_cast<const HDLDataPacket*>(data);
+  VelodyneFrameIndexingState& indexingState = static_cast<VelodyneFrameIndexingState&>(state);
+
+  isNewFrame = false;
+  framePositionInPacket = 0;
+
+  indexingState.NumberOfFiringPackets++;
+
+  const bool isVLS128 = dataPacket->isVLS128();
+
   for (int i = 0; i < HDL_FIRING_PER_PKT; ++i)
   {
     const HDLFiringData& firingData = dataPacket->firingData[i];
 
 
     // Skip dummy blocks of VLS-128 dual mode last 4 blocks
-    if (IsVLS128 && (firingData.blockIdentifier == 0 || firingData.blockIdentifier == 0xFFFF))
+    if (isVLS128 && (firingData.blockIdentifier == 0 || firingData.blockIdentifier == 0xFFFF))
     {
       continue;
     }
@@ -1448,43 +1708,53 @@ void vtkVelodynePacketInterpreter::PreProcessPacket(unsigned char const * data,
       {
         if (firingData.laserReturns[laserID].distance != 0)
         {
-          isEmptyFrame = false;
+          indexingState.IsEmptyFrame = false;
           break;
         }
       }
     }
     else
     {
-      isEmptyFrame = false;
+      indexingState.IsEmptyFrame = false;
     }
 
-    if (currentFrameState.hasChangedWithValue(firingData))
+    if (indexingState.Framing.hasChangedWithValue(firingData))
     {
       // Add file position if the frame is not empty
-      if (!isEmptyFrame || !this->IgnoreEmptyFrames)
+      if (!indexingState.IsEmptyFrame || !this->IgnoreEmptyFrames)
       {
         isNewFrame = true;
         framePositionInPacket = i;
-        frameNumber++;
+        indexingState.FrameNumber++;
         PacketProcessingDebugMacro(
-          << "\n\nEnd of frame #" << frameNumber
-          << ". #packets: " << numberOfFiringPackets - lastnumberOfFiringPackets << "\n\n"
+          << "\n\nEnd of frame #" << indexingState.FrameNumber
+          << ". #packets: " << indexingState.NumberOfFiringPackets - indexingState.LastNumberOfFiringPackets << "\n\n"
           << "RotationalPositions: ");
-        lastnumberOfFiringPackets = numberOfFiringPackets;
+        indexingState.LastNumberOfFiringPackets = indexingState.NumberOfFiringPackets;
       }
       // We start a new frame, reinitialize the boolean
-      isEmptyFrame = true;
+      indexingState.IsEmptyFrame = true;
     }
     PacketProcessingDebugMacro(<< firingData.rotationalPosition << ", ");
   }
+}
 
-  // Accumulate HDL64 Status byte data
-  if (IsHDL64Data && this->IsCorrectionFromLiveStream &&
-    !this->IsCalibrated)
-  {
-    this->rollingCalibrationData->appendData(dataPacket->gpsTimestamp, dataPacket->factoryField1, dataPacket->factoryField2);
-    this->HDL64LoadCorrectionsFromStreamData();
-  }
+//-----------------------------------------------------------------------------
+std::unique_ptr<FrameIndexingState> vtkVelodynePacketInterpreter::NewFrameIndexingState() const
+{
+  return std::unique_ptr<FrameIndexingState>(new VelodyneFrameIndexingState);
+}
+
+//-----------------------------------------------------------------------------
+void vtkVelodynePacketInterpreter::SetFrameIndexingState(const FrameIndexingState& state)
+{
+  *this->IndexingState = static_cast<const VelodyneFrameIndexingState&>(state);
+}
+
+//-----------------------------------------------------------------------------
+void vtkVelodynePacketInterpreter::ResetFrameIndexingState()
+{
+  this->IndexingState->reset();
 }
 
 //-----------------------------------------------------------------------------
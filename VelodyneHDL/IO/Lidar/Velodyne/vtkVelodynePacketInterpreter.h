@@ -8,10 +8,13 @@
 #include <vtkUnsignedShortArray.h>
 #include <memory>
 
+#include <boost/thread/mutex.hpp>
+
 using namespace DataPacketFixedLength;
 
 class RPMCalculator;
 class FramingState;
+class VelodyneFrameIndexingState;
 class vtkRollingDataAccumulator;
 
 
@@ -32,6 +35,17 @@ public:
     DUAL_INTENSITY_MASK = 0xc,
   };
 
+  /**
+   * @brief The ARRAY_STORAGE enum select how an optional point attribute is stored
+   * in the frame, this enables to reduce the memory used by each frame.
+   */
+  enum ARRAY_STORAGE
+  {
+    Disabled = 0, /*!< the array is not produced */
+    Float = 1,    /*!< the array is stored in single precision */
+    Double = 2,   /*!< the array is stored in double precision */
+  };
+
   void LoadCalibration(const std::string& filename) override;
 
   void ProcessPacket(unsigned char const * data, unsigned int dataLength, int startPosition = 0) override;
@@ -46,6 +60,15 @@ public:
 
   void PreProcessPacket(unsigned char const * data, unsigned int dataLength, bool &isNewFrame, int &framePositionInPacket) override;
 
+  void PreProcessPacket(unsigned char const * data, unsigned int dataLength, FrameIndexingState& state,
+                        bool &isNewFrame, int &framePositionInPacket) const override;
+
+  std::unique_ptr<FrameIndexingState> NewFrameIndexingState() const override;
+
+  void SetFrameIndexingState(const FrameIndexingState& state) override;
+
+  void ResetFrameIndexingState() override;
+
   std::string GetSensorInformation() override;
 
   void SetSelectedPointsWithDualReturn(double* data, int Npoints);
@@ -60,6 +83,12 @@ public:
     double focalSlope[HDL_MAX_NUM_LASERS], double minIntensity[HDL_MAX_NUM_LASERS],
     double maxIntensity[HDL_MAX_NUM_LASERS]);
 
+  /**
+   * @brief GetLaserStatistics return a table with one row per laser: the number of points,
+   * the mean distance and the mean intensity of the points of the last frame which is ready
+   */
+  vtkSmartPointer<vtkTable> GetLaserStatistics() override;
+
   vtkSetMacro(ShouldAddDualReturnArray, bool)
 
   vtkGetMacro(HasDualReturn, bool)
@@ -74,6 +103,40 @@ public:
 
   vtkSetMacro(DualReturnFilter, unsigned int)
 
+  //! @{
+  //! @copydoc XYZArraysStorage
+  vtkGetMacro(XYZArraysStorage, int)
+  vtkSetClampMacro(XYZArraysStorage, int, Disabled, Double)
+  //! @}
+
+  //! @{
+  //! @copydoc DistanceStorage
+  vtkGetMacro(DistanceStorage, int)
+  vtkSetClampMacro(DistanceStorage, int, Disabled, Double)
+  //! @}
+
+  //! @{
+  //! @copydoc AdjustedTimeStorage
+  vtkGetMacro(AdjustedTimeStorage, int)
+  vtkSetClampMacro(AdjustedTimeStorage, int, Disabled, Double)
+  //! @}
+
+  //! @{
+  //! @copydoc VerticalAngleStorage
+  vtkGetMacro(VerticalAngleStorage, int)
+  vtkSetClampMacro(VerticalAngleStorage, int, Disabled, Double)
+  //! @}
+
+  /**
+   * @brief AddVerticalAngleArray add the vertical_angle array to a frame produced without it,
+   * by looking up the laser_id of each point in the verticalCorrection column of the
+   * calibration table. This allows to disable VerticalAngleStorage and only build the
+   * array for the frames which need it.
+   * @param storage Float or Double
+   * @return false if the frame has no laser_id array or a laser is not in the calibration
+   */
+  bool AddVerticalAngleArray(vtkPolyData* frame, int storage = ARRAY_STORAGE::Double);
+
 protected:
   // Process the laser return from the firing data
   // firingData - one of HDL_FIRING_PER_PKT from the packet
@@ -107,17 +170,19 @@ protected:
 
   bool CheckReportedSensorAndCalibrationFileConsistent(const HDLDataPacket* dataPacket);
 
+  // Optional arrays (X, Y, Z, distance_m, adjustedtime and vertical_angle) are
+  // null when their storage is set to Disabled
   vtkSmartPointer<vtkPoints> Points;
-  vtkSmartPointer<vtkDoubleArray> PointsX;
-  vtkSmartPointer<vtkDoubleArray> PointsY;
-  vtkSmartPointer<vtkDoubleArray> PointsZ;
+  vtkSmartPointer<vtkDataArray> PointsX;
+  vtkSmartPointer<vtkDataArray> PointsY;
+  vtkSmartPointer<vtkDataArray> PointsZ;
   vtkSmartPointer<vtkUnsignedCharArray> Intensity;
   vtkSmartPointer<vtkUnsignedCharArray> LaserId;
   vtkSmartPointer<vtkUnsignedShortArray> Azimuth;
-  vtkSmartPointer<vtkDoubleArray> Distance;
+  vtkSmartPointer<vtkDataArray> Distance;
   vtkSmartPointer<vtkUnsignedShortArray> DistanceRaw;
-  vtkSmartPointer<vtkDoubleArray> Timestamp;
-  vtkSmartPointer<vtkDoubleArray> VerticalAngle;
+  vtkSmartPointer<vtkDataArray> Timestamp;
+  vtkSmartPointer<vtkDataArray> VerticalAngle;
   vtkSmartPointer<vtkUnsignedIntArray> RawTime;
   vtkSmartPointer<vtkIntArray> IntensityFlag;
   vtkSmartPointer<vtkIntArray> DistanceFlag;
@@ -156,12 +221,31 @@ protected:
   RPMCalculator* RpmCalculator_;
 
   FramingState* CurrentFrameState;
+  //! Indexing state used by PreProcessPacket
+  VelodyneFrameIndexingState* IndexingState;
   unsigned int LastTimestamp;
   std::vector<double> RpmByFrames;
   double TimeAdjust;
   vtkIdType LastPointId[HDL_MAX_NUM_LASERS];
   vtkIdType FirstPointIdOfDualReturnPair;
 
+  //! Sums over the points of a laser used to compute its statistics
+  struct LaserStatistics
+  {
+    vtkIdType NumberOfPoints = 0;
+    double SumDistance = 0.;
+    double SumIntensity = 0.;
+    //! Values of the last point, which a dual return can replace
+    double LastDistance = 0.;
+    double LastIntensity = 0.;
+  };
+  //! Statistics of the lasers in the frame under construction
+  LaserStatistics CurrentLaserStatistics[HDL_MAX_NUM_LASERS];
+  //! Statistics of the lasers in the last frame which is ready
+  LaserStatistics LastFrameLaserStatistics[HDL_MAX_NUM_LASERS];
+  //! Protect LastFrameLaserStatistics, which the UI reads while the stream thread splits frames
+  boost::mutex LaserStatisticsMutex;
+
   unsigned char SensorPowerMode;
 
   // Parameters ready by calibration
@@ -177,12 +261,31 @@ protected:
   // User configurable parameters
   int FiringsSkip;
 
+  //! Number of firings seen, to keep one out of OverloadFiringDecimation
+  unsigned int OverloadFiringCounter = 0;
+  //! Whether the blocks of the current firing are kept by the overload decimation
+  bool KeepOverloadFiring = true;
+
   bool UseIntraFiringAdjustment;
 
   bool ShouldCheckSensor;
 
   unsigned int DualReturnFilter;
 
+  //! Storage of the X, Y and Z arrays, which duplicate the points coordinates
+  int XYZArraysStorage = ARRAY_STORAGE::Double;
+
+  //! Storage of the distance_m array, which can also be computed from distance_raw
+  int DistanceStorage = ARRAY_STORAGE::Double;
+
+  //! Storage of the adjustedtime array. Single precision is not recommended as
+  //! it can't represent microseconds over more than a few seconds
+  int AdjustedTimeStorage = ARRAY_STORAGE::Double;
+
+  //! Storage of the vertical_angle array. This array only depends on laser_id,
+  //! so when disabled it can be derived on demand with AddVerticalAngleArray
+  int VerticalAngleStorage = ARRAY_STORAGE::Double;
+
   vtkVelodynePacketInterpreter();
   ~vtkVelodynePacketInterpreter();
 
@@ -0,0 +1,88 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TEMPORALTRANSFORMSBINARYFORMAT_H
+#define TEMPORALTRANSFORMSBINARYFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * @brief Layout of the binary trajectory files shared by vtkTemporalTransformsWriter
+ * and vtkTemporalTransformsReader.
+ *
+ * The file starts with a TemporalTransformsBinaryHeader, followed by three columns
+ * of doubles, all stored in the byte order given by the header:
+ * - time: N values, in seconds, sorted in increasing order
+ * - orientation: N tuples (x, y, z, angle) as an axis-angle, angle in radian
+ * - position: N tuples (x, y, z) in meters
+ *
+ * The columns have the memory layout of the vtkTemporalTransforms arrays, so that
+ * loading a trajectory is a copy of three blocks.
+ */
+struct TemporalTransformsBinaryHeader
+{
+  char Magic[8];                  /*!< "VVTRAJ" followed by two null characters */
+  uint32_t Version;               /*!< Version of the format */
+  uint32_t ByteOrderMark;         /*!< ByteOrderMark in the byte order of the writer */
+  uint64_t NumberOfTransforms;    /*!< Number of rows of each column */
+  uint64_t Reserved[2];           /*!< Unused, set to 0 */
+};
+
+namespace TemporalTransformsBinaryFormat
+{
+const char Magic[8] = { 'V', 'V', 'T', 'R', 'A', 'J', '\0', '\0' };
+const uint32_t Version = 1;
+const uint32_t ByteOrderMark = 0x01020304;
+//! Extension of the binary trajectory files
+const char Extension[] = ".traj";
+
+//! Number of components of each column
+const int TimeComponents = 1;
+const int OrientationComponents = 4;
+const int PositionComponents = 3;
+
+inline TemporalTransformsBinaryHeader CreateHeader(uint64_t numberOfTransforms)
+{
+  TemporalTransformsBinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, Magic, sizeof(Magic));
+  header.Version = Version;
+  header.ByteOrderMark = ByteOrderMark;
+  header.NumberOfTransforms = numberOfTransforms;
+  return header;
+}
+
+inline bool HasMagic(const char* data, size_t size)
+{
+  return size >= sizeof(Magic) && std::memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+inline bool HasExtension(const std::string& filename)
+{
+  const size_t length = sizeof(Extension) - 1;
+  return filename.size() >= length &&
+    filename.compare(filename.size() - length, length, Extension) == 0;
+}
+
+//! Total size of a file holding numberOfTransforms rows
+inline uint64_t GetFileSize(uint64_t numberOfTransforms)
+{
+  return sizeof(TemporalTransformsBinaryHeader) + numberOfTransforms * sizeof(double) *
+    (TimeComponents + OrientationComponents + PositionComponents);
+}
+}
+
+#endif // TEMPORALTRANSFORMSBINARYFORMAT_H
@@ -0,0 +1,204 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TEXTFILEPARSING_H
+#define TEXTFILEPARSING_H
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief The MappedTextFile class gives access to the whole content of a file,
+ * either mapped in memory or loaded in a buffer. The content is not null terminated.
+ */
+class MappedTextFile
+{
+public:
+  /**
+   * @brief Open load the file
+   * @param filename file to open
+   * @param useMemoryMap map the file instead of copying it in memory
+   * @throw std::exception if the file can not be read
+   */
+  void Open(const std::string& filename, bool useMemoryMap)
+  {
+    // an empty file can not be mapped
+    if (useMemoryMap && boost::filesystem::file_size(filename) > 0)
+    {
+      this->Mapped.open(filename);
+      this->Data = this->Mapped.data();
+      this->Size = this->Mapped.size();
+      return;
+    }
+
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+      throw std::runtime_error("Could not open file " + filename);
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    this->Buffer = stream.str();
+    this->Data = this->Buffer.data();
+    this->Size = this->Buffer.size();
+  }
+
+  const char* Begin() const { return this->Data; }
+  const char* End() const { return this->Data + this->Size; }
+  size_t GetSize() const { return this->Size; }
+
+private:
+  boost::iostreams::mapped_file_source Mapped;
+  std::string Buffer;
+  const char* Data = nullptr;
+  size_t Size = 0;
+};
+
+//! Space characters which can surround a value on a line
+inline bool IsBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @brief ParseDouble parse a floating point number at the beginning of [first, last),
+ * in the manner of std::from_chars: no leading space is skipped, no null terminated
+ * string is needed and no locale is involved.
+ *
+ * Numbers with up to 19 significant digits and a small exponent, which is the
+ * case of any value written with a fixed precision, are converted exactly with
+ * a single multiplication or division. Other numbers fall back to strtod.
+ *
+ * @param value set to the parsed number on success, left untouched otherwise
+ * @return the pointer past the parsed number, or first if there is no number
+ */
+inline const char* ParseDouble(const char* first, const char* last, double& value)
+{
+  // Exactly representable powers of 10
+  static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+  const char* it = first;
+  const bool negative = it < last && *it == '-';
+  if (it < last && (*it == '-' || *it == '+'))
+  {
+    ++it;
+  }
+
+  uint64_t mantissa = 0;
+  int significantDigits = 0;
+  int exponent = 0;
+  bool hasDigits = false;
+  bool truncated = false;
+
+  // integer part
+  for (; it < last && *it >= '0' && *it <= '9'; ++it)
+  {
+    hasDigits = true;
+    if (significantDigits < 19)
+    {
+      mantissa = mantissa * 10 + (*it - '0');
+      significantDigits += mantissa != 0;
+    }
+    else
+    {
+      truncated |= *it != '0';
+      exponent++;
+    }
+  }
+
+  // fractional part
+  if (it < last && *it == '.')
+  {
+    ++it;
+    for (; it < last && *it >= '0' && *it <= '9'; ++it)
+    {
+      hasDigits = true;
+      if (significantDigits < 19)
+      {
+        mantissa = mantissa * 10 + (*it - '0');
+        significantDigits += mantissa != 0;
+        exponent--;
+      }
+      else
+      {
+        truncated |= *it != '0';
+      }
+    }
+  }
+
+  if (hasDigits && it < last && (*it == 'e' || *it == 'E'))
+  {
+    // the exponent is only part of the number if it has digits
+    const char* exponentIt = it + 1;
+    const bool negativeExponent = exponentIt < last && *exponentIt == '-';
+    if (exponentIt < last && (*exponentIt == '-' || *exponentIt == '+'))
+    {
+      ++exponentIt;
+    }
+    if (exponentIt < last && *exponentIt >= '0' && *exponentIt <= '9')
+    {
+      int explicitExponent = 0;
+      for (; exponentIt < last && *exponentIt >= '0' && *exponentIt <= '9'; ++exponentIt)
+      {
+        if (explicitExponent < 100000)
+        {
+          explicitExponent = explicitExponent * 10 + (*exponentIt - '0');
+        }
+      }
+      exponent += negativeExponent ? -explicitExponent : explicitExponent;
+      it = exponentIt;
+    }
+  }
+
+  if (hasDigits && !truncated && mantissa < (uint64_t(1) << 53) && exponent >= -22 &&
+    exponent <= 22)
+  {
+    double result = static_cast<double>(mantissa);
+    result = exponent < 0 ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+    value = negative ? -result : result;
+    return it;
+  }
+
+  // Fall back on strtod (long numbers, huge exponents, inf, nan), which needs
+  // a null terminated copy of the token
+  const char* tokenEnd = first;
+  while (tokenEnd < last && !IsBlank(*tokenEnd) && *tokenEnd != ',' && *tokenEnd != '\n')
+  {
+    ++tokenEnd;
+  }
+  if (tokenEnd == first)
+  {
+    return first;
+  }
+  const std::string token(first, tokenEnd);
+  char* parsedEnd = nullptr;
+  const double result = std::strtod(token.c_str(), &parsedEnd);
+  if (parsedEnd == token.c_str())
+  {
+    return first;
+  }
+  value = result;
+  return first + (parsedEnd - token.c_str());
+}
+
+#endif // TEXTFILEPARSING_H
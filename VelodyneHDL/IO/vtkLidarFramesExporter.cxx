@@ -0,0 +1,766 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+// LOCAL
+#include "vtkLidarFramesExporter.h"
+#include "vtkLidarReader.h"
+
+// VTK
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtk_zlib.h>
+#include <vtksys/SystemTools.hxx>
+
+// BOOST
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+// STD
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <queue>
+#include <sstream>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Number formatting, much faster than the stream operators for the millions of
+// values of a capture
+//-----------------------------------------------------------------------------
+void AppendUnsigned(std::string& out, unsigned long long value)
+{
+  char digits[20];
+  int i = 20;
+  do
+  {
+    digits[--i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  out.append(digits + i, 20 - i);
+}
+
+//-----------------------------------------------------------------------------
+void AppendInteger(std::string& out, long long value)
+{
+  if (value < 0)
+  {
+    out += '-';
+    AppendUnsigned(out, 0ull - static_cast<unsigned long long>(value));
+    return;
+  }
+  AppendUnsigned(out, static_cast<unsigned long long>(value));
+}
+
+//-----------------------------------------------------------------------------
+void AppendFixed(std::string& out, double value, int precision)
+{
+  static const double powers[18] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+    1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17 };
+
+  const double scaled = value * powers[precision];
+  // also catches NaN and infinity
+  if (!(std::abs(scaled) < 9e18))
+  {
+    char buffer[512];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+    out.append(buffer, std::min<int>(length, sizeof(buffer) - 1));
+    return;
+  }
+
+  const long long rounded = std::llround(scaled);
+  if (rounded < 0)
+  {
+    out += '-';
+  }
+  const unsigned long long magnitude =
+    rounded < 0 ? 0ull - static_cast<unsigned long long>(rounded) : rounded;
+  const unsigned long long divisor = static_cast<unsigned long long>(powers[precision]);
+  AppendUnsigned(out, magnitude / divisor);
+  if (precision > 0)
+  {
+    char digits[17];
+    unsigned long long fraction = magnitude % divisor;
+    for (int i = precision - 1; i >= 0; --i)
+    {
+      digits[i] = static_cast<char>('0' + fraction % 10);
+      fraction /= 10;
+    }
+    out += '.';
+    out.append(digits, precision);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool IsIntegerType(int dataType)
+{
+  return dataType != VTK_FLOAT && dataType != VTK_DOUBLE;
+}
+
+//-----------------------------------------------------------------------------
+// Columns of a frame: the point coordinates, then each component of each point data array
+//-----------------------------------------------------------------------------
+struct Column
+{
+  std::string Name;
+  vtkDataArray* Array;
+  int Component;
+};
+
+//-----------------------------------------------------------------------------
+std::vector<Column> GetColumns(vtkPolyData* frame, const std::string& separator,
+  const char* const pointNames[3])
+{
+  std::vector<Column> columns;
+  vtkDataArray* points = frame->GetPoints() ? frame->GetPoints()->GetData() : nullptr;
+  for (int i = 0; i < 3; ++i)
+  {
+    columns.push_back({ pointNames[i], points, i });
+  }
+
+  vtkPointData* pointData = frame->GetPointData();
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i)
+  {
+    vtkDataArray* array = pointData->GetArray(i);
+    if (!array || !array->GetName())
+    {
+      continue;
+    }
+
+    const int nbComponents = array->GetNumberOfComponents();
+    for (int component = 0; component < nbComponents; ++component)
+    {
+      std::string name = array->GetName();
+      if (nbComponents > 1)
+      {
+        name += separator + std::to_string(component);
+      }
+      columns.push_back({ name, array, component });
+    }
+  }
+  return columns;
+}
+
+//-----------------------------------------------------------------------------
+const char* const CSV_POINT_NAMES[3] = { "Points:0", "Points:1", "Points:2" };
+const char* const PLY_POINT_NAMES[3] = { "x", "y", "z" };
+
+//-----------------------------------------------------------------------------
+std::string FormatCSV(vtkPolyData* frame, int precision)
+{
+  std::vector<Column> columns = GetColumns(frame, ":", CSV_POINT_NAMES);
+  const vtkIdType nbPoints = frame->GetNumberOfPoints();
+
+  std::string out;
+  // rough estimate to avoid most reallocations
+  out.reserve(static_cast<size_t>(nbPoints) * columns.size() * (precision + 4));
+
+  // same layout as the python export: quoted header, points first
+  for (size_t c = 0; c < columns.size(); ++c)
+  {
+    out += c ? ",\"" : "\"";
+    out += columns[c].Name;
+    out += '"';
+  }
+  out += '\n';
+
+  std::vector<bool> isInteger(columns.size());
+  for (size_t c = 0; c < columns.size(); ++c)
+  {
+    isInteger[c] = columns[c].Array && IsIntegerType(columns[c].Array->GetDataType());
+  }
+
+  for (vtkIdType i = 0; i < nbPoints; ++i)
+  {
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+      if (c)
+      {
+        out += ',';
+      }
+      const double value = columns[c].Array->GetComponent(i, columns[c].Component);
+      if (isInteger[c])
+      {
+        AppendInteger(out, static_cast<long long>(value));
+      }
+      else
+      {
+        AppendFixed(out, value, precision);
+      }
+    }
+    out += '\n';
+  }
+  return out;
+}
+
+//-----------------------------------------------------------------------------
+// PLY has no 64 bits integer type, such values are written as double
+void GetPLYType(int dataType, std::string& name, int& size)
+{
+  switch (dataType)
+  {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+      name = "char"; size = 1; break;
+    case VTK_UNSIGNED_CHAR:
+      name = "uchar"; size = 1; break;
+    case VTK_SHORT:
+      name = "short"; size = 2; break;
+    case VTK_UNSIGNED_SHORT:
+      name = "ushort"; size = 2; break;
+    case VTK_INT:
+      name = "int"; size = 4; break;
+    case VTK_UNSIGNED_INT:
+      name = "uint"; size = 4; break;
+    case VTK_FLOAT:
+      name = "float"; size = 4; break;
+    default:
+      name = "double"; size = 8; break;
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void WriteValue(char*& out, double value)
+{
+  T typedValue = static_cast<T>(value);
+  std::memcpy(out, &typedValue, sizeof(T));
+  out += sizeof(T);
+}
+
+//-----------------------------------------------------------------------------
+bool IsLittleEndian()
+{
+  const std::uint16_t one = 1;
+  return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+//-----------------------------------------------------------------------------
+std::string FormatPLY(vtkPolyData* frame)
+{
+  std::vector<Column> columns = GetColumns(frame, "_", PLY_POINT_NAMES);
+  const vtkIdType nbPoints = frame->GetNumberOfPoints();
+
+  std::ostringstream header;
+  header << "ply\n"
+         << "format " << (IsLittleEndian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+         << "element vertex " << nbPoints << "\n";
+
+  std::vector<int> sizes(columns.size());
+  size_t recordSize = 0;
+  for (size_t c = 0; c < columns.size(); ++c)
+  {
+    std::string typeName;
+    GetPLYType(columns[c].Array ? columns[c].Array->GetDataType() : VTK_FLOAT, typeName, sizes[c]);
+    header << "property " << typeName << " " << columns[c].Name << "\n";
+    recordSize += sizes[c];
+  }
+  header << "end_header\n";
+
+  std::string out = header.str();
+  const size_t headerSize = out.size();
+  out.resize(headerSize + recordSize * nbPoints);
+  char* data = &out[headerSize];
+
+  for (vtkIdType i = 0; i < nbPoints; ++i)
+  {
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+      const double value = columns[c].Array->GetComponent(i, columns[c].Component);
+      switch (columns[c].Array->GetDataType())
+      {
+        case VTK_CHAR:
+        case VTK_SIGNED_CHAR:
+          WriteValue<std::int8_t>(data, value); break;
+        case VTK_UNSIGNED_CHAR:
+          WriteValue<std::uint8_t>(data, value); break;
+        case VTK_SHORT:
+          WriteValue<std::int16_t>(data, value); break;
+        case VTK_UNSIGNED_SHORT:
+          WriteValue<std::uint16_t>(data, value); break;
+        case VTK_INT:
+          WriteValue<std::int32_t>(data, value); break;
+        case VTK_UNSIGNED_INT:
+          WriteValue<std::uint32_t>(data, value); break;
+        case VTK_FLOAT:
+          WriteValue<float>(data, value); break;
+        default:
+          WriteValue<double>(data, value); break;
+      }
+    }
+  }
+  return out;
+}
+
+//-----------------------------------------------------------------------------
+std::string FormatRaw(vtkPolyData* frame)
+{
+  std::vector<Column> columns = GetColumns(frame, "_", PLY_POINT_NAMES);
+  const vtkIdType nbPoints = frame->GetNumberOfPoints();
+
+  std::string out(nbPoints * columns.size() * sizeof(float), '\0');
+  char* data = out.empty() ? nullptr : &out[0];
+  for (vtkIdType i = 0; i < nbPoints; ++i)
+  {
+    for (const Column& column : columns)
+    {
+      WriteValue<float>(data, column.Array->GetComponent(i, column.Component));
+    }
+  }
+  return out;
+}
+
+//-----------------------------------------------------------------------------
+// Minimal zip archive writer, deflate or stored entries without zip64 extension
+//-----------------------------------------------------------------------------
+struct ZipEntry
+{
+  std::string Name;
+  std::string Data;            //!< compressed data
+  unsigned long Crc = 0;
+  size_t CompressedSize = 0;
+  size_t UncompressedSize = 0;
+  bool IsDeflated = false;
+  std::uint32_t Offset = 0;    //!< offset of the local header in the archive
+};
+
+//-----------------------------------------------------------------------------
+bool CompressEntry(const std::string& data, int level, ZipEntry& entry)
+{
+  entry.UncompressedSize = data.size();
+  entry.Crc = crc32(0L, Z_NULL, 0);
+  entry.Crc = crc32(entry.Crc, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size()));
+
+  if (level == 0)
+  {
+    entry.Data = data;
+    entry.CompressedSize = data.size();
+    entry.IsDeflated = false;
+    return true;
+  }
+
+  z_stream stream;
+  std::memset(&stream, 0, sizeof(stream));
+  // negative window bits: raw deflate data, as expected in a zip archive
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    return false;
+  }
+  entry.Data.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&entry.Data[0]);
+  stream.avail_out = static_cast<uInt>(entry.Data.size());
+  const int result = deflate(&stream, Z_FINISH);
+  entry.Data.resize(stream.total_out);
+  entry.CompressedSize = entry.Data.size();
+  deflateEnd(&stream);
+  entry.IsDeflated = true;
+  return result == Z_STREAM_END;
+}
+
+//-----------------------------------------------------------------------------
+class ZipWriter
+{
+public:
+  bool Open(const std::string& filename)
+  {
+    this->File.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+    // all entries share the date of the export, in MS-DOS format
+    std::time_t now = std::time(nullptr);
+    std::tm* t = std::localtime(&now);
+    this->Time = static_cast<std::uint16_t>((t->tm_hour << 11) | (t->tm_min << 5) | (t->tm_sec / 2));
+    this->Date = static_cast<std::uint16_t>(((t->tm_year - 80) << 9) | ((t->tm_mon + 1) << 5) | t->tm_mday);
+    return this->File.is_open();
+  }
+
+  bool Write(ZipEntry& entry)
+  {
+    if (this->Offset + entry.Data.size() + 30 + entry.Name.size() >= 0xFFFFFFFFull ||
+      entry.UncompressedSize >= 0xFFFFFFFFull || this->Entries.size() >= 0xFFFF)
+    {
+      // would need the zip64 extension
+      return false;
+    }
+
+    entry.Offset = static_cast<std::uint32_t>(this->Offset);
+    std::string header;
+    Put32(header, 0x04034b50);
+    this->PutCommonHeader(header, entry);
+    Put16(header, 0); // extra field length
+    header += entry.Name;
+
+    this->File.write(header.data(), header.size());
+    this->File.write(entry.Data.data(), entry.Data.size());
+    this->Offset += header.size() + entry.Data.size();
+
+    // only the metadata is kept for the central directory
+    entry.Data.clear();
+    entry.Data.shrink_to_fit();
+    this->Entries.push_back(entry);
+    return this->File.good();
+  }
+
+  bool Close()
+  {
+    std::string directory;
+    for (const ZipEntry& entry : this->Entries)
+    {
+      Put32(directory, 0x02014b50);
+      Put16(directory, 20); // version made by
+      this->PutCommonHeader(directory, entry);
+      Put16(directory, 0); // extra field length
+      Put16(directory, 0); // comment length
+      Put16(directory, 0); // disk number
+      Put16(directory, 0); // internal attributes
+      Put32(directory, 0); // external attributes
+      Put32(directory, entry.Offset);
+      directory += entry.Name;
+    }
+
+    const std::uint32_t directorySize = static_cast<std::uint32_t>(directory.size());
+    Put32(directory, 0x06054b50);
+    Put16(directory, 0); // disk number
+    Put16(directory, 0); // disk of the central directory
+    Put16(directory, static_cast<std::uint16_t>(this->Entries.size()));
+    Put16(directory, static_cast<std::uint16_t>(this->Entries.size()));
+    Put32(directory, directorySize);
+    Put32(directory, static_cast<std::uint32_t>(this->Offset));
+    Put16(directory, 0); // comment length
+
+    this->File.write(directory.data(), directory.size());
+    this->File.close();
+    return !this->File.fail();
+  }
+
+private:
+  static void Put16(std::string& out, std::uint16_t value)
+  {
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+  }
+
+  static void Put32(std::string& out, std::uint32_t value)
+  {
+    Put16(out, static_cast<std::uint16_t>(value & 0xFFFF));
+    Put16(out, static_cast<std::uint16_t>(value >> 16));
+  }
+
+  //! Fields shared by the local header and the central directory header
+  void PutCommonHeader(std::string& out, const ZipEntry& entry) const
+  {
+    Put16(out, 20);     // version needed to extract
+    Put16(out, 0x0800); // flags: utf-8 file name
+    Put16(out, entry.IsDeflated ? 8 : 0);
+    Put16(out, this->Time);
+    Put16(out, this->Date);
+    Put32(out, static_cast<std::uint32_t>(entry.Crc));
+    Put32(out, static_cast<std::uint32_t>(entry.CompressedSize));
+    Put32(out, static_cast<std::uint32_t>(entry.UncompressedSize));
+    Put16(out, static_cast<std::uint16_t>(entry.Name.size()));
+  }
+
+  std::ofstream File;
+  std::vector<ZipEntry> Entries;
+  unsigned long long Offset = 0;
+  std::uint16_t Time = 0;
+  std::uint16_t Date = 0;
+};
+}
+
+//-----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkLidarFramesExporter)
+
+//-----------------------------------------------------------------------------
+vtkCxxSetObjectMacro(vtkLidarFramesExporter, Reader, vtkLidarReader)
+
+//-----------------------------------------------------------------------------
+vtkLidarFramesExporter::~vtkLidarFramesExporter()
+{
+  this->SetReader(nullptr);
+  this->SetFileName(nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarFramesExporter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << endl;
+  os << indent << "FirstFrame: " << this->FirstFrame << endl;
+  os << indent << "LastFrame: " << this->LastFrame << endl;
+  os << indent << "Format: " << this->Format << endl;
+  os << indent << "WriteToZip: " << this->WriteToZip << endl;
+  os << indent << "CompressionLevel: " << this->CompressionLevel << endl;
+  os << indent << "Precision: " << this->Precision << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarFramesExporter::Write()
+{
+  if (!this->Reader || !this->FileName)
+  {
+    vtkErrorMacro(<< "A reader and a file name are required");
+    return false;
+  }
+
+  if (this->Reader->GetNumberOfFrames() == 0)
+  {
+    this->Reader->UpdateInformation();
+  }
+  const int lastFrame = this->LastFrame < 0 ? this->Reader->GetNumberOfFrames() - 1
+                                            : std::min(this->LastFrame, this->Reader->GetNumberOfFrames() - 1);
+  const int firstFrame = std::max(this->FirstFrame, 0);
+  if (firstFrame > lastFrame)
+  {
+    vtkErrorMacro(<< "No frame to export in [" << this->FirstFrame << ", " << this->LastFrame << "]");
+    return false;
+  }
+
+  // output files are named like the former python export
+  const std::string fileName = this->FileName;
+  const std::string baseName = vtksys::SystemTools::GetFilenameWithoutLastExtension(fileName);
+  const char* const extensions[3] = { "csv", "ply", "bin" };
+  const std::string extension = extensions[this->Format];
+
+  ZipWriter zip;
+  if (this->WriteToZip)
+  {
+    if (!zip.Open(fileName))
+    {
+      vtkErrorMacro(<< "Could not open " << fileName << " for writing");
+      return false;
+    }
+  }
+  else if (!vtksys::SystemTools::MakeDirectory(fileName))
+  {
+    vtkErrorMacro(<< "Could not create directory " << fileName);
+    return false;
+  }
+
+  bool success = true;
+  auto writeEntry = [&](ZipEntry& entry, const std::string& data) {
+    if (this->WriteToZip)
+    {
+      success &= zip.Write(entry);
+    }
+    else
+    {
+      std::ofstream file((fileName + "/" + entry.Name).c_str(), std::ios::binary);
+      file.write(data.data(), data.size());
+      success &= file.good();
+    }
+  };
+
+  // Frames are decoded in this thread, the reader not being thread safe, and
+  // are formatted by the workers. The results are written in frame order.
+  struct Task
+  {
+    int Frame;
+    vtkSmartPointer<vtkPolyData> Data;
+  };
+  struct Result
+  {
+    ZipEntry Entry;
+    std::string Data; //!< uncompressed data, only kept when writing in a directory
+    bool Valid;
+  };
+
+  boost::mutex mutex;
+  boost::condition_variable condition;
+  std::queue<Task> tasks;
+  std::map<int, Result> results;
+  bool noMoreTasks = false;
+
+  const int nbThreads = this->NumberOfThreads > 0
+    ? this->NumberOfThreads : std::max(1u, boost::thread::hardware_concurrency());
+  // bound the memory used by the frames waiting to be formatted or written
+  const size_t maxFramesInFlight = 2 * nbThreads;
+
+  const int format = this->Format;
+  const int precision = this->Precision;
+  const int compressionLevel = this->CompressionLevel;
+  const bool writeToZip = this->WriteToZip;
+
+  auto worker = [&]() {
+    while (true)
+    {
+      Task task;
+      {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (tasks.empty() && !noMoreTasks)
+        {
+          condition.wait(lock);
+        }
+        if (tasks.empty())
+        {
+          return;
+        }
+        task = tasks.front();
+        tasks.pop();
+      }
+
+      Result result;
+      std::string data;
+      switch (format)
+      {
+        case CSV: data = FormatCSV(task.Data, precision); break;
+        case PLY: data = FormatPLY(task.Data); break;
+        default: data = FormatRaw(task.Data); break;
+      }
+      char suffix[32];
+      std::snprintf(suffix, sizeof(suffix), " (Frame %04d).", task.Frame);
+      result.Entry.Name = baseName + suffix + extension;
+      if (writeToZip)
+      {
+        result.Valid = CompressEntry(data, compressionLevel, result.Entry);
+      }
+      else
+      {
+        result.Valid = true;
+        result.Data.swap(data);
+      }
+
+      {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        results[task.Frame] = std::move(result);
+      }
+      condition.notify_all();
+    }
+  };
+
+  boost::thread_group workers;
+  for (int i = 0; i < nbThreads; ++i)
+  {
+    workers.create_thread(worker);
+  }
+
+  int nextFrameToWrite = firstFrame;
+  const double nbFrames = lastFrame - firstFrame + 1;
+  // write the results available in frame order, waiting for them if required
+  auto writeResults = [&](bool wait, size_t maxInFlight) {
+    while (true)
+    {
+      Result result;
+      {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (wait && results.find(nextFrameToWrite) == results.end() &&
+          tasks.size() + results.size() >= maxInFlight)
+        {
+          condition.wait(lock);
+        }
+        auto it = results.find(nextFrameToWrite);
+        if (it == results.end())
+        {
+          return;
+        }
+        result = std::move(it->second);
+        results.erase(it);
+      }
+
+      if (!result.Valid)
+      {
+        vtkErrorMacro(<< "Failed to compress " << result.Entry.Name);
+        success = false;
+      }
+      else
+      {
+        writeEntry(result.Entry, result.Data);
+      }
+      nextFrameToWrite++;
+
+      double progress = (nextFrameToWrite - firstFrame) / nbFrames;
+      this->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    }
+  };
+
+  this->Reader->Open();
+  for (int frame = firstFrame; frame <= lastFrame && success; ++frame)
+  {
+    vtkSmartPointer<vtkPolyData> data = this->Reader->GetFrame(frame);
+    if (!data)
+    {
+      data = vtkSmartPointer<vtkPolyData>::New();
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+      tasks.push({ frame, data });
+    }
+    condition.notify_all();
+
+    writeResults(true, maxFramesInFlight);
+  }
+  this->Reader->Close();
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    noMoreTasks = true;
+  }
+  condition.notify_all();
+  // everything still in flight must be written
+  while (success && nextFrameToWrite <= lastFrame)
+  {
+    writeResults(true, 0);
+  }
+  workers.join_all();
+
+  // the columns of the raw format are only described once
+  if (success && this->Format == RAW)
+  {
+    vtkSmartPointer<vtkPolyData> frame;
+    this->Reader->Open();
+    frame = this->Reader->GetFrame(firstFrame);
+    this->Reader->Close();
+
+    std::string columns;
+    if (frame)
+    {
+      for (const Column& column : GetColumns(frame, "_", PLY_POINT_NAMES))
+      {
+        columns += column.Name + "\n";
+      }
+    }
+    ZipEntry entry;
+    entry.Name = "columns.txt";
+    if (this->WriteToZip)
+    {
+      success &= CompressEntry(columns, this->CompressionLevel, entry);
+    }
+    writeEntry(entry, columns);
+  }
+
+  if (this->WriteToZip)
+  {
+    success &= zip.Close();
+  }
+
+  if (!success)
+  {
+    vtkErrorMacro(<< "Failed to export the frames to " << fileName);
+  }
+  return success;
+}
@@ -0,0 +1,113 @@
+//=========================================================================
+//
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef VTKLIDARFRAMESEXPORTER_H
+#define VTKLIDARFRAMESEXPORTER_H
+
+#include <vtkObject.h>
+
+class vtkLidarReader;
+
+/**
+ * @brief The vtkLidarFramesExporter class exports a range of frames of a
+ * vtkLidarReader, one file per frame.
+ *
+ * Frames are decoded one after the other by the reader, while their formatting
+ * (and compression) is done by a pool of threads. The files are written in frame
+ * order either in a directory or directly in a zip archive. The supported formats are:
+ * - CSV: the point coordinates followed by all point data arrays
+ * - PLY: binary PLY with the same columns
+ * - Raw: the same columns packed as 32 bits floats, without header. The name of
+ *   the columns is written once in a "columns.txt" file
+ */
+class VTK_EXPORT vtkLidarFramesExporter : public vtkObject
+{
+public:
+  static vtkLidarFramesExporter* New();
+  vtkTypeMacro(vtkLidarFramesExporter, vtkObject)
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum FileFormat
+  {
+    CSV = 0,
+    PLY = 1,
+    RAW = 2
+  };
+
+  //! The reader to export the frames from. It must be able to read the frames (calibrated)
+  vtkGetObjectMacro(Reader, vtkLidarReader)
+  virtual void SetReader(vtkLidarReader*);
+
+  //! The output zip file or, when WriteToZip is off, the output directory
+  vtkSetStringMacro(FileName)
+  vtkGetStringMacro(FileName)
+
+  //! First frame to export
+  vtkSetMacro(FirstFrame, int)
+  vtkGetMacro(FirstFrame, int)
+
+  //! Last frame to export, included. -1 means the last frame of the reader
+  vtkSetMacro(LastFrame, int)
+  vtkGetMacro(LastFrame, int)
+
+  //! Format of the files, see FileFormat
+  vtkSetClampMacro(Format, int, CSV, RAW)
+  vtkGetMacro(Format, int)
+
+  //! Write all files in a single zip archive instead of a directory
+  vtkSetMacro(WriteToZip, bool)
+  vtkGetMacro(WriteToZip, bool)
+
+  //! Compression level of the zip archive, 0 stores the files without compression
+  vtkSetClampMacro(CompressionLevel, int, 0, 9)
+  vtkGetMacro(CompressionLevel, int)
+
+  //! Number of digits after the decimal point of the floating point values written in CSV
+  vtkSetClampMacro(Precision, int, 0, 17)
+  vtkGetMacro(Precision, int)
+
+  //! Number of threads formatting the frames, 0 means one per core
+  vtkSetMacro(NumberOfThreads, int)
+  vtkGetMacro(NumberOfThreads, int)
+
+  /**
+   * @brief Write export the frames. vtkCommand::ProgressEvent is invoked after each
+   * written frame, with the progress between 0 and 1 as call data.
+   * @return true on success
+   */
+  bool Write();
+
+protected:
+  vtkLidarFramesExporter() = default;
+  ~vtkLidarFramesExporter();
+
+  vtkLidarReader* Reader = nullptr;
+  char* FileName = nullptr;
+  int FirstFrame = 0;
+  int LastFrame = -1;
+  int Format = CSV;
+  bool WriteToZip = true;
+  int CompressionLevel = 1;
+  int Precision = 6;
+  int NumberOfThreads = 0;
+
+private:
+  vtkLidarFramesExporter(const vtkLidarFramesExporter&) = delete;
+  void operator=(const vtkLidarFramesExporter&) = delete;
+};
+
+#endif // VTKLIDARFRAMESEXPORTER_H
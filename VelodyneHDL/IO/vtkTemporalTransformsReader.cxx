@@ -14,34 +14,53 @@
 
 #include "vtkTemporalTransformsReader.h"
 
-#include <vtkAbstractArray.h>
-#include <vtkDelimitedTextReader.h>
+#include <vtkByteSwap.h>
 #include <vtkDoubleArray.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
-#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
-#include <vtkTable.h>
 
 #include <Eigen/Geometry>
 
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
 #include "vtkTemporalTransforms.h"
+#include "TemporalTransformsBinaryFormat.h"
+#include "TextFileParsing.h"
 
 namespace {
+//! Columns of the csv file used to build the trajectory
+enum Column
+{
+  TIME = 0,
+  ROLL,
+  PITCH,
+  YAW,
+  X,
+  Y,
+  Z,
+  NUMBER_OF_COLUMNS
+};
+
 //-----------------------------------------------------------------------------
-vtkDoubleArray* foundArray(vtkTable* table, std::vector<std::string> potentialName)
+int foundColumn(const std::vector<std::string>& header, std::vector<std::string> potentialName)
 {
-  // try to find the right array
+  // try to find the right column
   for (const auto& name: potentialName)
   {
-    vtkDoubleArray* tmp = vtkDoubleArray::SafeDownCast(table->GetColumnByName(name.c_str()));
-    if (tmp)
+    auto it = std::find(header.begin(), header.end(), name);
+    if (it != header.end())
     {
-      return tmp;
+      return static_cast<int>(it - header.begin());
     }
   }
   // throw an exception when no matching could be founded
@@ -54,40 +73,110 @@ vtkDoubleArray* foundArray(vtkTable* table, std::vector<std::string> potentialNa
 }
 
 //-----------------------------------------------------------------------------
-std::unordered_map<std::string, vtkDoubleArray*> createArrayIndex(vtkTable* table)
+std::array<int, NUMBER_OF_COLUMNS> createColumnIndex(const std::vector<std::string>& header)
 {
-  std::unordered_map<std::string, vtkDoubleArray*> array;
-  std::vector<std::string> potentialName;
-
-  std::string time[] = {"Time", "time", "Timestamp", "timestamp"};
-  potentialName = std::vector<std::string>(time, time + sizeof(time) / sizeof(time[0]));
-  array["time"] = foundArray(table, potentialName);
+  std::array<int, NUMBER_OF_COLUMNS> index;
+  index[TIME] = foundColumn(header, {"Time", "time", "Timestamp", "timestamp"});
+  index[ROLL] = foundColumn(header, {"Rx(Roll)", "Roll", "roll", "Rx", "rx"});
+  index[PITCH] = foundColumn(header, {"Ry(Pitch)", "Pitch", "pitch", "Ry", "ry"});
+  index[YAW] = foundColumn(header, {"Rz(Yaw)", "Yaw", "yaw", "Rz", "rz"});
+  index[X] = foundColumn(header, {"X", "x"});
+  index[Y] = foundColumn(header, {"Y", "y"});
+  index[Z] = foundColumn(header, {"Z", "z"});
+  return index;
+}
 
-  std::string roll[] = {"Rx(Roll)", "Roll", "roll", "Rx", "rx"};
-  potentialName = std::vector<std::string>(roll, roll + sizeof(roll) / sizeof(roll[0]));
-  array["roll"] = foundArray(table, potentialName);
+//-----------------------------------------------------------------------------
+//! Parse the field [begin, end) as a double, NaN if it is empty or not a number
+double parseDouble(const char* begin, const char* end)
+{
+  while (begin < end && IsBlank(*begin))
+  {
+    begin++;
+  }
+  while (end > begin && IsBlank(*(end - 1)))
+  {
+    end--;
+  }
+  double value = 0;
+  if (begin == end || ParseDouble(begin, end, value) != end)
+  {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return value;
+}
 
-  std::string pitch[] = {"Ry(Pitch)", "Pitch", "pitch", "Ry", "ry"};
-  potentialName = std::vector<std::string>(pitch, pitch + sizeof(pitch) / sizeof(pitch[0]));
-  array["pitch"] = foundArray(table, potentialName);
+//-----------------------------------------------------------------------------
+//! Split the header line into trimmed column names
+std::vector<std::string> parseHeader(const char* begin, const char* end)
+{
+  std::vector<std::string> names;
+  const char* field = begin;
+  while (field <= end)
+  {
+    const char* fieldEnd = std::find(field, end, ',');
+    const char* first = field;
+    const char* last = fieldEnd;
+    while (first < last && (IsBlank(*first) || *first == '"'))
+    {
+      first++;
+    }
+    while (last > first && (IsBlank(*(last - 1)) || *(last - 1) == '"'))
+    {
+      last--;
+    }
+    names.emplace_back(first, last);
+    field = fieldEnd + 1;
+  }
+  return names;
+}
 
-  std::string yaw[] = {"Rz(Yaw)", "Yaw", "yaw", "Rz", "rz"};
-  potentialName = std::vector<std::string>(yaw, yaw + sizeof(yaw) / sizeof(yaw[0]));
-  array["yaw"] = foundArray(table, potentialName);
+//-----------------------------------------------------------------------------
+//! Lines to skip: empty or comment ones
+bool isIgnoredLine(const char* begin, const char* end)
+{
+  while (begin < end && IsBlank(*begin))
+  {
+    begin++;
+  }
+  return begin == end || *begin == '#';
+}
 
-  std::string x[] = {"X", "x"};
-  potentialName = std::vector<std::string>(x, x + sizeof(x) / sizeof(x[0]));
-  array["X"] = foundArray(table, potentialName);
+//-----------------------------------------------------------------------------
+//! Check the header of a binary file, swap it to the host byte order if needed
+bool checkHeader(TemporalTransformsBinaryHeader& header, uint64_t fileSize, bool& swap, std::string& error)
+{
+  if (!TemporalTransformsBinaryFormat::HasMagic(header.Magic, sizeof(header.Magic)))
+  {
+    error = "Not a binary trajectory file";
+    return false;
+  }
 
-  std::string y[] = {"Y", "y"};
-  potentialName = std::vector<std::string>(y, y + sizeof(y) / sizeof(y[0]));
-  array["Y"] = foundArray(table, potentialName);
+  swap = header.ByteOrderMark != TemporalTransformsBinaryFormat::ByteOrderMark;
+  if (swap)
+  {
+    vtkByteSwap::SwapVoidRange(&header.Version, 1, sizeof(header.Version));
+    vtkByteSwap::SwapVoidRange(&header.ByteOrderMark, 1, sizeof(header.ByteOrderMark));
+    vtkByteSwap::SwapVoidRange(&header.NumberOfTransforms, 1, sizeof(header.NumberOfTransforms));
+    if (header.ByteOrderMark != TemporalTransformsBinaryFormat::ByteOrderMark)
+    {
+      error = "Unknown byte order";
+      return false;
+    }
+  }
 
-  std::string z[] = {"Z", "z"};
-  potentialName = std::vector<std::string>(z, z + sizeof(z) / sizeof(z[0]));
-  array["Z"] = foundArray(table, potentialName);
+  if (header.Version > TemporalTransformsBinaryFormat::Version)
+  {
+    error = "Unsupported version " + std::to_string(header.Version);
+    return false;
+  }
 
-  return array;
+  if (fileSize < TemporalTransformsBinaryFormat::GetFileSize(header.NumberOfTransforms))
+  {
+    error = "File is truncated";
+    return false;
+  }
+  return true;
 }
 }
 
@@ -112,78 +201,281 @@ int vtkTemporalTransformsReader::RequestData(vtkInformation* vtkNotUsed(request)
     return 1;
   }
 
-  // Read the data from the file
-  vtkNew<vtkDelimitedTextReader> csvReader;
-  csvReader->SetFileName(this->FileName);
-  csvReader->DetectNumericColumnsOn();
-  csvReader->SetFieldDelimiterCharacters(",");
-  csvReader->ForceDoubleOn();
-  csvReader->SetHaveHeaders(true);
-  csvReader->Update();
+  // The binary files are recognized by their header
+  char magic[sizeof(TemporalTransformsBinaryFormat::Magic)] = {};
+  std::ifstream file(this->FileName, std::ios::in | std::ios::binary);
+  if (!file.is_open())
+  {
+    vtkErrorMacro(<< "Could not open file " << this->FileName)
+    return 1;
+  }
+  file.read(magic, sizeof(magic));
+  const bool isBinary = TemporalTransformsBinaryFormat::HasMagic(magic, file.gcount());
+  file.close();
 
-  vtkTable* table = csvReader->GetOutput();
+  auto trajectory = vtkSmartPointer<vtkTemporalTransforms>::New();
+  const bool success = isBinary ? this->ReadBinary(trajectory) : this->ReadCSV(trajectory);
+  if (!success)
+  {
+    return 1;
+  }
 
-  if (table->GetNumberOfColumns() < 7)
+  // Set the filter output
+  vtkPolyData* output = vtkPolyData::GetData(outputVector);
+  output->ShallowCopy(trajectory);
+
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkTemporalTransformsReader::ReadCSV(vtkTemporalTransforms* trajectory)
+{
+  MappedTextFile content;
+  try
   {
-    vtkErrorMacro( << "The file you try to read has only " << table->GetNumberOfColumns() << " colums."
+    content.Open(this->FileName, this->UseMemoryMap);
+  }
+  catch (const std::exception& e)
+  {
+    vtkErrorMacro(<< "Could not read file " << this->FileName << ": " << e.what())
+    return false;
+  }
+
+  const char* it = content.Begin();
+  const char* end = content.End();
+
+  // The header is the first line which is not a comment
+  const char* lineEnd = it;
+  while (it < end)
+  {
+    lineEnd = std::find(it, end, '\n');
+    if (!isIgnoredLine(it, lineEnd))
+    {
+      break;
+    }
+    it = lineEnd + 1;
+  }
+  if (it >= end)
+  {
+    vtkErrorMacro(<< "The file " << this->FileName << " is empty")
+    return false;
+  }
+  const std::vector<std::string> header = parseHeader(it, lineEnd);
+  it = lineEnd + 1;
+
+  if (header.size() < NUMBER_OF_COLUMNS)
+  {
+    vtkErrorMacro( << "The file you try to read has only " << header.size() << " colums."
                    << "This reader needs to have a CVS file with the following colum:"
                    << "time, roll, pitch, yaw, X, Y, Z")
   }
 
+  // create map from the file columns to the needed ones
+  std::vector<int> columnRole(header.size(), -1);
+  try
+  {
+    const std::array<int, NUMBER_OF_COLUMNS> index = createColumnIndex(header);
+    for (int role = 0; role < NUMBER_OF_COLUMNS; role++)
+    {
+      columnRole[index[role]] = role;
+    }
+  }
+  catch (std::string e)
+  {
+    vtkErrorMacro(<< e)
+    return false;
+  }
+
+  // Allocate for the maximum number of rows, values are directly written in the arrays
+  const vtkIdType maxRows = it < end ? std::count(it, end, '\n') + 1 : 0;
   auto translation = vtkSmartPointer<vtkDoubleArray>::New();
   translation->SetNumberOfComponents(3);
+  translation->SetNumberOfTuples(maxRows);
   // The rotation will be store in an axis-angle representation (w, x, y, z) so that
   // - axis = (x, y, z) and norm(axis) = 1
   // - angle = w in radian
   auto axisAngle = vtkSmartPointer<vtkDoubleArray>::New();
   axisAngle->SetNumberOfComponents(4);
-  auto timstamp = vtkSmartPointer<vtkDoubleArray>::New();
+  axisAngle->SetNumberOfTuples(maxRows);
+  auto timestamp = vtkSmartPointer<vtkDoubleArray>::New();
+  timestamp->SetNumberOfTuples(maxRows);
+
+  double* translationData = translation->GetPointer(0);
+  double* axisAngleData = axisAngle->GetPointer(0);
+  double* timestampData = timestamp->GetPointer(0);
+
+  // Parse each row directly to doubles, the rows with a missing or invalid
+  // value are skipped
+  vtkIdType nbRows = 0;
+  vtkIdType nbInvalidRows = 0;
+  vtkIdType firstInvalidLine = 0;
+  vtkIdType lineNumber = std::count(content.Begin(), it, '\n');
+  std::array<double, NUMBER_OF_COLUMNS> values;
+  while (it < end)
+  {
+    lineEnd = std::find(it, end, '\n');
+    lineNumber++;
+    if (isIgnoredLine(it, lineEnd))
+    {
+      it = lineEnd + 1;
+      continue;
+    }
 
-  // create map for idx
-  std::unordered_map<std::string, vtkDoubleArray*> array;
-  try {
-    array = createArrayIndex(table);
-  } catch (std::string e) {
-    vtkErrorMacro(<< e)
-    return 1;
-  }
+    values.fill(std::numeric_limits<double>::quiet_NaN());
+    const char* field = it;
+    for (size_t column = 0; column < columnRole.size() && field <= lineEnd; column++)
+    {
+      const char* fieldEnd = std::find(field, lineEnd, ',');
+      if (columnRole[column] >= 0)
+      {
+        values[columnRole[column]] = parseDouble(field, fieldEnd);
+      }
+      field = fieldEnd + 1;
+    }
+    it = lineEnd + 1;
 
-  // Read the data from the csv table
-  for (vtkIdType i = 0; i < table->GetNumberOfRows(); i++)
-  {
-    translation->InsertNextTuple3(array["X"]->GetTuple1(i),
-                                  array["Y"]->GetTuple1(i),
-                                  array["Z"]->GetTuple1(i));
+    if (std::any_of(values.begin(), values.end(), [](double v) { return std::isnan(v); }))
+    {
+      if (nbInvalidRows++ == 0)
+      {
+        firstInvalidLine = lineNumber;
+      }
+      continue;
+    }
 
-    timstamp->InsertNextValue(array["time"]->GetTuple1(i) + this->TimeOffset);
+    timestampData[nbRows] = values[TIME] + this->TimeOffset;
+    translationData[3 * nbRows + 0] = values[X];
+    translationData[3 * nbRows + 1] = values[Y];
+    translationData[3 * nbRows + 2] = values[Z];
 
     // Assumption: roll, pitch and yaw are in degree
-    double roll  = array["roll"]->GetTuple1(i);
-    double pitch = array["pitch"]->GetTuple1(i);
-    double yaw   = array["yaw"]->GetTuple1(i);
-
     auto currentAxisAngleRotation = Eigen::AngleAxisd(
-          Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ())
-          * Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY())
-          * Eigen::AngleAxisd(roll, Eigen::Vector3d::UnitX()));
+          Eigen::AngleAxisd(values[YAW], Eigen::Vector3d::UnitZ())
+          * Eigen::AngleAxisd(values[PITCH], Eigen::Vector3d::UnitY())
+          * Eigen::AngleAxisd(values[ROLL], Eigen::Vector3d::UnitX()));
+
+    axisAngleData[4 * nbRows + 0] = currentAxisAngleRotation.axis()[0];
+    axisAngleData[4 * nbRows + 1] = currentAxisAngleRotation.axis()[1];
+    axisAngleData[4 * nbRows + 2] = currentAxisAngleRotation.axis()[2];
+    axisAngleData[4 * nbRows + 3] = currentAxisAngleRotation.angle();
+    nbRows++;
+  }
 
-    axisAngle->InsertNextTuple4(currentAxisAngleRotation.axis()[0],
-                                currentAxisAngleRotation.axis()[1],
-                                currentAxisAngleRotation.axis()[2],
-                                currentAxisAngleRotation.angle());
+  if (nbInvalidRows > 0)
+  {
+    vtkWarningMacro(<< nbInvalidRows << " rows of " << this->FileName
+                    << " have a missing or invalid value and are skipped, the first one is line "
+                    << firstInvalidLine)
   }
 
+  translation->SetNumberOfTuples(nbRows);
+  axisAngle->SetNumberOfTuples(nbRows);
+  timestamp->SetNumberOfTuples(nbRows);
+
   // Create the cell to be able to visualize the data.
-  auto trajectory = vtkSmartPointer<vtkTemporalTransforms>::New();
   trajectory->SetTranslationArray(translation);
-  trajectory->SetTimeArray(timstamp);
+  trajectory->SetTimeArray(timestamp);
   trajectory->SetOrientationArray(axisAngle);
+  return true;
+}
 
-  // Set the filter output
-  vtkPolyData* output = vtkPolyData::GetData(outputVector);
-  output->ShallowCopy(trajectory);
+//-----------------------------------------------------------------------------
+bool vtkTemporalTransformsReader::ReadBinary(vtkTemporalTransforms* trajectory)
+{
+  using namespace TemporalTransformsBinaryFormat;
 
-  return 1;
+  auto translation = vtkSmartPointer<vtkDoubleArray>::New();
+  translation->SetNumberOfComponents(PositionComponents);
+  auto axisAngle = vtkSmartPointer<vtkDoubleArray>::New();
+  axisAngle->SetNumberOfComponents(OrientationComponents);
+  auto timestamp = vtkSmartPointer<vtkDoubleArray>::New();
+  timestamp->SetNumberOfComponents(TimeComponents);
+  vtkDoubleArray* columns[3] = { timestamp, axisAngle, translation };
+
+  TemporalTransformsBinaryHeader header;
+  bool swap = false;
+  std::string error;
+  try
+  {
+    if (this->UseMemoryMap)
+    {
+      MappedTextFile content;
+      content.Open(this->FileName, true);
+      if (content.GetSize() < sizeof(header))
+      {
+        throw std::runtime_error("File is truncated");
+      }
+      std::memcpy(&header, content.Begin(), sizeof(header));
+      if (!checkHeader(header, content.GetSize(), swap, error))
+      {
+        throw std::runtime_error(error);
+      }
+
+      // each column is a single block to copy
+      const char* data = content.Begin() + sizeof(header);
+      for (vtkDoubleArray* column : columns)
+      {
+        column->SetNumberOfTuples(header.NumberOfTransforms);
+        const size_t size = column->GetNumberOfValues() * sizeof(double);
+        std::memcpy(column->GetVoidPointer(0), data, size);
+        data += size;
+      }
+    }
+    else
+    {
+      std::ifstream file(this->FileName, std::ios::in | std::ios::binary | std::ios::ate);
+      if (!file.is_open())
+      {
+        throw std::runtime_error("Could not open file");
+      }
+      const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+      file.seekg(0);
+      file.read(reinterpret_cast<char*>(&header), sizeof(header));
+      if (!file || !checkHeader(header, fileSize, swap, error))
+      {
+        throw std::runtime_error(file ? error : "File is truncated");
+      }
+
+      for (vtkDoubleArray* column : columns)
+      {
+        column->SetNumberOfTuples(header.NumberOfTransforms);
+        file.read(reinterpret_cast<char*>(column->GetVoidPointer(0)),
+          column->GetNumberOfValues() * sizeof(double));
+      }
+      if (!file)
+      {
+        throw std::runtime_error("File is truncated");
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    vtkErrorMacro(<< "Could not read binary trajectory " << this->FileName << ": " << e.what())
+    return false;
+  }
+
+  if (swap)
+  {
+    for (vtkDoubleArray* column : columns)
+    {
+      vtkByteSwap::SwapVoidRange(column->GetVoidPointer(0), column->GetNumberOfValues(), sizeof(double));
+    }
+  }
+
+  if (this->TimeOffset != 0.0)
+  {
+    double* time = timestamp->GetPointer(0);
+    for (vtkIdType i = 0; i < timestamp->GetNumberOfTuples(); i++)
+    {
+      time[i] += this->TimeOffset;
+    }
+  }
+
+  // Create the cell to be able to visualize the data.
+  trajectory->SetTranslationArray(translation);
+  trajectory->SetTimeArray(timestamp);
+  trajectory->SetOrientationArray(axisAngle);
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -26,6 +26,10 @@
 /**
  * @brief vtkTemporalTransformsReader reads a csv file to generate a vtkTemporalTransform.
  *
+ * The binary trajectory files written by vtkTemporalTransformsWriter (see
+ * TemporalTransformsBinaryFormat.h) are also supported, and recognized by their
+ * header whatever their extension.
+ *
  * The cvs file is expected to respect the following specification:
  * - Element separator = ","
  * - Line separator = "\n"
@@ -36,6 +40,7 @@
  * - pitch : expresses the sensor rotation around the Y axis and is in degree
  * - yaw   : expresses the sensor rotation around the Z axis and is in degree
  * - the rotation matrix can be recomposed this way: R = Rz(z)*Ry(y)*Rx(x)
+ * - empty lines and lines starting with "#" are ignored
  *
  * Remark: if you get from VeloView UI the error:
  * "vtkSIProxyDefinitionManager: No proxy that matches: group= and proxy= were found."
@@ -61,12 +66,22 @@ public:
   vtkSetMacro(TimeOffset, double)
   //@}
 
+  //@{
+  /**
+   * @copydoc vtkTemporalTransformsReader::UseMemoryMap
+   */
+  vtkGetMacro(UseMemoryMap, bool)
+  vtkSetMacro(UseMemoryMap, bool)
+  //@}
+
 protected:
   vtkTemporalTransformsReader();
 
-  //! Read the data from the csv file and fill TrajectoryCahce
-  //! can throw an error
-  void ReadData();
+  //! Parse the csv file into the trajectory, return false on failure
+  bool ReadCSV(vtkTemporalTransforms* trajectory);
+
+  //! Load the binary file into the trajectory, return false on failure
+  bool ReadBinary(vtkTemporalTransforms* trajectory);
 
   int RequestData(vtkInformation* request,
                   vtkInformationVector** inputVector,
@@ -76,6 +91,9 @@ private:
   //! TimeOffset in seconds relative to the system clock
   double TimeOffset = 0.0;
 
+  //! Map the file in memory instead of reading it through a stream
+  bool UseMemoryMap = true;
+
   vtkTemporalTransformsReader(const vtkTemporalTransformsReader&) = delete;
   void operator =(const vtkTemporalTransformsReader&) = delete;
 
@@ -6,9 +6,15 @@
 #include <vtkObjectFactory.h>
 #include "vtkInformationVector.h"
 #include "vtkInformation.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 #include "vtkConversions.h"
+#include "TemporalTransformsBinaryFormat.h"
 
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkTemporalTransformsWriter)
@@ -27,6 +33,12 @@ int vtkTemporalTransformsWriter::RequestData(vtkInformation *vtkNotUsed(request)
                                              vtkInformationVector **inputVector,
                                              vtkInformationVector *vtkNotUsed(outputVector))
 {
+  if (!this->FileName)
+  {
+    vtkErrorMacro("Please specify the file to write");
+    return 0;
+  }
+
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
   vtkPolyData *polyData = vtkPolyData::SafeDownCast(
   inInfo->Get(vtkDataObject::DATA_OBJECT()));
@@ -44,15 +56,29 @@ int vtkTemporalTransformsWriter::RequestData(vtkInformation *vtkNotUsed(request)
     return 0;
   }
 
+  const bool binary = this->FileType == VTK_BINARY ||
+    TemporalTransformsBinaryFormat::HasExtension(this->FileName);
+  const bool success = binary ? this->WriteBinary(transforms) : this->WriteCSV(transforms);
+  return success ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkTemporalTransformsWriter::WriteCSV(vtkTemporalTransforms* transforms)
+{
   vtkDataArray* time = transforms->GetTimeArray();
 
   std::ofstream file(this->FileName);
-  // TODO: when we support reading a CSV with commented line, add such comment:
-  // # Pose trajectory format, time in s, angles in degree, position in meters
-  // # Recompose the rotation part of the pose using:
-  // # R = Rz(yaw) * Ry(pitch) * Rx(roll)
-  // # a point exprimed in the Lidar reference frame can be exprimed in a fixed
-  // # reference frame using: X_fixed = R(t) * X_lidar + [x(t), y(t), z(t)]^T
+  if (!file.is_open())
+  {
+    vtkErrorMacro("Could not open file " << this->FileName);
+    return false;
+  }
+  // the lines starting with '#' are skipped by vtkTemporalTransformsReader
+  file << "# Pose trajectory format, time in s, angles in radian, position in meters" << endl
+       << "# Recompose the rotation part of the pose using:" << endl
+       << "# R = Rz(yaw) * Ry(pitch) * Rx(roll)" << endl
+       << "# a point expressed in the Lidar reference frame can be expressed in a fixed" << endl
+       << "# reference frame using: X_fixed = R(t) * X_lidar + [x(t), y(t), z(t)]^T" << endl;
   file << "Time,Rx(Roll),Ry(Pitch),Rz(Yaw),X,Y,Z" << endl;
 
   for (unsigned int i = 0; i < transforms->GetNumberOfPoints(); i++)
@@ -76,9 +102,60 @@ int vtkTemporalTransformsWriter::RequestData(vtkInformation *vtkNotUsed(request)
          << "," << towrite.second[0]
          << "," << towrite.second[1]
          << "," << towrite.second[2]
-         << std::endl;
+         << "\n";
   }
 
   file.close();
-  return 1;
+  return !file.fail();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkTemporalTransformsWriter::WriteBinary(vtkTemporalTransforms* transforms)
+{
+  using namespace TemporalTransformsBinaryFormat;
+
+  vtkDataArray* time = transforms->GetTimeArray();
+  vtkDataArray* orientation = transforms->GetOrientationArray();
+  vtkDataArray* position = transforms->GetTranslationArray();
+  const vtkIdType nbTransforms = transforms->GetNumberOfPoints();
+
+  // The format guarantees the rows to be sorted by time
+  std::vector<vtkIdType> order(nbTransforms);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [time](vtkIdType a, vtkIdType b)
+  {
+    return time->GetTuple1(a) < time->GetTuple1(b);
+  });
+
+  // Fill the columns before writing them at once
+  std::vector<double> times(nbTransforms * TimeComponents);
+  std::vector<double> orientations(nbTransforms * OrientationComponents);
+  std::vector<double> positions(nbTransforms * PositionComponents);
+  for (vtkIdType i = 0; i < nbTransforms; i++)
+  {
+    times[i] = time->GetTuple1(order[i]);
+    orientation->GetTuple(order[i], &orientations[i * OrientationComponents]);
+    position->GetTuple(order[i], &positions[i * PositionComponents]);
+  }
+
+  std::ofstream file(this->FileName, std::ios::out | std::ios::binary);
+  if (!file.is_open())
+  {
+    vtkErrorMacro("Could not open file " << this->FileName);
+    return false;
+  }
+
+  const TemporalTransformsBinaryHeader header = CreateHeader(nbTransforms);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(times.data()), times.size() * sizeof(double));
+  file.write(reinterpret_cast<const char*>(orientations.data()), orientations.size() * sizeof(double));
+  file.write(reinterpret_cast<const char*>(positions.data()), positions.size() * sizeof(double));
+  file.close();
+
+  if (file.fail())
+  {
+    vtkErrorMacro("Failed to write file " << this->FileName);
+    return false;
+  }
+  return true;
 }
@@ -18,6 +18,16 @@
 // #include <vtkPolyDataAlgorithm.h>
 #include <vtkPolyDataWriter.h>
 
+class vtkTemporalTransforms;
+
+/**
+ * @brief vtkTemporalTransformsWriter writes a vtkTemporalTransforms either as a
+ * CSV readable by vtkTemporalTransformsReader, or in a compact binary format
+ * (see TemporalTransformsBinaryFormat.h) which is much faster to load.
+ *
+ * The binary format is used when FileType is set to VTK_BINARY or when the
+ * file name has the ".traj" extension.
+ */
 // Inspired by vtkObjWriter
 class VTK_EXPORT vtkTemporalTransformsWriter : public vtkPolyDataWriter
 {
@@ -34,6 +44,12 @@ protected:
   vtkTemporalTransformsWriter() = default;
   ~vtkTemporalTransformsWriter();
 
+  //! Write the transforms as CSV, return false on failure
+  bool WriteCSV(vtkTemporalTransforms* transforms);
+
+  //! Write the transforms in the binary format, sorted by time, return false on failure
+  bool WriteBinary(vtkTemporalTransforms* transforms);
+
 private:
   vtkTemporalTransformsWriter(const vtkTemporalTransformsWriter&) = delete;
   void operator =(const vtkTemporalTransformsWriter&) = delete;
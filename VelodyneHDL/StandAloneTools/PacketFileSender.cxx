@@ -27,24 +27,58 @@
 =========================================================================*/
 // .NAME PacketFileSender -
 // .SECTION Description
-// This program reads a pcap file and sends the packets using UDP.
-// The default playback speed is based on the timestamps specified in the pcap file
+// This program reads one or several pcap files and sends the packets using UDP.
+// The default playback speed is based on the timestamps specified in the pcap files.
+// When several files are given, their packets are interleaved and each file is
+// sent to its own ports.
 
-#include "vtkPacketFileReader.h"
-#include "vvPacketSender.h"
+#include "vvPacketReplayer.h"
 
-#include <cstdlib>
-#include <ctime>
+#include <csignal>
+#include <iomanip>
 #include <iostream>
 #include <string>
-#include <chrono>
+#include <vector>
 
-#include <boost/thread/thread.hpp>
 #include <boost/program_options.hpp>
 namespace po = boost::program_options;
 
 const int OUTPUT_WIDTH = 15; // width of the column (#packet, duration, ...) in the output stream
 
+namespace
+{
+vvPacketReplayer* Replayer = nullptr;
+
+void StopReplay(int)
+{
+  if (Replayer)
+  {
+    Replayer->Stop();
+  }
+}
+
+void DisplayStatistics(const ReplayStatistics& stats)
+{
+  std::cout << std::fixed
+            << std::right << std::setw(OUTPUT_WIDTH) << stats.NumberOfPackets
+            << std::right << std::setw(OUTPUT_WIDTH) << std::setprecision(3) << stats.ElapsedTime
+            << std::right << std::setw(OUTPUT_WIDTH) << std::setprecision(0) << stats.GetPacketRate()
+            << std::right << std::setw(OUTPUT_WIDTH) << std::setprecision(2) << stats.GetByteRate() * 8e-6
+            << std::right << std::setw(OUTPUT_WIDTH) << std::setprecision(0) << stats.MaxLateness * 1e6
+            << std::endl;
+}
+
+//! return the port of the i-th capture, consecutive ports are used when a single one is given
+unsigned int GetPort(const std::vector<unsigned int>& ports, size_t i)
+{
+  if (i < ports.size())
+  {
+    return ports[i];
+  }
+  return ports.back() + static_cast<unsigned int>(i - ports.size() + 1);
+}
+}
+
 int main(int argc, char* argv[])
 {
   bool loop = false;  // run the capture 1 time or in loop
@@ -55,15 +89,18 @@ int main(int argc, char* argv[])
       ("help", "produce help message")
       ("ip", po::value<std::string>()->default_value("127.0.0.1"), "destination ip adress")
       ("loop", po::bool_switch(&loop), "run the capture in loop")
-      ("lidarPort", po::value<unsigned int>()->default_value(2368), "destination port for lidar packets")
-      ("GPSPort", po::value<unsigned int>()->default_value(8308), "destination port for GPS packets")
-      ("speed", po::value<double>()->default_value(1), "playback speed")
+      ("lidarPort", po::value<std::vector<unsigned int> >()->multitoken()->default_value(std::vector<unsigned int>(1, 2368), "2368"),
+       "destination port for lidar packets, one per pcap file. Consecutive ports are used for the files without one")
+      ("GPSPort", po::value<std::vector<unsigned int> >()->multitoken()->default_value(std::vector<unsigned int>(1, 8308), "8308"),
+       "destination port for GPS packets, one per pcap file. Consecutive ports are used for the files without one")
+      ("speed", po::value<double>()->default_value(1), "playback speed, 0 sends as fast as possible")
+      ("batch", po::value<unsigned int>()->default_value(32), "maximum number of packets sent at once")
       ("display-frequency", po::value<unsigned int>()->default_value(1000), "print information after every interval of X sent packets")
       ;
 
   po::options_description hidden("Hidden options");
   hidden.add_options()
-      ("input-file", po::value<std::string>(), "input file")
+      ("input-file", po::value<std::vector<std::string> >(), "input files")
       ;
 
   po::positional_options_description p;
@@ -77,86 +114,61 @@ int main(int argc, char* argv[])
             options(cmdline_options).positional(p).run(), vm);
   po::notify(vm);
 
-  if (vm.count("help") || argc < 2) {
-      cout << "Usage: PacketFileSender <pcap_file> [options]\n";
-      cout << visible << "\n";
+  if (vm.count("help") || !vm.count("input-file")) {
+      std::cout << "Usage: PacketFileSender <pcap_file> [<pcap_file> ...] [options]\n";
+      std::cout << visible << "\n";
       return 1;
   }
 
   // convert to the right type
-  std::string filename = vm["input-file"].as<std::string>();
-  double speed = vm["speed"].as<double>();
+  std::vector<std::string> filenames = vm["input-file"].as<std::vector<std::string> >();
   std::string destinationIp = vm["ip"].as<std::string>();
-  unsigned int lidarPort =  vm["lidarPort"].as<unsigned int>();
-  unsigned int GPSPort = vm["GPSPort"].as<unsigned int>();
+  std::vector<unsigned int> lidarPorts = vm["lidarPort"].as<std::vector<unsigned int> >();
+  std::vector<unsigned int> GPSPorts = vm["GPSPort"].as<std::vector<unsigned int> >();
   unsigned int display_frequency = vm["display-frequency"].as<unsigned int>();
 
-  const int microSecondsPerSecond = 1e6;
-
-  std::cout << "Start sending" << std::endl;
-
   try
   {
-    do
+    vvPacketReplayer replayer;
+    replayer.SetSpeed(vm["speed"].as<double>());
+    replayer.SetLoop(loop);
+    replayer.SetBatchSize(vm["batch"].as<unsigned int>());
+    replayer.SetProgressCallback(DisplayStatistics, display_frequency);
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+      replayer.AddCapture(filenames[i], destinationIp, GetPort(lidarPorts, i), GetPort(GPSPorts, i));
+      std::cout << filenames[i] << " -> " << destinationIp << ":" << GetPort(lidarPorts, i)
+                << " (GPS " << GetPort(GPSPorts, i) << ")" << std::endl;
+    }
+
+    // Ctrl+C stops the replay and still reports what has been achieved
+    Replayer = &replayer;
+    std::signal(SIGINT, StopReplay);
+
+    std::cout << "Start sending" << std::endl;
+    // output the column header for the displayed values
+    std::cout << "----------------------------------------------------------------------------" << std::endl
+              << std::right << std::setw(OUTPUT_WIDTH) << "# packets"
+              << std::right << std::setw(OUTPUT_WIDTH) << "duration (s)"
+              << std::right << std::setw(OUTPUT_WIDTH) << "f (Hz)"
+              << std::right << std::setw(OUTPUT_WIDTH) << "Mbit/s"
+              << std::right << std::setw(OUTPUT_WIDTH) << "max delay (us)"
+              << std::endl
+              << "----------------------------------------------------------------------------" << std::endl;
+
+    ReplayStatistics stats = replayer.Run();
+    Replayer = nullptr;
+
+    std::cout << "----------------------------------------------------------------------------" << std::endl;
+    DisplayStatistics(stats);
+    std::cout << "Achieved rate: " << std::setprecision(0) << stats.GetPacketRate() << " packets/s, "
+              << std::setprecision(2) << stats.GetByteRate() * 8e-6 << " Mbit/s over "
+              << std::setprecision(3) << stats.ElapsedTime << " s";
+    if (stats.NumberOfSendErrors > 0)
     {
-      auto replayStartTime = std::chrono::steady_clock::now();
-
-      // output the column header for the displayed values
-      std::cout << "----------------------------------------------------------------------------" << std::endl
-                << std::right << std::setw(OUTPUT_WIDTH) << "# packets"
-                << std::right << std::setw(OUTPUT_WIDTH) << "duration (s)"
-                << std::right << std::setw(OUTPUT_WIDTH) << "f (Hz)"
-                << std::right << std::setw(OUTPUT_WIDTH) << "delay (us)"
-                << std::endl
-                << "----------------------------------------------------------------------------" << std::endl;
-
-      // Create a Packet Sender
-      vvPacketSender sender(filename, destinationIp, lidarPort, GPSPort);
-
-      // Case starting time
-      double pcapStartTime = sender.pumpPacket();
-
-      while (!sender.IsDone())
-      {
-        // time from the pcap file
-        double pcapCurrentTime = sender.pumpPacket();
-        double pcapmicroSecondsSinceStart = (pcapCurrentTime - pcapStartTime) * microSecondsPerSecond;
-
-        // time from the wall clock
-        auto replayCurrentTime = std::chrono::steady_clock::now();
-        int replaymicroSecondsSinceStart =
-            std::chrono::duration_cast<std::chrono::microseconds>(replayCurrentTime - replayStartTime).count();
-
-        // check if the replay is to much in advance compared to the pcap time step
-        // if this is the case, we sleep the thread until the pcap catch up the replay
-        double time_delay = static_cast<double>(pcapmicroSecondsSinceStart) / speed  - replaymicroSecondsSinceStart;
-
-        if (time_delay > 0)
-        {
-        boost::this_thread::sleep(
-          boost::posix_time::microseconds(static_cast<int>(time_delay)));
-        }
-
-        // Display the user some information
-        if ((sender.GetPacketCount() % display_frequency) == 0)
-        {
-          // Compute nb of packets sended including the one from previous loops
-          int nbPacketSended = sender.GetPacketCount();
-
-          // Compute time since the replay began
-          double secondSinceStart = static_cast<double>(replaymicroSecondsSinceStart) / microSecondsPerSecond;
-
-          // Nice output
-          std::cout << std::fixed
-                    << std::right << std::setw(OUTPUT_WIDTH) << nbPacketSended
-                    << std::fixed << std::right << std::setw(OUTPUT_WIDTH) << secondSinceStart
-                    << std::right << std::setw(OUTPUT_WIDTH)
-                    << static_cast<double>(nbPacketSended) /  secondSinceStart
-                    << std::right << std::setw(OUTPUT_WIDTH) << time_delay
-                    << std::endl;
-        }
-      }
-    } while (loop);
+      std::cout << ", " << stats.NumberOfSendErrors << " packets failed to be sent";
+    }
+    std::cout << std::endl;
   }
   catch (std::exception& e)
   {
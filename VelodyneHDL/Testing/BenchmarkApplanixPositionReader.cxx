@@ -0,0 +1,156 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vtkApplanixPositionReader.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+const char* fieldNames[] = { "TIME", "DISTANCE", "EASTING", "NORTHING", "ELLIPSOID HEIGHT",
+  "LATITUDE", "LONGITUDE", "ROLL", "PITCH", "HEADING" };
+const char* arrayNames[] = { "time", "distance", "easting", "northing", "height", "lat", "lon",
+  "roll", "pitch", "heading" };
+const int nbFields = sizeof(fieldNames) / sizeof(fieldNames[0]);
+
+//-----------------------------------------------------------------------------
+//! Write the fields of a row, as an SBET export would, in buffer
+int formatRow(long row, char* buffer, size_t size)
+{
+  const double t = 400000.0 + row * 0.005;
+  return std::snprintf(buffer, size,
+    "  %.3f %.3f %.3f %.3f %.3f %.9f %.9f %.6f %.6f %.6f -0.012 0.034 0.000\n", t,
+    row * 0.05, 500000.0 + row * 0.04, 5000000.0 + row * 0.03, 50.0 + (row % 1000) * 0.001,
+    45.0 + row * 1e-7, -73.0 - row * 1e-7, (row % 360) * 0.01, -(row % 180) * 0.01,
+    (row % 3600) * 0.1);
+}
+
+//-----------------------------------------------------------------------------
+bool generateFile(const std::string& filename, long nbRows)
+{
+  FILE* file = std::fopen(filename.c_str(), "w");
+  if (!file)
+  {
+    return false;
+  }
+  std::fprintf(file, " PROJECT         benchmark\n");
+  std::fprintf(file, " central meridian = -75 deg\n\n");
+  for (int i = 0; i < nbFields; ++i)
+  {
+    std::fprintf(file, "%s%s", i ? ", " : "  ", fieldNames[i]);
+  }
+  std::fprintf(file, ", EAST VELOCITY, NORTH VELOCITY, UP VELOCITY\n");
+  std::fprintf(file, "  (sec), (m), (m), (m), (m), (deg), (deg), (deg), (deg), (deg), (m/s), "
+                     "(m/s), (m/s)\n\n");
+
+  char buffer[512];
+  for (long row = 0; row < nbRows; ++row)
+  {
+    std::fwrite(buffer, 1, formatRow(row, buffer, sizeof(buffer)), file);
+  }
+  std::fclose(file);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Check that every parsed value is exactly the one strtod gives for the written text
+bool checkOutput(vtkPolyData* output, long nbRows)
+{
+  vtkDataArray* arrays[nbFields];
+  for (int i = 0; i < nbFields; ++i)
+  {
+    arrays[i] = output->GetPointData()->GetArray(arrayNames[i]);
+    if (!arrays[i] || arrays[i]->GetNumberOfTuples() != nbRows)
+    {
+      std::cerr << "Array " << arrayNames[i] << " is missing or has a wrong size" << std::endl;
+      return false;
+    }
+  }
+
+  char buffer[512];
+  for (long row = 0; row < nbRows; ++row)
+  {
+    formatRow(row, buffer, sizeof(buffer));
+    char* it = buffer;
+    for (int i = 0; i < nbFields; ++i)
+    {
+      const double expected = std::strtod(it, &it);
+      if (arrays[i]->GetTuple1(row) != expected)
+      {
+        std::cerr << "Row " << row << ", field " << fieldNames[i] << ": read "
+                  << arrays[i]->GetTuple1(row) << " instead of " << expected << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+double read(const std::string& filename, int nbThreads, long nbRows, bool& isValid)
+{
+  auto reader = vtkSmartPointer<vtkApplanixPositionReader>::New();
+  reader->SetFileName(filename.c_str());
+  reader->SetNumberOfThreads(nbThreads);
+
+  const double start = vtkTimerLog::GetUniversalTime();
+  reader->Update();
+  const double elapsed = vtkTimerLog::GetUniversalTime() - start;
+
+  isValid = checkOutput(reader->GetOutput(), nbRows);
+  return elapsed;
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <path to a writable file that will be destroyed>"
+              << " [number of lines, default 2000000]" << std::endl;
+    return 1;
+  }
+
+  const std::string filename = argv[1];
+  const long nbRows = argc > 2 ? std::atol(argv[2]) : 2000000;
+
+  if (!generateFile(filename, nbRows))
+  {
+    std::cerr << "Could not write " << filename << std::endl;
+    return 1;
+  }
+
+  bool allgood = true;
+  for (int nbThreads : { 1, 0 })
+  {
+    bool isValid = false;
+    const double elapsed = read(filename, nbThreads, nbRows, isValid);
+    std::cout << nbRows << " lines read with "
+              << (nbThreads ? std::to_string(nbThreads) : std::string("all")) << " thread(s) in "
+              << elapsed << " s (" << nbRows / elapsed << " lines/s)" << std::endl;
+    allgood &= isValid;
+  }
+
+  std::remove(filename.c_str());
+  return allgood ? 0 : 1;
+}
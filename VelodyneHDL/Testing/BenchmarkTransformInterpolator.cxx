@@ -0,0 +1,191 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vtkVelodyneTransformInterpolator.h>
+#include <vtkMath.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+const double frequency = 200.0;   // Hz, rate of an INS trajectory
+const double speed = 10.0;        // m/s, along X
+const double yawRate = 0.1;       // rad/s, around Z
+
+//-----------------------------------------------------------------------------
+//! Synthetic trajectory: constant speed and yaw rate, which the linear
+//! interpolation gives exactly between two samples
+void pose(double t, double quaternion[4], double position[3])
+{
+  quaternion[0] = std::cos(0.5 * yawRate * t);
+  quaternion[1] = 0.0;
+  quaternion[2] = 0.0;
+  quaternion[3] = std::sin(0.5 * yawRate * t);
+  position[0] = speed * t;
+  position[1] = 1.0;
+  position[2] = 2.0;
+}
+
+//-----------------------------------------------------------------------------
+void generate(int nbPoses, std::vector<double>& times, std::vector<double>& quaternions,
+              std::vector<double>& positions)
+{
+  times.resize(nbPoses);
+  quaternions.resize(4 * nbPoses);
+  positions.resize(3 * nbPoses);
+  for (int i = 0; i < nbPoses; ++i)
+  {
+    times[i] = i / frequency;
+    pose(times[i], &quaternions[4 * i], &positions[3 * i]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+//! Check the interpolated transforms at times between the samples
+bool check(vtkVelodyneTransformInterpolator* interpolator, double duration, int nbChecks)
+{
+  auto transform = vtkSmartPointer<vtkTransform>::New();
+  for (int i = 0; i < nbChecks; ++i)
+  {
+    const double t = duration * (i + 0.37) / nbChecks;
+    interpolator->InterpolateTransform(t, transform);
+
+    double quaternion[4], position[3];
+    pose(t, quaternion, position);
+    double interpolatedPosition[3], orientation[3];
+    transform->GetPosition(interpolatedPosition);
+    transform->GetOrientation(orientation);
+    double yaw = vtkMath::DegreesFromRadians(yawRate * t);
+    yaw = std::fmod(yaw + 180.0, 360.0) - 180.0;
+    double yawError = std::abs(orientation[2] - yaw);
+    yawError = std::min(yawError, 360.0 - yawError);
+    if (std::sqrt(vtkMath::Distance2BetweenPoints(position, interpolatedPosition)) > 1e-6 ||
+        yawError > 1e-6)
+    {
+      std::cerr << "Wrong transform interpolated at " << t << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//! Check the poses interpolated at once by the Eigen API
+bool checkBatch(vtkVelodyneTransformInterpolator* interpolator, double duration, int nbChecks)
+{
+  std::vector<double> times(nbChecks);
+  for (int i = 0; i < nbChecks; ++i)
+  {
+    times[i] = duration * (i + 0.37) / nbChecks;
+  }
+  vtkVelodyneTransformInterpolator::QuaternionVector orientations;
+  std::vector<Eigen::Vector3d> positions;
+  interpolator->InterpolateTransforms(times, orientations, positions);
+
+  for (int i = 0; i < nbChecks; ++i)
+  {
+    double quaternion[4], position[3];
+    pose(times[i], quaternion, position);
+    const Eigen::Quaterniond expected(quaternion[0], quaternion[1], quaternion[2], quaternion[3]);
+    if ((positions[i] - Eigen::Map<Eigen::Vector3d>(position)).norm() > 1e-6 ||
+        orientations[i].angularDistance(expected) > 1e-6)
+    {
+      std::cerr << "Wrong pose interpolated at " << times[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const double duration = argc > 1 ? std::atof(argv[1]) : 3600.0;
+  const int nbPoses = static_cast<int>(duration * frequency);
+  const int nbChecks = 100000;
+
+  std::vector<double> times, quaternions, positions;
+  generate(nbPoses, times, quaternions, positions);
+  std::cout << "Synthetic trajectory of " << duration << " s, " << nbPoses << " poses" << std::endl;
+
+  bool allgood = true;
+
+  // add all the poses at once
+  {
+    auto interpolator = vtkSmartPointer<vtkVelodyneTransformInterpolator>::New();
+    interpolator->SetInterpolationTypeToLinear();
+    const double start = vtkTimerLog::GetUniversalTime();
+    interpolator->AddTransforms(nbPoses, times.data(), quaternions.data(), positions.data());
+    const double added = vtkTimerLog::GetUniversalTime();
+    allgood &= check(interpolator, duration, nbChecks);
+    const double end = vtkTimerLog::GetUniversalTime();
+    std::cout << "AddTransforms: " << added - start << " s, then " << nbChecks
+              << " interpolations (with initialization): " << end - added << " s" << std::endl;
+    allgood &= interpolator->GetNumberOfTransforms() == nbPoses;
+
+    const double batchStart = vtkTimerLog::GetUniversalTime();
+    allgood &= checkBatch(interpolator, duration, nbChecks);
+    const double batchEnd = vtkTimerLog::GetUniversalTime();
+    std::cout << "InterpolateTransforms: " << nbChecks << " interpolations: "
+              << batchEnd - batchStart << " s" << std::endl;
+  }
+
+  // add the poses one by one, as a reader does
+  {
+    auto interpolator = vtkSmartPointer<vtkVelodyneTransformInterpolator>::New();
+    interpolator->SetInterpolationTypeToLinear();
+    auto transform = vtkSmartPointer<vtkTransform>::New();
+    const double start = vtkTimerLog::GetUniversalTime();
+    for (int i = 0; i < nbPoses; ++i)
+    {
+      const double* q = &quaternions[4 * i];
+      transform->Identity();
+      transform->Translate(&positions[3 * i]);
+      transform->RotateWXYZ(vtkMath::DegreesFromRadians(2.0 * std::acos(q[0])), q[1], q[2], q[3]);
+      interpolator->AddTransform(times[i], transform);
+    }
+    const double end = vtkTimerLog::GetUniversalTime();
+    std::cout << "AddTransform: " << end - start << " s" << std::endl;
+    allgood &= check(interpolator, duration, nbChecks);
+  }
+
+  // live stream: one second of poses is appended, then interpolated
+  {
+    auto interpolator = vtkSmartPointer<vtkVelodyneTransformInterpolator>::New();
+    interpolator->SetInterpolationTypeToLinear();
+    auto transform = vtkSmartPointer<vtkTransform>::New();
+    const int chunk = static_cast<int>(frequency);
+    const double start = vtkTimerLog::GetUniversalTime();
+    for (int first = 0; first < nbPoses; first += chunk)
+    {
+      const int n = std::min(chunk, nbPoses - first);
+      interpolator->AddTransforms(n, &times[first], &quaternions[4 * first], &positions[3 * first]);
+      interpolator->InterpolateTransform(times[first], transform);
+    }
+    const double end = vtkTimerLog::GetUniversalTime();
+    std::cout << "Live appends of " << chunk << " poses with an interpolation after each: "
+              << end - start << " s" << std::endl;
+    allgood &= check(interpolator, duration, nbChecks);
+  }
+
+  return allgood ? 0 : 1;
+}
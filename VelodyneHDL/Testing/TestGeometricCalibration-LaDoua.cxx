@@ -36,7 +36,9 @@ int main(int argc, char* argv[])
 
   a = a->ApplyScale(1.0 / 0.0120337);
 
-  std::pair<double, AnglePositionVector> calib = EstimateCalibrationFromPoses(r, a);
+  int nbConstraints = 0;
+  std::pair<double, AnglePositionVector> calib = EstimateCalibrationFromPoses(r, a, false, &nbConstraints);
+  const Eigen::Vector3d T1 = calib.second.segment(3, 3);
   Eigen::Matrix3d R1 = RollPitchYawToMatrix(calib.second(0), calib.second(1), calib.second(2));
   Eigen::Matrix3d difference1 = R1 * R_gt.transpose();
   auto aa1 = Eigen::AngleAxisd(difference1);
@@ -49,6 +51,20 @@ int main(int argc, char* argv[])
             << ", " << std::abs(calib.second(4))
             << ", " << std::abs(calib.second(5)) << std::endl;
 
+  // only keep the informative constraints: there must be fewer of them, and the
+  // estimated calibration must stay close to the one using all the constraints
+  // (there is no ground truth for the translation)
+  int nbInformativeConstraints = 0;
+  calib = EstimateCalibrationFromPoses(r, a, true, &nbInformativeConstraints);
+  Eigen::Matrix3d R1Informative = RollPitchYawToMatrix(calib.second(0), calib.second(1), calib.second(2));
+  double angularError1Informative = (180.0 / vtkMath::Pi()) * Eigen::AngleAxisd(R1Informative * R_gt.transpose()).angle();
+  errors += angularError1Informative < angular_error_tol ? 0 : 1;
+  const double translationError1Informative = (calib.second.segment(3, 3) - T1).norm();
+  errors += translationError1Informative < 0.05 + 0.1 * T1.norm() ? 0 : 1;
+  errors += nbInformativeConstraints < nbConstraints ? 0 : 1;
+  std::cout << "informative constraints: " << nbInformativeConstraints << " / " << nbConstraints
+            << ", translation difference: " << translationError1Informative << std::endl;
+
 
   // Second dataset
 
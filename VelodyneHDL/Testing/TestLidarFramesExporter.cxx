@@ -0,0 +1,117 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarFramesExporter.h"
+#include "vtkLidarReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+#include <vtkInformation.h>
+#include <vtkNew.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+//! Number of files written in directory by an export
+unsigned long CountExportedFiles(const std::string& directory)
+{
+  vtksys::Directory dir;
+  if (!dir.Load(directory))
+  {
+    return 0;
+  }
+  unsigned long count = 0;
+  for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+  {
+    const std::string name = dir.GetFile(i);
+    count += name.find(" (Frame ") != std::string::npos ? 1 : 0;
+  }
+  return count;
+}
+
+//! Export the frames of the reader matching the first and last timesteps, as the application does
+int ExportTimesteps(vtkLidarReader* reader, const std::vector<double>& timesteps,
+                    const std::string& directory)
+{
+  vtksys::SystemTools::RemoveADirectory(directory);
+  vtkNew<vtkLidarFramesExporter> exporter;
+  exporter->SetReader(reader);
+  exporter->SetFileName(directory.c_str());
+  exporter->SetWriteToZip(false);
+  exporter->SetFirstFrame(reader->GetFrameIndexForTime(timesteps.front()));
+  exporter->SetLastFrame(reader->GetFrameIndexForTime(timesteps.back()));
+  if (!exporter->Write())
+  {
+    std::cerr << "Export of " << timesteps.size() << " timesteps failed" << std::endl;
+    return 1;
+  }
+  const unsigned long count = CountExportedFiles(directory);
+  if (count != timesteps.size())
+  {
+    std::cerr << "Exported " << count << " frames instead of " << timesteps.size() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: TestLidarFramesExporter <pcapFileName> <correctionFileName> <outputDirectory>"
+              << std::endl;
+    return 1;
+  }
+
+  int errors = 0;
+  const std::string outputDirectory = argv[3];
+
+  for (bool showFirstAndLastFrame : { false, true })
+  {
+    vtkNew<vtkLidarReader> reader;
+    auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+    reader->SetInterpreter(interpreter);
+    reader->SetFileName(argv[1]);
+    reader->SetCalibrationFileName(argv[2]);
+    reader->SetShowFirstAndLastFrame(showFirstAndLastFrame);
+    reader->UpdateInformation();
+
+    // the timesteps shown to the user, which are seconds, not frame indices
+    vtkInformation* info = reader->GetOutputInformation(0);
+    const int nbTimesteps = info->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    const double* values = info->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+    if (nbTimesteps < 3)
+    {
+      std::cerr << "Not enough frames in " << argv[1] << std::endl;
+      return 1;
+    }
+    const std::vector<double> timesteps(values, values + nbTimesteps);
+
+    // all the frames
+    errors += ExportTimesteps(reader.GetPointer(), timesteps, outputDirectory);
+
+    // a range of frames, which does not start at the first one
+    const std::vector<double> range(timesteps.begin() + 1, timesteps.end() - 1);
+    errors += ExportTimesteps(reader.GetPointer(), range, outputDirectory);
+  }
+
+  vtksys::SystemTools::RemoveADirectory(outputDirectory);
+  return errors;
+}
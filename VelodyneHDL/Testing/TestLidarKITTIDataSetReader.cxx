@@ -0,0 +1,116 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarKITTIDataSetReader.h"
+
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#define CHECK_POINTS(reader, frame, expected)                                               \
+  {                                                                                         \
+    const vtkIdType actual = reader->GetFrame(frame)->GetNumberOfPoints();                  \
+    if (actual != expected)                                                                 \
+    {                                                                                       \
+      std::cerr << "line " << __LINE__ << ": frame " << frame << " has " << actual          \
+                << " points instead of " << expected << std::endl;                          \
+      errors++;                                                                             \
+    }                                                                                       \
+  }
+
+namespace
+{
+//! Write a KITTI .bin file of numberOfPoints points, all in front of the sensor
+void WriteFrame(const std::string& folder, int frameNumber, int numberOfPoints)
+{
+  std::stringstream ss;
+  ss << folder << "/" << std::setw(10) << std::setfill('0') << frameNumber << ".bin";
+  std::ofstream os(ss.str(), std::ios::binary | std::ios::out | std::ios::trunc);
+  const float point[4] = { 1.f, 1.f, 0.f, 0.5f };
+  for (int i = 0; i < numberOfPoints; ++i)
+  {
+    os.write(reinterpret_cast<const char*>(point), sizeof(point));
+  }
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: TestLidarKITTIDataSetReader <temporaryFolder>" << std::endl;
+    return 1;
+  }
+
+  const std::string folder = argv[1];
+  vtksys::SystemTools::RemoveADirectory(folder);
+  vtksys::SystemTools::MakeDirectory(folder);
+  for (int frame = 0; frame < 3; ++frame)
+  {
+    WriteFrame(folder, frame, 10 + frame);
+  }
+
+  int errors = 0;
+  vtkNew<vtkLidarKITTIDataSetReader> reader;
+  reader->SetFileName(folder);
+  reader->SetFrameCacheSize(2);
+
+  // a cached frame is not read again, so rewriting its file does not change it
+  CHECK_POINTS(reader, 0, 10);
+  WriteFrame(folder, 0, 20);
+  CHECK_POINTS(reader, 0, 10);
+
+  // the least recently used frame is evicted and read again
+  CHECK_POINTS(reader, 1, 11);
+  CHECK_POINTS(reader, 2, 12);
+  CHECK_POINTS(reader, 0, 20);
+
+  // reducing the size of the cache evicts the least recently used frames
+  const vtkMTimeType mtime = reader->GetMTime();
+  reader->SetFrameCacheSize(1);
+  if (reader->GetMTime() <= mtime)
+  {
+    std::cerr << "Changing the size of the cache does not modify the reader" << std::endl;
+    errors++;
+  }
+  WriteFrame(folder, 0, 30);
+  WriteFrame(folder, 2, 32);
+  CHECK_POINTS(reader, 0, 20);
+  CHECK_POINTS(reader, 2, 32);
+
+  // a frame which cannot be read is not cached
+  CHECK_POINTS(reader, 3, 0);
+  WriteFrame(folder, 3, 13);
+  CHECK_POINTS(reader, 3, 13);
+
+  // modifying a returned frame does not modify the cached one
+  vtkSmartPointer<vtkPolyData> frame = reader->GetFrame(3);
+  frame->GetPointData()->GetArray("X")->SetTuple1(0, 42.);
+  if (reader->GetFrame(3)->GetPointData()->GetArray("X")->GetTuple1(0) != 1.)
+  {
+    std::cerr << "Modifying a frame modified the cached one" << std::endl;
+    errors++;
+  }
+
+  vtksys::SystemTools::RemoveADirectory(folder);
+  return errors;
+}
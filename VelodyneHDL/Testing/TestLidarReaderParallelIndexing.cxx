@@ -0,0 +1,156 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+#include <vtkInformation.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <pcap.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+//! Copy a pcap, inserting after each packet a few non UDP records (ARP requests),
+//! which are skipped by the "udp" filter of the reader
+bool WritePcapWithNonUdpRecords(const std::string& input, const std::string& output)
+{
+  char errorBuffer[PCAP_ERRBUF_SIZE];
+  pcap_t* in = pcap_open_offline(input.c_str(), errorBuffer);
+  if (!in)
+  {
+    std::cerr << "Cannot open " << input << ": " << errorBuffer << std::endl;
+    return false;
+  }
+  pcap_dumper_t* out = pcap_dump_open(in, output.c_str());
+  if (!out)
+  {
+    std::cerr << "Cannot write " << output << ": " << pcap_geterr(in) << std::endl;
+    pcap_close(in);
+    return false;
+  }
+
+  // ethernet broadcast frame of type ARP, padded to the minimal frame size
+  unsigned char arp[60];
+  std::memset(arp, 0, sizeof(arp));
+  std::memset(arp, 0xff, 6);
+  arp[12] = 0x08;
+  arp[13] = 0x06;
+
+  struct pcap_pkthdr* header = nullptr;
+  const unsigned char* data = nullptr;
+  unsigned int packetIndex = 0;
+  while (pcap_next_ex(in, &header, &data) >= 0)
+  {
+    pcap_dump(reinterpret_cast<unsigned char*>(out), header, data);
+
+    struct pcap_pkthdr arpHeader = *header;
+    arpHeader.caplen = sizeof(arp);
+    arpHeader.len = sizeof(arp);
+    for (unsigned int i = 0; i < packetIndex % 4; ++i)
+    {
+      pcap_dump(reinterpret_cast<unsigned char*>(out), &arpHeader, arp);
+    }
+    packetIndex++;
+  }
+  pcap_dump_close(out);
+  pcap_close(in);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+std::vector<double> GetTimesteps(vtkLidarReader* reader)
+{
+  vtkInformation* info = reader->GetOutputInformation(0);
+  const int nbTimesteps = info->Length(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+  const double* values = info->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+  return std::vector<double>(values, values + nbTimesteps);
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: TestLidarReaderParallelIndexing <pcapFileName> <correctionFileName> "
+                 "<temporaryPcapFileName>" << std::endl;
+    return 1;
+  }
+
+  const std::string pcapFileName = argv[3];
+  if (!WritePcapWithNonUdpRecords(argv[1], pcapFileName))
+  {
+    return 1;
+  }
+
+  // the same pcap indexed sequentially, then in parallel with small chunks so that
+  // many chunks boundaries fall on or next to the non UDP records
+  auto readIndex = [&](int numberOfThreads, vtkLidarReader* reader) {
+    auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+    reader->SetInterpreter(interpreter);
+    reader->SetFileName(pcapFileName);
+    reader->SetCalibrationFileName(argv[2]);
+    reader->SetShowFirstAndLastFrame(true);
+    reader->SetNumberOfIndexingThreads(numberOfThreads);
+    reader->SetMinimalIndexingChunkSize(64 * 1024);
+    reader->UpdateInformation();
+    return GetTimesteps(reader);
+  };
+
+  vtkNew<vtkLidarReader> sequentialReader;
+  const std::vector<double> sequential = readIndex(1, sequentialReader.GetPointer());
+
+  int errors = 0;
+  for (int numberOfThreads : { 2, 3, 8 })
+  {
+    vtkNew<vtkLidarReader> parallelReader;
+    const std::vector<double> parallel = readIndex(numberOfThreads, parallelReader.GetPointer());
+    if (sequential.size() < 3 || parallel != sequential)
+    {
+      std::cerr << "With " << numberOfThreads << " threads, " << parallel.size()
+                << " frames are indexed instead of " << sequential.size()
+                << " or their times differ" << std::endl;
+      errors++;
+      continue;
+    }
+
+    // the file positions may differ by the filtered records preceding a packet,
+    // but they must give the same frames
+    for (int frame = 0; frame < static_cast<int>(sequential.size()); ++frame)
+    {
+      vtkSmartPointer<vtkPolyData> expected = sequentialReader->GetFrame(frame);
+      vtkSmartPointer<vtkPolyData> actual = parallelReader->GetFrame(frame);
+      if (expected->GetNumberOfPoints() != actual->GetNumberOfPoints())
+      {
+        std::cerr << "With " << numberOfThreads << " threads, frame " << frame << " has "
+                  << actual->GetNumberOfPoints() << " points instead of "
+                  << expected->GetNumberOfPoints() << std::endl;
+        errors++;
+        break;
+      }
+    }
+  }
+
+  vtksys::SystemTools::RemoveFile(pcapFileName);
+  return errors;
+}
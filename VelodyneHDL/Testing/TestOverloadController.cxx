@@ -0,0 +1,157 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "OverloadController.h"
+
+#include <iostream>
+
+#define CHECK(condition)                                                          \
+  if (!(condition))                                                               \
+  {                                                                               \
+    std::cerr << "line " << __LINE__ << ": " #condition " failed" << std::endl;   \
+    errors++;                                                                     \
+  }
+
+namespace
+{
+//! Simulate a frame at 10 Hz, whose decoding takes load times its period
+double SimulateFrame(OverloadController& controller, double time, double load,
+                     unsigned int queueDepth, unsigned int droppedFrames = 0)
+{
+  const double period = 0.1;
+  controller.AddProcessingTime(load * period);
+  time += period;
+  controller.EndFrame(time, queueDepth, droppedFrames);
+  return time;
+}
+}
+
+int main(int, char*[])
+{
+  int errors = 0;
+
+  // the work is not shed by default
+  {
+    OverloadController controller;
+    CHECK(controller.GetPolicy() == OverloadController::Disabled);
+  }
+
+  // a growing queue increases the level up to its maximum, the progressive
+  // policy successively decimating the firings, the lasers and the frames
+  {
+    OverloadController controller;
+    controller.SetPolicy(OverloadController::Progressive);
+    controller.SetRecoveryFrames(3);
+    double time = 0.;
+    time = SimulateFrame(controller, time, 0.2, 10);
+    CHECK(controller.GetLevel() == 0);
+    CHECK(controller.GetFiringDecimation() == 1 && controller.GetLaserStride() == 1 &&
+          controller.GetFrameDecimation() == 1);
+
+    time = SimulateFrame(controller, time, 0.2, 600);
+    CHECK(controller.GetLevel() == 1 && controller.GetFiringDecimation() == 2 &&
+          controller.GetLaserStride() == 1);
+    time = SimulateFrame(controller, time, 0.2, 700);
+    CHECK(controller.GetLevel() == 2 && controller.GetLaserStride() == 2 &&
+          controller.GetFrameDecimation() == 1);
+    time = SimulateFrame(controller, time, 0.2, 800);
+    CHECK(controller.GetLevel() == 3 && controller.GetFrameDecimation() == 2);
+    time = SimulateFrame(controller, time, 0.2, 900);
+    CHECK(controller.GetLevel() == OverloadController::MaxLevel);
+    CHECK(controller.GetNumberOfEscalations() == 3);
+
+    // a queue above the high depth which is draining does not escalate, nor recover
+    time = SimulateFrame(controller, time, 0.2, 600, 1);
+    CHECK(controller.GetLevel() == 3);
+
+    // recovery requires several consecutive calm frames, any busy frame restarts the count
+    time = SimulateFrame(controller, time, 0.2, 10);
+    time = SimulateFrame(controller, time, 0.2, 10);
+    time = SimulateFrame(controller, time, 0.7, 10);
+    time = SimulateFrame(controller, time, 0.2, 10);
+    time = SimulateFrame(controller, time, 0.2, 10);
+    CHECK(controller.GetLevel() == 3);
+    time = SimulateFrame(controller, time, 0.2, 10);
+    CHECK(controller.GetLevel() == 2);
+    for (int i = 0; i < 6; ++i)
+    {
+      time = SimulateFrame(controller, time, 0.2, 10);
+    }
+    CHECK(controller.GetLevel() == 0);
+    CHECK(controller.GetNumberOfEscalations() == 3);
+
+    // all the frames completed above level 0 are degraded, and dropped frames are accumulated
+    CHECK(controller.GetNumberOfDegradedFrames() == 16);
+    CHECK(controller.GetNumberOfDroppedFrames() == 1);
+
+    controller.Reset();
+    CHECK(controller.GetLevel() == 0 && controller.GetNumberOfDegradedFrames() == 0 &&
+          controller.GetNumberOfDroppedFrames() == 0 && controller.GetNumberOfEscalations() == 0);
+  }
+
+  // draining a backlog keeps the decoding fully busy, but must not shed any work
+  {
+    OverloadController controller;
+    controller.SetPolicy(OverloadController::Progressive);
+    double time = 0.;
+    for (unsigned int depth = 5000; depth >= 1000; depth -= 500)
+    {
+      time = SimulateFrame(controller, time, 1., depth);
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+      time = SimulateFrame(controller, time, 1., 10);
+    }
+    CHECK(controller.GetLevel() == 0 && controller.GetNumberOfEscalations() == 0);
+  }
+
+  // each policy has its own decimations
+  {
+    OverloadController controller;
+    controller.SetPolicy(OverloadController::FiringDecimation);
+    double time = 0.;
+    time = SimulateFrame(controller, time, 0.2, 10);
+    time = SimulateFrame(controller, time, 0.2, 600);
+    CHECK(controller.GetLevel() == 1 && controller.GetFiringDecimation() == 2);
+    time = SimulateFrame(controller, time, 0.2, 700);
+    CHECK(controller.GetLevel() == 2 && controller.GetFiringDecimation() == 4);
+    CHECK(controller.GetLaserStride() == 1 && controller.GetFrameDecimation() == 1);
+
+    controller.SetPolicy(OverloadController::LaserSubsetting);
+    CHECK(controller.GetLevel() == 0);
+    time = SimulateFrame(controller, time, 0.2, 800);
+    CHECK(controller.GetLaserStride() == 2 && controller.GetFiringDecimation() == 1);
+
+    controller.SetPolicy(OverloadController::FrameDropping);
+    time = SimulateFrame(controller, time, 0.2, 900);
+    time = SimulateFrame(controller, time, 0.2, 1000);
+    CHECK(controller.GetFrameDecimation() == 3 && controller.GetLaserStride() == 1);
+  }
+
+  // a disabled controller never sheds any work
+  {
+    OverloadController controller;
+    controller.SetPolicy(OverloadController::Disabled);
+    double time = 0.;
+    for (int i = 0; i < 10; ++i)
+    {
+      time = SimulateFrame(controller, time, 2., 10000);
+    }
+    CHECK(controller.GetLevel() == 0 && controller.GetNumberOfEscalations() == 0);
+    CHECK(controller.GetFiringDecimation() == 1 && controller.GetLaserStride() == 1 &&
+          controller.GetFrameDecimation() == 1);
+  }
+
+  return errors;
+}
@@ -0,0 +1,239 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkPCLRansacModel.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkIntArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkTable.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Number of errors in the models table, which must have nbModels rows of
+// nbCoefficients coefficients
+int CheckModelsTable(vtkTable* models, vtkIdType nbModels, int nbCoefficients, const char* name)
+{
+  vtkDoubleArray* coefficients = models ? vtkDoubleArray::SafeDownCast(models->GetColumnByName("coefficients")) : nullptr;
+  if (!coefficients || models->GetNumberOfRows() != nbModels)
+  {
+    std::cerr << name << ": expected " << nbModels << " rows with coefficients, got "
+              << (models ? models->GetNumberOfRows() : 0) << std::endl;
+    return 1;
+  }
+  if (coefficients->GetNumberOfComponents() != nbCoefficients)
+  {
+    std::cerr << name << ": expected " << nbCoefficients << " coefficients per model, got "
+              << coefficients->GetNumberOfComponents() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Two square grids of 21x21 points, on the plane z = 0 and on the plane
+// x = 20 above it, and a few points far from both
+vtkSmartPointer<vtkPolyData> CreateTwoPlanes()
+{
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i <= 20; ++i)
+  {
+    for (int j = 0; j <= 20; ++j)
+    {
+      points->InsertNextPoint(0.5 * i, 0.5 * j, 0.);
+    }
+  }
+  for (int i = 0; i <= 20; ++i)
+  {
+    for (int j = 0; j <= 20; ++j)
+    {
+      points->InsertNextPoint(20., 0.5 * i, 1. + 0.5 * j);
+    }
+  }
+  points->InsertNextPoint(30., 40., 7.);
+  points->InsertNextPoint(-15., 3., 12.);
+  points->InsertNextPoint(5., -20., 9.);
+  points->InsertNextPoint(40., -8., -6.);
+  points->InsertNextPoint(-9., 25., -14.);
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points.GetPointer());
+  return polyData;
+}
+
+//-----------------------------------------------------------------------------
+// Points on a cylinder of radius 2 around the z axis
+vtkSmartPointer<vtkPolyData> CreateCylinder()
+{
+  vtkNew<vtkPoints> points;
+  for (int i = 0; i < 36; ++i)
+  {
+    const double angle = vtkMath::RadiansFromDegrees(10. * i);
+    for (int j = 0; j <= 10; ++j)
+    {
+      points->InsertNextPoint(2. * std::cos(angle), 2. * std::sin(angle), 0.5 * j);
+    }
+  }
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points.GetPointer());
+  return polyData;
+}
+
+//-----------------------------------------------------------------------------
+int TestTwoPlanes()
+{
+  const vtkIdType nbPlanePoints = 21 * 21;
+  vtkSmartPointer<vtkPolyData> input = CreateTwoPlanes();
+
+  vtkNew<vtkPCLRansacModel> filter;
+  filter->SetInputData(input);
+  filter->SetModelType(vtkPCLRansacModel::Plane);
+  filter->SetDistanceThreshold(0.05);
+  filter->SetNumberOfModels(3);
+  filter->SetMinimumNumberOfInliers(50);
+  filter->SetNumberOfThreads(2);
+  filter->Update();
+
+  // a plane model has 4 coefficients, a line model would have 6
+  vtkTable* models = vtkTable::SafeDownCast(filter->GetOutputDataObject(1));
+  if (CheckModelsTable(models, 2, 4, "Two planes"))
+  {
+    return 1;
+  }
+
+  int errors = 0;
+  vtkIntArray* labels = vtkIntArray::SafeDownCast(filter->GetOutput()->GetPointData()->GetArray("ransac_label"));
+  if (!labels || labels->GetNumberOfTuples() != input->GetNumberOfPoints())
+  {
+    std::cerr << "Two planes: missing ransac_label array" << std::endl;
+    return 1;
+  }
+
+  // each grid gets a single label, and the far points none
+  const int firstLabel = labels->GetValue(0);
+  const int secondLabel = labels->GetValue(nbPlanePoints);
+  if (firstLabel < 0 || secondLabel < 0 || firstLabel == secondLabel)
+  {
+    std::cerr << "Two planes: wrong labels " << firstLabel << " and " << secondLabel << std::endl;
+    return 1;
+  }
+  for (vtkIdType i = 0; i < input->GetNumberOfPoints(); ++i)
+  {
+    const int expected = i < nbPlanePoints ? firstLabel : (i < 2 * nbPlanePoints ? secondLabel : -1);
+    if (labels->GetValue(i) != expected)
+    {
+      std::cerr << "Two planes: point " << i << " has label " << labels->GetValue(i)
+                << " instead of " << expected << std::endl;
+      errors++;
+    }
+  }
+
+  // the coefficients are a * x + b * y + c * z + d = 0, with a unit normal
+  vtkDoubleArray* coefficients = vtkDoubleArray::SafeDownCast(models->GetColumnByName("coefficients"));
+  vtkIntArray* nbInliers = vtkIntArray::SafeDownCast(models->GetColumnByName("number_of_inliers"));
+  const double expectedPlanes[2][4] = { { 0., 0., 1., 0. }, { 1., 0., 0., -20. } };
+  const int modelLabels[2] = { firstLabel, secondLabel };
+  for (int k = 0; k < 2; ++k)
+  {
+    double plane[4];
+    coefficients->GetTuple(modelLabels[k], plane);
+    const double sign = vtkMath::Dot(plane, expectedPlanes[k]) < 0 ? -1. : 1.;
+    for (int c = 0; c < 4; ++c)
+    {
+      if (std::abs(sign * plane[c] - expectedPlanes[k][c]) > 1e-3)
+      {
+        std::cerr << "Two planes: wrong coefficient " << c << " of plane " << k << ": " << plane[c] << std::endl;
+        errors++;
+      }
+    }
+    if (!nbInliers || nbInliers->GetValue(modelLabels[k]) != nbPlanePoints)
+    {
+      std::cerr << "Two planes: wrong number of inliers of plane " << k << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+
+//-----------------------------------------------------------------------------
+int TestCylinder()
+{
+  vtkSmartPointer<vtkPolyData> input = CreateCylinder();
+
+  vtkNew<vtkPCLRansacModel> filter;
+  filter->SetInputData(input);
+  filter->SetModelType(vtkPCLRansacModel::Cylinder);
+  filter->SetDistanceThreshold(0.05);
+  filter->SetNumberOfModels(1);
+  filter->SetNormalNeighbors(10);
+  filter->Update();
+
+  // point on the axis, axis direction and radius
+  vtkTable* models = vtkTable::SafeDownCast(filter->GetOutputDataObject(1));
+  if (CheckModelsTable(models, 1, 7, "Cylinder"))
+  {
+    return 1;
+  }
+
+  int errors = 0;
+  double cylinder[7];
+  vtkDoubleArray::SafeDownCast(models->GetColumnByName("coefficients"))->GetTuple(0, cylinder);
+  if (std::abs(cylinder[6] - 2.) > 0.05)
+  {
+    std::cerr << "Cylinder: wrong radius " << cylinder[6] << std::endl;
+    errors++;
+  }
+  const double axisNorm = vtkMath::Norm(cylinder + 3);
+  if (axisNorm == 0 || std::abs(cylinder[5]) / axisNorm < 0.99)
+  {
+    std::cerr << "Cylinder: the axis is not along z" << std::endl;
+    errors++;
+  }
+  if (std::hypot(cylinder[0], cylinder[1]) > 0.1)
+  {
+    std::cerr << "Cylinder: the axis does not go through the origin" << std::endl;
+    errors++;
+  }
+
+  vtkIntArray* labels = vtkIntArray::SafeDownCast(filter->GetOutput()->GetPointData()->GetArray("ransac_label"));
+  vtkIdType nbLabeled = 0;
+  for (vtkIdType i = 0; labels && i < labels->GetNumberOfTuples(); ++i)
+  {
+    nbLabeled += labels->GetValue(i) == 0;
+  }
+  if (nbLabeled < 0.9 * input->GetNumberOfPoints())
+  {
+    std::cerr << "Cylinder: only " << nbLabeled << " points are part of the model" << std::endl;
+    errors++;
+  }
+  return errors;
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int, char*[])
+{
+  int errors = 0;
+  errors += TestTwoPlanes();
+  errors += TestCylinder();
+  return errors;
+}
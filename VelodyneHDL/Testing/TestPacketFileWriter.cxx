@@ -0,0 +1,105 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkPacketFileReader.h"
+#include "vtkPacketFileWriter.h"
+
+#include <vtksys/SystemTools.hxx>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+//! Source and destination ports of the UDP header preceding the data
+void GetPorts(const unsigned char* data, int& source, int& destination)
+{
+  const unsigned char* udpHeader = data - 8;
+  source = (udpHeader[0] << 8) | udpHeader[1];
+  destination = (udpHeader[2] << 8) | udpHeader[3];
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: TestPacketFileWriter <temporaryPcapFileName>" << std::endl;
+    return 1;
+  }
+  const std::string fileName = argv[1];
+
+  // packets of two lidars, of the default lidar port and of the GPS
+  const std::vector<unsigned char> lidarPacket(1206, 0x42);
+  const std::vector<unsigned char> positionPacket(512, 0x24);
+  {
+    vtkPacketFileWriter writer;
+    if (!writer.Open(fileName))
+    {
+      std::cerr << "Cannot write " << fileName << ": " << writer.GetLastError() << std::endl;
+      return 1;
+    }
+    writer.WritePacket(lidarPacket.data(), lidarPacket.size(), 2368);
+    writer.WritePacket(lidarPacket.data(), lidarPacket.size(), 2370);
+    writer.WritePacket(lidarPacket.data(), lidarPacket.size());
+    writer.WritePacket(positionPacket.data(), positionPacket.size(), 8310);
+    writer.Close();
+  }
+
+  const int expectedPorts[4] = { 2368, 2370, 2368, 8310 };
+  const unsigned int expectedLengths[4] = { 1206, 1206, 1206, 512 };
+
+  int errors = 0;
+  vtkPacketFileReader reader;
+  if (!reader.Open(fileName))
+  {
+    std::cerr << "Cannot read " << fileName << ": " << reader.GetLastError() << std::endl;
+    return 1;
+  }
+  const unsigned char* data = nullptr;
+  unsigned int dataLength = 0;
+  double timeSinceStart = 0;
+  int packet = 0;
+  while (reader.NextPacket(data, dataLength, timeSinceStart))
+  {
+    if (packet >= 4)
+    {
+      packet++;
+      continue;
+    }
+    int source = 0;
+    int destination = 0;
+    GetPorts(data, source, destination);
+    if (dataLength != expectedLengths[packet] || source != expectedPorts[packet] ||
+      destination != expectedPorts[packet])
+    {
+      std::cerr << "Packet " << packet << " of " << dataLength << " bytes has the ports "
+                << source << " -> " << destination << " instead of " << expectedPorts[packet]
+                << std::endl;
+      errors++;
+    }
+    packet++;
+  }
+  reader.Close();
+  if (packet != 4)
+  {
+    std::cerr << packet << " packets are read instead of 4" << std::endl;
+    errors++;
+  }
+
+  vtksys::SystemTools::RemoveFile(fileName);
+  return errors;
+}
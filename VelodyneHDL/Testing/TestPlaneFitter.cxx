@@ -0,0 +1,112 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vtkFloatArray.h>
+#include <vtkPlaneFitter.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <Eigen/Dense>
+
+int main(int argc, char* argv[])
+{
+  // Noisy points of a tilted plane, far from the origin. Each channel is
+  // shifted along the normal by a known offset.
+  const int nbPoints = 64000;
+  const unsigned int nchannels = 64;
+  const double noise = 0.02;
+  const Eigen::Vector3d center(1000.0, -2000.0, 30.0);
+  const Eigen::Vector3d planeNormal = Eigen::Vector3d(0.2, -0.3, 1.0).normalized();
+  const Eigen::Vector3d u = planeNormal.unitOrthogonal();
+  const Eigen::Vector3d v = planeNormal.cross(u);
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> coordinate(-20.0, 20.0);
+  std::normal_distribution<double> gaussian(0.0, noise);
+
+  auto data = vtkSmartPointer<vtkFloatArray>::New();
+  data->SetNumberOfComponents(3);
+  data->SetNumberOfTuples(nbPoints);
+  auto laserId = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  laserId->SetName("laser_id");
+  laserId->SetNumberOfTuples(nbPoints);
+  // centered offsets, their variance adds to the one of the noise
+  std::vector<double> offsets(nchannels);
+  double offsetsVariance = 0.0;
+  for (unsigned int c = 0; c < nchannels; ++c)
+  {
+    offsets[c] = 0.0005 * (static_cast<double>(c) - 0.5 * (nchannels - 1));
+    offsetsVariance += offsets[c] * offsets[c] / nchannels;
+  }
+  const double expectedStdDev = std::sqrt(noise * noise + offsetsVariance);
+  for (int i = 0; i < nbPoints; ++i)
+  {
+    const unsigned int c = i % nchannels;
+    const Eigen::Vector3d point = center + coordinate(rng) * u + coordinate(rng) * v +
+      (offsets[c] + gaussian(rng)) * planeNormal;
+    data->SetTuple3(i, point(0), point(1), point(2));
+    laserId->SetValue(i, c);
+  }
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  points->SetData(data);
+  auto polydata = vtkSmartPointer<vtkPolyData>::New();
+  polydata->SetPoints(points);
+  polydata->GetPointData()->AddArray(laserId);
+
+  double origin[3], normal[3], minDist, maxDist, stdDev;
+  std::vector<double> channelMean(nchannels), channelStdDev(nchannels);
+  std::vector<vtkIdType> channelNpts(nchannels);
+  vtkPlaneFitter::PlaneFit(polydata, origin, normal, minDist, maxDist, stdDev, channelMean.data(),
+    channelStdDev.data(), channelNpts.data(), nchannels);
+
+  int errors = 0;
+  const Eigen::Vector3d fitNormal(normal);
+  const double sign = fitNormal.dot(planeNormal) < 0 ? -1.0 : 1.0;
+  if (std::abs(std::abs(fitNormal.dot(planeNormal)) - 1.0) > 1e-5)
+  {
+    std::cerr << "Wrong normal: " << fitNormal.transpose() << std::endl;
+    errors++;
+  }
+  if (std::abs(planeNormal.dot(Eigen::Vector3d(origin) - center)) > 0.01)
+  {
+    std::cerr << "Origin not on the plane: " << Eigen::Vector3d(origin).transpose() << std::endl;
+    errors++;
+  }
+  if (std::abs(stdDev - expectedStdDev) > 0.05 * expectedStdDev || minDist > -3 * noise || maxDist < 3 * noise)
+  {
+    std::cerr << "Wrong distances: " << stdDev << " " << minDist << " " << maxDist << std::endl;
+    errors++;
+  }
+  for (unsigned int c = 0; c < nchannels; ++c)
+  {
+    if (channelNpts[c] != nbPoints / nchannels ||
+        std::abs(sign * channelMean[c] - offsets[c]) > 0.003 ||
+        std::abs(channelStdDev[c] - noise) > 0.2 * noise)
+    {
+      std::cerr << "Wrong statistics for channel " << c << ": " << channelNpts[c] << " points, mean "
+                << channelMean[c] << ", standard deviation " << channelStdDev[c] << std::endl;
+      errors++;
+    }
+  }
+
+  return errors;
+}
@@ -0,0 +1,105 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "PoseGraph.h"
+
+#include <pcl/point_types.h>
+
+#include <cmath>
+#include <iostream>
+
+int main(int, char*[])
+{
+  int errors = 0;
+
+  // The sensor drives around a 10 m square and comes back to its start. The
+  // odometry slightly overestimates each rotation, so its last pose drifts away
+  // from the first one.
+  const int stepsPerSide = 10;
+  const double yawBias = 0.001;
+  const Eigen::Isometry3d forward(Eigen::Translation3d(1., 0., 0.));
+  const Eigen::Isometry3d turn(Eigen::AngleAxisd(M_PI / 2., Eigen::Vector3d::UnitZ()));
+  const Eigen::Isometry3d bias(Eigen::AngleAxisd(yawBias, Eigen::Vector3d::UnitZ()));
+
+  ScanContext descriptor;
+  descriptor.Compute(pcl::PointCloud<pcl::PointXYZ>(), 10.);
+
+  PoseGraph graph;
+  Eigen::Isometry3d odometry = Eigen::Isometry3d::Identity();
+  graph.AddKeyframe(odometry, descriptor);
+  for (int side = 0; side < 4; ++side)
+  {
+    for (int step = 0; step < stepsPerSide; ++step)
+    {
+      odometry = odometry * forward * bias;
+      if (step == stepsPerSide - 1)
+      {
+        odometry = odometry * turn;
+      }
+      graph.AddKeyframe(odometry, descriptor);
+    }
+  }
+  const int last = graph.GetNumberOfKeyframes() - 1;
+
+  const double drift = (graph.GetPose(last).translation() - graph.GetPose(0).translation()).norm();
+  if (drift < 0.3)
+  {
+    std::cerr << "The odometry drift of " << drift << " m is too small for the test" << std::endl;
+    errors++;
+  }
+
+  // the registration found that the last keyframe is at the place of the first one
+  graph.AddLoopClosure(0, last, Eigen::Isometry3d::Identity());
+  graph.Optimize(100);
+
+  // the first keyframe is fixed, the last one is pulled back onto it
+  const Eigen::Isometry3d& first = graph.GetPose(0);
+  if (!first.isApprox(Eigen::Isometry3d::Identity()))
+  {
+    std::cerr << "The first keyframe moved" << std::endl;
+    errors++;
+  }
+  const Eigen::Isometry3d error = first.inverse() * graph.GetPose(last);
+  const double translationError = error.translation().norm();
+  const double rotationError = Eigen::AngleAxisd(error.linear()).angle();
+  if (translationError > 0.1 || rotationError > 0.01)
+  {
+    std::cerr << "After the loop closure, the last keyframe is " << translationError << " m and "
+              << rotationError << " rad away from the first one, the drift was " << drift << " m"
+              << std::endl;
+    errors++;
+  }
+
+  // the correction is spread along the loop: the keyframe in the middle of the
+  // loop moved, by less than the last one
+  const int middle = last / 2;
+  Eigen::Isometry3d truth = Eigen::Isometry3d::Identity();
+  for (int k = 0; k < middle; ++k)
+  {
+    truth = truth * forward;
+    if (k % stepsPerSide == stepsPerSide - 1)
+    {
+      truth = truth * turn;
+    }
+  }
+  const double middleError = (graph.GetPose(middle).translation() - truth.translation()).norm();
+  if (middleError > drift / 2.)
+  {
+    std::cerr << "The keyframe in the middle of the loop is " << middleError
+              << " m away from its true position" << std::endl;
+    errors++;
+  }
+
+  return errors;
+}
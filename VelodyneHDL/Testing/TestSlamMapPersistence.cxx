@@ -0,0 +1,156 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SlamMapBinaryFormat.h"
+#include "vtkSlam.h"
+
+#include <vtkNew.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// Write a grid whose voxels (listed in the order of RollingGrid::Write) each
+// contain a few points
+void WriteGrid(std::ostream& out, uint32_t mapType, const std::vector<SlamMapBinaryVoxel>& voxels,
+               uint64_t numberOfVoxels)
+{
+  SlamMapBinaryGridHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.MapType = mapType;
+  header.VoxelSize = 20;
+  header.VoxelResolution = 5.;
+  header.LeafSize = 0.3;
+  header.VoxelGridPosition[0] = -10;
+  header.VoxelGridPosition[1] = -3;
+  header.VoxelGridPosition[2] = 7;
+  header.NumberOfVoxels = numberOfVoxels;
+  for (const SlamMapBinaryVoxel& voxel : voxels)
+  {
+    header.NumberOfPoints += voxel.NumberOfPoints;
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(voxels.data()), voxels.size() * sizeof(SlamMapBinaryVoxel));
+
+  for (const SlamMapBinaryVoxel& voxel : voxels)
+  {
+    for (uint32_t p = 0; p < voxel.NumberOfPoints; ++p)
+    {
+      for (int c = 0; c < SlamMapBinaryFormat::PointComponents; ++c)
+      {
+        const float value = 0.25f * (voxel.Index[0] + voxel.Index[1] + voxel.Index[2]) + 0.5f * p + 0.125f * c + mapType;
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+std::string WriteMaps(const std::string& filename, uint64_t numberOfPlanarVoxels)
+{
+  std::ostringstream content;
+  const double pose[6] = { 0., 0., 0., 0., 0., 0. };
+  const SlamMapBinaryHeader header = SlamMapBinaryFormat::CreateHeader(SlamMapBinaryFormat::NumberOfMapTypes, pose);
+  content.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  const std::vector<SlamMapBinaryVoxel> edges = { { { 0, 0, 1 }, 2 }, { { 3, 19, 4 }, 1 } };
+  const std::vector<SlamMapBinaryVoxel> planars = { { { 1, 2, 3 }, 3 }, { { 1, 2, 4 }, 1 }, { { 19, 0, 0 }, 2 } };
+  const std::vector<SlamMapBinaryVoxel> blobs;
+  WriteGrid(content, SlamMapBinaryFormat::EdgesMap, edges, edges.size());
+  WriteGrid(content, SlamMapBinaryFormat::PlanarsMap, planars, numberOfPlanarVoxels);
+  WriteGrid(content, SlamMapBinaryFormat::BlobsMap, blobs, blobs.size());
+
+  std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  file << content.str();
+  return content.str();
+}
+
+//-----------------------------------------------------------------------------
+std::string ReadFile(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Wrong number of arguments. Usage: TestSlamMapPersistence <output prefix>" << std::endl;
+    return 1;
+  }
+  const std::string inputFileName = std::string(argv[1]) + "-input.map";
+  const std::string outputFileName = std::string(argv[1]) + "-output.map";
+
+  int errors = 0;
+
+  // Loading a map and saving it back gives the same file
+  const std::string content = WriteMaps(inputFileName, 3);
+  vtkNew<vtkSlam> slam;
+  if (!slam->LoadMaps(inputFileName))
+  {
+    std::cerr << "Could not load " << inputFileName << std::endl;
+    return 1;
+  }
+  if (!slam->SaveMaps(outputFileName))
+  {
+    std::cerr << "Could not save " << outputFileName << std::endl;
+    return 1;
+  }
+  if (ReadFile(outputFileName) != content)
+  {
+    std::cerr << "The saved maps differ from the loaded ones" << std::endl;
+    errors++;
+  }
+
+  // Grids announcing more voxels than the grid or the file can hold are
+  // rejected, and the maps already loaded are kept
+  for (uint64_t numberOfVoxels : { 1000000000000ULL, 7000ULL })
+  {
+    WriteMaps(inputFileName, numberOfVoxels);
+    if (slam->LoadMaps(inputFileName))
+    {
+      std::cerr << "A map file announcing " << numberOfVoxels << " voxels was loaded" << std::endl;
+      errors++;
+    }
+  }
+  slam->SaveMaps(outputFileName);
+  if (ReadFile(outputFileName) != content)
+  {
+    std::cerr << "The maps were modified by a map file which could not be loaded" << std::endl;
+    errors++;
+  }
+
+  // A truncated file is rejected
+  {
+    std::ofstream file(inputFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    file << content.substr(0, content.size() - sizeof(float));
+  }
+  if (slam->LoadMaps(inputFileName))
+  {
+    std::cerr << "A truncated map file was loaded" << std::endl;
+    errors++;
+  }
+
+  return errors;
+}
@@ -1,10 +1,13 @@
 #include "vtkTemporalTransformsReader.h"
 #include "vtkTemporalTransformsWriter.h"
 
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <stdio.h>
+#include <string>
 
+#include "vtkPointData.h"
 #include "vtkPolyData.h"
 
 #include "TestHelpers.h"
@@ -67,6 +70,89 @@ bool read_write_trajectory(char* to_read, char* to_write)
   return 1;
 }
 
+bool check_binary_round_trip(char* to_read, const std::string& to_write)
+{
+  auto reader = vtkSmartPointer<vtkTemporalTransformsReader>::New();
+  reader->SetFileName(to_read);
+  reader->Update();
+
+  auto writer = vtkSmartPointer<vtkTemporalTransformsWriter>::New();
+  writer->SetInputConnection(0, reader->GetOutputPort());
+  writer->SetFileName(to_write.c_str());
+  writer->SetFileTypeToBinary();
+  writer->Update();
+
+  // the binary file must be read identically, with and without memory mapping
+  bool allgood = true;
+  for (bool useMemoryMap : { true, false })
+  {
+    auto binaryReader = vtkSmartPointer<vtkTemporalTransformsReader>::New();
+    binaryReader->SetFileName(to_write.c_str());
+    binaryReader->SetUseMemoryMap(useMemoryMap);
+    binaryReader->Update();
+
+    vtkPolyData* expected = reader->GetOutput();
+    vtkPolyData* read = binaryReader->GetOutput();
+    allgood &= read->GetNumberOfPoints() == expected->GetNumberOfPoints();
+    allgood &= read->GetNumberOfCells() == 1;
+    if (!allgood)
+    {
+      return false;
+    }
+    for (const char* name : { "Time", "Orientation(AxisAngle)" })
+    {
+      vtkDataArray* a = expected->GetPointData()->GetArray(name);
+      vtkDataArray* b = read->GetPointData()->GetArray(name);
+      allgood &= b != nullptr && a->GetNumberOfComponents() == b->GetNumberOfComponents();
+      for (vtkIdType i = 0; allgood && i < a->GetNumberOfTuples(); i++)
+      {
+        allgood &= compare(a->GetTuple(i), b->GetTuple(i), a->GetNumberOfComponents(), 0.0);
+      }
+    }
+    for (vtkIdType i = 0; allgood && i < expected->GetNumberOfPoints(); i++)
+    {
+      allgood &= compare(expected->GetPoint(i), read->GetPoint(i), 3, 0.0);
+    }
+  }
+  return allgood;
+}
+
+bool check_incomplete_rows_are_skipped(const std::string& to_write)
+{
+  {
+    std::ofstream file(to_write.c_str());
+    file << "# comment" << std::endl
+         << "Time,Rx(Roll),Ry(Pitch),Rz(Yaw),X,Y,Z" << std::endl
+         << "0.0,0,0,0,1,2,3" << std::endl
+         << "0.1,0,0,0,1,2" << std::endl
+         << "0.2,0,0,,1,2,3" << std::endl
+         << "0.3,0,0,0,1,2,abc" << std::endl
+         << "0.4,0,0,0,4,5,6" << std::endl;
+  }
+
+  auto reader = vtkSmartPointer<vtkTemporalTransformsReader>::New();
+  reader->SetFileName(to_write.c_str());
+  reader->Update();
+  vtkPolyData* read = reader->GetOutput();
+
+  bool allgood = read->GetNumberOfPoints() == 2;
+  if (!allgood)
+  {
+    return false;
+  }
+  vtkDataArray* time = read->GetPointData()->GetArray("Time");
+  allgood &= time != nullptr;
+  const double referenceTimes[2] = { 0.0, 0.4 };
+  for (vtkIdType i = 0; allgood && i < 2; i++)
+  {
+    const double t = time->GetTuple1(i);
+    allgood &= compare(&t, &referenceTimes[i], 1, epsilon);
+  }
+  const double referenceLastPointXYZ[3] = { 4., 5., 6. };
+  allgood &= compare(read->GetPoint(1), referenceLastPointXYZ, 3, epsilon);
+  return allgood;
+}
+
 int main(int argc, char* argv[])
 {
   if (argc != 3)
@@ -124,5 +210,26 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  // Finally, check that the binary format gives back the same trajectory
+  const std::string binaryFile = std::string(temporaryFile) + ".traj";
+  if (!check_binary_round_trip(referenceTrajectory, binaryFile))
+  {
+    std::cout << "Reading file written in binary format using vtkTemporalTransformsWriter"
+                 " does not give back the same trajectory" << std::endl;
+    std::remove(binaryFile.c_str());
+    return 1;
+  }
+  std::remove(binaryFile.c_str());
+
+  // The rows with missing or invalid values must be skipped, not read as NaN
+  if (!check_incomplete_rows_are_skipped(temporaryFile))
+  {
+    std::cout << "Reading a file with incomplete rows using vtkTemporalTransformsReader"
+                 " does not skip them" << std::endl;
+    std::remove(temporaryFile);
+    return 1;
+  }
+  std::remove(temporaryFile);
+
   return 0;
 }
@@ -8,6 +8,7 @@
 #include <vtkTimeSourceExample.h>
 #include <vtkTrailingFrame.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
@@ -91,6 +92,40 @@ bool check_trailing_frames(vtkTrailingFrame* tf, vtkInformation* info, double *t
 }
 
 
+bool check_accumulated_frames(vtkTrailingFrame* tf, vtkInformation* info, double *time_steps,
+                              int time_index, vtkIdType nb_points_per_frame)
+{
+    // in accumulation mode, the first block merges the frames, from the oldest to the current one
+    int nb_trailing_frames = tf->GetNumberOfTrailingFrames();
+    info->Set(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP(), time_steps[time_index]);
+    tf->Update();
+    auto tf_out = vtkMultiBlockDataSet::SafeDownCast(tf->GetOutputDataObject(0));
+    auto merged = vtkPolyData::SafeDownCast(tf_out->GetBlock(0));
+    int first_index = std::max(time_index - nb_trailing_frames, 0);
+    int nb_frames = time_index - first_index + 1;
+    if (!merged || merged->GetNumberOfPoints() != nb_frames * nb_points_per_frame)
+    {
+        std::cerr << "Trailing frame test failed: \n";
+        std::cerr << "Expected " << nb_frames * nb_points_per_frame << " accumulated points at index "
+                  << time_index << "\n";
+        return false;
+    }
+    auto array = vtkDoubleArray::SafeDownCast(merged->GetPointData()->GetArray("Point Value"));
+    for (int i = 0; i < nb_frames; ++i)
+    {
+        double expected_value = value_fonction(time_steps[first_index + i]);
+        double value = array->GetValue(i * nb_points_per_frame);
+        if (std::abs(value - expected_value) > epsilon)
+        {
+            std::cerr << "Trailing frame test failed: \n";
+            std::cerr << "Expected accumulated value " << expected_value << " found " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
 int main(int argc, char* argv[])
 {
     // vtkTimeSourceExample generates 10 time steps of points with a data array called "Point Value".
@@ -142,5 +177,23 @@ int main(int argc, char* argv[])
     // go to 7 and check
     res = res && check_trailing_frames(tf, outInfo, time_steps, 7);
 
+    // accumulation mode: step forward, jump forward, go back and grow the window
+    grid_to_poly->Update();
+    vtkIdType nb_points_per_frame = grid_to_poly->GetOutput()->GetNumberOfPoints();
+    tf->SetAccumulationMode(true);
+    tf->SetNumberOfTrailingFrames(N1);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 0, nb_points_per_frame);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 1, nb_points_per_frame);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 2, nb_points_per_frame);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 3, nb_points_per_frame);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 7, nb_points_per_frame);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 2, nb_points_per_frame);
+    tf->SetNumberOfTrailingFrames(N2);
+    res = res && check_accumulated_frames(tf, outInfo, time_steps, 5, nb_points_per_frame);
+
+    // back to the multiblock of frames
+    tf->SetAccumulationMode(false);
+    res = res && check_trailing_frames(tf, outInfo, time_steps, 6);
+
     return res ? 0 : -1;
 }
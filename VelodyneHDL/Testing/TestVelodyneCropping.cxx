@@ -0,0 +1,169 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+#include <vtkDataArray.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+bool IsAzimuthInside(double theta, double thetaMin, double thetaMax)
+{
+  // the interval wraps around 360 if its first bound is greater
+  return thetaMin <= thetaMax ? theta >= thetaMin && theta <= thetaMax
+                              : theta >= thetaMin || theta <= thetaMax;
+}
+
+//-----------------------------------------------------------------------------
+//! Straightforward per point test, with the square roots and the trigonometric
+//! functions that the interpreter avoids
+bool IsInside(int mode, const double region[6], const double pos[3], double theta)
+{
+  const double rho = std::sqrt(pos[0] * pos[0] + pos[1] * pos[1]);
+  switch (mode)
+  {
+    case vtkLidarPacketInterpreter::Cartesian:
+      return pos[0] >= region[0] && pos[0] <= region[1] && pos[1] >= region[2] &&
+        pos[1] <= region[3] && pos[2] >= region[4] && pos[2] <= region[5];
+    case vtkLidarPacketInterpreter::Spherical:
+    {
+      const double phi = vtkMath::DegreesFromRadians(std::atan2(pos[2], rho));
+      const double r = std::sqrt(rho * rho + pos[2] * pos[2]);
+      return IsAzimuthInside(theta, region[0], region[1]) && phi >= region[2] &&
+        phi <= region[3] && r >= region[4] && r <= region[5];
+    }
+    case vtkLidarPacketInterpreter::Cylindric:
+      return IsAzimuthInside(theta, region[0], region[1]) && pos[2] >= region[2] &&
+        pos[2] <= region[3] && rho >= region[4] && rho <= region[5];
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> ReadFrame(const std::string& pcapFileName,
+                                       const std::string& calibrationFileName,
+                                       bool useIntraFiringAdjustment, int mode,
+                                       const double region[6], bool cropOutside)
+{
+  auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  interpreter->SetUseIntraFiringAdjustment(useIntraFiringAdjustment);
+  interpreter->SetCropMode(mode);
+  interpreter->SetCropRegion(region[0], region[1], region[2], region[3], region[4], region[5]);
+  interpreter->SetCropOutside(cropOutside);
+  vtkNew<vtkLidarReader> reader;
+  reader->SetInterpreter(interpreter);
+  reader->SetFileName(pcapFileName);
+  reader->SetCalibrationFileName(calibrationFileName);
+  reader->Update();
+  return reader->GetFrame(1);
+}
+
+//-----------------------------------------------------------------------------
+//! Crop a frame and check that the points kept are the ones of the uncropped
+//! frame which pass the per point test, in the same order
+int TestCropping(const std::string& pcapFileName, const std::string& calibrationFileName,
+                 const char* name, int mode, const double region[6], bool cropOutside)
+{
+  int errors = 0;
+  const double noRegion[6] = { 0, 0, 0, 0, 0, 0 };
+  for (bool useIntraFiringAdjustment : { true, false })
+  {
+    vtkSmartPointer<vtkPolyData> full = ReadFrame(pcapFileName, calibrationFileName,
+      useIntraFiringAdjustment, vtkLidarPacketInterpreter::None, noRegion, false);
+    vtkSmartPointer<vtkPolyData> cropped = ReadFrame(pcapFileName, calibrationFileName,
+      useIntraFiringAdjustment, mode, region, cropOutside);
+
+    vtkDataArray* azimuth = full->GetPointData()->GetArray("azimuth");
+    vtkIdType kept = 0;
+    for (vtkIdType i = 0; i < full->GetNumberOfPoints(); ++i)
+    {
+      double pos[3];
+      full->GetPoint(i, pos);
+      if (IsInside(mode, region, pos, azimuth->GetTuple1(i) / 100.) == cropOutside)
+      {
+        continue;
+      }
+      double croppedPos[3] = { 0, 0, 0 };
+      if (kept < cropped->GetNumberOfPoints())
+      {
+        cropped->GetPoint(kept, croppedPos);
+      }
+      if (kept >= cropped->GetNumberOfPoints() || vtkMath::Distance2BetweenPoints(pos, croppedPos) > 0.)
+      {
+        std::cerr << name << " (intra firing adjustment " << useIntraFiringAdjustment
+                  << "): the point " << i << " is missing" << std::endl;
+        errors++;
+        break;
+      }
+      kept++;
+    }
+    if (errors == 0 && kept != cropped->GetNumberOfPoints())
+    {
+      std::cerr << name << " (intra firing adjustment " << useIntraFiringAdjustment << "): "
+                << cropped->GetNumberOfPoints() << " points kept instead of " << kept << std::endl;
+      errors++;
+    }
+    if (kept == 0 || kept == full->GetNumberOfPoints())
+    {
+      std::cerr << name << ": the region does not crop the frame, the test is meaningless"
+                << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: TestVelodyneCropping <pcapFileName> <correctionFileName>" << std::endl;
+    return 1;
+  }
+  const std::string pcap = argv[1];
+  const std::string calibration = argv[2];
+
+  int errors = 0;
+  const double box[6] = { -10, 10, -5, 15, -1, 1 };
+  errors += TestCropping(pcap, calibration, "Cartesian", vtkLidarPacketInterpreter::Cartesian, box, false);
+
+  // the firings and lasers outside the azimuth interval are rejected before decoding
+  const double sphere[6] = { 30, 200, -5.5, 5.5, 1, 30 };
+  errors += TestCropping(pcap, calibration, "Spherical", vtkLidarPacketInterpreter::Spherical, sphere, false);
+  errors += TestCropping(pcap, calibration, "Spherical outside", vtkLidarPacketInterpreter::Spherical, sphere, true);
+
+  const double wrappingSphere[6] = { 300, 60, -90, 90, 0, 1000 };
+  errors += TestCropping(pcap, calibration, "Spherical wrapping at 360",
+    vtkLidarPacketInterpreter::Spherical, wrappingSphere, false);
+
+  const double cylinder[6] = { 100, 250, -1, 0.5, 2, 20 };
+  errors += TestCropping(pcap, calibration, "Cylindric", vtkLidarPacketInterpreter::Cylindric, cylinder, false);
+
+  const double wrappingCylinder[6] = { 270, 45, -100, 100, 0, 1000 };
+  errors += TestCropping(pcap, calibration, "Cylindric wrapping at 360",
+    vtkLidarPacketInterpreter::Cylindric, wrappingCylinder, true);
+
+  return errors;
+}
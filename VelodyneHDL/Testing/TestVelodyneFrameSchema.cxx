@@ -0,0 +1,96 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+#include <cmath>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: TestVelodyneFrameSchema <pcapFileName> <correctionFileName>" << std::endl;
+    return 1;
+  }
+
+  // the same frame, with all the optional arrays, then with the compact schema
+  auto readFrame = [&](vtkVelodynePacketInterpreter* interpreter) {
+    vtkNew<vtkLidarReader> reader;
+    reader->SetInterpreter(interpreter);
+    reader->SetFileName(argv[1]);
+    reader->SetCalibrationFileName(argv[2]);
+    reader->Update();
+    return reader->GetFrame(1);
+  };
+
+  auto fullInterpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  vtkSmartPointer<vtkPolyData> full = readFrame(fullInterpreter);
+
+  auto compactInterpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  compactInterpreter->SetXYZArraysStorage(vtkVelodynePacketInterpreter::Disabled);
+  compactInterpreter->SetDistanceStorage(vtkVelodynePacketInterpreter::Float);
+  compactInterpreter->SetAdjustedTimeStorage(vtkVelodynePacketInterpreter::Disabled);
+  compactInterpreter->SetVerticalAngleStorage(vtkVelodynePacketInterpreter::Disabled);
+  vtkSmartPointer<vtkPolyData> compact = readFrame(compactInterpreter);
+
+  int errors = 0;
+  if (!full || !compact || full->GetNumberOfPoints() == 0 ||
+      full->GetNumberOfPoints() != compact->GetNumberOfPoints())
+  {
+    std::cerr << "The compact schema changed the points of the frame" << std::endl;
+    return 1;
+  }
+
+  for (const char* name : { "X", "Y", "Z", "adjustedtime", "vertical_angle" })
+  {
+    if (compact->GetPointData()->GetArray(name))
+    {
+      std::cerr << "The disabled array " << name << " is present" << std::endl;
+      errors++;
+    }
+  }
+  if (compact->GetPointData()->GetArray("distance_m")->GetDataType() != VTK_FLOAT)
+  {
+    std::cerr << "distance_m is not stored in single precision" << std::endl;
+    errors++;
+  }
+
+  // the vertical angle derived from the calibration table matches the stored one
+  if (!compactInterpreter->AddVerticalAngleArray(compact))
+  {
+    std::cerr << "The vertical angle could not be derived from laser_id" << std::endl;
+    return errors + 1;
+  }
+  vtkDataArray* expected = full->GetPointData()->GetArray("vertical_angle");
+  vtkDataArray* derived = compact->GetPointData()->GetArray("vertical_angle");
+  for (vtkIdType i = 0; i < full->GetNumberOfPoints(); ++i)
+  {
+    if (std::abs(expected->GetTuple1(i) - derived->GetTuple1(i)) > 1e-9)
+    {
+      std::cerr << "Wrong vertical angle for point " << i << ": " << derived->GetTuple1(i)
+                << " instead of " << expected->GetTuple1(i) << std::endl;
+      errors++;
+      break;
+    }
+  }
+
+  return errors;
+}
@@ -0,0 +1,110 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkTable.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+//! Read the first frame with the given dual return filter, and check the laser
+//! statistics output against the statistics computed from the frame points
+int TestFile(const std::string& pcapFileName, const std::string& calibrationFileName,
+             unsigned int dualReturnFilter)
+{
+  auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  interpreter->SetDualReturnFilter(dualReturnFilter);
+  vtkNew<vtkLidarReader> reader;
+  reader->SetInterpreter(interpreter);
+  reader->SetFileName(pcapFileName);
+  reader->SetCalibrationFileName(calibrationFileName);
+  reader->Update();
+
+  vtkPolyData* frame = vtkPolyData::SafeDownCast(reader->GetOutputDataObject(0));
+  vtkTable* statistics = vtkTable::SafeDownCast(reader->GetOutputDataObject(2));
+  if (!frame || !statistics || frame->GetNumberOfPoints() == 0 || statistics->GetNumberOfRows() == 0)
+  {
+    std::cerr << pcapFileName << ": no frame or no laser statistics" << std::endl;
+    return 1;
+  }
+
+  const vtkIdType numberOfLasers = statistics->GetNumberOfRows();
+  std::vector<vtkIdType> count(numberOfLasers, 0);
+  std::vector<double> sumDistance(numberOfLasers, 0.);
+  std::vector<double> sumIntensity(numberOfLasers, 0.);
+  vtkDataArray* laserId = frame->GetPointData()->GetArray("laser_id");
+  vtkDataArray* distance = frame->GetPointData()->GetArray("distance_m");
+  vtkDataArray* intensity = frame->GetPointData()->GetArray("intensity");
+  for (vtkIdType i = 0; i < frame->GetNumberOfPoints(); ++i)
+  {
+    const vtkIdType laser = static_cast<vtkIdType>(laserId->GetTuple1(i));
+    if (laser < 0 || laser >= numberOfLasers)
+    {
+      std::cerr << pcapFileName << ": laser " << laser << " has no statistics" << std::endl;
+      return 1;
+    }
+    count[laser]++;
+    sumDistance[laser] += distance->GetTuple1(i);
+    sumIntensity[laser] += intensity->GetTuple1(i);
+  }
+
+  int errors = 0;
+  for (vtkIdType laser = 0; laser < numberOfLasers; ++laser)
+  {
+    const double n = static_cast<double>(std::max<vtkIdType>(count[laser], 1));
+    const vtkIdType numberOfPoints = statistics->GetValueByName(laser, "number_of_points").ToLongLong();
+    const double meanDistance = statistics->GetValueByName(laser, "mean_distance_m").ToDouble();
+    const double meanIntensity = statistics->GetValueByName(laser, "mean_intensity").ToDouble();
+    if (numberOfPoints != count[laser] || std::abs(meanDistance - sumDistance[laser] / n) > 1e-6 ||
+        std::abs(meanIntensity - sumIntensity[laser] / n) > 1e-6)
+    {
+      std::cerr << pcapFileName << " (dual return filter " << dualReturnFilter << "): laser "
+                << laser << " statistics " << numberOfPoints << ", " << meanDistance << ", "
+                << meanIntensity << " instead of " << count[laser] << ", "
+                << sumDistance[laser] / n << ", " << sumIntensity[laser] / n << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: TestVelodyneLaserStatistics <dualReturnPcapFileName> <correctionFileName>"
+              << std::endl;
+    return 1;
+  }
+
+  int errors = 0;
+  errors += TestFile(argv[1], argv[2], 0);
+  // the first return is replaced by the second one when only the latter matches
+  errors += TestFile(argv[1], argv[2], vtkVelodynePacketInterpreter::DUAL_DISTANCE_FAR);
+  errors += TestFile(argv[1], argv[2], vtkVelodynePacketInterpreter::DUAL_INTENSITY_HIGH);
+  return errors;
+}
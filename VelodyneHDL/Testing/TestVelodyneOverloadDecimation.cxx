@@ -0,0 +1,107 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkLidarReader.h"
+#include "vtkVelodynePacketInterpreter.h"
+
+#include <vtkDataArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+#include <iostream>
+#include <set>
+#include <string>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+std::set<int> GetLaserIds(vtkPolyData* frame)
+{
+  std::set<int> ids;
+  vtkDataArray* laserId = frame->GetPointData()->GetArray("laser_id");
+  for (vtkIdType i = 0; i < frame->GetNumberOfPoints(); ++i)
+  {
+    ids.insert(static_cast<int>(laserId->GetTuple1(i)));
+  }
+  return ids;
+}
+
+//-----------------------------------------------------------------------------
+//! Read a frame with and without the overload firing decimation, and check that the
+//! decimation only removes whole firings: all the lasers and returns are kept
+int TestFile(const std::string& pcapFileName, const std::string& calibrationFileName)
+{
+  auto interpreter = vtkSmartPointer<vtkVelodynePacketInterpreter>::New();
+  vtkNew<vtkLidarReader> reader;
+  reader->SetInterpreter(interpreter);
+  reader->SetFileName(pcapFileName);
+  reader->SetCalibrationFileName(calibrationFileName);
+  reader->Update();
+  if (reader->GetNumberOfFrames() < 3)
+  {
+    std::cerr << "Not enough frames in " << pcapFileName << std::endl;
+    return 1;
+  }
+
+  vtkSmartPointer<vtkPolyData> full = reader->GetFrame(1);
+  interpreter->SetOverloadDecimation(2, 1, 1);
+  vtkSmartPointer<vtkPolyData> decimated = reader->GetFrame(1);
+  interpreter->SetOverloadDecimation(1, 1, 1);
+
+  int errors = 0;
+  if (GetLaserIds(full) != GetLaserIds(decimated))
+  {
+    std::cerr << pcapFileName << ": the firing decimation removed lasers, "
+              << GetLaserIds(full).size() << " lasers instead of " << GetLaserIds(decimated).size()
+              << std::endl;
+    errors++;
+  }
+
+  // about half the points, allowing for the firings at the frame boundaries
+  const double ratio = static_cast<double>(decimated->GetNumberOfPoints()) / full->GetNumberOfPoints();
+  if (ratio < 0.45 || ratio > 0.55)
+  {
+    std::cerr << pcapFileName << ": the firing decimation kept " << ratio
+              << " of the points instead of half" << std::endl;
+    errors++;
+  }
+
+  // both returns of the kept firings are decoded
+  const bool hasDualReturn = full->GetPointData()->GetArray("dual_return_matching") != nullptr;
+  if (hasDualReturn != (decimated->GetPointData()->GetArray("dual_return_matching") != nullptr))
+  {
+    std::cerr << pcapFileName << ": the firing decimation changed the returns" << std::endl;
+    errors++;
+  }
+  return errors;
+}
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3 || argc % 2 == 0)
+  {
+    std::cerr << "Usage: TestVelodyneOverloadDecimation <pcapFileName> <correctionFileName> ..."
+              << std::endl;
+    return 1;
+  }
+
+  int errors = 0;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    errors += TestFile(argv[i], argv[i + 1]);
+  }
+  return errors;
+}
@@ -0,0 +1,67 @@
+// Copyright 2019 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vtkVertexCells.h"
+
+#include <vtkIdList.h>
+#include <vtkNew.h>
+
+#include <iostream>
+
+namespace
+{
+//! Check that the cells are the vertices 0, 1, ..., numberOfVerts - 1
+int CheckVertexCells(vtkCellArray* cells, vtkIdType numberOfVerts, const char* name)
+{
+  if (cells->GetNumberOfCells() != numberOfVerts)
+  {
+    std::cerr << name << ": " << cells->GetNumberOfCells() << " cells instead of "
+              << numberOfVerts << std::endl;
+    return 1;
+  }
+  vtkIdType npts = 0;
+  vtkIdType* pts = nullptr;
+  cells->InitTraversal();
+  for (vtkIdType i = 0; cells->GetNextCell(npts, pts); ++i)
+  {
+    if (npts != 1 || pts[0] != i)
+    {
+      std::cerr << name << ": wrong cell " << i << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+}
+
+int main(int, char*[])
+{
+  int errors = 0;
+
+  // modifying the cells of a frame leaves the cells of the other frames untouched
+  vtkSmartPointer<vtkCellArray> first = NewVertexCells(100);
+  vtkSmartPointer<vtkCellArray> second = NewVertexCells(100);
+  vtkIdType point = 42;
+  first->ReplaceCell(0, 1, &point);
+  first->Reset();
+  first->InsertNextCell(1, &point);
+  errors += CheckVertexCells(second, 100, "after modifying another frame");
+
+  vtkSmartPointer<vtkCellArray> big = NewVertexCells(200000);
+  errors += CheckVertexCells(big, 200000, "big request");
+  errors += CheckVertexCells(second, 100, "after a bigger request");
+
+  errors += CheckVertexCells(NewVertexCells(0), 0, "empty request");
+  return errors;
+}
@@ -37,6 +37,7 @@ public:
   void saveSettings();
   void restoreSettings();
   void SetSphericalSettings();
+  void SetCylindricSettings();
   void SetCartesianSettings();
   void ActivateSpinBox();
   void DesactivateSpinBox();
@@ -91,6 +92,10 @@ void vvCropReturnsDialog::pqInternal::restoreSettings()
     this->Settings->value("VelodyneHDLPlugin/CropReturnsDialog/cartesianRadioButton", false)
       .toBool());
 
+  this->cylindricRadioButton->setChecked(
+    this->Settings->value("VelodyneHDLPlugin/CropReturnsDialog/cylindricRadioButton", false)
+      .toBool());
+
   if (this->cartesianRadioButton->isChecked())
   {
     this->SetCartesianSettings();
@@ -101,6 +106,11 @@ void vvCropReturnsDialog::pqInternal::restoreSettings()
     this->SetSphericalSettings();
   }
 
+  if (this->cylindricRadioButton->isChecked())
+  {
+    this->SetCylindricSettings();
+  }
+
   this->CropGroupBox->setChecked(
     this->Settings->value("VelodyneHDLPlugin/CropReturnsDialog/EnableCropping", false).toBool());
 
@@ -189,6 +199,8 @@ vvCropReturnsDialog::vvCropReturnsDialog(QWidget* p)
     this->Internal->cartesianRadioButton, SIGNAL(clicked()), this, SLOT(onCartesianToggled()));
   connect(
     this->Internal->sphericalRadioButton, SIGNAL(clicked()), this, SLOT(onSphericalToggled()));
+  connect(
+    this->Internal->cylindricRadioButton, SIGNAL(clicked()), this, SLOT(onCylindricToggled()));
   connect(this->Internal->CropGroupBox, SIGNAL(clicked()), this, SLOT(onCropGroupBoxToggled()));
 
   // Without configuration file, no croping is perform
@@ -231,9 +243,12 @@ QVector3D vvCropReturnsDialog::firstCorner() const
   double cropRegion[6];
   this->Internal->GetCropRegion(cropRegion);
 
-  if (this->Internal->sphericalRadioButton->isChecked())
+  if (this->Internal->sphericalRadioButton->isChecked() ||
+    this->Internal->cylindricRadioButton->isChecked())
   {
-    return QVector3D(cropRegion[0], cropRegion[2], qMin(cropRegion[4], cropRegion[5]));
+    // the azimuth interval wraps around 360 if its first bound is greater
+    return QVector3D(cropRegion[0], qMin(cropRegion[2], cropRegion[3]),
+      qMin(cropRegion[4], cropRegion[5]));
   }
   else
   {
@@ -248,9 +263,11 @@ QVector3D vvCropReturnsDialog::secondCorner() const
   double cropRegion[6];
   this->Internal->GetCropRegion(cropRegion);
 
-  if (this->Internal->sphericalRadioButton->isChecked())
+  if (this->Internal->sphericalRadioButton->isChecked() ||
+    this->Internal->cylindricRadioButton->isChecked())
   {
-    return QVector3D(cropRegion[1], cropRegion[3], qMax(cropRegion[4], cropRegion[5]));
+    return QVector3D(cropRegion[1], qMax(cropRegion[2], cropRegion[3]),
+      qMax(cropRegion[4], cropRegion[5]));
   }
   else
   {
@@ -289,6 +306,8 @@ void vvCropReturnsDialog::accept()
     this->Internal->cartesianRadioButton->isChecked());
   this->Internal->Settings->setValue("VelodyneHDLPlugin/CropReturnsDialog/sphericalRadioButton",
     this->Internal->sphericalRadioButton->isChecked());
+  this->Internal->Settings->setValue("VelodyneHDLPlugin/CropReturnsDialog/cylindricRadioButton",
+    this->Internal->cylindricRadioButton->isChecked());
 
   QDialog::accept();
 }
@@ -305,6 +324,12 @@ void vvCropReturnsDialog::onSphericalToggled()
   this->Internal->SetSphericalSettings();
 }
 
+//-----------------------------------------------------------------------------
+void vvCropReturnsDialog::onCylindricToggled()
+{
+  this->Internal->SetCylindricSettings();
+}
+
 //-----------------------------------------------------------------------------
 void vvCropReturnsDialog::onSliderBoxToggled()
 {
@@ -349,6 +374,42 @@ void vvCropReturnsDialog::pqInternal::SetSphericalSettings()
   this->ZDoubleRangeSlider.setMaximum(maxR);
 }
 
+//-----------------------------------------------------------------------------
+void vvCropReturnsDialog::pqInternal::SetCylindricSettings()
+{
+  this->ActivateSpinBox();
+  // change the labels
+  this->XLabel->setText("Rotational angle");
+  this->YLabel->setText("Z");
+  this->ZLabel->setText("Distance to Z axis");
+
+  // cylindrical coordinates (rho,theta,z)
+  double minRho = 0, maxRho = 240;
+  double minTheta = 0, maxTheta = 360; // Rotational Angle
+  double minZ = -300, maxZ = 300;
+  // theta is between [minTheta,maxTheta] - Rotational Angle
+  this->X1SpinBox->setMinimum(minTheta);
+  this->X2SpinBox->setMinimum(minTheta);
+  this->XDoubleRangeSlider.setMinimum(minTheta);
+  this->X1SpinBox->setMaximum(maxTheta);
+  this->X2SpinBox->setMaximum(maxTheta);
+  this->XDoubleRangeSlider.setMaximum(maxTheta);
+  // z is between [minZ,maxZ]
+  this->Y1SpinBox->setMinimum(minZ);
+  this->Y2SpinBox->setMinimum(minZ);
+  this->YDoubleRangeSlider.setMinimum(minZ);
+  this->Y1SpinBox->setMaximum(maxZ);
+  this->Y2SpinBox->setMaximum(maxZ);
+  this->YDoubleRangeSlider.setMaximum(maxZ);
+  // rho is positive
+  this->Z1SpinBox->setMinimum(minRho);
+  this->Z2SpinBox->setMinimum(minRho);
+  this->ZDoubleRangeSlider.setMinimum(minRho);
+  this->Z1SpinBox->setMaximum(maxRho);
+  this->Z2SpinBox->setMaximum(maxRho);
+  this->ZDoubleRangeSlider.setMaximum(maxRho);
+}
+
 //-----------------------------------------------------------------------------
 void vvCropReturnsDialog::pqInternal::SetCartesianSettings()
 {
@@ -393,11 +454,11 @@ void vvCropReturnsDialog::onNoneToggled()
 //-----------------------------------------------------------------------------
 int vvCropReturnsDialog::GetCropMode() const
 {
-  // Crop mode :
-  // 0 -> cartesian
-  // 1 -> Spherical
-  // 2 -> Cylindric
-  // 3 -> None
+  // Crop mode, in the order of vtkLidarPacketInterpreter::CROP_MODE :
+  // 0 -> None
+  // 1 -> Cartesian
+  // 2 -> Spherical
+  // 3 -> Cylindric
   if (this->Internal->cartesianRadioButton->isChecked())
   {
     return 1;
@@ -406,13 +467,13 @@ int vvCropReturnsDialog::GetCropMode() const
   {
     return 2;
   }
-  else if (this->Internal->noneRadioButton->isChecked())
+  else if (this->Internal->cylindricRadioButton->isChecked())
   {
-    return 0;
+    return 3;
   }
   else
   {
-    return 3;
+    return 0;
   }
 }
 
@@ -638,6 +699,7 @@ void vvCropReturnsDialog::onCropGroupBoxToggled()
   this->Internal->noneRadioButton->setDisabled(!this->Internal->CropGroupBox->isChecked());
   this->Internal->cartesianRadioButton->setDisabled(!this->Internal->CropGroupBox->isChecked());
   this->Internal->sphericalRadioButton->setDisabled(!this->Internal->CropGroupBox->isChecked());
+  this->Internal->cylindricRadioButton->setDisabled(!this->Internal->CropGroupBox->isChecked());
   this->Internal->CropOutsideCheckBox->setDisabled(!this->Internal->CropGroupBox->isChecked());
 }
 
@@ -52,6 +52,7 @@ public slots:
   void onNoneToggled();
   void onCartesianToggled();
   void onSphericalToggled();
+  void onCylindricToggled();
   void onSliderBoxToggled();
   void onCropGroupBoxToggled();
   void onSpinBoxChanged(double value);
@@ -16,6 +16,7 @@
 #include "vtkLASFileWriter.h"
 #include "vtkPVConfig.h" //  needed for PARAVIEW_VERSION
 #include "vtkLidarReader.h"
+#include "vtkLidarStream.h"
 #include "vvPythonQtDecorators.h"
 
 #include <pqActiveObjects.h>
@@ -49,6 +50,7 @@
 #include <QMainWindow>
 #include <QMessageBox>
 #include <QProcess>
+#include <QPointer>
 #include <QProgressDialog>
 #include <QTimer>
 
@@ -358,6 +360,50 @@ void pqVelodyneManager::saveFramesToLAS(vtkLidarReader* reader, vtkPolyData* pos
 void pqVelodyneManager::setup()
 {
   QTimer::singleShot(0, this, SLOT(pythonStartup()));
+
+  this->connect(pqApplicationCore::instance()->getServerManagerModel(),
+    SIGNAL(sourceAdded(pqPipelineSource*)), SLOT(onSourceAdded(pqPipelineSource*)));
+}
+
+//-----------------------------------------------------------------------------
+void pqVelodyneManager::onSourceAdded(pqPipelineSource* source)
+{
+  vtkLidarStream* stream = vtkLidarStream::SafeDownCast(source->getProxy()->GetClientSideObject());
+  if (!stream)
+  {
+    return;
+  }
+
+  // The callback is called from the receiving thread, only the id of the proxy
+  // is given to the main thread as the source may be deleted in between
+  QPointer<pqVelodyneManager> self(this);
+  unsigned int proxyId = source->getProxy()->GetGlobalID();
+  stream->SetNewFrameCallback([self, proxyId]() {
+    QMetaObject::invokeMethod(self.data(), "onLiveSourceNewFrame", Qt::QueuedConnection,
+      Q_ARG(unsigned int, proxyId));
+  });
+}
+
+//-----------------------------------------------------------------------------
+void pqVelodyneManager::onLiveSourceNewFrame(unsigned int proxyId)
+{
+  pqServerManagerModel* smModel = pqApplicationCore::instance()->getServerManagerModel();
+  pqPipelineSource* source = smModel->findItem<pqPipelineSource*>(proxyId);
+  if (!source)
+  {
+    return;
+  }
+
+  vtkSMSourceProxy* proxy = vtkSMSourceProxy::SafeDownCast(source->getProxy());
+  vtkLidarStream* stream = vtkLidarStream::SafeDownCast(proxy->GetClientSideObject());
+  if (!stream || !stream->Poll())
+  {
+    return;
+  }
+
+  proxy->MarkModified(proxy);
+  proxy->UpdatePipelineInformation();
+  pqApplicationCore::instance()->render();
 }
 
 //-----------------------------------------------------------------------------
@@ -86,6 +86,15 @@ signals:
 
   void sourceCreated();
 
+private slots:
+
+  /// Subscribe to the new frames of the live streams, so that they are rendered
+  /// as soon as they are received
+  void onSourceAdded(pqPipelineSource* source);
+
+  /// Update and render a live stream, called in the main thread once a frame is completed
+  void onLiveSourceNewFrame(unsigned int proxyId);
+
 private:
   pqVelodyneManager(QObject* p);
 
@@ -34,6 +34,7 @@ import bisect
 
 from PythonQt.paraview import vvCalibrationDialog, vvCropReturnsDialog, vvSelectFramesDialog
 from VelodyneHDLPluginPython import vtkVelodynePacketInterpreter
+from VelodyneHDLPluginPython import vtkLidarFramesExporter
 
 _repCache = {}
 
@@ -791,8 +792,34 @@ def saveFrameRange(filename, frameStart, frameStop, saveFunction):
     saveFunction(filename, timesteps)
 
 
+def exportFrames(filename, timesteps, fileFormat):
+    # export the frames directly from the reader, without going through the pipeline
+    reader = getReader()
+    reader.SMProxy.UpdateVTKObjects()
+    lidarReader = reader.GetClientSideObject()
+
+    # the timesteps are reader times, the exporter expects reader frame indices,
+    # which include the first and last frames even when they are hidden
+    exporter = vtkLidarFramesExporter()
+    exporter.SetReader(lidarReader)
+    exporter.SetFileName(filename)
+    exporter.SetFirstFrame(lidarReader.GetFrameIndexForTime(min(timesteps)))
+    exporter.SetLastFrame(lidarReader.GetFrameIndexForTime(max(timesteps)))
+    exporter.SetFormat(fileFormat)
+    exporter.SetWriteToZip(True)
+    exporter.SetPrecision(16 if fileFormat == vtkLidarFramesExporter.CSV else 6)
+    return exporter.Write()
+
+
 def saveCSV(filename, timesteps):
 
+    if getReader() is not None and len(timesteps):
+        if not exportFrames(filename, timesteps, vtkLidarFramesExporter.CSV):
+            QtGui.QMessageBox.warning(getMainWindow(), 'Export failed',
+                                      'The frames could not be saved to %s' % filename)
+            return False
+        return True
+
     tempDir = kiwiviewerExporter.tempfile.mkdtemp()
     basenameWithoutExtension = os.path.splitext(os.path.basename(filename))[0]
     outDir = os.path.join(tempDir, basenameWithoutExtension)
@@ -813,6 +840,7 @@ def saveCSV(filename, timesteps):
 
     kiwiviewerExporter.zipDir(outDir, filename)
     kiwiviewerExporter.shutil.rmtree(tempDir)
+    return True
 
 # transform parameter indicates the coordinates system and
 # the referential for the exported points clouds:
@@ -923,9 +951,9 @@ def onSaveCSV():
             if frameOptions.mode == vvSelectFramesDialog.ALL_FRAMES:
                 saveAllFrames(fileName, saveCSV)
             else:
-                start = frameOptions.start
-                stop = frameOptions.stop
-                saveFrameRange(fileName, start, stop, saveCSV)
+                # the dialog frames are indices of the shown timesteps
+                timesteps = getCurrentTimesteps()[frameOptions.start:frameOptions.stop + 1]
+                saveCSV(fileName, timesteps)
 
             setTransformMode(oldTransform)
 
@@ -1225,6 +1253,26 @@ def stopStream():
         sensor.Stop()
 
 
+def addSensor(LIDARPort, calibrationFile, LIDARForwardingPort=0):
+    '''Listen to an additional lidar, of the same kind as the opened one, on its own port'''
+    sensor = getSensor()
+    if sensor:
+        sensor.Stop()
+        sensor.AdditionalSensors = list(sensor.AdditionalSensors) + \
+            [str(LIDARPort), calibrationFile, str(LIDARForwardingPort)]
+        sensor.UpdateVTKObjects()
+        sensor.Start()
+
+
+def removeAdditionalSensors():
+    sensor = getSensor()
+    if sensor:
+        sensor.Stop()
+        sensor.AdditionalSensors = []
+        sensor.UpdateVTKObjects()
+        sensor.Start()
+
+
 def pollSource():
 
     source = getSensor()
@@ -1347,7 +1395,7 @@ def onCropReturns(show = True):
 
     if lidarInterpreter:
         lidarInterpreter.CropOutside = dialog.cropOutside
-        dialogCropMode = ['None', 'Cartesian', 'Spherical']
+        dialogCropMode = ['None', 'Cartesian', 'Spherical', 'Cylindric']
         lidarInterpreter.CropMode = dialogCropMode[dialog.GetCropMode()]
         p1 = dialog.firstCorner
         p2 = dialog.secondCorner
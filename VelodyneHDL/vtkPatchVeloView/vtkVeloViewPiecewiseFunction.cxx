@@ -1136,6 +1136,46 @@ void vtkVeloViewPiecewiseFunction::FillFromDataPointer(int nb, double *ptr)
   this->SortAndUpdateRange();
 }
 
+// Append an array of (x, y) pairs to the function. The nodes are only
+// sorted again if the new points are not sorted after the current ones.
+void vtkVeloViewPiecewiseFunction::AppendFromDataPointer(int nb, double *ptr)
+{
+  if (nb <= 0 || !ptr)
+    {
+    return;
+    }
+
+  bool isSorted = this->Internal->Nodes.empty() ||
+                  ptr[0] > this->Internal->Nodes.back()->X;
+
+  double *inPtr = ptr;
+  int i;
+  for (i=0; i < nb; i++)
+    {
+    vtkPiecewiseFunctionNode *node = new vtkPiecewiseFunctionNode;
+    node->X  = inPtr[0];
+    node->Y  = inPtr[1];
+    node->Sharpness = 0.0;
+    node->Midpoint  = 0.5;
+
+    if (i > 0 && inPtr[0] <= inPtr[-2])
+      {
+      isSorted = false;
+      }
+    this->Internal->Nodes.push_back(node);
+    inPtr += 2;
+    }
+
+  if (!isSorted)
+    {
+    this->SortAndUpdateRange();
+    }
+  else if (!this->UpdateRange())
+    {
+    this->Modified();
+    }
+}
+
 //----------------------------------------------------------------------------
 vtkVeloViewPiecewiseFunction* vtkVeloViewPiecewiseFunction::GetData(vtkInformation* info)
 {
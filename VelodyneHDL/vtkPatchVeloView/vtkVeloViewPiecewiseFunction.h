@@ -99,6 +99,12 @@ public:
   double *GetDataPointer();
   void FillFromDataPointer(int, double*);
 
+  // Description:
+  // Add (x, y) pairs to the function. When they are sorted and after the
+  // last node, the nodes are not sorted again, so that appending to a
+  // large function is linear in the number of added points.
+  void AppendFromDataPointer(int, double*);
+
   // Description:
   // Returns the min and max node locations of the function.
   vtkGetVector2Macro( Range, double );
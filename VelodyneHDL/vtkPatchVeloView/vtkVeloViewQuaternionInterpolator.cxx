@@ -16,6 +16,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkVeloViewQuaternion.h"
 #include "vtkVeloViewQuaternionInterpolator.h"
+#include <algorithm>
 #include <vector>
 
 vtkStandardNewMacro(vtkVeloViewQuaternionInterpolator);
@@ -199,46 +200,31 @@ void vtkVeloViewQuaternionInterpolator::InterpolateQuaternion(double t,
 
   else if ( t >= this->QuaternionList->back().Time )
     {
-    TimedQuaternion &Q = this->QuaternionList->front();
+    TimedQuaternion &Q = this->QuaternionList->back();
     q = Q.Q;
     return;
     }
 
+  // Find the interval [iter, nextIter] containing t by bisection, the
+  // list being sorted. The code above guarantees that there are at least
+  // two quaternions defined and that t is strictly inside their range.
+  QuaternionListIterator nextIter = std::upper_bound(
+    this->QuaternionList->begin(), this->QuaternionList->end(), t,
+    [](double time, const TimedQuaternion& quaternion) { return time < quaternion.Time; });
+  QuaternionListIterator iter = nextIter - 1;
+  double T = (t - iter->Time) / (nextIter->Time - iter->Time);
+
   // Depending on the interpolation type we do the right thing.
-  // The code above guarantees that there are at least two quaternions defined.
   int numQuats = this->GetNumberOfQuaternions();
   if ( this->InterpolationType == INTERPOLATION_TYPE_LINEAR || numQuats < 3 )
     {
-    QuaternionListIterator iter = this->QuaternionList->begin();
-    QuaternionListIterator nextIter = iter + 1;
-    for ( ; nextIter != this->QuaternionList->end(); ++iter, ++nextIter)
-      {
-      if ( iter->Time <= t && t <= nextIter->Time )
-        {
-        double T = (t - iter->Time) / (nextIter->Time - iter->Time);
-        q = iter->Q.Slerp(T,nextIter->Q);
-        break;
-        }
-      }
+    q = iter->Q.Slerp(T,nextIter->Q);
     }//if linear quaternion interpolation
 
   else // this->InterpolationType == INTERPOLATION_TYPE_SPLINE
     {
-    QuaternionListIterator iter = this->QuaternionList->begin();
-    QuaternionListIterator nextIter = iter + 1;
     QuaternionListIterator iter0, iter1, iter2, iter3;
-
-    //find the interval
-    double T=0.0;
-    int i;
-    for (i=0; nextIter != this->QuaternionList->end(); ++iter, ++nextIter, ++i)
-      {
-      if ( iter->Time <= t && t <= nextIter->Time )
-        {
-        T = (t - iter->Time) / (nextIter->Time - iter->Time);
-        break;
-        }
-      }
+    int i = static_cast<int>(iter - this->QuaternionList->begin());
 
     vtkVeloViewQuaterniond ai, bi, qc, qd;
     if ( i == 0 ) //initial interval
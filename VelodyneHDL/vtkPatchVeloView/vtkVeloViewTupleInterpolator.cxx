@@ -236,6 +236,28 @@ void vtkVeloViewTupleInterpolator::FillFromData(int nb, double *t, double **data
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkVeloViewTupleInterpolator::AppendFromData(int nb, double *t, double **data)
+{
+  int i;
+  if ( this->InterpolationType == INTERPOLATION_TYPE_LINEAR )
+    {
+    double *ptr = new double[2*nb];
+    for (i=0; i<this->NumberOfComponents; i++)
+      {
+      double *dimData = data[i];
+      for (int j = 0; j < nb; j++)
+        {
+        ptr[2 * j] = t[j];
+        ptr[2 * j + 1] = dimData[j];
+        }
+      this->Linear[i]->AppendFromDataPointer(nb, ptr);
+      }
+    delete [] ptr;
+    this->Modified();
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkVeloViewTupleInterpolator::AddTuple(double t, double tuple[])
 {
@@ -87,6 +87,11 @@ public:
   // each time a tuple is added. 
   void FillFromData(int nb, double *t, double **data);
 
+  // Description:
+  // Add tuples after the ones given to FillFromData, without sorting again
+  // all the tuples when the new ones are sorted and after them.
+  void AppendFromData(int nb, double *t, double **data);
+
   // Description:
   // Add another tuple to the list of tuples to be interpolated.  Note that
   // using the same time t value more than once replaces the previous tuple